@@ -49,43 +49,13 @@
 //TwoWire SercomWire(&sercom2, 4, 3);
 
 
-/**************************************************************************/
-/*!
-    @brief  Abstract away platform differences in Arduino wire library
-*/
-/**************************************************************************/
-uint8_t Adafruit_ADS1015_Flex::i2cread(void) {
-  #if ARDUINO >= 100
-  return _wire->read();
-  #else
-  return _wire->receive();
-  #endif
-}
-
-/**************************************************************************/
-/*!
-    @brief  Abstract away platform differences in Arduino wire library
-*/
-/**************************************************************************/
-void Adafruit_ADS1015_Flex::i2cwrite(uint8_t x) {
-  #if ARDUINO >= 100
-  _wire->write((uint8_t)x);
-  #else
-  _wire->send(x);
-  #endif
-}
-
 /**************************************************************************/
 /*!
     @brief  Writes 16-bits to the specified destination register
 */
 /**************************************************************************/
-void Adafruit_ADS1015_Flex::writeRegister(uint8_t i2cAddress, uint8_t reg, uint16_t value) {
-  _wire->beginTransmission(i2cAddress);
-  i2cwrite((uint8_t)reg);
-  i2cwrite((uint8_t)(value>>8));
-  i2cwrite((uint8_t)(value & 0xFF));
-  _wire->endTransmission();
+bool Adafruit_ADS1015_Flex::writeRegister(uint8_t reg, uint16_t value) {
+  return m_i2c.write16(reg, value);
 }
 
 /**************************************************************************/
@@ -93,12 +63,8 @@ void Adafruit_ADS1015_Flex::writeRegister(uint8_t i2cAddress, uint8_t reg, uint1
     @brief  Reads 16-bits to the specified destination register
 */
 /**************************************************************************/
-uint16_t Adafruit_ADS1015_Flex::readRegister(uint8_t i2cAddress, uint8_t reg) {
-  _wire->beginTransmission(i2cAddress);
-  i2cwrite(reg);
-  _wire->endTransmission();
-  _wire->requestFrom(i2cAddress, (uint8_t)2);
-  return ((i2cread() << 8) | i2cread());
+uint16_t Adafruit_ADS1015_Flex::readRegister(uint8_t reg) {
+  return m_i2c.read16(reg);
 }
 
 /**************************************************************************/
@@ -107,14 +73,19 @@ uint16_t Adafruit_ADS1015_Flex::readRegister(uint8_t i2cAddress, uint8_t reg) {
 */
 /**************************************************************************/
 
-Adafruit_ADS1015_Flex::Adafruit_ADS1015_Flex(TwoWire *wire) { // convenience init
-   Adafruit_ADS1015_Flex(wire, m_i2cAddress);
+Adafruit_ADS1015_Flex::Adafruit_ADS1015_Flex(TwoWire *wire) // convenience init
+  : Adafruit_ADS1015_Flex(wire, ADS1X15_ADDRESS) {
 }
 
-Adafruit_ADS1015_Flex::Adafruit_ADS1015_Flex(TwoWire *wire, uint8_t i2cAddress) {
+Adafruit_ADS1015_Flex::Adafruit_ADS1015_Flex(TwoWire *wire, uint8_t i2cAddress)
+  : m_i2c(wire, i2cAddress) {
    this->_wire = wire;
    m_i2cAddress = i2cAddress; //ADS1X15_ADDRESS; //  ToDo: make more flexible
    m_bitShift = ADS1015_CONV_REG_BIT_SHIFT_4;
+   for (uint8_t i = 0; i < ADS1X15_INPUTS; i++)
+   {
+     m_autoGain[i] = GAIN_TWOTHIRDS;   // widest range until an input was seen
+   }
 }
 
 
@@ -123,13 +94,11 @@ Adafruit_ADS1015_Flex::Adafruit_ADS1015_Flex(TwoWire *wire, uint8_t i2cAddress)
     @brief  Instantiates a new ADS1115 class w/appropriate properties
 */
 /**************************************************************************/
-/*
-Adafruit_ADS1115_Flex::Adafruit_ADS1115_Flex(uint8_t i2cAddress)
-{
-   m_i2cAddress = i2cAddress;
+Adafruit_ADS1115_Flex::Adafruit_ADS1115_Flex(TwoWire *wire, uint8_t i2cAddress)
+  : Adafruit_ADS1015_Flex(wire, i2cAddress) {
    m_bitShift = ADS1115_CONV_REG_BIT_SHIFT_0;
 }
-*/
+
 /**************************************************************************/
 /*!
     @brief  Sets up the HW (reads coefficients values, etc.)
@@ -139,6 +108,24 @@ void Adafruit_ADS1015_Flex::begin() {
   //_wire->begin();
 }
 
+/**************************************************************************/
+/*!
+    @brief  Factories for FlexRegistry, which cannot tell an ADS1015 from
+            an ADS1115: the sketch registers the one it has
+*/
+/**************************************************************************/
+FlexAsyncSensor *Adafruit_ADS1015_Flex::create(TwoWire *wire, uint8_t i2cAddress) {
+  Adafruit_ADS1015_Flex *ads = new Adafruit_ADS1015_Flex(wire, i2cAddress);
+  ads->begin();
+  return ads;
+}
+
+FlexAsyncSensor *Adafruit_ADS1115_Flex::create(TwoWire *wire, uint8_t i2cAddress) {
+  Adafruit_ADS1115_Flex *ads = new Adafruit_ADS1115_Flex(wire, i2cAddress);
+  ads->begin();
+  return ads;
+}
+
 #if defined(ARDUINO_ARCH_ESP8266)
 /**************************************************************************/
 /*!
@@ -224,6 +211,9 @@ uint16_t getSingleEndedConfigBitsForMUX(uint8_t channel) {
 */
 /**************************************************************************/
 float Adafruit_ADS1015_Flex::readADC_SingleEnded_V(uint8_t channel) {
+	if (m_autoRange && channel <= 3) {
+	  return autoRangeVolts(getSingleEndedConfigBitsForMUX(channel));
+	}
 	return (float)readADC_SingleEnded(channel) * voltsPerBit();
 }
 
@@ -233,11 +223,61 @@ float Adafruit_ADS1015_Flex::readADC_SingleEnded_V(uint8_t channel) {
 */
 /**************************************************************************/
 int16_t Adafruit_ADS1015_Flex::readADC_SingleEnded(uint8_t channel) {
+  int16_t value = 0;
+  readADC_SingleEnded(channel, &value);
+  return value;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets a single-ended ADC reading from the specified channel.
+            *value is only written on FLEX_OK.
+*/
+/**************************************************************************/
+flexResult_t Adafruit_ADS1015_Flex::readADC_SingleEnded(uint8_t channel, int16_t *value) {
   if (channel > 3)
   {
-    return 0;
+    return m_i2c.setError(FLEX_ERR_ARG);
+  }
+  return readSingleShot(getSingleEndedConfigBitsForMUX(channel), m_gain, value);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts a single-shot conversion, waits for it (bounded by the
+            conversion time plus the device timeout) and reads the result
+*/
+/**************************************************************************/
+flexResult_t Adafruit_ADS1015_Flex::readSingleShot(uint16_t mux, adsGain_t gain, int16_t *value) {
+  // Write config register to the ADC
+  if (!startSingleShot(mux, gain))
+  {
+    return m_i2c.lastError();
+  }
+
+  // Wait for the conversion to complete
+  flexResult_t result = waitForConversion();
+  if (result != FLEX_OK)
+  {
+    return result;
+  }
+
+  int16_t conversion = getLastConversionResults();
+  if (m_i2c.lastError() == FLEX_OK)
+  {
+    *value = conversion;
+    markSampled(m_startedAt + conversionMidpoint());
   }
+  return m_i2c.lastError();
+}
 
+/**************************************************************************/
+/*!
+    @brief  Single-shot config word for mux, gain and data rate, with the
+            'start single-conversion' bit set
+*/
+/**************************************************************************/
+uint16_t Adafruit_ADS1015_Flex::singleShotConfig(uint16_t mux, adsGain_t gain, adsSPS_t sps) {
   // Start with default values
   uint16_t config = ADS1X15_REG_CONFIG_CQUE_NONE    | // Disable the comparator (default val)
                     ADS1X15_REG_CONFIG_CLAT_NONLAT  | // Non-latching (default val)
@@ -246,24 +286,35 @@ int16_t Adafruit_ADS1015_Flex::readADC_SingleEnded(uint8_t channel) {
                     ADS1X15_REG_CONFIG_MODE_SINGLE;   // Single-shot mode (default)
 
   // Set PGA/voltage range
-  config |= m_gain;
+  config |= gain;
 
   // Set Samples per Second
-  config |= m_SPS;
+  config |= sps;
 
-  // Set single-ended input channel
-  config |= getSingleEndedConfigBitsForMUX(channel);
+  // Set input channel(s)
+  config |= mux;
 
   // Set 'start single-conversion' bit
   config |= ADS1X15_REG_CONFIG_OS_SINGLE;
+  return config;
+}
 
-  // Write config register to the ADC
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_CONFIG, config);
+/**************************************************************************/
+/*!
+    @brief  Writes the single-shot config word for the given MUX bits,
+            which starts the conversion. Does not wait.
+*/
+/**************************************************************************/
+bool Adafruit_ADS1015_Flex::startSingleShot(uint16_t mux, adsGain_t gain) {
+  uint16_t config = singleShotConfig(mux, gain, m_SPS);
 
-  // Wait for the conversion to complete
-  waitForConversion();
+  m_mux = mux;
+  m_continuous = false;
 
-  return getLastConversionResults();                                      // conversion delay is included in this method
+  // Write config register to the ADC
+  bool ok = writeRegister(ADS1X15_REG_POINTER_CONFIG, config);
+  m_startedAt = micros();
+  return ok;
 }
 
 /**************************************************************************/
@@ -275,32 +326,20 @@ int16_t Adafruit_ADS1015_Flex::readADC_SingleEnded(uint8_t channel) {
 */
 /**************************************************************************/
 int16_t Adafruit_ADS1015_Flex::readADC_Differential(adsDiffMux_t regConfigDiffMUX) {
-  // Start with default values
-  uint16_t config = ADS1X15_REG_CONFIG_CQUE_NONE    | // Disable the comparator (default val)
-                    ADS1X15_REG_CONFIG_CLAT_NONLAT  | // Non-latching (default val)
-                    ADS1X15_REG_CONFIG_CPOL_ACTVLOW | // Alert/Rdy active low   (default val)
-                    ADS1X15_REG_CONFIG_CMODE_TRAD   | // Traditional comparator (default val)
-                    ADS1X15_REG_CONFIG_MODE_SINGLE;   // Single-shot mode (default)
-
-  // Set PGA/voltage range
-  config |= m_gain;
-
-  // Set Samples per Second
-  config |= m_SPS;
-
-  // Set channels
-  config |= regConfigDiffMUX;          // set P and N inputs for differential
-
-  // Set 'start single-conversion' bit
-  config |= ADS1X15_REG_CONFIG_OS_SINGLE;
-
-  // Write config register to the ADC
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_CONFIG, config);
-
-  // Wait for the conversion to complete
-  waitForConversion();
+  int16_t value = 0;
+  readADC_Differential(regConfigDiffMUX, &value);
+  return value;
+}
 
-  return getLastConversionResults();                                      // conversion delay is included in this method
+/**************************************************************************/
+/*!
+    @brief  Differential reading as above, *value is only written on
+            FLEX_OK
+*/
+/**************************************************************************/
+flexResult_t Adafruit_ADS1015_Flex::readADC_Differential(adsDiffMux_t regConfigDiffMUX, int16_t *value) {
+  // Set P and N inputs for differential
+  return readSingleShot(regConfigDiffMUX, m_gain, value);
 }
 
 /**************************************************************************/
@@ -361,6 +400,10 @@ int16_t Adafruit_ADS1015_Flex::readADC_Differential_2_3() {
 */
 /**************************************************************************/
 float Adafruit_ADS1015_Flex::readADC_Differential_0_1_V() {
+  if (m_autoRange)
+  {
+    return autoRangeVolts(DIFF_MUX_0_1);
+  }
   return (float) readADC_Differential(DIFF_MUX_0_1) * voltsPerBit();                               // AIN0 = P, AIN1 = N
 }
 
@@ -374,6 +417,10 @@ float Adafruit_ADS1015_Flex::readADC_Differential_0_1_V() {
 */
 /**************************************************************************/
 float Adafruit_ADS1015_Flex::readADC_Differential_0_3_V() {
+  if (m_autoRange)
+  {
+    return autoRangeVolts(DIFF_MUX_0_3);
+  }
   return (float) readADC_Differential(DIFF_MUX_0_3) * voltsPerBit();                               // AIN0 = P, AIN1 = N
 }
 
@@ -387,6 +434,10 @@ float Adafruit_ADS1015_Flex::readADC_Differential_0_3_V() {
 */
 /**************************************************************************/
 float Adafruit_ADS1015_Flex::readADC_Differential_1_3_V() {
+  if (m_autoRange)
+  {
+    return autoRangeVolts(DIFF_MUX_1_3);
+  }
   return (float) readADC_Differential(DIFF_MUX_1_3) * voltsPerBit();                               // AIN0 = P, AIN1 = N
 }
 
@@ -400,6 +451,10 @@ float Adafruit_ADS1015_Flex::readADC_Differential_1_3_V() {
 */
 /**************************************************************************/
 float Adafruit_ADS1015_Flex::readADC_Differential_2_3_V() {
+  if (m_autoRange)
+  {
+    return autoRangeVolts(DIFF_MUX_2_3);
+  }
   return (float) readADC_Differential(DIFF_MUX_2_3) * voltsPerBit();                               // AIN0 = P, AIN1 = N
 }
 
@@ -431,16 +486,21 @@ void Adafruit_ADS1015_Flex::startComparator_SingleEnded(uint8_t channel, int16_t
   // Set single-ended input channel
   config |= getSingleEndedConfigBitsForMUX(channel);
 
+  FlexI2CBatch batch;
+
   // Set the high threshold register
   // Shift 12-bit results left 4 bits for the ADS1015
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_HITHRESH, highThreshold << m_bitShift);
+  batch.write16(ADS1X15_REG_POINTER_HITHRESH, highThreshold << m_bitShift);
 
   // Set the high threshold register to the default
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_LOWTHRESH, ADS1X15_LOW_THRESHOLD_DEFAULT);
+  batch.write16(ADS1X15_REG_POINTER_LOWTHRESH, ADS1X15_LOW_THRESHOLD_DEFAULT);
 
   // Write config register to the ADC
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_CONFIG, config);
+  batch.write16(ADS1X15_REG_POINTER_CONFIG, config);
 
+  // All three writes back to back
+  m_i2c.run(&batch);
+  m_continuous = true;
 }
 
 
@@ -472,16 +532,21 @@ void Adafruit_ADS1015_Flex::startWindowComparator_SingleEnded(uint8_t channel, i
   // Set single-ended input channel
   config |= getSingleEndedConfigBitsForMUX(channel);
 
+  FlexI2CBatch batch;
+
   // Set the high threshold register
   // Shift 12-bit results left 4 bits for the ADS1015
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_HITHRESH, highThreshold << m_bitShift);
+  batch.write16(ADS1X15_REG_POINTER_HITHRESH, highThreshold << m_bitShift);
 
   // Set the high threshold register to the default
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_LOWTHRESH, lowThreshold << m_bitShift);
+  batch.write16(ADS1X15_REG_POINTER_LOWTHRESH, lowThreshold << m_bitShift);
 
   // Write config register to the ADC
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_CONFIG, config);
+  batch.write16(ADS1X15_REG_POINTER_CONFIG, config);
 
+  // All three writes back to back
+  m_i2c.run(&batch);
+  m_continuous = true;
 }
 
 
@@ -493,6 +558,18 @@ void Adafruit_ADS1015_Flex::startWindowComparator_SingleEnded(uint8_t channel, i
 */
 /**************************************************************************/
 void Adafruit_ADS1015_Flex::startContinuous_SingleEnded(uint8_t channel)
+{
+  startContinuous(getSingleEndedConfigBitsForMUX(channel));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Continuous conversions of mux (single-ended or differential)
+            with ALERT/RDY pulsing at every result, see
+            startContinuous_SingleEnded() and ADS1x15Stream
+*/
+/**************************************************************************/
+bool Adafruit_ADS1015_Flex::startContinuous(uint16_t mux)
 {
   // Start with default values
   uint16_t config = ADS1X15_REG_CONFIG_CQUE_1CONV   | // Comparator enabled and asserts on 1 match
@@ -505,66 +582,248 @@ void Adafruit_ADS1015_Flex::startContinuous_SingleEnded(uint8_t channel)
   // Set Samples per Second
   config |= m_SPS;
 
-  // Set single-ended input channel
-  config |= getSingleEndedConfigBitsForMUX(channel);
+  // Set the input
+  config |= mux;
 
   // Continuous mode is set by setting the most signigicant bit for the HIGH threshold to 1
   // and for the LOW threshold to 0.  This is accomlished by setting the HIGH threshold to the
   // low default (a negative number) and the LOW threshold to the HIGH default (a positive number)
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_HITHRESH, ADS1X15_LOW_THRESHOLD_DEFAULT);
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_LOWTHRESH, ADS1X15_HIGH_THRESHOLD_DEFAULT);
+  FlexI2CBatch batch;
+  batch.write16(ADS1X15_REG_POINTER_HITHRESH, ADS1X15_LOW_THRESHOLD_DEFAULT);
+  batch.write16(ADS1X15_REG_POINTER_LOWTHRESH, ADS1X15_HIGH_THRESHOLD_DEFAULT);
 
   // Write config register to the ADC
-  writeRegister(m_i2cAddress, ADS1X15_REG_POINTER_CONFIG, config);
+  batch.write16(ADS1X15_REG_POINTER_CONFIG, config);
 
+  // All three writes back to back
+  m_mux = mux;
+  m_continuous = true;
+  return (m_i2c.run(&batch) == FLEX_OK);
 }
 
 /**************************************************************************/
 /*!
-    @brief  Poll the device each millisecond until the conversion is done.
-	        Using delay is important for an ESP8266 becasue it yeilds to the
-			allow network operations to run.
+    @brief  Sleeps or yields until the modelled end of the last single-shot
+            conversion, then confirms it with one read of the config
+            register (see waitReady()). Using delay is important for an
+            ESP8266 because it yields to allow network operations to run.
+            Gives up with FLEX_ERR_TIMEOUT once the conversion is overdue
+            by more than the device timeout, or on the first bus error (a
+            failed read used to look like a busy ADC and hang here forever).
 */
 /**************************************************************************/
-void Adafruit_ADS1015_Flex::waitForConversion()
+flexResult_t Adafruit_ADS1015_Flex::waitForConversion()
 {
-  delay(0);                // delay(0) causes a yeild for ESP8266
-  delayMicroseconds(10);   // Slight delay to ensure converstion started.  Probably not needed, but for safety
-  do {
-	  delay(0);            // delay(0) causes a yeild for ESP8266
-	 }
-	 while (ADS1X15_REG_CONFIG_OS_BUSY == (readRegister(m_i2cAddress, ADS1X15_REG_POINTER_CONFIG) & ADS1X15_REG_CONFIG_OS_MASK));
-            // Stop when the config register OS bit changes to 1
+  return waitReady(m_startedAt, conversionMicros(m_SPS), &m_readMicros);
 }
 
 /**************************************************************************/
 /*!
-    @brief  This function reads the last conversion
-            results without changing the config value.
+    @brief  Learned slowdown of this chip's oscillator in 1/1024 of the
+            nominal period (0 until a conversion overran the model)
+*/
+/**************************************************************************/
+uint16_t Adafruit_ADS1015_Flex::rateTrim(void)
+{
+  return m_rateTrim;
+}
 
-			After the comparator triggers, in order to clear the comparator,
-			we need to read the conversion results.
+/**************************************************************************/
+/*!
+    @brief  OS checks that found a conversion still running past the
+            modelled end, each one a bus transaction the model could
+            not save
 */
 /**************************************************************************/
-int16_t Adafruit_ADS1015_Flex::getLastConversionResults()
+uint32_t Adafruit_ADS1015_Flex::conversionOverruns(void)
+{
+  return m_overruns;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Modelled length of a conversion with a nominal period (us,
+            without the start-up): the period plus the learned trim
+*/
+/**************************************************************************/
+uint32_t Adafruit_ADS1015_Flex::expectedMicros(uint32_t nominal)
+{
+  return nominal + (nominal * m_rateTrim) / ADS1X15_TRIM_ONE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  A conversion of this nominal period was still running elapsed
+            us after its start: raises the trim so the model covers it
+            (rounded up, at most ADS1X15_TRIM_MAX)
+*/
+/**************************************************************************/
+void Adafruit_ADS1015_Flex::stretchConversion(uint32_t nominal, uint32_t elapsed)
 {
-  // Read the conversion results
-  uint16_t res = readRegister(m_i2cAddress, ADS1X15_REG_POINTER_CONVERT) >> m_bitShift;
-  if (m_bitShift == ADS1115_CONV_REG_BIT_SHIFT_0)            // for ADS1115
+  m_onTime = 0;
+  if (nominal == 0 || elapsed <= 10 + expectedMicros(nominal))
   {
-    return (int16_t)res;
+    return;
   }
-  else
+  uint32_t over = elapsed - 10 - nominal;
+  uint32_t trim = (over * ADS1X15_TRIM_ONE + nominal - 1) / nominal;
+  m_rateTrim = (trim > ADS1X15_TRIM_MAX) ? ADS1X15_TRIM_MAX : trim;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sleeps through the modelled conversion time (nominal period
+            plus the learned trim), less the time of the previous check
+            (*readMicros, a pointer write plus 2 byte read) so the one
+            confirming check lands on the end of the conversion. A check
+            that still finds it running counts an overrun; OS is then
+            re-checked after 1/64 period, doubling the gap up to 1/4
+            period so a stalled chip costs a few checks, and the trim is
+            raised to the middle of the last gap, where the end was.
+            Every ADS1X15_TRIM_DECAY on-time checks give one unit back,
+            so the model follows a chip that warms up faster.
+            Gives up 25% past the nominal period plus the device timeout.
+*/
+/**************************************************************************/
+flexResult_t Adafruit_ADS1015_Flex::waitReady(uint32_t startedAt, uint32_t nominal, uint32_t *readMicros)
+{
+  FlexI2CDevice *dev = &m_i2c;
+  uint32_t waitStart = dev->waitBegin();
+  uint32_t expected = 10 + expectedMicros(nominal);   // +10us conversion start-up
+  uint32_t elapsed = micros() - startedAt;
+  flexResult_t result = FLEX_OK;
+  bool late = false;
+  uint32_t busyAt = 0;            // last check that found it running
+
+  uint32_t lead = *readMicros;    // the check samples OS near its end
+  if (elapsed + lead < expected)
+  {
+    uint32_t sleep = expected - elapsed - lead;
+    delay(sleep / 1000);          // yields on ESP8266, even delay(0)
+    delayMicroseconds(sleep % 1000);
+  }
+
+  uint32_t deadline = dev->deadline(nominal / 4 + lead);
+  uint32_t step = nominal / ADS1X15_OVERRUN_STEPS;
+  for (;;)
+  {
+    uint32_t readAt = micros();
+    uint16_t config = dev->read16(ADS1X15_REG_POINTER_CONFIG);
+    *readMicros = micros() - readAt;
+    if (dev->lastError() != FLEX_OK)
+    {
+      result = dev->lastError();
+      break;
+    }
+    if ((config & ADS1X15_REG_CONFIG_OS_MASK) != ADS1X15_REG_CONFIG_OS_BUSY)
+    {
+      break;
+    }
+    busyAt = micros() - startedAt;
+    if (busyAt > expected)
+    {
+      m_overruns++;               // not a check sent early by a stale lead
+      late = true;
+    }
+    if (dev->expired(deadline))
+    {
+      result = FLEX_ERR_TIMEOUT;
+      break;
+    }
+    uint32_t left = deadline - micros();
+    delay(0);
+    delayMicroseconds((step < left) ? step : left);
+    step = (2 * step < nominal / ADS1X15_OVERRUN_BACKOFF) ? 2 * step : nominal / ADS1X15_OVERRUN_BACKOFF;
+  }
+
+  if (late && result == FLEX_OK)
+  {
+    stretchConversion(nominal, busyAt + (micros() - startedAt - busyAt) / 2);
+  }
+  else if (!late && m_rateTrim > 0 && ++m_onTime >= ADS1X15_TRIM_DECAY)
+  {
+    m_rateTrim--;
+    m_onTime = 0;
+  }
+  dev->waitEnd(waitStart);
+  return result;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Conversion register as readADC_SingleEnded() returns it
+*/
+/**************************************************************************/
+bool Adafruit_ADS1015_Flex::readResult(int16_t *counts)
+{
+  uint8_t raw[2];
+
+  if (!m_i2c.readRegisters(ADS1X15_REG_POINTER_CONVERT, raw, 2))
+  {
+    return false;
+  }
+  // The ADS1015 12-bit result is left aligned, an arithmetic shift keeps the sign
+  *counts = (int16_t)(((uint16_t)raw[0] << 8) | raw[1]) >> m_bitShift;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads the finished single-shot result and, for next != 0,
+            starts the next conversion with that config word. The start
+            goes first when the next conversion is at least twice as long
+            as a register read (readMicros): the conversion register only
+            changes when the new conversion ends. Otherwise (e.g. 3300
+            SPS on a 100 kHz bus) the result is read first so it cannot
+            be overwritten mid-read. *nextStartedAt is micros() after the
+            config write.
+*/
+/**************************************************************************/
+bool Adafruit_ADS1015_Flex::collectAndStart(uint16_t next, uint32_t nextConversion, uint32_t readMicros,
+                                            int16_t *counts, uint32_t *nextStartedAt)
+{
+  bool    nextFirst = (next != 0) && (nextConversion > 2 * readMicros);
+
+  m_continuous = false;
+  if (nextFirst)
+  {
+    if (!m_i2c.write16(ADS1X15_REG_POINTER_CONFIG, next))
+    {
+      return false;
+    }
+    *nextStartedAt = micros();
+  }
+
+  if (!readResult(counts))
   {
-    // Shift 12-bit results right 4 bits for the ADS1015,
-    // making sure we keep the sign bit intact
-    if (res > 0x07FF)
+    return false;
+  }
+
+  if ((next != 0) && !nextFirst)
+  {
+    if (!m_i2c.write16(ADS1X15_REG_POINTER_CONFIG, next))
     {
-      // negative number - extend the sign to 16th bit
-      res |= 0xF000;
+      return false;
     }
-    return (int16_t)res;
+    *nextStartedAt = micros();
   }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  This function reads the last conversion
+            results without changing the config value.
+
+			After the comparator triggers, in order to clear the comparator,
+			we need to read the conversion results.
+*/
+/**************************************************************************/
+int16_t Adafruit_ADS1015_Flex::getLastConversionResults()
+{
+  // Read the conversion results. The ADS1015 12-bit result is left
+  // aligned, an arithmetic shift right by 4 keeps the sign intact
+  return (int16_t)readRegister(ADS1X15_REG_POINTER_CONVERT) >> m_bitShift;
 }
 
 /**************************************************************************/
@@ -575,52 +834,766 @@ int16_t Adafruit_ADS1015_Flex::getLastConversionResults()
 /**************************************************************************/
 float Adafruit_ADS1015_Flex::voltsPerBit()
 {
-	float v = 0;
-	if (m_bitShift == ADS1015_CONV_REG_BIT_SHIFT_4) {            // for ADS1015
-	  switch (m_gain)
-	  {
-		case (GAIN_TWOTHIRDS):
-		  v = ADS1015_VOLTS_PER_BIT_GAIN_TWOTHIRDS;
-		  break;
-		case (GAIN_ONE):
-		  v = ADS1015_VOLTS_PER_BIT_GAIN_ONE;
-		  break;
-		 case (GAIN_TWO):
-		  v = ADS1015_VOLTS_PER_BIT_GAIN_TWO;
-		  break;
-		case (GAIN_FOUR):
-		  v = ADS1015_VOLTS_PER_BIT_GAIN_FOUR;
-		  break;
-		case (GAIN_EIGHT):
-		  v = ADS1015_VOLTS_PER_BIT_GAIN_EIGHT;
-		  break;
-		case (GAIN_SIXTEEN):
-		  v = ADS1015_VOLTS_PER_BIT_GAIN_SIXTEEN;
-		  break;
-	  }
-	} else                  // for ADS1115
-	{
-	  switch (m_gain)
-	  {
-		case (GAIN_TWOTHIRDS):
-		  v = ADS1115_VOLTS_PER_BIT_GAIN_TWOTHIRDS;
-		  break;
-		case (GAIN_ONE):
-		  v = ADS1115_VOLTS_PER_BIT_GAIN_ONE;
-		  break;
-		 case (GAIN_TWO):
-		  v = ADS1115_VOLTS_PER_BIT_GAIN_TWO;
-		  break;
-		case (GAIN_FOUR):
-		  v = ADS1115_VOLTS_PER_BIT_GAIN_FOUR;
-		  break;
-		case (GAIN_EIGHT):
-		  v = ADS1115_VOLTS_PER_BIT_GAIN_EIGHT;
-		  break;
-		case (GAIN_SIXTEEN):
-		  v = ADS1115_VOLTS_PER_BIT_GAIN_SIXTEEN;
-		  break;
-	  }
+	return adsVoltsPerBit((adsChip_t)m_bitShift, m_gain);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts counts to micro-volts in integer math. One 16 bit
+            count is 187.5, 125, 62.5, 31.25, 15.625 or 7.8125 uV for
+            the six gains, i.e. 375/2, 125/1, 125/2 ... 125/16; ADS1015
+            counts are scaled up to 16 bit first.
+*/
+/**************************************************************************/
+int32_t Adafruit_ADS1015_Flex::microvolts(int16_t counts)
+{
+	return microvolts(counts, m_gain);
+}
+
+int32_t Adafruit_ADS1015_Flex::microvolts(int16_t counts, adsGain_t gain)
+{
+	return flexScale((int32_t)counts * (1 << m_bitShift), adsMicrovoltMul(gain), adsMicrovoltShift(gain));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts a buffer of counts (e.g. continuous mode samples) to
+            Volts, same scale as readADC_SingleEnded_V()
+*/
+/**************************************************************************/
+void Adafruit_ADS1015_Flex::convertBatch(const int16_t *counts, uint16_t count, float *volts)
+{
+	flexScaleBatch(counts, count, voltsPerBit(), volts);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Integer version of convertBatch(), same values as
+            microvolts(). The ADS1015 shift is folded into the multiplier
+            so the loop is a single multiply and shift.
+*/
+/**************************************************************************/
+void Adafruit_ADS1015_Flex::convertBatch_uV(const int16_t *counts, uint16_t count, int32_t *microvolts)
+{
+	flexScaleBatchFixed(counts, count, (int32_t)adsMicrovoltMul(m_gain) << m_bitShift, adsMicrovoltShift(m_gain), microvolts);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Single-ended reading in micro-volts, *microvolts is only
+            written on FLEX_OK
+*/
+/**************************************************************************/
+flexResult_t Adafruit_ADS1015_Flex::readADC_SingleEnded_uV(uint8_t channel, int32_t *microvolts)
+{
+	if (channel > 3) {
+	  return m_i2c.setError(FLEX_ERR_ARG);
+	}
+	return readMicrovolts(getSingleEndedConfigBitsForMUX(channel), microvolts);
+}
+
+flexResult_t Adafruit_ADS1015_Flex::readADC_Differential_uV(adsDiffMux_t regConfigDiffMUX, int32_t *microvolts)
+{
+	return readMicrovolts(regConfigDiffMUX, microvolts);
+}
+
+/**************************************************************************/
+/*!
+    @brief  One micro-volt reading of mux. At the set gain, or with auto
+            range at the gain predicted for this input; a prediction
+            that clips is converted once more at the widest range, then
+            the next gain is predicted from the result.
+*/
+/**************************************************************************/
+flexResult_t Adafruit_ADS1015_Flex::readMicrovolts(uint16_t mux, int32_t *microvolts)
+{
+	uint8_t   input = (mux & ADS1X15_REG_CONFIG_MUX_MASK) >> 12;
+	adsGain_t gain = m_autoRange ? m_autoGain[input] : m_gain;
+	int16_t   counts;
+
+	flexResult_t result = readSingleShot(mux, gain, &counts);
+	if (result == FLEX_OK && m_autoRange && clipped(counts) && gain != GAIN_TWOTHIRDS) {
+	  m_reconversions++;
+	  gain = GAIN_TWOTHIRDS;
+	  result = readSingleShot(mux, gain, &counts);
 	}
-	return v;
+	if (result != FLEX_OK) {
+	  return result;
+	}
+
+	*microvolts = this->microvolts(counts, gain);
+	m_lastGain = gain;
+	if (m_autoRange) {
+	  m_autoGain[input] = predictGain(*microvolts);
+	}
+	return FLEX_OK;
+}
+
+float Adafruit_ADS1015_Flex::autoRangeVolts(uint16_t mux)
+{
+	int32_t uV = 0;
+	readMicrovolts(mux, &uV);
+	return (float)uV * 0.000001F;
+}
+
+/**************************************************************************/
+/*!
+    @brief  True for a result at either end of the range, the input may
+            be beyond it
+*/
+/**************************************************************************/
+bool Adafruit_ADS1015_Flex::clipped(int16_t counts)
+{
+	int16_t full = (int16_t)(0x7FFF >> m_bitShift);
+	return (counts >= full) || (counts < -full);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Highest gain whose full scale holds microvolts with
+            1 / ADS1X15_AUTORANGE_HEADROOM of it to spare
+*/
+/**************************************************************************/
+adsGain_t Adafruit_ADS1015_Flex::predictGain(int32_t microvolts)
+{
+	static const adsGain_t gains[6] = { GAIN_SIXTEEN, GAIN_EIGHT, GAIN_FOUR, GAIN_TWO, GAIN_ONE, GAIN_TWOTHIRDS };
+	int32_t magnitude = (microvolts < 0) ? -microvolts : microvolts;
+	int32_t needed = magnitude + magnitude / ADS1X15_AUTORANGE_HEADROOM;
+
+	for (uint8_t i = 0; i < 5; i++) {
+	  if (needed < adsFullScaleMicrovolts(gains[i])) {
+	    return gains[i];
+	  }
+	}
+	return GAIN_TWOTHIRDS;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Turns auto range on or off for the _uV and _V reads. The
+            counts reads keep using setGain().
+*/
+/**************************************************************************/
+void Adafruit_ADS1015_Flex::setAutoRange(bool enable)
+{
+	m_autoRange = enable;
+}
+
+bool Adafruit_ADS1015_Flex::autoRange(void)
+{
+	return m_autoRange;
+}
+
+adsGain_t Adafruit_ADS1015_Flex::lastGain(void)
+{
+	return m_lastGain;
+}
+
+uint32_t Adafruit_ADS1015_Flex::rangeReconversions(void)
+{
+	return m_reconversions;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts a single-ended single-shot conversion and returns
+            immediately. Use poll() / collect() / lastResult().
+*/
+/**************************************************************************/
+bool Adafruit_ADS1015_Flex::startADC_SingleEnded(uint8_t channel)
+{
+  if (channel > 3)
+  {
+    _state = FLEX_ERROR;
+    return false;
+  }
+  m_mux = getSingleEndedConfigBitsForMUX(channel);
+  return start();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts a differential single-shot conversion and returns
+            immediately. Use poll() / collect() / lastResult().
+*/
+/**************************************************************************/
+bool Adafruit_ADS1015_Flex::startADC_Differential(adsDiffMux_t regConfigDiffMUX)
+{
+  m_mux = regConfigDiffMUX;
+  return start();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts a single-shot conversion on the last used input
+            (single ended AIN0 if nothing was started before)
+*/
+/**************************************************************************/
+bool Adafruit_ADS1015_Flex::start(void)
+{
+  if (!startSingleShot(m_mux, m_gain))
+  {
+    _state = FLEX_ERROR;
+    return false;
+  }
+  markStarted();
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Non-blocking check for the end of the conversion. The config
+            register is only read once the modelled conversion time has
+            passed, so polling early costs no bus traffic.
+*/
+/**************************************************************************/
+flexState_t Adafruit_ADS1015_Flex::poll(void)
+{
+  if (_state != FLEX_BUSY)
+  {
+    return _state;
+  }
+  if (!elapsedSinceStart(conversionTime()))
+  {
+    return FLEX_BUSY;
+  }
+  uint16_t config = readRegister(ADS1X15_REG_POINTER_CONFIG);
+  if (m_i2c.lastError() != FLEX_OK)
+  {
+    _state = FLEX_ERROR;
+  }
+  else if ((config & ADS1X15_REG_CONFIG_OS_MASK) != ADS1X15_REG_CONFIG_OS_BUSY)
+  {
+    _state = FLEX_READY;
+  }
+  else
+  {
+    // Still running past the model: the next start waits longer
+    m_overruns++;
+    stretchConversion(conversionMicros(m_SPS), micros() - _startedAt);
+    if (overdue(m_i2c.timeout()))
+    {
+      m_i2c.setError(FLEX_ERR_TIMEOUT);
+      _state = FLEX_ERROR;
+    }
+  }
+  return _state;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads the finished conversion, see lastResult()
+*/
+/**************************************************************************/
+bool Adafruit_ADS1015_Flex::collect(void)
+{
+  if (_state != FLEX_READY)
+  {
+    return false;
+  }
+  int16_t conversion = getLastConversionResults();
+  if (m_i2c.lastError() != FLEX_OK)
+  {
+    _state = FLEX_ERROR;
+    return false;
+  }
+  m_lastResult = conversion;
+  markSampled(_startedAt + conversionMidpoint());
+  _state = FLEX_IDLE;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Modelled single-shot conversion time in microseconds for the
+            current data rate and chip (1 / SPS plus the learned trim)
+*/
+/**************************************************************************/
+uint32_t Adafruit_ADS1015_Flex::conversionTime(void)
+{
+  return expectedMicros(conversionMicros(m_SPS)) + 10;    // +10us conversion start-up
+}
+
+/**************************************************************************/
+/*!
+    @brief  Nominal 1 / data rate of this chip at sps, in us
+*/
+/**************************************************************************/
+uint32_t Adafruit_ADS1015_Flex::conversionMicros(adsSPS_t sps)
+{
+  static const uint16_t ads1015Rates[8] = { 128, 250, 490, 920, 1600, 2400, 3300, 3300 };
+  static const uint16_t ads1115Rates[8] = { 8, 16, 32, 64, 128, 250, 475, 860 };
+
+  uint8_t  index = (sps >> 5) & 0x07;
+  uint16_t rate = (m_bitShift == ADS1015_CONV_REG_BIT_SHIFT_4) ? ads1015Rates[index] : ads1115Rates[index];
+
+  return 1000000UL / rate;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Single-shot conversions power the ADC down by themselves, so
+            this only ends a continuous or comparator mode: MODE goes back
+            to single-shot without starting a conversion. start() writes
+            a complete single-shot config again, there is no wake().
+*/
+/**************************************************************************/
+bool Adafruit_ADS1015_Flex::sleep(void)
+{
+  if (!m_continuous)
+  {
+    return true;
+  }
+  uint16_t config = readRegister(ADS1X15_REG_POINTER_CONFIG);
+  if (m_i2c.lastError() != FLEX_OK)
+  {
+    return false;
+  }
+  config = (config | ADS1X15_REG_CONFIG_MODE_SINGLE) & ~ADS1X15_REG_CONFIG_OS_MASK;
+  if (!writeRegister(ADS1X15_REG_POINTER_CONFIG, config))
+  {
+    return false;
+  }
+  m_continuous = false;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Datasheet typical currents: 150uA converting, 0.5uA powered
+            down (between single-shot conversions)
+*/
+/**************************************************************************/
+flexPowerProfile_t Adafruit_ADS1015_Flex::powerProfile(void)
+{
+  flexPowerProfile_t profile;
+  profile.convertMicroAmps = 150;
+  profile.idleMicroAmps = m_continuous ? 150 : 0.5F;
+  profile.sleepMicroAmps = 0.5F;
+  profile.wakeMicros = 0;
+  return profile;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Time from the config write to the middle of the integration
+            window (10us start-up plus half a data period), the instant
+            a single-shot result represents, see sampleMicros()
+*/
+/**************************************************************************/
+uint32_t Adafruit_ADS1015_Flex::conversionMidpoint(void)
+{
+  return 10 + (conversionTime() - 10) / 2;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Result fetched by the last collect()
+*/
+/**************************************************************************/
+int16_t Adafruit_ADS1015_Flex::lastResult(void)
+{
+  return m_lastResult;
+}
+
+int32_t Adafruit_ADS1015_Flex::lastResult_uV(void)
+{
+  return microvolts(m_lastResult);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Result of the last bus transaction or wait, see flexResult_t
+*/
+/**************************************************************************/
+flexResult_t Adafruit_ADS1015_Flex::lastError(void)
+{
+  return m_i2c.lastError();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Bus and wait counters of this ADC, see flexI2CStats_t
+*/
+/**************************************************************************/
+flexI2CStats_t Adafruit_ADS1015_Flex::getStats(void)
+{
+  return m_i2c.stats();
+}
+
+void Adafruit_ADS1015_Flex::resetStats(void)
+{
+  m_i2c.resetStats();
+}
+
+/***************************************************************************
+ SCAN LIST
+ ***************************************************************************/
+
+ADS1x15Scan::ADS1x15Scan(Adafruit_ADS1015_Flex *ads)
+{
+  _ads = ads;
+  _count = 0;
+  _readMicros = 0;
+  _autoRange = false;
+}
+
+bool ADS1x15Scan::addSingleEnded(uint8_t channel, adsGain_t gain, adsSPS_t sps)
+{
+  return (channel < 4) && add(getSingleEndedConfigBitsForMUX(channel), gain, sps);
+}
+
+bool ADS1x15Scan::addDifferential(adsDiffMux_t regConfigDiffMUX, adsGain_t gain, adsSPS_t sps)
+{
+  return add(regConfigDiffMUX, gain, sps);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Appends an entry with its config word built here, once;
+            false when the list is full
+*/
+/**************************************************************************/
+bool ADS1x15Scan::add(uint16_t mux, adsGain_t gain, adsSPS_t sps)
+{
+  if (_count >= ADS1X15_SCAN_MAX)
+  {
+    return false;
+  }
+  _config[_count] = _ads->singleShotConfig(mux, gain, sps);
+  _gain[_count] = gain;
+  _conversion[_count] = _ads->conversionMicros(sps);
+  _count++;
+  return true;
+}
+
+void ADS1x15Scan::clear(void)
+{
+  _count = 0;
+}
+
+uint8_t ADS1x15Scan::count(void)
+{
+  return _count;
+}
+
+uint32_t ADS1x15Scan::conversionTime(void)
+{
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    total += 10 + _ads->expectedMicros(_conversion[i]);
+  }
+  return total;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts every entry in list order, each one started as soon
+            as the one before is done (see collectAndStart()). Stops at
+            the first failure, frame->count tells how far it got.
+*/
+/**************************************************************************/
+flexResult_t ADS1x15Scan::read(adsScanFrame_t *frame)
+{
+  FlexI2CDevice *dev = &_ads->m_i2c;
+  uint32_t startedAt;
+  uint32_t nextStartedAt = 0;
+  uint32_t clipped = 0;              // entries to convert again, by bit
+
+  frame->count = 0;
+  if (_count == 0)
+  {
+    return FLEX_ERR_ARG;
+  }
+
+  _ads->m_continuous = false;
+  if (!dev->write16(ADS1X15_REG_POINTER_CONFIG, _config[0]))
+  {
+    return dev->lastError();
+  }
+  startedAt = micros();
+
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    flexResult_t result = _ads->waitReady(startedAt, _conversion[i], &_readMicros);
+    if (result != FLEX_OK)
+    {
+      return result;
+    }
+
+    bool    next = (i + 1 < _count);
+    int16_t counts;
+    if (!_ads->collectAndStart(next ? _config[i + 1] : 0, next ? _conversion[i + 1] : 0, _readMicros,
+                               &counts, &nextStartedAt))
+    {
+      return dev->lastError();
+    }
+    frame->counts[i] = counts;
+    frame->gain[i] = _gain[i];
+    frame->microvolts[i] = _ads->microvolts(counts, _gain[i]);
+    frame->at[i] = startedAt + 10 + _ads->expectedMicros(_conversion[i]) / 2;
+    frame->count++;
+    startedAt = nextStartedAt;
+
+    if (_autoRange)
+    {
+      if (_ads->clipped(counts) && _gain[i] != GAIN_TWOTHIRDS)
+      {
+        clipped |= 1UL << i;      // converted again after the frame
+      }
+      else
+      {
+        setGain(i, Adafruit_ADS1015_Flex::predictGain(frame->microvolts[i]));
+      }
+    }
+  }
+
+  for (uint8_t i = 0; clipped != 0; i++, clipped >>= 1)
+  {
+    if (clipped & 1)
+    {
+      flexResult_t result = reconvert(i, frame);
+      if (result != FLEX_OK)
+      {
+        return result;
+      }
+    }
+  }
+  return FLEX_OK;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts a clipped entry once more at +/-6.144V, replaces its
+            frame result and predicts its next gain from the new one
+*/
+/**************************************************************************/
+flexResult_t ADS1x15Scan::reconvert(uint8_t entry, adsScanFrame_t *frame)
+{
+  FlexI2CDevice *dev = &_ads->m_i2c;
+  uint16_t config = (_config[entry] & ~ADS1X15_REG_CONFIG_PGA_MASK) | GAIN_TWOTHIRDS;
+  int16_t  counts;
+
+  if (!dev->write16(ADS1X15_REG_POINTER_CONFIG, config))
+  {
+    return dev->lastError();
+  }
+  uint32_t startedAt = micros();
+  flexResult_t result = _ads->waitReady(startedAt, _conversion[entry], &_readMicros);
+  if (result != FLEX_OK)
+  {
+    return result;
+  }
+  if (!_ads->readResult(&counts))
+  {
+    return dev->lastError();
+  }
+  _ads->m_reconversions++;
+
+  frame->counts[entry] = counts;
+  frame->gain[entry] = GAIN_TWOTHIRDS;
+  frame->microvolts[entry] = _ads->microvolts(counts, GAIN_TWOTHIRDS);
+  frame->at[entry] = startedAt + 10 + _ads->expectedMicros(_conversion[entry]) / 2;
+  setGain(entry, Adafruit_ADS1015_Flex::predictGain(frame->microvolts[entry]));
+  return FLEX_OK;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gain of an entry from the next frame on, patched into its
+            config word
+*/
+/**************************************************************************/
+void ADS1x15Scan::setGain(uint8_t entry, adsGain_t gain)
+{
+  _gain[entry] = gain;
+  _config[entry] = (_config[entry] & ~ADS1X15_REG_CONFIG_PGA_MASK) | gain;
+}
+
+void ADS1x15Scan::setAutoRange(bool enable)
+{
+  _autoRange = enable;
+}
+
+/***************************************************************************
+ DEVICE ARRAY
+ ***************************************************************************/
+
+ADS1x15Array::ADS1x15Array(void)
+{
+  _count = 0;
+}
+
+bool ADS1x15Array::add(Adafruit_ADS1015_Flex *ads)
+{
+  if (_count >= ADS1X15_ARRAY_MAX)
+  {
+    return false;
+  }
+  _ads[_count] = ads;
+  _readMicros[_count] = 0;
+  _count++;
+  return true;
+}
+
+uint8_t ADS1x15Array::count(void)
+{
+  return _count;
+}
+
+/**************************************************************************/
+/*!
+    @brief  channel (0-3) of every device, into frame->counts[device][channel]
+*/
+/**************************************************************************/
+flexResult_t ADS1x15Array::readADC_SingleEnded(uint8_t channel, adsArrayFrame_t *frame)
+{
+  if (channel > 3)
+  {
+    frame->devices = _count;
+    frame->valid = 0;
+    return FLEX_ERR_ARG;
+  }
+  uint16_t mux = getSingleEndedConfigBitsForMUX(channel);
+  return sweep(&mux, &channel, 1, frame);
+}
+
+/**************************************************************************/
+/*!
+    @brief  The same pair on every device, into frame->counts[device][0]
+*/
+/**************************************************************************/
+flexResult_t ADS1x15Array::readADC_Differential(adsDiffMux_t regConfigDiffMUX, adsArrayFrame_t *frame)
+{
+  uint16_t mux = regConfigDiffMUX;
+  uint8_t  input = 0;
+  return sweep(&mux, &input, 1, frame);
+}
+
+/**************************************************************************/
+/*!
+    @brief  All four channels of every device
+*/
+/**************************************************************************/
+flexResult_t ADS1x15Array::readAll_SingleEnded(adsArrayFrame_t *frame)
+{
+  static const uint16_t mux[4] = { ADS1X15_REG_CONFIG_MUX_SINGLE_0, ADS1X15_REG_CONFIG_MUX_SINGLE_1,
+                                   ADS1X15_REG_CONFIG_MUX_SINGLE_2, ADS1X15_REG_CONFIG_MUX_SINGLE_3 };
+  static const uint8_t  input[4] = { 0, 1, 2, 3 };
+  return sweep(mux, input, 4, frame);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts mux on every device still in the sweep, back to back
+*/
+/**************************************************************************/
+void ADS1x15Array::startAll(uint16_t mux, uint32_t *startedAt, bool *alive, flexResult_t *first)
+{
+  for (uint8_t d = 0; d < _count; d++)
+  {
+    if (!alive[d])
+    {
+      continue;
+    }
+    alive[d] = _ads[d]->startSingleShot(mux, _ads[d]->m_gain);
+    startedAt[d] = micros();
+    if (!alive[d] && (*first == FLEX_OK))
+    {
+      *first = _ads[d]->lastError();
+    }
+  }
+}
+
+void ADS1x15Array::drop(uint8_t device, flexResult_t result, bool *alive, flexResult_t *first)
+{
+  alive[device] = false;
+  if (*first == FLEX_OK)
+  {
+    *first = result;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Per input: waits for the first device (the others started
+            after it, so their wait is mostly over by then) and checks OS
+            on every device. Then the next input is started on all of
+            them, back to back again, and the results are read while
+            those conversions run: the conversion registers only change
+            when they end. If the reads might not fit in a conversion
+            (fewer than 2 reads per device, measured by the OS checks)
+            the results are read first.
+*/
+/**************************************************************************/
+flexResult_t ADS1x15Array::sweep(const uint16_t *mux, const uint8_t *input, uint8_t inputs, adsArrayFrame_t *frame)
+{
+  uint32_t     startedAt[ADS1X15_ARRAY_MAX];
+  uint32_t     at[ADS1X15_ARRAY_MAX];
+  bool         alive[ADS1X15_ARRAY_MAX];
+  flexResult_t first = FLEX_OK;
+
+  frame->devices = _count;
+  frame->valid = 0;
+  if (_count == 0)
+  {
+    return FLEX_ERR_ARG;
+  }
+
+  for (uint8_t d = 0; d < _count; d++)
+  {
+    alive[d] = true;
+  }
+  startAll(mux[0], startedAt, alive, &first);
+
+  for (uint8_t i = 0; i < inputs; i++)
+  {
+    bool nextFirst = (i + 1 < inputs);
+    for (uint8_t d = 0; d < _count; d++)
+    {
+      if (!alive[d])
+      {
+        continue;
+      }
+      Adafruit_ADS1015_Flex *ads = _ads[d];
+      uint32_t conversion = ads->conversionMicros(ads->m_SPS);
+      flexResult_t result = ads->waitReady(startedAt[d], conversion, &_readMicros[d]);
+      if (result != FLEX_OK)
+      {
+        drop(d, result, alive, &first);
+        continue;
+      }
+      at[d] = startedAt[d] + ads->conversionMidpoint();
+      nextFirst = nextFirst && (conversion > 2 * _count * _readMicros[d]);
+    }
+
+    if (nextFirst)
+    {
+      startAll(mux[i + 1], startedAt, alive, &first);
+    }
+
+    for (uint8_t d = 0; d < _count; d++)
+    {
+      int16_t counts;
+      if (!alive[d])
+      {
+        continue;
+      }
+      if (!_ads[d]->readResult(&counts))
+      {
+        drop(d, _ads[d]->lastError(), alive, &first);
+        continue;
+      }
+      frame->counts[d][input[i]] = counts;
+      frame->at[d][input[i]] = at[d];
+      frame->valid |= 1UL << (d * 4 + input[i]);
+    }
+
+    if ((i + 1 < inputs) && !nextFirst)
+    {
+      startAll(mux[i + 1], startedAt, alive, &first);
+    }
+  }
+  return first;
 }
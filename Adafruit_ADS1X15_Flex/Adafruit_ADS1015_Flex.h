@@ -32,6 +32,12 @@
 #endif
 
 #include <Wire.h>
+#include <FlexI2CDevice.h>
+#include <FlexAsyncSensor.h>
+#include <FlexFixed.h>
+#include <FlexConvert.h>
+#include <FlexRing.h>
+#include <FlexI2CTransport.h>
 
 /*=========================================================================
     I2C ADDRESS/BITS
@@ -149,6 +155,33 @@
 
 /*=========================================================================*/
 
+/*=========================================================================
+    CONVERSION TIME MODEL
+    -----------------------------------------------------------------------
+    The internal oscillator is only within 10% of the nominal data rate.
+    The driver sleeps through the nominal period plus a trim learned
+    from overruns (in 1/1024 of the period, so it holds for every data
+    rate) and then confirms the end with one OS check.
+    -----------------------------------------------------------------------*/
+    #define ADS1X15_TRIM_ONE                1024   // trim units per nominal period
+    #define ADS1X15_TRIM_MAX                256    // 25%, well past the tolerance
+    #define ADS1X15_TRIM_DECAY              16     // on-time checks per unit given back
+    #define ADS1X15_OVERRUN_STEPS           64     // first re-check of an overrun, 1/64 period
+    #define ADS1X15_OVERRUN_BACKOFF         4      // re-checks double up to 1/4 period
+/*=========================================================================*/
+
+/*=========================================================================
+    AUTO RANGE
+    -----------------------------------------------------------------------
+    With auto range on, the PGA setting of every input (4 single-ended,
+    4 differential) is predicted from its previous sample: the smallest
+    full scale with 1 / ADS1X15_AUTORANGE_HEADROOM of it to spare. Only
+    a result that clips is converted again, at +/-6.144V.
+    -----------------------------------------------------------------------*/
+    #define ADS1X15_AUTORANGE_HEADROOM      8      // keep 1/8 of full scale spare
+    #define ADS1X15_INPUTS                  8      // mux settings, by MUX bits
+/*=========================================================================*/
+
 typedef enum : uint16_t
 {
   DIFF_MUX_0_1      = ADS1X15_REG_CONFIG_MUX_DIFF_0_1,
@@ -190,14 +223,83 @@ typedef enum : uint16_t
 	DR_DEFAULT_SPS             = (0x0080)     // 1600 for ADS1015, 128 for ADS1115
 } adsSPS_t;
 
-class Adafruit_ADS1015_Flex
+// Chip, by the right shift of its conversion register
+typedef enum : uint8_t
+{
+  CHIP_ADS1015      = ADS1015_CONV_REG_BIT_SHIFT_4,
+  CHIP_ADS1115      = ADS1115_CONV_REG_BIT_SHIFT_0
+} adsChip_t;
+
+/*=========================================================================
+    SCALE PER CHIP AND GAIN
+    -----------------------------------------------------------------------
+    Volts per count, and micro-volts per 16 bit count as mul >> shift
+    (187.5, 125, 62.5, 31.25, 15.625 or 7.8125 uV: 375/2, 125/1, 125/2
+    ... 125/16). Constant expressions when chip and gain are, see
+    ADS1x15<CHIP, GAIN>.
+    -----------------------------------------------------------------------*/
+    constexpr float adsVoltsPerBit(adsChip_t chip, adsGain_t gain)
+    {
+      return (chip == CHIP_ADS1015) ?
+               ((gain == GAIN_TWOTHIRDS) ? ADS1015_VOLTS_PER_BIT_GAIN_TWOTHIRDS :
+                (gain == GAIN_ONE)       ? ADS1015_VOLTS_PER_BIT_GAIN_ONE :
+                (gain == GAIN_TWO)       ? ADS1015_VOLTS_PER_BIT_GAIN_TWO :
+                (gain == GAIN_FOUR)      ? ADS1015_VOLTS_PER_BIT_GAIN_FOUR :
+                (gain == GAIN_EIGHT)     ? ADS1015_VOLTS_PER_BIT_GAIN_EIGHT :
+                (gain == GAIN_SIXTEEN)   ? ADS1015_VOLTS_PER_BIT_GAIN_SIXTEEN : 0.0F) :
+               ((gain == GAIN_TWOTHIRDS) ? ADS1115_VOLTS_PER_BIT_GAIN_TWOTHIRDS :
+                (gain == GAIN_ONE)       ? ADS1115_VOLTS_PER_BIT_GAIN_ONE :
+                (gain == GAIN_TWO)       ? ADS1115_VOLTS_PER_BIT_GAIN_TWO :
+                (gain == GAIN_FOUR)      ? ADS1115_VOLTS_PER_BIT_GAIN_FOUR :
+                (gain == GAIN_EIGHT)     ? ADS1115_VOLTS_PER_BIT_GAIN_EIGHT :
+                (gain == GAIN_SIXTEEN)   ? ADS1115_VOLTS_PER_BIT_GAIN_SIXTEEN : 0.0F);
+    }
+
+    constexpr int32_t adsFullScaleMicrovolts(adsGain_t gain)
+    {
+      return (gain == GAIN_TWOTHIRDS) ? 6144000 :
+             (gain == GAIN_ONE)       ? 4096000 :
+             (gain == GAIN_TWO)       ? 2048000 :
+             (gain == GAIN_FOUR)      ? 1024000 :
+             (gain == GAIN_EIGHT)     ? 512000 : 256000;
+    }
+
+    constexpr uint16_t adsMicrovoltMul(adsGain_t gain)
+    {
+      return (gain == GAIN_TWOTHIRDS) ? 375 : 125;
+    }
+
+    constexpr uint8_t adsMicrovoltShift(adsGain_t gain)
+    {
+      return (gain == GAIN_TWOTHIRDS) ? 1 :
+             (gain == GAIN_ONE)       ? 0 :
+             (gain == GAIN_TWO)       ? 1 :
+             (gain == GAIN_FOUR)      ? 2 :
+             (gain == GAIN_EIGHT)     ? 3 : 4;
+    }
+/*=========================================================================*/
+
+class Adafruit_ADS1015_Flex : public FlexAsyncSensor
 {
 protected:
    // Instance-specific properties
    uint8_t   m_i2cAddress;
+   FlexI2CDevice m_i2c;
    uint8_t   m_bitShift;
    adsGain_t m_gain                = GAIN_DEFAULT;  /* +/- 6.144V range (limited to VDD +0.3V max!) */
    adsSPS_t  m_SPS                 = DR_DEFAULT_SPS;
+   uint16_t  m_mux                 = ADS1X15_REG_CONFIG_MUX_SINGLE_0;  /* input of the last started conversion */
+   int16_t   m_lastResult          = 0;
+   bool      m_continuous          = false;  /* continuous / comparator mode, not powered down */
+   uint32_t  m_startedAt           = 0;      /* micros() after the last single-shot config write */
+   uint32_t  m_readMicros          = 0;      /* duration of the last OS check */
+   uint16_t  m_rateTrim            = 0;      /* learned oscillator slowdown, 1/1024 of the period */
+   uint8_t   m_onTime              = 0;      /* on-time checks since the trim last changed */
+   uint32_t  m_overruns            = 0;      /* OS checks that found a conversion past the model */
+   bool      m_autoRange           = false;  /* PGA per input, predicted from its last sample */
+   adsGain_t m_autoGain[ADS1X15_INPUTS];     /* next PGA setting per input, by MUX bits */
+   adsGain_t m_lastGain            = GAIN_DEFAULT;  /* of the last _uV / _V read */
+   uint32_t  m_reconversions       = 0;      /* clipped predictions converted again */
 
  public:
 //, uint8_t i2cAddress = ADS1X15_ADDRESS);
@@ -205,11 +307,14 @@ protected:
   Adafruit_ADS1015_Flex(TwoWire *wire, uint8_t i2cAddress);
   TwoWire *_wire;
   void begin(void);
+  static FlexAsyncSensor *create(TwoWire *wire, uint8_t i2cAddress);  // FlexRegistry factory
 #if defined(ARDUINO_ARCH_ESP8266)
   void begin(uint8_t sda, uint8_t scl);
 #endif
   int16_t   readADC_SingleEnded(uint8_t channel);
   int16_t   readADC_Differential(adsDiffMux_t);
+  flexResult_t readADC_SingleEnded(uint8_t channel, int16_t *value);
+  flexResult_t readADC_Differential(adsDiffMux_t, int16_t *value);
   int16_t   readADC_Differential_0_1(void);
   int16_t   readADC_Differential_0_3(void);
   int16_t   readADC_Differential_1_3(void);
@@ -228,13 +333,544 @@ protected:
   float     readADC_Differential_0_3_V(void);
   float     readADC_Differential_1_3_V(void);
   float     readADC_Differential_2_3_V(void);
-  void      waitForConversion();
+  // Integer micro-volts at the current gain, no float math
+  int32_t   microvolts(int16_t counts);
+  flexResult_t readADC_SingleEnded_uV(uint8_t channel, int32_t *microvolts);
+  flexResult_t readADC_Differential_uV(adsDiffMux_t, int32_t *microvolts);
+  // Whole count buffers at once (see FlexConvert.h), at the current gain
+  void      convertBatch(const int16_t *counts, uint16_t count, float *volts);
+  void      convertBatch_uV(const int16_t *counts, uint16_t count, int32_t *microvolts);
+  flexResult_t waitForConversion();
+  uint16_t  rateTrim(void);                 // learned slowdown, 1/1024 of the nominal period
+  uint32_t  conversionOverruns(void);       // OS checks that found the conversion still running
+  // PGA per input from its previous sample, for the _uV and _V reads
+  void      setAutoRange(bool enable);
+  bool      autoRange(void);
+  adsGain_t lastGain(void);                 // PGA setting of the last _uV / _V read
+  uint32_t  rangeReconversions(void);       // clipped predictions converted again
+
+  // Non-blocking single-shot conversions (see FlexAsyncSensor)
+  bool        startADC_SingleEnded(uint8_t channel);
+  bool        startADC_Differential(adsDiffMux_t regConfigDiffMUX);
+  bool        start(void);                  // repeats the last started input
+  flexState_t poll(void);
+  bool        collect(void);
+  uint32_t    conversionTime(void);
+  bool        sleep(void);                  // ends continuous mode, see FlexScheduler::setDutyCycle()
+  flexPowerProfile_t powerProfile(void);
+  int16_t     lastResult(void);
+  int32_t     lastResult_uV(void);
+
+  flexResult_t   lastError(void);
+  flexI2CStats_t getStats(void);
+  void           resetStats(void);
+
+ private:
+    template <flexRingIndex_t N> friend class ADS1x15Stream;
+    friend class ADS1x15Scan;
+    friend class ADS1x15Array;
+
+    uint16_t singleShotConfig(uint16_t mux, adsGain_t gain, adsSPS_t sps);
+    uint32_t conversionMicros(adsSPS_t sps);
+    bool startSingleShot(uint16_t mux, adsGain_t gain);
+    bool startContinuous(uint16_t mux);
+    uint32_t expectedMicros(uint32_t nominal);
+    void stretchConversion(uint32_t nominal, uint32_t elapsed);
+    flexResult_t waitReady(uint32_t startedAt, uint32_t nominal, uint32_t *readMicros);
+    bool readResult(int16_t *counts);
+    bool collectAndStart(uint16_t next, uint32_t nextConversion, uint32_t readMicros,
+                         int16_t *counts, uint32_t *nextStartedAt);
+    flexResult_t readSingleShot(uint16_t mux, adsGain_t gain, int16_t *value);
+    flexResult_t readMicrovolts(uint16_t mux, int32_t *microvolts);
+    float autoRangeVolts(uint16_t mux);
+    int32_t microvolts(int16_t counts, adsGain_t gain);
+    bool clipped(int16_t counts);
+    static adsGain_t predictGain(int32_t microvolts);
+    uint32_t conversionMidpoint(void);
+    bool writeRegister(uint8_t reg, uint16_t value);
+    uint16_t readRegister(uint8_t reg);
+};
+
+// Same driver, 16 bit results (no conversion register shift)
+class Adafruit_ADS1115_Flex : public Adafruit_ADS1015_Flex
+{
+ public:
+  Adafruit_ADS1115_Flex(TwoWire *wire, uint8_t i2cAddress = ADS1X15_ADDRESS);
+  static FlexAsyncSensor *create(TwoWire *wire, uint8_t i2cAddress);  // FlexRegistry factory
+};
+
+/**************************************************************************/
+/*!
+    ADS1015 or ADS1115 with the gain fixed at compile time:
+
+      ADS1x15<CHIP_ADS1115, GAIN_ONE> ads(&myWire, 0x49);
+      ads.begin();
+
+    Volts per bit and the micro-volt scale are constants instead of two
+    switches on chip and gain per call. The runtime driver is a protected
+    base, so setGain() and setAutoRange() are unreachable, also through
+    a base class reference, and the constants always hold; everything
+    else is Adafruit_ADS1015_Flex. Pass sensor() to FlexScheduler.
+
+    The runtime driver is still linked in underneath, so the template
+    saves time per call, not code size.
+*/
+/**************************************************************************/
+template <adsChip_t CHIP, adsGain_t GAIN>
+class ADS1x15 : protected Adafruit_ADS1015_Flex
+{
+ public:
+  ADS1x15(TwoWire *wire, uint8_t i2cAddress = ADS1X15_ADDRESS)
+    : Adafruit_ADS1015_Flex(wire, i2cAddress)
+  {
+    m_bitShift = CHIP;
+    m_gain = GAIN;
+  }
+
+  using Adafruit_ADS1015_Flex::begin;
+  using Adafruit_ADS1015_Flex::readADC_SingleEnded;
+  using Adafruit_ADS1015_Flex::readADC_Differential;
+  using Adafruit_ADS1015_Flex::readADC_Differential_0_1;
+  using Adafruit_ADS1015_Flex::readADC_Differential_0_3;
+  using Adafruit_ADS1015_Flex::readADC_Differential_1_3;
+  using Adafruit_ADS1015_Flex::readADC_Differential_2_3;
+  using Adafruit_ADS1015_Flex::readADC_Differential_0_1_V;
+  using Adafruit_ADS1015_Flex::readADC_Differential_0_3_V;
+  using Adafruit_ADS1015_Flex::readADC_Differential_1_3_V;
+  using Adafruit_ADS1015_Flex::readADC_Differential_2_3_V;
+  using Adafruit_ADS1015_Flex::startComparator_SingleEnded;
+  using Adafruit_ADS1015_Flex::startWindowComparator_SingleEnded;
+  using Adafruit_ADS1015_Flex::startContinuous_SingleEnded;
+  using Adafruit_ADS1015_Flex::getLastConversionResults;
+  using Adafruit_ADS1015_Flex::getGain;
+  using Adafruit_ADS1015_Flex::setSPS;
+  using Adafruit_ADS1015_Flex::getSPS;
+  using Adafruit_ADS1015_Flex::waitForConversion;
+  using Adafruit_ADS1015_Flex::rateTrim;
+  using Adafruit_ADS1015_Flex::conversionOverruns;
+  using Adafruit_ADS1015_Flex::startADC_SingleEnded;
+  using Adafruit_ADS1015_Flex::startADC_Differential;
+  using Adafruit_ADS1015_Flex::start;
+  using Adafruit_ADS1015_Flex::poll;
+  using Adafruit_ADS1015_Flex::collect;
+  using Adafruit_ADS1015_Flex::conversionTime;
+  using Adafruit_ADS1015_Flex::sleep;
+  using Adafruit_ADS1015_Flex::wake;
+  using Adafruit_ADS1015_Flex::powerProfile;
+  using Adafruit_ADS1015_Flex::state;
+  using Adafruit_ADS1015_Flex::sampleMicros;
+  using Adafruit_ADS1015_Flex::setSampleTrim;
+  using Adafruit_ADS1015_Flex::lastResult;
+  using Adafruit_ADS1015_Flex::lastError;
+  using Adafruit_ADS1015_Flex::getStats;
+  using Adafruit_ADS1015_Flex::resetStats;
+
+  /* The async interface, which cannot change the gain */
+  FlexAsyncSensor *sensor(void) { return this; }
+
+  static constexpr float voltsPerBit(void) { return adsVoltsPerBit(CHIP, GAIN); }
+
+  static int32_t microvolts(int16_t counts)
+  {
+    return flexScale((int32_t)counts * (1 << CHIP), adsMicrovoltMul(GAIN), adsMicrovoltShift(GAIN));
+  }
+
+  float readADC_SingleEnded_V(uint8_t channel)
+  {
+    return (float)readADC_SingleEnded(channel) * voltsPerBit();
+  }
+
+  flexResult_t readADC_SingleEnded_uV(uint8_t channel, int32_t *uV)
+  {
+    int16_t counts;
+    flexResult_t result = readADC_SingleEnded(channel, &counts);
+    if (result == FLEX_OK)
+    {
+      *uV = microvolts(counts);
+    }
+    return result;
+  }
+
+  flexResult_t readADC_Differential_uV(adsDiffMux_t regConfigDiffMUX, int32_t *uV)
+  {
+    int16_t counts;
+    flexResult_t result = readADC_Differential(regConfigDiffMUX, &counts);
+    if (result == FLEX_OK)
+    {
+      *uV = microvolts(counts);
+    }
+    return result;
+  }
+
+  int32_t lastResult_uV(void) { return microvolts(m_lastResult); }
+
+  void convertBatch(const int16_t *counts, uint16_t count, float *volts)
+  {
+    flexScaleBatch(counts, count, voltsPerBit(), volts);
+  }
+
+  void convertBatch_uV(const int16_t *counts, uint16_t count, int32_t *uV)
+  {
+    flexScaleBatchFixed(counts, count, (int32_t)adsMicrovoltMul(GAIN) << CHIP, adsMicrovoltShift(GAIN), uV);
+  }
+};
+
+/**************************************************************************/
+/*!
+    One conversion result of an ADS1x15Stream
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint32_t at;              // micros(), middle of the conversion
+  int16_t  counts;          // as readADC_SingleEnded() returns them
+} adsSample_t;
+
+/**************************************************************************/
+/*!
+    Continuous conversions paced by the ALERT/RDY pin.
+
+    startContinuous_SingleEnded() already sets the thresholds so ALERT/RDY
+    pulses low at the end of every conversion. The stream turns each
+    pulse into exactly one conversion register read, the config register
+    is never polled, and keeps the results in a FlexRing of N samples:
+
+      MyDmaTransport transport(&myWire);         // interrupt driven FlexI2CTransport
+      ADS1x15Stream<64> stream(&ads, &transport);
+      void onAlert(void) { stream.onDataReady(); }
+
+      pinMode(ALERT_PIN, INPUT_PULLUP);          // open drain
+      attachInterrupt(digitalPinToInterrupt(ALERT_PIN), onAlert, FALLING);
+      ads.setSPS(ADS1015_DR_3300SPS);
+      stream.start_SingleEnded(0);
+      ...
+      adsSample_t s;
+      while (stream.read(&s)) { ... }
+
+    The register pointer is left on the conversion register, so every
+    sample is one plain 2 byte read; keep other traffic to this ADC off
+    the bus meanwhile. With a transport the interrupt queues that read
+    (FlexI2CTransport::receive()) and the completion pushes the sample,
+    so samples arrive without loop() doing anything. That needs an
+    interrupt or DMA backend: a blocking() one such as FlexWireTransport
+    would run the I2C inside the ISR and makes start_*() return false.
+    Without a transport read() fetches the pending result.
+
+    Sample times come from the edge, half a nominal period back, so they
+    follow the ADC's own oscillator. A result that is not fetched before
+    the next edge is counted in lost() (the ADC overwrites it), as are
+    samples that find the ring full.
+*/
+/**************************************************************************/
+template <flexRingIndex_t N = 32>
+class ADS1x15Stream
+{
+ public:
+  ADS1x15Stream(Adafruit_ADS1015_Flex *ads, FlexI2CTransport *transport = NULL)
+    : _ads(ads), _transport(transport)
+  {
+    _transfer.done = true;
+    _transfer.result = FLEX_OK;
+    _transfer.next = NULL;
+    _running = false;
+    _pending = false;
+    _halfPeriod = 0;
+    _edgeAt = 0;
+    _lost = 0;
+    _errors = 0;
+  }
+
+  bool start_SingleEnded(uint8_t channel)
+  {
+    if (!begin())
+    {
+      return false;
+    }
+    _ads->startContinuous_SingleEnded(channel);
+    return started(_ads->m_i2c.lastError() == FLEX_OK);
+  }
+
+  bool start_Differential(adsDiffMux_t regConfigDiffMUX)
+  {
+    if (!begin())
+    {
+      return false;
+    }
+    return started(_ads->startContinuous(regConfigDiffMUX));
+  }
+
+  /* Call from the ALERT/RDY falling edge interrupt */
+  void onDataReady(void)
+  {
+    uint32_t at = micros() - _halfPeriod;
+
+    if (!_running)
+    {
+      return;
+    }
+    if (_transport == NULL)
+    {
+      if (_pending)
+      {
+        _lost++;
+      }
+      _edgeAt = at;
+      _pending = true;
+      return;
+    }
+    if (!_transfer.done)
+    {
+      _lost++;          // previous read still on the bus
+      return;
+    }
+    _edgeAt = at;
+    if (!_transport->receive(&_transfer, _ads->m_i2cAddress, _frame, 2, onFrame, this))
+    {
+      _errors++;
+    }
+  }
+
+  /* Oldest sample, false when there is none */
+  bool read(adsSample_t *sample)
+  {
+    if ((_transport == NULL) && _pending)
+    {
+      noInterrupts();
+      uint32_t at = _edgeAt;
+      _pending = false;
+      interrupts();
+
+      uint8_t frame[2];
+      if (_ads->m_i2c.read(frame, 2))
+      {
+        push(at, frame);
+      }
+      else
+      {
+        _errors++;
+      }
+    }
+    return _samples.pop(sample);
+  }
+
+  /* Back to single-shot (powered down); samples already taken stay readable */
+  bool stop(void)
+  {
+    _running = false;
+    _pending = false;
+    if (_transport != NULL)
+    {
+      _transport->wait(&_transfer, 2 * _ads->conversionTime());
+    }
+    return _ads->sleep();
+  }
+
+  bool            running(void)   { return _running; }
+  flexRingIndex_t available(void) { return _samples.count(); }
+  uint32_t        lost(void)      { return _lost + _samples.overruns(); }   // since construction
+  uint32_t        errors(void)    { return _errors; }                       // failed reads
+
+ private:
+  bool begin(void)
+  {
+    if ((_transport != NULL) && _transport->blocking())
+    {
+      return false;     // would do the I2C inside the ALERT/RDY interrupt
+    }
+    _running = false;
+    _pending = false;
+    _samples.clear();
+    _halfPeriod = (_ads->conversionTime() - 10) / 2;   // nominal period, no start-up margin
+    return true;
+  }
+
+  bool started(bool ok)
+  {
+    if (ok)
+    {
+      uint8_t reg = ADS1X15_REG_POINTER_CONVERT;
+      ok = _ads->m_i2c.write(&reg, 1);
+    }
+    _running = ok;
+    return ok;
+  }
+
+  void push(uint32_t at, const uint8_t *frame)
+  {
+    adsSample_t sample;
+    sample.at = at;
+    sample.counts = (int16_t)(((uint16_t)frame[0] << 8) | frame[1]) >> _ads->m_bitShift;
+    _samples.push(sample);
+  }
+
+  static void onFrame(flexI2CTransfer_t *transfer)
+  {
+    ADS1x15Stream *stream = (ADS1x15Stream *)transfer->context;
+    if (transfer->result == FLEX_OK)
+    {
+      stream->push(stream->_edgeAt, stream->_frame);
+    }
+    else
+    {
+      stream->_errors++;
+    }
+  }
+
+  Adafruit_ADS1015_Flex *_ads;
+  FlexI2CTransport      *_transport;
+  flexI2CTransfer_t      _transfer;
+  uint8_t                _frame[2];
+  FlexRing<adsSample_t, N> _samples;
+  volatile bool          _running;
+  volatile bool          _pending;       // no transport: a result waits for read()
+  volatile uint32_t      _edgeAt;        // sample time of the result in flight / pending
+  uint32_t               _halfPeriod;
+  volatile uint32_t      _lost;
+  volatile uint32_t      _errors;
+};
+
+/*=========================================================================
+    SCAN LIST
+    -----------------------------------------------------------------------*/
+#ifndef ADS1X15_SCAN_MAX
+    #define ADS1X15_SCAN_MAX                (8)       // 4 single-ended + 4 differential
+#endif
+/*=========================================================================*/
+
+/**************************************************************************/
+/*!
+    Results of one ADS1x15Scan::read(), in scan list order
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint8_t  count;                             // entries converted
+  int16_t  counts[ADS1X15_SCAN_MAX];          // at the entry's gain
+  adsGain_t gain[ADS1X15_SCAN_MAX];           // PGA setting the entry was converted with
+  int32_t  microvolts[ADS1X15_SCAN_MAX];
+  uint32_t at[ADS1X15_SCAN_MAX];              // micros(), middle of the conversion
+} adsScanFrame_t;
+
+static_assert(ADS1X15_SCAN_MAX <= 32, "ADS1x15Scan::read(): clipped entries are a 32 bit mask");
+
+/**************************************************************************/
+/*!
+    A list of inputs, each with its own gain and data rate, converted
+    one after another as a single-shot sequence:
+
+      ADS1x15Scan scan(&ads);
+      scan.addSingleEnded(0, GAIN_ONE, ADS1015_DR_3300SPS);
+      scan.addSingleEnded(1, GAIN_ONE, ADS1015_DR_3300SPS);
+      scan.addDifferential(DIFF_MUX_2_3, GAIN_SIXTEEN, ADS1015_DR_920SPS);
+      adsScanFrame_t frame;
+      if (scan.read(&frame) == FLEX_OK) ...
+
+    The config words are built once, in add(). read() waits out each
+    conversion's nominal time before the OS bit is checked at all, then
+    starts the next entry and reads the finished result back to back,
+    so between entries the ADC idles only for one OS check and one
+    config write.
+
+    With setAutoRange(true) each entry's gain follows its signal: the
+    next frame converts it at the gain predicted from this frame's
+    result (see AUTO RANGE), and an entry that clips is converted once
+    more at +/-6.144V after the rest of the frame. frame.gain[] holds
+    the gain of each result.
+*/
+/**************************************************************************/
+class ADS1x15Scan
+{
+ public:
+  ADS1x15Scan(Adafruit_ADS1015_Flex *ads);
+
+  bool         addSingleEnded(uint8_t channel, adsGain_t gain, adsSPS_t sps);
+  bool         addDifferential(adsDiffMux_t regConfigDiffMUX, adsGain_t gain, adsSPS_t sps);
+  void         clear(void);
+  uint8_t      count(void);
+  uint32_t     conversionTime(void);          // all entries, without the bus time
+  void         setAutoRange(bool enable);     // the entries' gains are the first guess
+
+  flexResult_t read(adsScanFrame_t *frame);   // blocking, whole list
 
  private:
-    void i2cwrite(uint8_t x);
-    void writeRegister(uint8_t i2cAddress, uint8_t reg, uint16_t value);
-    uint16_t readRegister(uint8_t i2cAddress, uint8_t reg);
-    uint8_t i2cread(void);
+  bool         add(uint16_t mux, adsGain_t gain, adsSPS_t sps);
+  void         setGain(uint8_t entry, adsGain_t gain);
+  flexResult_t reconvert(uint8_t entry, adsScanFrame_t *frame);
+
+  Adafruit_ADS1015_Flex *_ads;
+  uint16_t     _config[ADS1X15_SCAN_MAX];     // single-shot config word, OS set
+  adsGain_t    _gain[ADS1X15_SCAN_MAX];
+  uint32_t     _conversion[ADS1X15_SCAN_MAX]; // nominal 1 / data rate, us
+  uint8_t      _count;
+  uint32_t     _readMicros;                   // last OS check, measured
+  bool         _autoRange;
+};
+
+/*=========================================================================
+    DEVICE ARRAY
+    -----------------------------------------------------------------------*/
+#ifndef ADS1X15_ARRAY_MAX
+    #define ADS1X15_ARRAY_MAX               (4)       // 0x48 - 0x4B on one bus
+#endif
+/*=========================================================================*/
+
+/**************************************************************************/
+/*!
+    Results of one ADS1x15Array read, per device (in add() order) and
+    input: the channel for single-ended reads, 0 for a differential one
+*/
+/**************************************************************************/
+typedef struct
+{
+  uint8_t  devices;                           // in the array
+  uint32_t valid;                             // bit device * 4 + input, set when read
+  int16_t  counts[ADS1X15_ARRAY_MAX][4];      // at the device's gain
+  uint32_t at[ADS1X15_ARRAY_MAX][4];          // micros(), middle of the conversion
+} adsArrayFrame_t;
+
+static_assert(ADS1X15_ARRAY_MAX <= 8, "adsArrayFrame_t: valid holds 8 devices");
+
+/**************************************************************************/
+/*!
+    Up to ADS1X15_ARRAY_MAX ADCs sampled together:
+
+      Adafruit_ADS1115_Flex adc0(&myWire, 0x48), adc1(&myWire, 0x49) ...
+      ADS1x15Array array;
+      array.add(&adc0);
+      array.add(&adc1);
+      adsArrayFrame_t frame;
+      array.readAll_SingleEnded(&frame);      // 4 devices x 4 channels
+
+    The same input is started on every device back to back, so those
+    conversions run at the same time, one config write apart. After one
+    wait each device gets one OS check, then readAll_SingleEnded() starts
+    the next channel on all of them, again back to back, and reads the
+    results while those conversions run. Every device keeps its own gain
+    and data rate. A device that fails is left out of the rest of the
+    read; the others still fill the frame, the first failure is
+    returned.
+*/
+/**************************************************************************/
+class ADS1x15Array
+{
+ public:
+  ADS1x15Array(void);
+
+  bool         add(Adafruit_ADS1015_Flex *ads);   // false when full
+  uint8_t      count(void);
+
+  flexResult_t readADC_SingleEnded(uint8_t channel, adsArrayFrame_t *frame);
+  flexResult_t readADC_Differential(adsDiffMux_t regConfigDiffMUX, adsArrayFrame_t *frame);
+  flexResult_t readAll_SingleEnded(adsArrayFrame_t *frame);
+
+ private:
+  flexResult_t sweep(const uint16_t *mux, const uint8_t *input, uint8_t inputs, adsArrayFrame_t *frame);
+  void         startAll(uint16_t mux, uint32_t *startedAt, bool *alive, flexResult_t *first);
+  void         drop(uint8_t device, flexResult_t result, bool *alive, flexResult_t *first);
+
+  Adafruit_ADS1015_Flex *_ads[ADS1X15_ARRAY_MAX];
+  uint32_t     _readMicros[ADS1X15_ARRAY_MAX];    // last OS check per device, measured
+  uint8_t      _count;
 };
 
 #endif
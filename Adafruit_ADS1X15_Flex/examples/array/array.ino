@@ -0,0 +1,67 @@
+// -------------------------------------------------------
+// ADS1x15Array Example
+// 16 channels from four ADS1115s on one bus (myWire,
+// SERCOM2; ADDR to GND, VDD, SDA and SCL for 0x48 - 0x4B).
+// The same channel converts on all four at once, so each
+// line holds four near-simultaneous samples per channel.
+//
+// J.A. Korten - 2019
+//
+// -------------------------------------------------------
+
+#include <Wire.h>
+#include "wiring_private.h" // pinPeripheral() function
+#include "Adafruit_ADS1015_Flex.h"
+
+#define serialSpeed 115200
+
+TwoWire myWire(&sercom2, 4, 3);
+Adafruit_ADS1115_Flex adc0 = Adafruit_ADS1115_Flex(&myWire, 0x48);
+Adafruit_ADS1115_Flex adc1 = Adafruit_ADS1115_Flex(&myWire, 0x49);
+Adafruit_ADS1115_Flex adc2 = Adafruit_ADS1115_Flex(&myWire, 0x4A);
+Adafruit_ADS1115_Flex adc3 = Adafruit_ADS1115_Flex(&myWire, 0x4B);
+ADS1x15Array adcs;
+
+void setup()
+{
+  Serial.begin(serialSpeed);
+
+  myWire.begin(); // master SERCOM 2
+  myWire.setClock(400000);
+
+  // Assign pins 4 & 3 to SERCOM functionality
+  pinPeripheral(4, PIO_SERCOM_ALT);
+  pinPeripheral(3, PIO_SERCOM_ALT);
+
+  delay(2500); // Wait for Serial...
+
+  Adafruit_ADS1115_Flex *all[4] = { &adc0, &adc1, &adc2, &adc3 };
+  for (uint8_t d = 0; d < 4; d++) {
+    all[d]->begin();
+    all[d]->setGain(GAIN_ONE);
+    all[d]->setSPS(ADS1115_DR_860SPS);
+    adcs.add(all[d]);
+  }
+}
+
+void loop()
+{
+  adsArrayFrame_t frame;
+
+  flexResult_t result = adcs.readAll_SingleEnded(&frame);
+  if (result != FLEX_OK) {
+    Serial.print("array: ");
+    Serial.println(flexResultString(result)); // the other devices are still read
+  }
+
+  for (uint8_t d = 0; d < frame.devices; d++) {
+    for (uint8_t c = 0; c < 4; c++) {
+      if (frame.valid & (1UL << (d * 4 + c))) {
+        Serial.print(frame.counts[d][c]);
+      }
+      Serial.print((d == frame.devices - 1 && c == 3) ? "\n" : ",");
+    }
+  }
+
+  delay(100);
+}
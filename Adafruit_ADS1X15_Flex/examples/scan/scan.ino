@@ -0,0 +1,59 @@
+// -------------------------------------------------------
+// ADS1x15Scan Example
+// Reads a battery voltage, a thermistor and a current shunt
+// on one ADS1115 (myWire, SERCOM2) as one scan frame, each
+// input with its own gain and data rate.
+//
+// J.A. Korten - 2019
+//
+// -------------------------------------------------------
+
+#include <Wire.h>
+#include "wiring_private.h" // pinPeripheral() function
+#include "Adafruit_ADS1015_Flex.h"
+
+#define serialSpeed 115200
+
+TwoWire myWire(&sercom2, 4, 3);
+Adafruit_ADS1115_Flex ads = Adafruit_ADS1115_Flex(&myWire, 0x48);
+ADS1x15Scan scan(&ads);
+
+void setup()
+{
+  Serial.begin(serialSpeed);
+
+  myWire.begin(); // master SERCOM 2
+  myWire.setClock(400000);
+
+  // Assign pins 4 & 3 to SERCOM functionality
+  pinPeripheral(4, PIO_SERCOM_ALT);
+  pinPeripheral(3, PIO_SERCOM_ALT);
+
+  delay(2500); // Wait for Serial...
+
+  ads.begin();
+
+  scan.addSingleEnded(0, GAIN_ONE, ADS1115_DR_860SPS);              // battery divider
+  scan.addSingleEnded(1, GAIN_TWO, ADS1115_DR_128SPS);              // thermistor, less noise
+  scan.addDifferential(DIFF_MUX_2_3, GAIN_SIXTEEN, ADS1115_DR_860SPS); // shunt
+}
+
+void loop()
+{
+  adsScanFrame_t frame;
+
+  flexResult_t result = scan.read(&frame);
+  if (result != FLEX_OK) {
+    Serial.print("scan failed: ");
+    Serial.println(flexResultString(result));
+  }
+
+  for (uint8_t i = 0; i < frame.count; i++) {
+    Serial.print(frame.at[i]);
+    Serial.print(",");
+    Serial.print(frame.microvolts[i]);
+    Serial.print(i + 1 < frame.count ? "," : "\n");
+  }
+
+  delay(100);
+}
@@ -0,0 +1,84 @@
+// -------------------------------------------------------
+// ADS1x15Stream Example
+// Captures a current waveform with the ADS1015 at 3300 SPS
+// (myWire, SERCOM2). The ALERT/RDY pin pulses at the end of
+// every conversion; its interrupt marks the result and
+// loop() fetches it with one 2 byte read, so the samples are
+// spaced by the ADC's own clock and the config register is
+// never polled.
+//
+// Connections: ALRT --- pin 6 (open drain, pulled up here)
+//
+// With an interrupt driven FlexI2CTransport the read is
+// queued from the interrupt itself instead:
+//   ADS1x15Stream<64> stream(&ads, &transport);
+// Flex I2C has no such backend for real hardware yet;
+// FlexWireTransport blocks, so the stream refuses it.
+//
+// J.A. Korten - 2019
+//
+// -------------------------------------------------------
+
+#include <Wire.h>
+#include "wiring_private.h" // pinPeripheral() function
+#include "Adafruit_ADS1015_Flex.h"
+
+#define serialSpeed 115200
+#define alertPin    6
+#define captureSize 256
+
+TwoWire myWire(&sercom2, 4, 3);
+Adafruit_ADS1015_Flex ads = Adafruit_ADS1015_Flex(&myWire, 0x48);
+ADS1x15Stream<64> stream(&ads);
+
+adsSample_t capture[captureSize];
+
+void onAlert()
+{
+  stream.onDataReady();
+}
+
+void setup()
+{
+  Serial.begin(serialSpeed);
+
+  myWire.begin(); // master SERCOM 2
+  myWire.setClock(400000);
+
+  // Assign pins 4 & 3 to SERCOM functionality
+  pinPeripheral(4, PIO_SERCOM_ALT);
+  pinPeripheral(3, PIO_SERCOM_ALT);
+
+  delay(2500); // Wait for Serial...
+
+  ads.begin();
+  ads.setGain(GAIN_FOUR);          // +/- 1.024V over the shunt
+  ads.setSPS(ADS1015_DR_3300SPS);
+
+  pinMode(alertPin, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(alertPin), onAlert, FALLING);
+}
+
+void loop()
+{
+  uint16_t taken = 0;
+
+  stream.start_Differential(DIFF_MUX_0_1);
+  while (taken < captureSize) {
+    if (stream.read(&capture[taken])) {
+      taken++;
+    }
+  }
+  stream.stop();                   // powered down while printing
+
+  // Times relative to the first sample, ~303 us apart
+  for (uint16_t i = 0; i < taken; i++) {
+    Serial.print(capture[i].at - capture[0].at);
+    Serial.print(",");
+    Serial.println(ads.microvolts(capture[i].counts));
+  }
+  Serial.print("lost: ");
+  Serial.println(stream.lost());
+
+  delay(1000);
+}
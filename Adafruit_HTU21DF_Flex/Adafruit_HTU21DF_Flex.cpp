@@ -27,52 +27,111 @@
 #endif
 
 
-Adafruit_HTU21DF_Flex::Adafruit_HTU21DF_Flex(TwoWire *wire) {
+Adafruit_HTU21DF_Flex::Adafruit_HTU21DF_Flex(TwoWire *wire) : _i2c(wire, HTU21DF_I2CADDR) {
    this->_wire = wire;
+   _measuringHumidity = false;
+   _rawTemp = 0;
+   _tempStartedAt = 0;
+   _lastRawTemp = 0;
+   _lastRawHum = 0;
 }
 
 boolean Adafruit_HTU21DF_Flex::begin(void) {
    return init();
 }
 
+/**************************************************************************/
+/*!
+    @brief  Factory for FlexRegistry: new driver on wire, NULL if begin()
+            fails (the HTU21DF has a fixed address)
+*/
+/**************************************************************************/
+FlexAsyncSensor *Adafruit_HTU21DF_Flex::create(TwoWire *wire, uint8_t address) {
+  (void)address;
+  Adafruit_HTU21DF_Flex *htu = new Adafruit_HTU21DF_Flex(wire);
+  if (!htu->begin()) {
+    delete htu;
+    return NULL;
+  }
+  return htu;
+}
+
 boolean Adafruit_HTU21DF_Flex::init(void) {
   //_wire->begin(); removed...
 
   reset();
 
-  _wire->beginTransmission(HTU21DF_I2CADDR);
-  _wire->write(HTU21DF_READREG);
-  _wire->endTransmission();
-  _wire->requestFrom(HTU21DF_I2CADDR, 1);
-  return (_wire->read() == 0x2); // after reset should be 0x2
+  return (_i2c.read8(HTU21DF_READREG) == 0x2); // after reset should be 0x2
 }
 
 void Adafruit_HTU21DF_Flex::reset(void) {
-  _wire->beginTransmission(HTU21DF_I2CADDR);
-  _wire->write(HTU21DF_RESET);
-  _wire->endTransmission();
-  delay(15);
+  uint8_t command = HTU21DF_RESET;
+  _i2c.write(&command, 1);
+  _i2c.waitMillis(15);
 }
 
+// Issues a no hold master measurement command, waits the nominal conversion
+// time and then polls for the result until the deadline. The sensor NACKs
+// its address while converting instead of holding the clock, so a stalled
+// sensor costs at most conversionUs + timeout and never blocks the bus for
+// the other devices on it. The sample time is the middle of the conversion,
+// half the nominal conversion time after the command.
+flexResult_t Adafruit_HTU21DF_Flex::readRaw(uint8_t command, uint32_t conversionUs, uint16_t *value) {
+  if (!_i2c.write(&command, 1)) {
+    return _i2c.lastError();
+  }
+  uint32_t startedAt = micros();
+  uint32_t deadline = _i2c.deadline(conversionUs);
+  _i2c.waitMillis(conversionUs / 1000);
+
+  uint32_t waitStart = _i2c.waitBegin();
+  flexResult_t result;
+  while ((result = readResult(value)) == FLEX_ERR_ADDR_NACK) { // still converting
+    if (_i2c.expired(deadline)) {
+      result = FLEX_ERR_TIMEOUT;
+      break;
+    }
+    delay(1);
+  }
+  _i2c.waitEnd(waitStart);
+
+  if (result == FLEX_OK) {
+    markSampled(startedAt + conversionUs / 2);
+  }
+  return result;
+}
 
-float Adafruit_HTU21DF_Flex::readTemperature(void) {
-
-  // OK lets ready!
-  _wire->beginTransmission(HTU21DF_I2CADDR);
-  _wire->write(HTU21DF_READTEMP);
-  _wire->endTransmission();
-
-  delay(50); // add delay between request and actual read!
-
-  _wire->requestFrom(HTU21DF_I2CADDR, 3);
-  while (!_wire->available()) {}
-
-  uint16_t t = _wire->read();
-  t <<= 8;
-  t |= _wire->read();
+// Reads a 16-bit measurement result and checks it against the CRC byte.
+// In no hold master mode the sensor NACKs this while still converting.
+flexResult_t Adafruit_HTU21DF_Flex::readResult(uint16_t *value) {
+  uint8_t data[3] = { 0, 0, 0 };
+  if (!_i2c.read(data, 3)) {
+    return _i2c.lastError();
+  }
+  if (crc8(data, 2) != data[2]) {
+    return _i2c.setError(FLEX_ERR_CRC);
+  }
+
+  *value = data[0];
+  *value <<= 8;
+  *value |= data[1];
+
+  return FLEX_OK;
+}
 
-  uint8_t crc = _wire->read();
+// CRC-8 as sent by the sensor: polynomial x^8 + x^5 + x^4 + 1, init 0
+uint8_t Adafruit_HTU21DF_Flex::crc8(const uint8_t *data, uint8_t count) {
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
 
+float Adafruit_HTU21DF_Flex::convertTemperature(uint16_t t) {
   float temp = t;
   temp *= 175.72;
   temp /= 65536;
@@ -81,30 +140,221 @@ float Adafruit_HTU21DF_Flex::readTemperature(void) {
   return temp;
 }
 
+float Adafruit_HTU21DF_Flex::convertHumidity(uint16_t h) {
+  float hum = h;
+  hum *= 125;
+  hum /= 65536;
+  hum -= 6;
+
+  return hum;
+}
+
+// Same formulas in integer math (multiplier 17572 resp. 12500, >> 16), the
+// two status bits are masked off as the datasheet asks
+int16_t Adafruit_HTU21DF_Flex::convertTemperatureCenti(uint16_t t) {
+  return (int16_t)(flexScale(t & 0xFFFC, 17572, 16) - 4685);
+}
+
+int16_t Adafruit_HTU21DF_Flex::convertHumidityCenti(uint16_t h) {
+  return (int16_t)(flexScale(h & 0xFFFC, 12500, 16) - 600);
+}
+
+
+float Adafruit_HTU21DF_Flex::readTemperature(void) {
+
+  uint16_t t = 0;
+  readRaw(HTU21DF_READTEMP_NH, HTU21DF_TEMP_CONV_US, &t);
+
+  return convertTemperature(t);
+}
+
 
 float Adafruit_HTU21DF_Flex::readHumidity(void) {
-  // OK lets ready!
-  _wire->beginTransmission(HTU21DF_I2CADDR);
-  _wire->write(HTU21DF_READHUM);
-  _wire->endTransmission();
 
-  delay(50); // add delay between request and actual read!
+  uint16_t h = 0;
+  readRaw(HTU21DF_READHUM_NH, HTU21DF_HUM_CONV_US, &h);
 
-  _wire->requestFrom(HTU21DF_I2CADDR, 3);
-  while (!_wire->available()) {}
+  return convertHumidity(h);
+}
 
-  uint16_t h = _wire->read();
-  h <<= 8;
-  h |= _wire->read();
+// Same as above, but *celsius is only written on FLEX_OK
+flexResult_t Adafruit_HTU21DF_Flex::readTemperature(float *celsius) {
+  uint16_t t;
+  flexResult_t result = readRaw(HTU21DF_READTEMP_NH, HTU21DF_TEMP_CONV_US, &t);
 
-  uint8_t crc = _wire->read();
+  if (result == FLEX_OK) {
+    *celsius = convertTemperature(t);
+  }
+  return result;
+}
 
-  float hum = h;
-  hum *= 125;
-  hum /= 65536;
-  hum -= 6;
+// Same as above, but *percent is only written on FLEX_OK
+flexResult_t Adafruit_HTU21DF_Flex::readHumidity(float *percent) {
+  uint16_t h;
+  flexResult_t result = readRaw(HTU21DF_READHUM_NH, HTU21DF_HUM_CONV_US, &h);
 
-  return hum;
+  if (result == FLEX_OK) {
+    *percent = convertHumidity(h);
+  }
+  return result;
+}
+
+// Centi-degrees Celsius, *centiCelsius is only written on FLEX_OK
+flexResult_t Adafruit_HTU21DF_Flex::readTemperatureCenti(int16_t *centiCelsius) {
+  uint16_t t;
+  flexResult_t result = readRaw(HTU21DF_READTEMP_NH, HTU21DF_TEMP_CONV_US, &t);
+
+  if (result == FLEX_OK) {
+    *centiCelsius = convertTemperatureCenti(t);
+  }
+  return result;
+}
+
+// Centi-percent relative humidity, *centiPercent is only written on FLEX_OK
+flexResult_t Adafruit_HTU21DF_Flex::readHumidityCenti(int16_t *centiPercent) {
+  uint16_t h;
+  flexResult_t result = readRaw(HTU21DF_READHUM_NH, HTU21DF_HUM_CONV_US, &h);
+
+  if (result == FLEX_OK) {
+    *centiPercent = convertHumidityCenti(h);
+  }
+  return result;
+}
+
+flexResult_t Adafruit_HTU21DF_Flex::lastError(void) {
+  return _i2c.lastError();
+}
+
+/*********************************************************************/
+// Non-blocking measurement
+//
+// start() issues a no hold master temperature command and returns. poll()
+// fetches the temperature once it is due, immediately kicks off the
+// humidity conversion and reports FLEX_READY when that one is due too.
+// collect() fetches the humidity; lastTemperature()/lastHumidity() then
+// return the new values. A humidity result that is NACKed (still
+// converting) leaves the state BUSY until the timeout, like the
+// temperature one in poll(). sampleMicros() is the middle of the
+// temperature conversion.
+/*********************************************************************/
+
+bool Adafruit_HTU21DF_Flex::start(void) {
+  uint8_t command = HTU21DF_READTEMP_NH;
+
+  _measuringHumidity = false;
+  if (!_i2c.write(&command, 1)) {
+    _state = FLEX_ERROR;
+    return false;
+  }
+  markStarted();
+  _tempStartedAt = _startedAt;
+  return true;
+}
+
+flexState_t Adafruit_HTU21DF_Flex::poll(void) {
+  if (_state != FLEX_BUSY) {
+    return _state;
+  }
+
+  if (!_measuringHumidity) {
+    if (!elapsedSinceStart(HTU21DF_TEMP_CONV_US)) {
+      return FLEX_BUSY;
+    }
+    uint8_t command = HTU21DF_READHUM_NH;
+    flexResult_t result = readResult(&_rawTemp);
+    if ((result == FLEX_ERR_ADDR_NACK) &&
+        !elapsedSinceStart(HTU21DF_TEMP_CONV_US + _i2c.timeout())) {
+      return FLEX_BUSY; // still converting, try again on the next poll
+    }
+    if ((result != FLEX_OK) || !_i2c.write(&command, 1)) {
+      _state = FLEX_ERROR;
+      return _state;
+    }
+    _measuringHumidity = true;
+    markStarted();
+    return FLEX_BUSY;
+  }
+
+  if (elapsedSinceStart(HTU21DF_HUM_CONV_US)) {
+    _state = FLEX_READY;
+  }
+  return _state;
+}
+
+bool Adafruit_HTU21DF_Flex::collect(void) {
+  uint16_t h;
+
+  if (_state != FLEX_READY) {
+    return false;
+  }
+  flexResult_t result = readResult(&h);
+  if ((result == FLEX_ERR_ADDR_NACK) &&
+      !elapsedSinceStart(HTU21DF_HUM_CONV_US + _i2c.timeout())) {
+    _state = FLEX_BUSY; // still converting, the next poll() hands it back
+    return false;
+  }
+  if (result != FLEX_OK) {
+    _state = FLEX_ERROR;
+    return false;
+  }
+
+  _lastRawTemp = _rawTemp;
+  _lastRawHum = h;
+  markSampled(_tempStartedAt + HTU21DF_TEMP_CONV_US / 2);
+  _state = FLEX_IDLE;
+  return true;
+}
+
+uint32_t Adafruit_HTU21DF_Flex::conversionTime(void) {
+  return HTU21DF_TEMP_CONV_US + HTU21DF_HUM_CONV_US;
+}
+
+// The humidity command goes out when poll() sees the temperature stage end,
+// so a caller that waits the whole conversionTime() first gets the sample
+// late. Report the stage in progress instead, counted from start().
+uint32_t Adafruit_HTU21DF_Flex::nextPollTime(void) {
+  if (_measuringHumidity) {
+    return (_startedAt - _tempStartedAt) + HTU21DF_HUM_CONV_US;
+  }
+  return HTU21DF_TEMP_CONV_US;
+}
+
+// Datasheet typical currents: 450uA measuring, 0.02uA in the sleep mode
+// the sensor enters after every measurement
+flexPowerProfile_t Adafruit_HTU21DF_Flex::powerProfile(void) {
+  flexPowerProfile_t profile;
+  profile.convertMicroAmps = 450;
+  profile.idleMicroAmps = 0.02F;
+  profile.sleepMicroAmps = 0.02F;
+  profile.wakeMicros = 0;
+  return profile;
+}
+
+// The last*() values are converted when asked for, so a sketch that only
+// uses the integer ones never does float math
+float Adafruit_HTU21DF_Flex::lastTemperature(void) {
+  return convertTemperature(_lastRawTemp);
+}
+
+float Adafruit_HTU21DF_Flex::lastHumidity(void) {
+  return convertHumidity(_lastRawHum);
+}
+
+int16_t Adafruit_HTU21DF_Flex::lastTemperatureCenti(void) {
+  return convertTemperatureCenti(_lastRawTemp);
+}
+
+int16_t Adafruit_HTU21DF_Flex::lastHumidityCenti(void) {
+  return convertHumidityCenti(_lastRawHum);
+}
+
+// Bus and wait counters of this sensor, see flexI2CStats_t
+flexI2CStats_t Adafruit_HTU21DF_Flex::getStats(void) {
+  return _i2c.stats();
+}
+
+void Adafruit_HTU21DF_Flex::resetStats(void) {
+  _i2c.resetStats();
 }
 
 
@@ -23,6 +23,9 @@
  #include "WProgram.h"
 #endif
 #include "Wire.h"
+#include <FlexI2CDevice.h>
+#include <FlexAsyncSensor.h>
+#include <FlexFixed.h>
 
 #define HTU21DF_I2CADDR       0x40
 #define HTU21DF_READTEMP      0xE3
@@ -30,19 +33,57 @@
 #define HTU21DF_WRITEREG      0xE6
 #define HTU21DF_READREG       0xE7
 #define HTU21DF_RESET         0xFE
+#define HTU21DF_READTEMP_NH   0xF3  // no hold master: bus stays free while converting
+#define HTU21DF_READHUM_NH    0xF5  // no hold master
 
+#define HTU21DF_TEMP_CONV_US  50000 // max. conversion time 14-bit temperature
+#define HTU21DF_HUM_CONV_US   16000 // max. conversion time 12-bit humidity
 
 
-class Adafruit_HTU21DF_Flex {
+
+class Adafruit_HTU21DF_Flex : public FlexAsyncSensor {
     public:
         Adafruit_HTU21DF_Flex(TwoWire *wire);
         TwoWire *_wire;
         boolean begin(void);
         boolean init(void);
+        static FlexAsyncSensor *create(TwoWire *wire, uint8_t address); // FlexRegistry factory
         float readTemperature(void);
         float readHumidity(void);
+        flexResult_t readTemperature(float *celsius);
+        flexResult_t readHumidity(float *percent);
+        // Integer versions, no float math: 2345 = 23.45 C / 23.45 %RH
+        flexResult_t readTemperatureCenti(int16_t *centiCelsius);
+        flexResult_t readHumidityCenti(int16_t *centiPercent);
+        flexResult_t lastError(void);
         void reset(void);
+
+        // Non-blocking: start() measures temperature, then humidity
+        bool start(void);
+        flexState_t poll(void);
+        bool collect(void);
+        uint32_t conversionTime(void);
+        uint32_t nextPollTime(void);           // end of the temperature, then the humidity stage
+        flexPowerProfile_t powerProfile(void); // sleeps by itself, no sleep()
+        float lastTemperature(void);
+        float lastHumidity(void);
+        int16_t lastTemperatureCenti(void);
+        int16_t lastHumidityCenti(void);
+
+        flexI2CStats_t getStats(void);
+        void resetStats(void);
     private:
         boolean readData(void);
-        float humidity, temp;
+        flexResult_t readRaw(uint8_t command, uint32_t conversionUs, uint16_t *value);
+        flexResult_t readResult(uint16_t *value);
+        uint8_t crc8(const uint8_t *data, uint8_t count);
+        float convertTemperature(uint16_t t);
+        float convertHumidity(uint16_t h);
+        int16_t convertTemperatureCenti(uint16_t t);
+        int16_t convertHumidityCenti(uint16_t h);
+        FlexI2CDevice _i2c;
+        bool _measuringHumidity;
+        uint16_t _rawTemp;
+        uint32_t _tempStartedAt; // sample time of the measurement in flight
+        uint16_t _lastRawTemp, _lastRawHum; // of the last collect(), converted on demand
 };
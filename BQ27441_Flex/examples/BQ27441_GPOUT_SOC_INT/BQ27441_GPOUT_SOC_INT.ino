@@ -16,6 +16,9 @@
   battery's stats. They should only print when the percentage goes up or down
   by 1%.
 
+  Flex: the GPOUT pulse is caught by an interrupt that queues it in a
+  FlexRing, so pulses that arrive while loop() is printing are not lost.
+
   Hardware Resources:
   - Arduino Development Board
   - SparkFun Battery Babysitter
@@ -26,6 +29,7 @@
   Arduino Uno (any 'duino should do)
 ******************************************************************************/
 #include <BQ27441_Flex.h>
+#include <FlexRing.h>
 #include <Wire.h>
 
 // Set BATTERY_CAPACITY to the design capacity of your battery.
@@ -40,6 +44,21 @@ const int PERCENTAGE_INTERVAL = 1;
 TwoWire myWire(&sercom3, 20, 21);
 BQ27441_Flex _lipoGauge = BQ27441_Flex(&myWire);
 
+// GPOUT pulses, pushed by the ISR and popped by loop()
+typedef struct
+{
+  uint32_t at; // micros() of the falling edge
+} socPulse_t;
+
+FlexRing<socPulse_t, 8> socPulses;
+uint32_t reportedOverruns = 0;
+
+void onGPOUT()
+{
+  socPulse_t pulse = { micros() };
+  socPulses.push(pulse);
+}
+
 #if defined(ARDUINO_SAMD_ZERO) && !defined(Serial)
   // Resolves the need to use SerialUSB instead of Serial
   // for RobotPatient SAMD21 firmware...
@@ -129,18 +148,16 @@ void printBatteryStats()
   int power = _lipoGauge.power(); // Read average power draw (mW)
   int health = _lipoGauge.soh(); // Read state-of-health (%)
 
-  // Assemble a string to print
-  String toPrint = "[" + String(millis() / 1000) + "] ";
-  toPrint += String(soc) + "% | ";
-  toPrint += String(volts) + " mV | ";
-  toPrint += String(current) + " mA | ";
-  toPrint += String(capacity) + " / ";
-  toPrint += String(fullCapacity) + " mAh | ";
-  toPrint += String(power) + " mW | ";
-  toPrint += String(health) + "%";
-
-  // Print the string
-  Serial.println(toPrint);
+  // Print piece by piece; building a String per line fragments the heap
+  // (see FlexLog for a binary record of the same values)
+  Serial.print("["); Serial.print(millis() / 1000); Serial.print("] ");
+  Serial.print(soc); Serial.print("% | ");
+  Serial.print(volts); Serial.print(" mV | ");
+  Serial.print(current); Serial.print(" mA | ");
+  Serial.print(capacity); Serial.print(" / ");
+  Serial.print(fullCapacity); Serial.print(" mAh | ");
+  Serial.print(power); Serial.print(" mW | ");
+  Serial.print(health); Serial.println("%");
 }
 
 void setup()
@@ -150,16 +167,27 @@ void setup()
   setupBQ27441();
   delay(2000);
   Serial.println("GPOUT_PIN example");
+
+  // GPOUT is active-low: every falling edge is one SOC_INT pulse
+  attachInterrupt(digitalPinToInterrupt(GPOUT_PIN), onGPOUT, FALLING);
 }
 
 void loop()
 {
-  // The interrupt is set to active-low. If the GPOUT pin goes low...
-  if (digitalRead(GPOUT_PIN) == LOW)
+  socPulse_t pulse;
+
+  // SOC_INT occurred (possibly several times while we were printing)
+  while (socPulses.pop(&pulse))
   {
-    // ...SOC_INT occurred. Print battery stats.
+    Serial.print("SOC_INT at ");
+    Serial.print(pulse.at);
+    Serial.print(" us: ");
     printBatteryStats();
-  } else {
-    //Serial.println("GPOUT_PIN == HIGH");
+  }
+
+  if (socPulses.overruns() != reportedOverruns)
+  {
+    reportedOverruns = socPulses.overruns();
+    Serial.println("Warning: GPOUT pulses dropped, ring full");
   }
 }
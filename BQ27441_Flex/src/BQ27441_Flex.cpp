@@ -30,9 +30,23 @@ Johan Korten
  ************************** Initialization Functions *************************
  *****************************************************************************/
 // Initializes class variables
-BQ27441_Flex::BQ27441_Flex(TwoWire *wire) : _deviceAddress(BQ72441_I2C_ADDRESS), _sealFlag(false), _userConfigControl(false)
+BQ27441_Flex::BQ27441_Flex(TwoWire *wire) : _deviceAddress(BQ72441_I2C_ADDRESS), _sealFlag(false), _userConfigControl(false), _i2c(wire, BQ72441_I2C_ADDRESS), _configState(FLEX_IDLE), _configStartedAt(0)
 {
 	this->_wire = wire;
+	memset(&_snapshot, 0, sizeof(_snapshot));
+}
+
+// Creates and begins a driver for FlexRegistry, NULL on failure
+FlexAsyncSensor *BQ27441_Flex::create(TwoWire *wire, uint8_t address)
+{
+	(void)address; // fixed address
+	BQ27441_Flex *lipo = new BQ27441_Flex(wire);
+	if (!lipo->begin())
+	{
+		delete lipo;
+		return NULL;
+	}
+	return lipo;
 }
 
 // Initializes I2C and verifies communication with the BQ27441_Flex.
@@ -43,6 +57,8 @@ bool BQ27441_Flex::begin(void)
 	//wire.begin(); // Initialize I2C master
 	// JK: do not do this inside this library it is a bad practice and might freeze the i2c bus!!!
 
+	_i2c.invalidateAll(); // Gauge may have been power cycled since the last begin()
+
 	deviceID = deviceType(); // Read deviceType from BQ27441_Flex
 
 	if (deviceID == BQ27441_DEVICE_ID)
@@ -184,6 +200,76 @@ uint16_t BQ27441_Flex::temperature(temp_measure type)
 	return temp;
 }
 
+/*****************************************************************************
+ ************************** Non-blocking Functions ***************************
+ *****************************************************************************/
+// The gauge measures continuously, so start() only arms a snapshot
+bool BQ27441_Flex::start(void)
+{
+	_state = FLEX_READY;
+	return true;
+}
+
+// Never waits
+flexState_t BQ27441_Flex::poll(void)
+{
+	return _state;
+}
+
+// Reads Temperature() .. StateOfHealth() in a single 32 byte burst
+bool BQ27441_Flex::collect(void)
+{
+	uint8_t data[BQ27441_SNAPSHOT_LENGTH];
+
+	if (_state != FLEX_READY)
+		return false;
+
+	// The gauge updates its registers on its own, the read is the sample
+	uint32_t readAt = micros();
+	if (!i2cReadBytes(BQ27441_SNAPSHOT_FIRST, data, BQ27441_SNAPSHOT_LENGTH))
+	{
+		_state = FLEX_ERROR;
+		return false;
+	}
+	markSampled(readAt);
+
+	// Each command is a little endian word at (command - first)
+	#define BQ27441_SNAPSHOT_WORD(cmd) \
+		(((uint16_t)data[(cmd) - BQ27441_SNAPSHOT_FIRST + 1] << 8) | data[(cmd) - BQ27441_SNAPSHOT_FIRST])
+	_snapshot.temperature = BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_TEMP);
+	_snapshot.voltage = BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_VOLTAGE);
+	_snapshot.flags = BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_FLAGS);
+	_snapshot.nomCapacity = BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_NOM_CAPACITY);
+	_snapshot.availCapacity = BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_AVAIL_CAPACITY);
+	_snapshot.remCapacity = BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_REM_CAPACITY);
+	_snapshot.fullCapacity = BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_FULL_CAPACITY);
+	_snapshot.avgCurrent = (int16_t) BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_AVG_CURRENT);
+	_snapshot.stdbyCurrent = (int16_t) BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_STDBY_CURRENT);
+	_snapshot.maxCurrent = (int16_t) BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_MAX_CURRENT);
+	_snapshot.avgPower = (int16_t) BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_AVG_POWER);
+	_snapshot.soc = BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_SOC);
+	_snapshot.intTemperature = BQ27441_SNAPSHOT_WORD(BQ27441_COMMAND_INT_TEMP);
+	#undef BQ27441_SNAPSHOT_WORD
+	// StateOfHealth() sits in the last two bytes: percent, status
+	_snapshot.sohPercent = data[BQ27441_COMMAND_SOH - BQ27441_SNAPSHOT_FIRST];
+	_snapshot.sohStatus = data[BQ27441_COMMAND_SOH - BQ27441_SNAPSHOT_FIRST + 1];
+
+	_state = FLEX_IDLE;
+	return true;
+}
+
+// No conversion involved
+uint32_t BQ27441_Flex::conversionTime(void)
+{
+	return 0;
+}
+
+// Battery characteristics fetched by the last collect()
+battery_snapshot BQ27441_Flex::snapshot(void)
+{
+	return _snapshot;
+}
+
 /*****************************************************************************
  ************************** GPOUT Control Functions **************************
  *****************************************************************************/
@@ -345,17 +431,65 @@ bool BQ27441_Flex::enterConfig(bool userControl)
 
 	if (executeControlWord(BQ27441_CONTROL_SET_CFGUPDATE))
 	{
-		int16_t timeout = BQ72441_I2C_TIMEOUT;
-		while ((timeout--) && (!(status() & BQ27441_FLAG_CFGUPMODE)))
+		// Wait at most BQ72441_I2C_TIMEOUT ms (plus the bus timeout)
+		uint32_t deadline = _i2c.deadline((uint32_t)BQ72441_I2C_TIMEOUT * 1000);
+		uint32_t waitStart = _i2c.waitBegin();
+		bool entered = false;
+		for (;;)
+		{
+			entered = status() & BQ27441_FLAG_CFGUPMODE;
+			if (entered || (_i2c.lastError() != FLEX_OK) || _i2c.expired(deadline))
+				break;
 			delay(1);
+		}
+		_i2c.waitEnd(waitStart);
 
-		if (timeout > 0)
-			return true;
+		return entered;
 	}
 
 	return false;
 }
 
+// Non-blocking enterConfig(): send SET_CFGUPDATE and return right away
+bool BQ27441_Flex::startEnterConfig(bool userControl)
+{
+	if (userControl) _userConfigControl = true;
+
+	if (sealed())
+	{
+		_sealFlag = true;
+		unseal(); // Must be unsealed before making changes
+	}
+
+	if (!executeControlWord(BQ27441_CONTROL_SET_CFGUPDATE))
+	{
+		_configState = FLEX_ERROR;
+		return false;
+	}
+	_configStartedAt = millis();
+	_configState = FLEX_BUSY;
+	return true;
+}
+
+// Single CONTROL_STATUS check for config update mode
+flexState_t BQ27441_Flex::pollEnterConfig(void)
+{
+	if (_configState != FLEX_BUSY)
+		return _configState;
+
+	if (status() & BQ27441_FLAG_CFGUPMODE)
+		_configState = FLEX_READY;
+	else if (_i2c.lastError() != FLEX_OK)
+		_configState = FLEX_ERROR;
+	else if ((uint32_t)(millis() - _configStartedAt) > BQ72441_I2C_TIMEOUT)
+	{
+		_configState = FLEX_ERROR;
+		_i2c.setError(FLEX_ERR_TIMEOUT);
+	}
+
+	return _configState;
+}
+
 // Exit configuration mode with the option to perform a resimulation
 bool BQ27441_Flex::exitConfig(bool resim)
 {
@@ -370,10 +504,24 @@ bool BQ27441_Flex::exitConfig(bool resim)
 	{
 		if (softReset())
 		{
-			int16_t timeout = BQ72441_I2C_TIMEOUT;
-			while ((timeout--) && ((flags() & BQ27441_FLAG_CFGUPMODE)))
+			// Wait at most BQ72441_I2C_TIMEOUT ms (plus the bus timeout)
+			uint32_t deadline = _i2c.deadline((uint32_t)BQ72441_I2C_TIMEOUT * 1000);
+			uint32_t waitStart = _i2c.waitBegin();
+			bool exited = false;
+			for (;;)
+			{
+				exited = !(flags() & BQ27441_FLAG_CFGUPMODE);
+				if (_i2c.lastError() != FLEX_OK)
+				{
+					exited = false;
+					break;
+				}
+				if (exited || _i2c.expired(deadline))
+					break;
 				delay(1);
-			if (timeout > 0)
+			}
+			_i2c.waitEnd(waitStart);
+			if (exited)
 			{
 				if (_sealFlag) seal(); // Seal back up if we IC was sealed coming in
 				return true;
@@ -427,9 +575,19 @@ bool BQ27441_Flex::unseal(void)
 }
 
 // Read the 16-bit opConfig register from extended data
+// (only the first time, after that from the shadow kept by writeOpConfig)
 uint16_t BQ27441_Flex::opConfig(void)
 {
-	return readWord(BQ27441_EXTENDED_OPCONFIG);
+	uint16_t value;
+	if (_i2c.shadow(BQ27441_EXTENDED_OPCONFIG, &value))
+		return value;
+
+	uint8_t data[2];
+	if (!i2cReadBytes(BQ27441_EXTENDED_OPCONFIG, data, 2))
+		return 0;
+	value = ((uint16_t) data[1] << 8) | data[0];
+	_i2c.setShadow(BQ27441_EXTENDED_OPCONFIG, value);
+	return value;
 }
 
 // Write the 16-bit opConfig register in extended data
@@ -440,19 +598,23 @@ bool BQ27441_Flex::writeOpConfig(uint16_t value)
 	uint8_t opConfigData[2] = {opConfigMSB, opConfigLSB};
 
 	// OpConfig register location: BQ27441_ID_REGISTERS id, offset 0
-	return writeExtendedData(BQ27441_ID_REGISTERS, 0, opConfigData, 2);
+	if (!writeExtendedData(BQ27441_ID_REGISTERS, 0, opConfigData, 2))
+		return false;
+	_i2c.setShadow(BQ27441_EXTENDED_OPCONFIG, value);
+	return true;
 }
 
 // Issue a soft-reset to the BQ27441_Flex-G1A
 bool BQ27441_Flex::softReset(void)
 {
+	_i2c.invalidateAll();
 	return executeControlWord(BQ27441_CONTROL_SOFT_RESET);
 }
 
 // Read a 16-bit command word from the BQ27441_Flex-G1A
 uint16_t BQ27441_Flex::readWord(uint16_t subAddress)
 {
-	uint8_t data[2];
+	uint8_t data[2] = {0, 0}; // 0 on a bus error, see lastError()
 	i2cReadBytes(subAddress, data, 2);
 	return ((uint16_t) data[1] << 8) | data[0];
 }
@@ -590,6 +752,10 @@ bool BQ27441_Flex::writeExtendedData(uint8_t classID, uint8_t offset, uint8_t *
 	if (len > 32)
 		return false;
 
+	// OpConfig lives at offset 0 of the registers class
+	if ((classID == BQ27441_ID_REGISTERS) && (offset < 2))
+		_i2c.invalidate(BQ27441_EXTENDED_OPCONFIG);
+
 	if (!_userConfigControl) enterConfig(false);
 
 	if (!blockDataControl()) // // enable block data memory control
@@ -618,44 +784,38 @@ bool BQ27441_Flex::writeExtendedData(uint8_t classID, uint8_t offset, uint8_t *
 	return true;
 }
 
+// Result of the last bus transaction or wait, see flexResult_t
+flexResult_t BQ27441_Flex::lastError(void)
+{
+	return _i2c.lastError();
+}
+
+// Bus and wait counters of the gauge, see flexI2CStats_t
+flexI2CStats_t BQ27441_Flex::getStats(void)
+{
+	return _i2c.stats();
+}
+
+void BQ27441_Flex::resetStats(void)
+{
+	_i2c.resetStats();
+}
+
 /*****************************************************************************
  ************************ I2C Read and Write Routines ************************
  *****************************************************************************/
 
 // Read a specified number of bytes over I2C at a given subAddress
+// (single burst: command pointer, repeated start, count bytes)
 int16_t BQ27441_Flex::i2cReadBytes(uint8_t subAddress, uint8_t * dest, uint8_t count)
 {
-	int16_t timeout = BQ72441_I2C_TIMEOUT;
-	_wire->beginTransmission(_deviceAddress);
-	_wire->write(subAddress);
-	_wire->endTransmission(true);
-
-	_wire->requestFrom(_deviceAddress, count);
-	while ((_wire->available() < count) && timeout--)
-		delay(1);
-	if (timeout)
-	{
-		for (int i=0; i<count; i++)
-		{
-			dest[i] = _wire->read();
-		}
-	}
-
-	return timeout;
+	return _i2c.readRegisters(subAddress, dest, count);
 }
 
 // Write a specified number of bytes over I2C to a given subAddress
 uint16_t BQ27441_Flex::i2cWriteBytes(uint8_t subAddress, uint8_t * src, uint8_t count)
 {
-	_wire->beginTransmission(_deviceAddress);
-	_wire->write(subAddress);
-	for (int i=0; i<count; i++)
-	{
-		_wire->write(src[i]);
-	}
-	_wire->endTransmission(true);
-
-	return true;
+	return _i2c.writeRegisters(subAddress, src, count);
 }
 
 BQ27441_Flex lipoGauge(TwoWire *wire); // Use lipo.[] to interact with the library in an Arduino sketch
@@ -28,10 +28,17 @@ No modifications made
 
 #include "Arduino.h"
 #include "Wire.h"
+#include <FlexI2CDevice.h>
+#include <FlexAsyncSensor.h>
 #include "BQ27441_Definitions.h"
 
 #define BQ72441_I2C_TIMEOUT 2000
 
+// Standard commands Temperature() .. StateOfHealth() are contiguous and are
+// read as a single 32 byte burst by collect()
+#define BQ27441_SNAPSHOT_FIRST	BQ27441_COMMAND_TEMP
+#define BQ27441_SNAPSHOT_LENGTH	32
+
 // Parameters for the current() function, to specify which current to read
 typedef enum {
 	AVG,  // Average Current (DEFAULT)
@@ -76,7 +83,26 @@ typedef enum {
 	BAT_LOW  // Set GPOUT to BAT_LOW functionality
 } gpout_function;
 
-class BQ27441_Flex {
+// Battery characteristics fetched in one go by collect()
+typedef struct {
+	uint16_t temperature;   // Battery temperature in 0.1 K
+	uint16_t voltage;       // mV
+	uint16_t flags;         // Flags()
+	uint16_t nomCapacity;   // Nominal available capacity in mAh
+	uint16_t availCapacity; // Full available capacity in mAh
+	uint16_t remCapacity;   // Remaining capacity in mAh
+	uint16_t fullCapacity;  // Full charge capacity in mAh
+	int16_t avgCurrent;     // mA, >0 indicates charging
+	int16_t stdbyCurrent;   // mA
+	int16_t maxCurrent;     // mA
+	int16_t avgPower;       // mW, >0 indicates charging
+	uint16_t soc;           // State of charge in %
+	uint16_t intTemperature; // Internal IC temperature in 0.1 K
+	uint8_t sohPercent;     // State of health in %
+	uint8_t sohStatus;      // State of health status bits
+} battery_snapshot;
+
+class BQ27441_Flex : public FlexAsyncSensor {
 public:
 	//////////////////////////////
 	// Initialization Functions //
@@ -95,6 +121,13 @@ public:
 	*/
 	bool begin(void);
 
+	/**
+	    Factory for FlexRegistry: creates a driver on wire and begins it.
+
+		@return the driver, NULL if begin() failed.
+	*/
+	static FlexAsyncSensor *create(TwoWire *wire, uint8_t address);
+
 	/**
 	    Configures the design capacity of the connected battery.
 
@@ -160,6 +193,66 @@ public:
 	*/
 	uint16_t temperature(temp_measure type = BATTERY);
 
+	/////////////////////////////////////////////
+	// Non-blocking access (see FlexAsyncSensor) //
+	/////////////////////////////////////////////
+	/**
+	    The gauge measures continuously, so start() only arms a snapshot
+
+		@return true
+	*/
+	bool start(void);
+
+	/**
+	    Never waits: FLEX_READY right after start()
+
+		@return state of the snapshot
+	*/
+	flexState_t poll(void);
+
+	/**
+	    Reads Temperature() .. StateOfHealth() in a single burst, see
+		snapshot()
+
+		@return true on success
+	*/
+	bool collect(void);
+
+	/**
+	    No conversion involved
+
+		@return 0
+	*/
+	uint32_t conversionTime(void);
+
+	/**
+	    Battery characteristics fetched by the last collect()
+
+		@return copy of the last snapshot
+	*/
+	battery_snapshot snapshot(void);
+
+	/**
+	    Result of the last bus transaction or wait. The getters return 0
+		when the gauge does not answer, this tells why.
+
+		@return FLEX_OK or the reason of the failure
+	*/
+	flexResult_t lastError(void);
+
+	/**
+	    Bus transactions, bytes, NACKs, timeouts and time spent in the
+		config mode polling loops since construction / resetStats()
+
+		@return copy of the counters
+	*/
+	flexI2CStats_t getStats(void);
+
+	/**
+	    Clears the counters returned by getStats()
+	*/
+	void resetStats(void);
+
 	////////////////////////////
 	// GPOUT Control Commands //
 	////////////////////////////
@@ -294,6 +387,24 @@ public:
 	*/
 	bool enterConfig(bool userControl = true);
 
+	/**
+	    Non-blocking variant of enterConfig(): unseals if needed, issues
+		SET_CFGUPDATE and returns right away. Follow up with
+		pollEnterConfig() until it is no longer FLEX_BUSY.
+
+		@param userControl, see enterConfig()
+		@return true if the command was sent
+	*/
+	bool startEnterConfig(bool userControl = true);
+
+	/**
+	    Single CONTROL_STATUS check for config update mode
+
+		@return FLEX_READY once in config mode, FLEX_ERROR after
+		        BQ72441_I2C_TIMEOUT ms, FLEX_BUSY otherwise
+	*/
+	flexState_t pollEnterConfig(void);
+
 	/**
 	    Exit configuration mode with the option to perform a resimulation
 
@@ -321,6 +432,10 @@ private:
 	bool _sealFlag; // Global to identify that IC was previously sealed
 	bool _userConfigControl; // Global to identify that user has control over
 	                         // entering/exiting config
+	FlexI2CDevice _i2c; // Shared Flex register transport (bus + address)
+	battery_snapshot _snapshot; // Filled by collect()
+	flexState_t _configState; // Progress of startEnterConfig()
+	uint32_t _configStartedAt; // millis() when startEnterConfig() was issued
 
 	/**
 	    Check if the BQ27441-G1A is sealed or not.
@@ -0,0 +1,83 @@
+// -------------------------------------------------------
+// FlexLog Example
+// Streams the FXOS8700 (SERCOM2, myWire) accel + mag raw
+// counts and a BQ27441 (SERCOM3, Wire) battery snapshot
+// per second as binary FlexLog records instead of text
+// lines. No String, no heap; some 14 bytes per motion
+// sample instead of 80.
+//
+// Capture the serial port to a file and turn it into CSV
+// with host/flexlog_decode:
+//   cat /dev/ttyACM0 > run.bin
+//   flexlog_decode run.bin > run.csv
+//
+// J.A. Korten - 2019
+//
+// -------------------------------------------------------
+
+#include <Wire.h>
+#include "wiring_private.h" // pinPeripheral() function
+#include "FlexLog.h"
+#include "RP_FXOS8700.h"
+#include "BQ27441_Flex.h"
+
+#define serialSpeed 115200
+
+#define LOG_ID_MOTION  0
+#define LOG_ID_BATTERY 1
+
+TwoWire myWire(&sercom2, 4, 3);
+RP_FXOS8700 accelMag = RP_FXOS8700(&myWire);
+BQ27441_Flex lipo = BQ27441_Flex(&Wire);
+FlexLogEncoder encoder;
+
+uint8_t record[FLEX_LOG_RECORD_MAX];
+unsigned long lastBattery = 0;
+
+void setup()
+{
+  Serial.begin(serialSpeed);
+
+  myWire.begin(); // master SERCOM 2
+  Wire.begin(); // master SERCOM 3
+
+  // Assign pins 4 & 3 to SERCOM functionality
+  pinPeripheral(4, PIO_SERCOM_ALT);
+  pinPeripheral(3, PIO_SERCOM_ALT);
+
+  delay(2500); // Wait for Serial...
+
+  accelMag.begin(ACCEL_RANGE_4G);
+  lipo.begin();
+  accelMag.start();
+}
+
+void loop()
+{
+  flexState_t state = accelMag.poll();
+  if (state == FLEX_READY && accelMag.collect()) {
+    int16_t raw[6] = {
+      accelMag.accel_raw.x, accelMag.accel_raw.y, accelMag.accel_raw.z,
+      accelMag.mag_raw.x, accelMag.mag_raw.y, accelMag.mag_raw.z
+    };
+    uint8_t n = encoder.encode(LOG_ID_MOTION, accelMag.sampleMicros(), raw, 6, record);
+    Serial.write(record, n);
+  }
+  if (state != FLEX_BUSY) {
+    accelMag.start(); // wait for the next data ready
+  }
+
+  if (millis() - lastBattery >= 1000) {
+    lastBattery = millis();
+    lipo.start();
+    if (lipo.poll() == FLEX_READY && lipo.collect()) {
+      battery_snapshot b = lipo.snapshot();
+      int32_t raw[7] = {
+        b.soc, b.voltage, b.avgCurrent, b.remCapacity,
+        b.fullCapacity, b.avgPower, b.sohPercent
+      };
+      uint8_t n = encoder.encode(LOG_ID_BATTERY, lipo.sampleMicros(), raw, 7, record);
+      Serial.write(record, n);
+    }
+  }
+}
@@ -0,0 +1,74 @@
+// -------------------------------------------------------
+// FlexRegistry Example
+// Finds the Flex sensors on SERCOM2 (myWire, sensor hut)
+// and SERCOM3 (Wire, board) in one pass, creates their
+// drivers and samples all of them with a FlexScheduler.
+// Replaces the scanDevices / reportDevice startup of the
+// FlexScanner example.
+//
+// J.A. Korten - 2019
+//
+// -------------------------------------------------------
+
+#include <Wire.h>
+#include "wiring_private.h" // pinPeripheral() function
+#include "FlexRegistry.h"
+#include "FlexScheduler.h"
+#include "Adafruit_HTU21DF_Flex.h"
+#include "Adafruit_ADS1015_Flex.h"
+#include "RP_FXAS21002C.h"
+#include "RP_FXOS8700.h"
+#include "SparkFunMPL3115A2_Flex.h"
+#include "BQ27441_Flex.h"
+
+#define serialSpeed 115200
+
+TwoWire myWire(&sercom2, 4, 3);
+FlexRegistry registry;
+FlexScheduler scheduler;
+
+void setup()
+{
+  Serial.begin(serialSpeed);
+
+  myWire.begin(); // master SERCOM 2
+  Wire.begin(); // master SERCOM 3
+
+  // Assign pins 4 & 3 to SERCOM functionality
+  pinPeripheral(4, PIO_SERCOM_ALT);
+  pinPeripheral(3, PIO_SERCOM_ALT);
+
+  registry.addBus(&myWire);
+  registry.addBus(&Wire);
+  registry.setFactory(FLEX_CHIP_HTU21DF, Adafruit_HTU21DF_Flex::create);
+  registry.setFactory(FLEX_CHIP_ADS1X15, Adafruit_ADS1115_Flex::create);
+  registry.setFactory(FLEX_CHIP_FXAS21002C, RP_FXAS21002C::create);
+  registry.setFactory(FLEX_CHIP_FXOS8700, RP_FXOS8700::create);
+  registry.setFactory(FLEX_CHIP_MPL3115A2, MPL3115A2_Flex::create);
+  registry.setFactory(FLEX_CHIP_BQ27441, BQ27441_Flex::create);
+  registry.scan();
+
+  for (uint8_t i = 0; i < registry.count(); i++) {
+    flexFound_t found = registry.device(i);
+    if (found.sensor != NULL) {
+      scheduler.add(found.sensor, found.bus, 1.0);
+    }
+  }
+  scheduler.begin();
+
+  delay(2500); // Wait for Serial...
+
+  Serial.print("Scan took "); Serial.print(registry.scanMicros()); Serial.println(" us");
+  for (uint8_t i = 0; i < registry.count(); i++) {
+    flexFound_t found = registry.device(i);
+    Serial.print(flexChipName(found.chip));
+    Serial.print(" at 0x"); Serial.print(found.address, HEX);
+    Serial.print(found.bus == &myWire ? " on SERCOM2" : " on SERCOM3");
+    Serial.println(found.sensor != NULL ? "" : " (begin failed)");
+  }
+}
+
+void loop()
+{
+  scheduler.run();
+}
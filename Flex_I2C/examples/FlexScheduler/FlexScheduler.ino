@@ -0,0 +1,85 @@
+// -------------------------------------------------------
+// FlexScheduler Example
+// Samples an HTU21DF on SERCOM2 (myWire) at 5 Hz and a
+// MPL3115A2 on SERCOM3 (Wire) at 1 Hz from one loop that
+// never blocks. Sensors with a low power mode are parked
+// between samples. Prints the achieved rates and the
+// estimated current every 10 s.
+//
+// J.A. Korten - 2019
+//
+// -------------------------------------------------------
+
+#include <Wire.h>
+#include "wiring_private.h" // pinPeripheral() function
+#include "FlexScheduler.h"
+#include "Adafruit_HTU21DF_Flex.h"
+#include "SparkFunMPL3115A2_Flex.h"
+
+#define serialSpeed 115200
+
+TwoWire myWire(&sercom2, 4, 3);
+Adafruit_HTU21DF_Flex htu = Adafruit_HTU21DF_Flex(&myWire);
+MPL3115A2_Flex mpl = MPL3115A2_Flex(&Wire);
+FlexScheduler scheduler;
+
+int8_t htuIndex;
+int8_t mplIndex;
+unsigned long lastReport = 0;
+
+void onSample(uint8_t index, FlexAsyncSensor *sensor)
+{
+  if (index == htuIndex) {
+    Serial.print("Temp: "); Serial.print(htu.lastTemperature());
+    Serial.print("\t\tHum: "); Serial.println(htu.lastHumidity());
+  } else if (index == mplIndex) {
+    Serial.print("Pressure(Pa): "); Serial.println(mpl.lastPressure());
+  }
+}
+
+void setup()
+{
+  Serial.begin(serialSpeed);
+
+  myWire.begin(); // master SERCOM 2
+  Wire.begin(); // master SERCOM 3
+
+  // Assign pins 4 & 3 to SERCOM functionality
+  pinPeripheral(4, PIO_SERCOM_ALT);
+  pinPeripheral(3, PIO_SERCOM_ALT);
+
+  delay(2500); // Wait for Serial...
+
+  htu.begin();
+  mpl.begin();
+  mpl.setModeBarometer();
+  mpl.setOversampleRate(7); // ~512 ms per conversion
+  mpl.enableEventFlags();
+
+  htuIndex = scheduler.add(&htu, &myWire, 5.0);
+  mplIndex = scheduler.add(&mpl, &Wire, 1.0);
+  scheduler.setDutyCycle(htuIndex, true); // sleeps by itself, stays as is
+  scheduler.setDutyCycle(mplIndex, true); // standby between samples
+  scheduler.setCallback(onSample);
+  scheduler.begin();
+}
+
+void loop()
+{
+  scheduler.run();
+
+  if (millis() - lastReport > 10000) {
+    lastReport = millis();
+    for (uint8_t i = 0; i < scheduler.count(); i++) {
+      flexSchedulerStats_t s = scheduler.stats(i);
+      Serial.print("Sensor "); Serial.print(i);
+      Serial.print(": "); Serial.print(scheduler.achievedRate(i));
+      Serial.print(" Hz, missed "); Serial.print(s.missed);
+      Serial.print(", errors "); Serial.print(s.errors);
+      Serial.print(", ~"); Serial.print(scheduler.averageMicroAmps(i));
+      Serial.println(" uA");
+    }
+  }
+
+  // other work goes here, keep it short
+}
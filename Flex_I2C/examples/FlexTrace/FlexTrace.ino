@@ -0,0 +1,69 @@
+// -------------------------------------------------------
+// FlexTrace Example
+// Records every I2C transaction of the FXOS8700 (SERCOM2,
+// myWire) and the HTU21DF (SERCOM3, Wire) with
+// FlexI2CTrace and streams the capture over Serial, next
+// to the normal work of the sketch.
+//
+// Capture the serial port to a file, then look at it or
+// serve it back to the same drivers on Linux:
+//   cat /dev/ttyACM0 > bus.trace
+//   flextrace_dump bus.trace > bus.csv
+//   (host/sim/FlexSimReplay for the replay)
+//
+// J.A. Korten - 2019
+//
+// -------------------------------------------------------
+
+#include <Wire.h>
+#include "wiring_private.h" // pinPeripheral() function
+#include "FlexI2CTrace.h"
+#include "RP_FXOS8700.h"
+#include "Adafruit_HTU21DF_Flex.h"
+
+#define serialSpeed 115200
+
+TwoWire myWire(&sercom2, 4, 3);
+RP_FXOS8700 accelMag = RP_FXOS8700(&myWire);
+Adafruit_HTU21DF_Flex htu = Adafruit_HTU21DF_Flex(&Wire);
+
+uint8_t traceBuffer[1024];
+FlexI2CTrace trace(traceBuffer, sizeof(traceBuffer));
+
+unsigned long lastHumidity = 0;
+
+void setup()
+{
+  Serial.begin(serialSpeed);
+
+  myWire.begin(); // master SERCOM 2
+  Wire.begin(); // master SERCOM 3
+
+  // Assign pins 4 & 3 to SERCOM functionality
+  pinPeripheral(4, PIO_SERCOM_ALT);
+  pinPeripheral(3, PIO_SERCOM_ALT);
+
+  delay(2500); // Wait for Serial...
+
+  FlexI2CDevice::setTrace(&trace); // from here on, begin() included
+  accelMag.begin(ACCEL_RANGE_4G);
+  htu.begin();
+}
+
+void loop()
+{
+  sensors_event_t accel, mag;
+  accelMag.getEvent(&accel, &mag);
+
+  if (millis() - lastHumidity >= 1000) {
+    lastHumidity = millis();
+    htu.readHumidity();
+  }
+
+  // Hand the capture over before it fills up (a record is at most
+  // FLEX_TRACE_RECORD_MAX bytes, a register read some 16)
+  if (trace.length() > trace.size() / 2) {
+    Serial.write(trace.data(), trace.length());
+    trace.clear();
+  }
+}
@@ -0,0 +1,135 @@
+/**************************************************************************/
+/*!
+    @file     FlexAsyncSensor.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Non-blocking measurement interface shared by the Flex drivers.
+
+    A measurement is split in three calls that never wait:
+
+    start()   - kick off a conversion (one short bus write, or nothing
+                for free running devices) and return immediately
+    poll()    - cheap check whether the result is there yet; may advance
+                an internal state machine (e.g. HTU21DF temp -> humidity)
+    collect() - fetch the result from the device into the driver, after
+                which the driver specific last...() accessors are valid
+
+    This way one loop can keep many sensors in flight at once: a sweep
+    takes about as long as the slowest conversion instead of the sum.
+
+    sampleMicros() is the micros() time the last sample was taken, not
+    when it was read. Drivers with a conversion per sample stamp it at
+    the conversion start edge plus the known time to the middle of the
+    conversion. Free running drivers stamp it at data ready: halfway
+    between the last status read that saw no new data and the first one
+    that did, so a tight poll() loop gets it to within half the poll
+    interval. Without such a bracket (blocking getEvent()) the sample is
+    on average half an output period old. setSampleTrim() adds a board
+    specific correction, e.g. an external filter's group delay.
+
+    Drivers with a low power mode implement sleep() / wake() (standby
+    or power-down between samples) and describe their supply current in
+    powerProfile(), so FlexScheduler can park them between samples and
+    estimate the energy per sample. The defaults mean "no low power
+    mode, current unknown".
+
+    Usage:
+    FlexAsyncSensor *sensors[] = { &htu, &mpl, &ads };
+
+    for (i...) sensors[i]->start();
+    while (pending) {
+      for (i...) if (sensors[i]->poll() == FLEX_READY) sensors[i]->collect();
+      // do other work
+    }
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_ASYNC_SENSOR_H
+#define _FLEX_ASYNC_SENSOR_H
+
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+typedef enum
+{
+  FLEX_IDLE  = 0,   // nothing in flight (or result already collected)
+  FLEX_BUSY  = 1,   // conversion started, result not available yet
+  FLEX_READY = 2,   // result can be collected
+  FLEX_ERROR = 3    // device or bus error, call start() again
+} flexState_t;
+
+/* Typical supply currents (datasheet, at the driver's settings), only
+   used for estimates; 0 when unknown */
+typedef struct
+{
+  float    convertMicroAmps;  // from start() until the sample is collected
+  float    idleMicroAmps;     // awake between samples
+  float    sleepMicroAmps;    // after sleep()
+  uint32_t wakeMicros;        // from wake() until start() gives valid data
+} flexPowerProfile_t;
+
+class FlexAsyncSensor
+{
+ public:
+  virtual ~FlexAsyncSensor() {}             // drivers are owned through this type, see FlexRegistry
+
+  virtual bool        start(void) = 0;
+  virtual flexState_t poll(void) = 0;
+  virtual bool        collect(void) = 0;
+
+  /* Expected time from start() until poll() can report FLEX_READY, in us */
+  virtual uint32_t    conversionTime(void) = 0;
+
+  /* Time from start() until the next poll() has work to do, in us. A
+     driver with several stages (HTU21DF temp -> humidity) reports the
+     end of the stage in progress, so the next one starts on time */
+  virtual uint32_t    nextPollTime(void)          { return conversionTime(); }
+
+  /* Low power mode between samples; false when there is none */
+  virtual bool        sleep(void)                 { return false; }
+  virtual bool        wake(void)                  { return true; }
+  virtual flexPowerProfile_t powerProfile(void)
+  {
+    flexPowerProfile_t profile = { 0, 0, 0, 0 };
+    return profile;
+  }
+
+  flexState_t         state(void) { return _state; }
+
+  /* micros() at which the last sample was taken, plus the trim */
+  uint32_t            sampleMicros(void)          { return _sampledAt + (uint32_t)_sampleTrim; }
+  void                setSampleTrim(int32_t us)   { _sampleTrim = us; }
+
+ protected:
+  /* Helpers for the implementing drivers */
+  void markStarted(void)                { _startedAt = micros(); _state = FLEX_BUSY; _bracketed = false; }
+  bool elapsedSinceStart(uint32_t us)   { return (uint32_t)(micros() - _startedAt) >= us; }
+  bool overdue(uint32_t graceUs)        { return elapsedSinceStart(conversionTime() + graceUs); }
+
+  /* Conversion per sample: the sample time itself */
+  void markSampled(uint32_t at)         { _sampledAt = at; }
+
+  /* Free running: a status read at readAt without / with new data */
+  void markNotReady(uint32_t readAt)    { _notReadyAt = readAt; _bracketed = true; }
+  void markDataReady(uint32_t readAt)
+  {
+    _sampledAt = _bracketed ? _notReadyAt + (readAt - _notReadyAt) / 2
+                            : readAt - conversionTime() / 2;
+    _bracketed = false;
+  }
+
+  flexState_t _state      = FLEX_IDLE;
+  uint32_t    _startedAt  = 0;
+  uint32_t    _sampledAt  = 0;
+  uint32_t    _notReadyAt = 0;
+  int32_t     _sampleTrim = 0;
+  bool        _bracketed  = false;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/**************************************************************************/
+/*!
+    @file     FlexConvert.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Batch conversion kernels for raw sample buffers.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexConvert.h"
+#include "FlexFixed.h"
+
+void flexScaleBatch(const int16_t *FLEX_RESTRICT in, uint16_t count, float scale,
+                    float *FLEX_RESTRICT out)
+{
+  for (uint16_t i = 0; i < count; i++)
+  {
+    out[i] = (float)in[i] * scale;
+  }
+}
+
+void flexScaleBatchFixed(const int16_t *FLEX_RESTRICT in, uint16_t count, int32_t mul, uint8_t shift,
+                         int32_t *FLEX_RESTRICT out)
+{
+  for (uint16_t i = 0; i < count; i++)
+  {
+    out[i] = flexScale(in[i], mul, shift);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  One pass per column: each loop reads with a stride of three
+            and writes contiguously
+*/
+/**************************************************************************/
+void flexScaleXYZBatch(const int16_t *FLEX_RESTRICT xyz, uint16_t count, float scale,
+                       float *FLEX_RESTRICT x, float *FLEX_RESTRICT y, float *FLEX_RESTRICT z)
+{
+  for (uint16_t i = 0; i < count; i++)
+  {
+    x[i] = (float)xyz[3 * i] * scale;
+  }
+  for (uint16_t i = 0; i < count; i++)
+  {
+    y[i] = (float)xyz[3 * i + 1] * scale;
+  }
+  for (uint16_t i = 0; i < count; i++)
+  {
+    z[i] = (float)xyz[3 * i + 2] * scale;
+  }
+}
+
+void flexScaleXYZBatchFixed(const int16_t *FLEX_RESTRICT xyz, uint16_t count, int32_t mul, uint8_t shift,
+                            int32_t *FLEX_RESTRICT x, int32_t *FLEX_RESTRICT y, int32_t *FLEX_RESTRICT z)
+{
+  for (uint16_t i = 0; i < count; i++)
+  {
+    x[i] = flexScale(xyz[3 * i], mul, shift);
+  }
+  for (uint16_t i = 0; i < count; i++)
+  {
+    y[i] = flexScale(xyz[3 * i + 1], mul, shift);
+  }
+  for (uint16_t i = 0; i < count; i++)
+  {
+    z[i] = flexScale(xyz[3 * i + 2], mul, shift);
+  }
+}
+
+void flexPressureBatch(const uint32_t *FLEX_RESTRICT words, uint16_t count, float *FLEX_RESTRICT pascal)
+{
+  for (uint16_t i = 0; i < count; i++)
+  {
+    pascal[i] = (float)(words[i] >> 4) * 0.25F;
+  }
+}
+
+void flexPressureBatchX4(const uint32_t *FLEX_RESTRICT words, uint16_t count, uint32_t *FLEX_RESTRICT quarterPascal)
+{
+  for (uint16_t i = 0; i < count; i++)
+  {
+    quarterPascal[i] = words[i] >> 4;
+  }
+}
@@ -0,0 +1,59 @@
+/**************************************************************************/
+/*!
+    @file     FlexConvert.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Batch conversion kernels for raw sample buffers.
+
+    getEvent() / getLastEvent() convert one sample at a time, with the
+    range switch and the event bookkeeping around every multiply. Once a
+    FIFO drain hands over 32 samples at once, the drivers convert the
+    whole buffer through these kernels instead: one tight loop per
+    output column, a single scale factor (or integer multiplier and
+    shift) per call, no branches inside the loop.
+
+    Output is structure-of-arrays (x[], y[], z[]) so every loop writes a
+    contiguous array, which lets the compiler unroll and vectorize it on
+    host and Cortex-M4 builds. Input is the raw buffer as the drivers
+    store it: interleaved x/y/z int16 triples (gyroRawData_t,
+    fxos8700RawData_t), ADS1X15 counts, or MPL3115A2 pressure words
+    (OUT_P_MSB << 16 | OUT_P_CSB << 8 | OUT_P_LSB).
+
+    The driver wrappers (RP_FXAS21002C::convertBatch(), ...) pick the
+    scale for the current range / gain.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_CONVERT_H
+#define _FLEX_CONVERT_H
+
+#include <stdint.h>
+
+#if defined(__GNUC__)
+  #define FLEX_RESTRICT  __restrict__
+#else
+  #define FLEX_RESTRICT
+#endif
+
+/* out[i] = in[i] * scale */
+void flexScaleBatch(const int16_t *FLEX_RESTRICT in, uint16_t count, float scale,
+                    float *FLEX_RESTRICT out);
+
+/* out[i] = in[i] * mul >> shift, rounded (see flexScale()) */
+void flexScaleBatchFixed(const int16_t *FLEX_RESTRICT in, uint16_t count, int32_t mul, uint8_t shift,
+                         int32_t *FLEX_RESTRICT out);
+
+/* Interleaved x/y/z triples to three scaled columns */
+void flexScaleXYZBatch(const int16_t *FLEX_RESTRICT xyz, uint16_t count, float scale,
+                       float *FLEX_RESTRICT x, float *FLEX_RESTRICT y, float *FLEX_RESTRICT z);
+void flexScaleXYZBatchFixed(const int16_t *FLEX_RESTRICT xyz, uint16_t count, int32_t mul, uint8_t shift,
+                            int32_t *FLEX_RESTRICT x, int32_t *FLEX_RESTRICT y, int32_t *FLEX_RESTRICT z);
+
+/* MPL3115A2 barometer words (Q18.2 Pa, left aligned in 24 bits) */
+void flexPressureBatch(const uint32_t *FLEX_RESTRICT words, uint16_t count, float *FLEX_RESTRICT pascal);
+void flexPressureBatchX4(const uint32_t *FLEX_RESTRICT words, uint16_t count, uint32_t *FLEX_RESTRICT quarterPascal);
+
+#endif
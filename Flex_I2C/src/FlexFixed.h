@@ -0,0 +1,47 @@
+/**************************************************************************/
+/*!
+    @file     FlexFixed.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Integer (fixed point) scaling for the Flex drivers.
+
+    The SAMD21 (Cortex-M0+) has no FPU: every float multiply or divide is
+    a software library call. Next to their float outputs the drivers
+    offer integer ones in a fixed unit, computed from the raw counts with
+    a precomputed multiplier and shift (value * mul >> shift, rounded):
+
+    HTU21DF      centi-degC, centi-%RH
+    ADS1X15      micro-volts
+    FXAS21002C   milli-dps
+    FXOS8700     milli-g, nano-tesla
+    MPL3115A2    Pa * 4, centi-degC, centi-meters
+
+    Usage:
+    int16_t centi;
+    if (htu.readTemperatureCenti(&centi) == FLEX_OK) { ... }  // 2345 = 23.45 C
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_FIXED_H
+#define _FLEX_FIXED_H
+
+#include <stdint.h>
+
+typedef struct
+{
+  int32_t x;
+  int32_t y;
+  int32_t z;
+} flexVector32_t;
+
+/* value * mul / 2^shift, rounded half up; value * mul must fit in 32 bits */
+static inline int32_t flexScale(int32_t value, int32_t mul, uint8_t shift)
+{
+  int32_t product = value * mul;
+  return shift ? ((product + ((int32_t)1 << (shift - 1))) >> shift) : product;
+}
+
+#endif
@@ -0,0 +1,118 @@
+/**************************************************************************/
+/*!
+    @file     FlexI2CBatch.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    A queue of prepared register transactions for one FlexI2CDevice.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include "FlexI2CBatch.h"
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+FlexI2CBatch::FlexI2CBatch(void)
+{
+  clear();
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Empties the batch so it can be filled again
+*/
+/**************************************************************************/
+void FlexI2CBatch::clear(void)
+{
+  _count = 0;
+  _used = 0;
+  _completed = 0;
+  _overflowed = false;
+}
+
+bool FlexI2CBatch::write8(uint8_t reg, uint8_t value)
+{
+  return writeRegisters(reg, &value, 1);
+}
+
+bool FlexI2CBatch::write16(uint8_t reg, uint16_t value)
+{
+  uint8_t data[2] = { (uint8_t)(value >> 8), (uint8_t)(value & 0xFF) };
+  return writeRegisters(reg, data, 2);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Queues a (burst) register write, the data is copied into the
+            batch right away
+*/
+/**************************************************************************/
+bool FlexI2CBatch::writeRegisters(uint8_t reg, const uint8_t *src, uint8_t count)
+{
+  if ((_count >= FLEX_I2C_BATCH_OPS) || ((uint16_t)_used + count > FLEX_I2C_BATCH_BYTES))
+  {
+    _overflowed = true;
+    return false;
+  }
+
+  entry_t *entry = &_ops[_count++];
+  entry->op = FLEX_BATCH_WRITE;
+  entry->reg = reg;
+  entry->count = count;
+  entry->offset = _used;
+  entry->dest = NULL;
+  memcpy(&_bytes[_used], src, count);
+  _used += count;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Queues a (burst) register read into dest, which must stay
+            valid until the batch has run
+*/
+/**************************************************************************/
+bool FlexI2CBatch::readRegisters(uint8_t reg, uint8_t *dest, uint8_t count)
+{
+  if (_count >= FLEX_I2C_BATCH_OPS)
+  {
+    _overflowed = true;
+    return false;
+  }
+
+  entry_t *entry = &_ops[_count++];
+  entry->op = FLEX_BATCH_READ;
+  entry->reg = reg;
+  entry->count = count;
+  entry->offset = 0;
+  entry->dest = dest;
+  return true;
+}
+
+uint8_t FlexI2CBatch::count(void)
+{
+  return _count;
+}
+
+uint8_t FlexI2CBatch::completed(void)
+{
+  return _completed;
+}
+
+bool FlexI2CBatch::overflowed(void)
+{
+  return _overflowed;
+}
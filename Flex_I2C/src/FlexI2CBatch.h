@@ -0,0 +1,102 @@
+/**************************************************************************/
+/*!
+    @file     FlexI2CBatch.h
+    @author   J.A. Korten
+    @license  BSD
+
+    A queue of prepared register transactions for one FlexI2CDevice.
+
+    Instead of issuing a configuration as a string of separate write8()
+    calls, a driver describes it once as a batch and hands the whole
+    batch to FlexI2CDevice::run(), which executes the transactions back
+    to back and stops at the first failure. Write data is copied into the
+    batch when it is added, read data lands in the caller's buffers when
+    the batch runs. A batch can be built once (e.g. in a constructor) and
+    run as often as needed.
+
+    Because a batch is plain data (operation list + byte pool), a future
+    interrupt or DMA driven backend can walk it without the CPU issuing
+    every transfer.
+
+    Usage:
+    FlexI2CBatch batch;
+    batch.write8(CTRL_REG1, 0x00);       // standby
+    batch.write8(XYZ_DATA_CFG, 0x01);    // 4G
+    batch.write8(CTRL_REG1, 0x15);       // active
+    if (dev.run(&batch) != FLEX_OK) ... // batch.completed() tells how far it got
+
+    With a FlexRegister.h map the values can be spelled as fields;
+    write() stores the whole register, fields not named are 0:
+    batch.write(FXOS_CTRL1_DR::set(2) | FXOS_CTRL1_LNOISE::set(1) | FXOS_CTRL1_ACTIVE::set(1));
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_I2C_BATCH_H
+#define _FLEX_I2C_BATCH_H
+
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include "FlexRegister.h"
+
+#ifndef FLEX_I2C_BATCH_OPS
+  #define FLEX_I2C_BATCH_OPS     8      // transactions per batch
+#endif
+#ifndef FLEX_I2C_BATCH_BYTES
+  #define FLEX_I2C_BATCH_BYTES   32     // write data per batch
+#endif
+
+typedef enum
+{
+  FLEX_BATCH_WRITE = 0,   // register pointer + data, STOP
+  FLEX_BATCH_READ  = 1    // register pointer, repeated START, data, STOP
+} flexBatchOp_t;
+
+class FlexI2CBatch
+{
+ public:
+  FlexI2CBatch(void);
+
+  void      clear(void);
+
+  // Queue transactions, false when the batch is full
+  bool      write8(uint8_t reg, uint8_t value);
+  bool      write16(uint8_t reg, uint16_t value);                        // MSB first
+  bool      writeRegisters(uint8_t reg, const uint8_t *src, uint8_t count);
+  bool      readRegisters(uint8_t reg, uint8_t *dest, uint8_t count);
+  template<class REG> bool write(FlexBits<REG> bits)                     // whole register
+  {
+    static_assert(REG::size() <= 2, "write: 8 and 16 bit registers only");
+    return (REG::size() == 2) ? write16(REG::address(), bits.bits) : write8(REG::address(), (uint8_t)bits.bits);
+  }
+
+  uint8_t   count(void);          // queued transactions
+  uint8_t   completed(void);      // transactions that succeeded in the last run
+  bool      overflowed(void);     // something did not fit, run() refuses the batch
+
+ private:
+  friend class FlexI2CDevice;
+
+  typedef struct
+  {
+    uint8_t   op;                 // flexBatchOp_t
+    uint8_t   reg;
+    uint8_t   count;
+    uint8_t   offset;             // write data in _bytes
+    uint8_t  *dest;               // read data
+  } entry_t;
+
+  entry_t   _ops[FLEX_I2C_BATCH_OPS];
+  uint8_t   _bytes[FLEX_I2C_BATCH_BYTES];
+  uint8_t   _count;
+  uint8_t   _used;
+  uint8_t   _completed;
+  bool      _overflowed;
+};
+
+#endif
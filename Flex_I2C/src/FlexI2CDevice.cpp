@@ -0,0 +1,600 @@
+/**************************************************************************/
+/*!
+    @file     FlexI2CDevice.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Shared register transport for the Flex sensor libraries.
+
+    Flexible extensions J.A. Korten 2019
+    version for SERCOM Wire
+*/
+/**************************************************************************/
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include <Wire.h>
+#include "FlexI2CDevice.h"
+
+#if FLEX_I2C_STATS
+  #define FLEX_I2C_COUNT(statement)   statement
+#else
+  #define FLEX_I2C_COUNT(statement)
+#endif
+
+#if FLEX_I2C_TRACE
+FlexI2CTrace *FlexI2CDevice::_trace = NULL;
+#endif
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Abstract away platform differences in Arduino wire library
+*/
+/**************************************************************************/
+void FlexI2CDevice::wireWrite(uint8_t x)
+{
+  #if ARDUINO >= 100
+    _wire->write((uint8_t)x);
+  #else
+    _wire->send(x);
+  #endif
+}
+
+/**************************************************************************/
+/*!
+    @brief  Abstract away platform differences in Arduino wire library
+*/
+/**************************************************************************/
+uint8_t FlexI2CDevice::wireRead(void)
+{
+  #if ARDUINO >= 100
+    return _wire->read();
+  #else
+    return _wire->receive();
+  #endif
+}
+
+/**************************************************************************/
+/*!
+    @brief  Ends a transmission and maps the Wire status to a flexResult_t
+*/
+/**************************************************************************/
+bool FlexI2CDevice::endTransmission(bool stop)
+{
+  uint8_t status = _wire->endTransmission(stop);
+  FLEX_I2C_COUNT(_stats.transactions++);
+
+  switch (status)
+  {
+    case 0:  _lastError = FLEX_OK;            break;
+    case 1:  _lastError = FLEX_ERR_ARG;       break;  // data too long for the buffer
+    case 2:  _lastError = FLEX_ERR_ADDR_NACK; break;
+    case 3:  _lastError = FLEX_ERR_DATA_NACK; break;
+    case 5:  _lastError = FLEX_ERR_TIMEOUT;   break;  // cores with WIRE_HAS_TIMEOUT
+    default: _lastError = FLEX_ERR_BUS;       break;
+  }
+#if defined(WIRE_HAS_TIMEOUT)
+  if (_wire->getWireTimeoutFlag())
+  {
+    _wire->clearWireTimeoutFlag();
+    _lastError = FLEX_ERR_TIMEOUT;
+  }
+#endif
+
+  if (_lastError == FLEX_ERR_TIMEOUT)
+  {
+    countTimeout();
+  }
+  else if (_lastError != FLEX_OK)
+  {
+    FLEX_I2C_COUNT(_stats.nacks++);
+  }
+  return (_lastError == FLEX_OK);
+}
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Binds a device address to an (already started) TwoWire bus
+*/
+/**************************************************************************/
+FlexI2CDevice::FlexI2CDevice(TwoWire *wire, uint8_t address)
+{
+  _wire = wire;
+  _address = address;
+  _shadowValid = 0;
+  _lastError = FLEX_OK;
+  resetStats();
+  _timeout = FLEX_I2C_TIMEOUT_US;   // the bus' own Wire timeout is left alone
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+TwoWire *FlexI2CDevice::wire(void)
+{
+  return _wire;
+}
+
+uint8_t FlexI2CDevice::address(void)
+{
+  return _address;
+}
+
+void FlexI2CDevice::setAddress(uint8_t address)
+{
+  _address = address;
+  invalidateAll();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks that the device ACKs its address (empty write)
+*/
+/**************************************************************************/
+bool FlexI2CDevice::probe(void)
+{
+  uint32_t at = traceStart();
+  _wire->beginTransmission(_address);
+  bool ok = endTransmission(true);
+  traceWrite(at, -1, NULL, 0, true);
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes count bytes in a single transmission
+*/
+/**************************************************************************/
+bool FlexI2CDevice::write(const uint8_t *src, uint8_t count, bool stop)
+{
+  uint32_t at = traceStart();
+  _wire->beginTransmission(_address);
+  for (uint8_t i = 0; i < count; i++)
+  {
+    wireWrite(src[i]);
+  }
+  FLEX_I2C_COUNT(_stats.bytesWritten += count);
+  bool ok = endTransmission(stop);
+  traceWrite(at, -1, src, count, stop);
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads count bytes, returns false on a short read
+*/
+/**************************************************************************/
+bool FlexI2CDevice::read(uint8_t *dest, uint8_t count, bool stop)
+{
+  uint32_t at = traceStart();
+  uint8_t received = _wire->requestFrom((uint8_t)_address, (uint8_t)count, (uint8_t)stop);
+  FLEX_I2C_COUNT(_stats.transactions++);
+  FLEX_I2C_COUNT(_stats.bytesRead += received);
+#if defined(WIRE_HAS_TIMEOUT)
+  if (_wire->getWireTimeoutFlag())
+  {
+    _wire->clearWireTimeoutFlag();
+    countTimeout();
+    _lastError = FLEX_ERR_TIMEOUT;
+    traceRead(at, count, dest, received, stop);
+    return false;
+  }
+#endif
+  if (received != count)
+  {
+    FLEX_I2C_COUNT(_stats.nacks++);
+    /* Nothing at all means the address (or a busy device) NACKed */
+    _lastError = (received == 0) ? FLEX_ERR_ADDR_NACK : FLEX_ERR_SHORT_READ;
+    traceRead(at, count, dest, received, stop);
+    return false;
+  }
+  _lastError = FLEX_OK;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    dest[i] = wireRead();
+  }
+  traceRead(at, count, dest, received, stop);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes the register pointer followed by count data bytes in
+            one transmission. Devices with auto-increment store the bytes
+            in consecutive registers.
+*/
+/**************************************************************************/
+bool FlexI2CDevice::writeRegisters(uint8_t reg, const uint8_t *src, uint8_t count)
+{
+  uint32_t at = traceStart();
+  _wire->beginTransmission(_address);
+  wireWrite(reg);
+  for (uint8_t i = 0; i < count; i++)
+  {
+    wireWrite(src[i]);
+  }
+  FLEX_I2C_COUNT(_stats.bytesWritten += 1 + count);
+  bool ok = endTransmission(true);
+  traceWrite(at, reg, src, count, true);
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Burst read: register pointer write, repeated start, then count
+            bytes from consecutive registers.
+*/
+/**************************************************************************/
+bool FlexI2CDevice::readRegisters(uint8_t reg, uint8_t *dest, uint8_t count)
+{
+  uint32_t at = traceStart();
+  _wire->beginTransmission(_address);
+  wireWrite(reg);
+  FLEX_I2C_COUNT(_stats.bytesWritten++);
+  bool ok = endTransmission(false);
+  traceWrite(at, reg, NULL, 0, false);
+  if (!ok)
+  {
+    return false;
+  }
+  return read(dest, count);
+}
+
+bool FlexI2CDevice::write8(uint8_t reg, uint8_t value)
+{
+  return writeRegisters(reg, &value, 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads a single register, returns 0 on a bus error (like the
+            original driver helpers did)
+*/
+/**************************************************************************/
+uint8_t FlexI2CDevice::read8(uint8_t reg)
+{
+  uint8_t value = 0;
+  readRegisters(reg, &value, 1);
+  return value;
+}
+
+bool FlexI2CDevice::write16(uint8_t reg, uint16_t value)
+{
+  uint8_t data[2] = { (uint8_t)(value >> 8), (uint8_t)(value & 0xFF) };
+  return writeRegisters(reg, data, 2);
+}
+
+uint16_t FlexI2CDevice::read16(uint8_t reg)
+{
+  uint8_t data[2] = { 0, 0 };
+  readRegisters(reg, data, 2);
+  return ((uint16_t)data[0] << 8) | data[1];
+}
+
+uint16_t FlexI2CDevice::read16LE(uint8_t reg)
+{
+  uint8_t data[2] = { 0, 0 };
+  readRegisters(reg, data, 2);
+  return ((uint16_t)data[1] << 8) | data[0];
+}
+
+/***************************************************************************
+ BATCHES
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Executes the queued transactions of batch in order, back to
+            back. Stops at the first failure and returns its result;
+            batch->completed() tells how many went through. Written
+            registers drop their shadow, the batch bypasses the cache.
+*/
+/**************************************************************************/
+flexResult_t FlexI2CDevice::run(FlexI2CBatch *batch)
+{
+  batch->_completed = 0;
+  if (batch->_overflowed)
+  {
+    return setError(FLEX_ERR_ARG);
+  }
+
+  for (uint8_t i = 0; i < batch->_count; i++)
+  {
+    FlexI2CBatch::entry_t *entry = &batch->_ops[i];
+    bool ok;
+
+    if (entry->op == FLEX_BATCH_WRITE)
+    {
+      invalidate(entry->reg);
+      ok = writeRegisters(entry->reg, &batch->_bytes[entry->offset], entry->count);
+    }
+    else
+    {
+      ok = readRegisters(entry->reg, entry->dest, entry->count);
+    }
+    if (!ok)
+    {
+      return _lastError;
+    }
+    batch->_completed++;
+  }
+  return setError(FLEX_OK);
+}
+
+/***************************************************************************
+ ERRORS AND DEADLINES
+ ***************************************************************************/
+
+flexResult_t FlexI2CDevice::lastError(void)
+{
+  return _lastError;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Records an error found by the driver itself (e.g. a CRC
+            mismatch or an overdue conversion) so lastError() reports it,
+            returns result
+*/
+/**************************************************************************/
+flexResult_t FlexI2CDevice::setError(flexResult_t result)
+{
+  if (result == FLEX_ERR_TIMEOUT)
+  {
+    countTimeout();
+  }
+  _lastError = result;
+  return result;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets how long a wait may overrun its nominal time, in us. Also
+            the per transfer timeout on cores with WIRE_HAS_TIMEOUT (note
+            that one is shared by every device on that bus). Only an
+            explicit call touches Wire; the constructor just keeps the
+            FLEX_I2C_TIMEOUT_US default for the waits.
+*/
+/**************************************************************************/
+void FlexI2CDevice::setTimeout(uint32_t us)
+{
+  _timeout = us;
+#if defined(WIRE_HAS_TIMEOUT)
+  _wire->setWireTimeout(us, true);
+#endif
+}
+
+uint32_t FlexI2CDevice::timeout(void)
+{
+  return _timeout;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Deadline for a wait that nominally takes expectedUs: now plus
+            expectedUs plus timeout(). Pass it to expired().
+*/
+/**************************************************************************/
+uint32_t FlexI2CDevice::deadline(uint32_t expectedUs)
+{
+  return micros() + expectedUs + _timeout;
+}
+
+/**************************************************************************/
+/*!
+    @brief  True once the deadline has passed; counts a timeout and sets
+            lastError() to FLEX_ERR_TIMEOUT then
+*/
+/**************************************************************************/
+bool FlexI2CDevice::expired(uint32_t deadline)
+{
+  if ((int32_t)(micros() - deadline) < 0)
+  {
+    return false;
+  }
+  setError(FLEX_ERR_TIMEOUT);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Short description of a flexResult_t, for logging
+*/
+/**************************************************************************/
+const char *flexResultString(flexResult_t result)
+{
+  switch (result)
+  {
+    case FLEX_OK:             return "ok";
+    case FLEX_ERR_ADDR_NACK:  return "address NACK";
+    case FLEX_ERR_DATA_NACK:  return "data NACK";
+    case FLEX_ERR_SHORT_READ: return "short read";
+    case FLEX_ERR_BUS:        return "bus error";
+    case FLEX_ERR_TIMEOUT:    return "timeout";
+    case FLEX_ERR_CRC:        return "CRC mismatch";
+    case FLEX_ERR_ARG:        return "invalid argument";
+  }
+  return "unknown";
+}
+
+/***************************************************************************
+ SHADOW CACHE
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Reads a control register, from the shadow when it holds a
+            valid copy, otherwise from the bus (and then shadows it)
+*/
+/**************************************************************************/
+uint8_t FlexI2CDevice::readShadow8(uint8_t reg)
+{
+  uint16_t value;
+
+  if (shadow(reg, &value))
+  {
+    return (uint8_t)value;
+  }
+
+  uint8_t fresh = 0;
+  if (readRegisters(reg, &fresh, 1))
+  {
+    setShadow(reg, fresh);
+  }
+  return fresh;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes a control register and keeps the written value as its
+            shadow. A failed write drops the shadow, the chip state is
+            unknown then.
+*/
+/**************************************************************************/
+bool FlexI2CDevice::writeShadow8(uint8_t reg, uint8_t value)
+{
+  if (writeRegisters(reg, &value, 1))
+  {
+    setShadow(reg, value);
+    return true;
+  }
+  invalidate(reg);
+  return false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Looks up the shadow of reg (8 or 16 bit, up to the driver).
+            Returns false when it is not cached.
+*/
+/**************************************************************************/
+bool FlexI2CDevice::shadow(uint8_t reg, uint16_t *value)
+{
+  for (uint8_t i = 0; i < FLEX_I2C_SHADOW_SLOTS; i++)
+  {
+    if ((_shadowValid & (1 << i)) && (_shadowReg[i] == reg))
+    {
+      *value = _shadowValue[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Stores the shadow of reg. When all slots are taken by other
+            registers reg simply stays uncached.
+*/
+/**************************************************************************/
+void FlexI2CDevice::setShadow(uint8_t reg, uint16_t value)
+{
+  int8_t freeSlot = -1;
+
+  for (uint8_t i = 0; i < FLEX_I2C_SHADOW_SLOTS; i++)
+  {
+    if (_shadowValid & (1 << i))
+    {
+      if (_shadowReg[i] == reg)
+      {
+        _shadowValue[i] = value;
+        return;
+      }
+    }
+    else if (freeSlot < 0)
+    {
+      freeSlot = i;
+    }
+  }
+
+  if (freeSlot >= 0)
+  {
+    _shadowReg[freeSlot] = reg;
+    _shadowValue[freeSlot] = value;
+    _shadowValid |= (1 << freeSlot);
+  }
+}
+
+void FlexI2CDevice::invalidate(uint8_t reg)
+{
+  for (uint8_t i = 0; i < FLEX_I2C_SHADOW_SLOTS; i++)
+  {
+    if ((_shadowValid & (1 << i)) && (_shadowReg[i] == reg))
+    {
+      _shadowValid &= ~(1 << i);
+    }
+  }
+}
+
+void FlexI2CDevice::invalidateAll(void)
+{
+  _shadowValid = 0;
+}
+
+/***************************************************************************
+ INSTRUMENTATION
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Records the transfers of every FlexI2CDevice into trace from
+            now on, NULL stops recording. Not available (and no cost)
+            with FLEX_I2C_TRACE 0.
+*/
+/**************************************************************************/
+#if FLEX_I2C_TRACE
+void FlexI2CDevice::setTrace(FlexI2CTrace *trace)
+{
+  _trace = trace;
+}
+
+FlexI2CTrace *FlexI2CDevice::trace(void)
+{
+  return _trace;
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Counters since construction or the last resetStats(), all
+            zero when compiled with FLEX_I2C_STATS 0
+*/
+/**************************************************************************/
+flexI2CStats_t FlexI2CDevice::stats(void)
+{
+#if FLEX_I2C_STATS
+  return _stats;
+#else
+  flexI2CStats_t none;
+  memset(&none, 0, sizeof(none));
+  return none;
+#endif
+}
+
+void FlexI2CDevice::resetStats(void)
+{
+  FLEX_I2C_COUNT(memset(&_stats, 0, sizeof(_stats)));
+}
+
+/**************************************************************************/
+/*!
+    @brief  delay() for drivers, counted as wait time
+*/
+/**************************************************************************/
+void FlexI2CDevice::waitMillis(uint32_t ms)
+{
+  delay(ms);
+  FLEX_I2C_COUNT(_stats.waitMicros += ms * 1000);
+}
@@ -0,0 +1,307 @@
+/**************************************************************************/
+/*!
+    @file     FlexI2CDevice.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Shared register transport for the Flex sensor libraries.
+
+    Every Flex driver gets its TwoWire bus injected. Instead of each driver
+    carrying its own copy of byte-at-a-time read8/write8 helpers, the
+    drivers hand their bus and address to a FlexI2CDevice and use it for
+    all register I/O. Multi-register reads are issued as a single burst
+    using a repeated start (no STOP between the register pointer write
+    and the read), multi-register writes go out in a single transmission.
+
+    Usage:
+    TwoWire myWire(&sercom2, 4, 3);
+
+    FlexI2CDevice dev = FlexI2CDevice(&myWire, 0x60);
+    uint8_t buf[5];
+    dev.readRegisters(0x01, buf, 5); // OUT_P_MSB .. OUT_T_LSB in one go
+
+    Control registers that only change when the driver writes them can
+    be kept in a small shadow cache (readShadow8 / writeShadow8): the
+    first read goes to the bus, after that read-modify-write sequences
+    cost a single write. Drivers call invalidate() / invalidateAll()
+    whenever the chip may have changed a shadowed register by itself
+    (reset, self-clearing bits, ...).
+
+    Configuration sequences can be queued in a FlexI2CBatch and executed
+    as one unit with run().
+
+    Drivers that describe their registers with FlexRegister.h get typed
+    access on top: update() merges field changes into one shadowed
+    write (or none when nothing changes), readBlock() / writeBlock()
+    issue one auto-increment burst per contiguous run of registers.
+
+    Every transfer records a flexResult_t, see lastError(). Drivers bound
+    their polling loops with deadline() / expired(): a wait may overrun
+    its nominal time by at most timeout() (FLEX_I2C_TIMEOUT_US, default
+    5 ms) before it gives up with FLEX_ERR_TIMEOUT, so a stalled sensor
+    costs a bounded few milliseconds. On cores that support it
+    (WIRE_HAS_TIMEOUT) setTimeout() also hands the budget to the Wire
+    library for the individual transfers; that one is per bus, so
+    constructing a device never changes it.
+
+    Every device keeps cheap counters (transactions, bytes, NACKs,
+    timeouts and time spent waiting in delays / polling loops), see
+    stats(). Define FLEX_I2C_STATS as 0 before including to compile them
+    out completely.
+
+    setTrace() taps the traffic of every device into a FlexI2CTrace
+    (see FlexI2CTrace.h), e.g. to capture a field unit's bus for replay
+    on the host. Without a trace set a transfer costs one pointer test.
+
+    Flexible extensions J.A. Korten 2019
+    version for SERCOM Wire
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_I2C_DEVICE_H
+#define _FLEX_I2C_DEVICE_H
+
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include <Wire.h>
+#include "FlexResult.h"
+#include "FlexI2CBatch.h"
+#include "FlexRegister.h"
+#include "FlexI2CTrace.h"
+
+#ifndef FLEX_I2C_TIMEOUT_US
+  #define FLEX_I2C_TIMEOUT_US    5000   // max. overrun of a wait, per transfer on Wire
+#endif
+
+#ifndef FLEX_I2C_STATS
+  #define FLEX_I2C_STATS  1
+#endif
+
+#ifndef FLEX_I2C_SHADOW_SLOTS
+  #define FLEX_I2C_SHADOW_SLOTS  4      // shadowed registers per device (1..8)
+#endif
+
+static_assert((FLEX_I2C_SHADOW_SLOTS >= 1) && (FLEX_I2C_SHADOW_SLOTS <= 8),
+              "FLEX_I2C_SHADOW_SLOTS: 1..8, FlexI2CDevice::_shadowValid is an 8 bit mask");
+
+typedef struct
+{
+  uint32_t transactions;    // address phases (START / repeated START)
+  uint32_t bytesWritten;    // data bytes, register pointers included
+  uint32_t bytesRead;
+  uint32_t nacks;           // NACKed transmissions and short reads
+  uint32_t timeouts;        // polling loops that gave up
+  uint32_t waitMicros;      // time in delays / polling loops (wraps after ~71 min)
+} flexI2CStats_t;
+
+class FlexI2CDevice
+{
+ public:
+  FlexI2CDevice(TwoWire *wire, uint8_t address);
+
+  TwoWire  *wire(void);
+  uint8_t   address(void);
+  void      setAddress(uint8_t address);
+
+  bool      probe(void);
+
+  // Raw transfers (no register pointer)
+  bool      write(const uint8_t *src, uint8_t count, bool stop = true);
+  bool      read(uint8_t *dest, uint8_t count, bool stop = true);
+
+  // Register transfers, auto-increment bursts for count > 1
+  bool      writeRegisters(uint8_t reg, const uint8_t *src, uint8_t count);
+  bool      readRegisters(uint8_t reg, uint8_t *dest, uint8_t count);
+
+  // Single register helpers
+  bool      write8(uint8_t reg, uint8_t value);
+  uint8_t   read8(uint8_t reg);
+  bool      write16(uint8_t reg, uint16_t value);    // MSB first
+  uint16_t  read16(uint8_t reg);                     // MSB first
+  uint16_t  read16LE(uint8_t reg);                   // LSB first
+
+  // Prepared transactions, back to back, stops at the first failure
+  flexResult_t run(FlexI2CBatch *batch);
+
+  // Errors and deadlines
+  flexResult_t lastError(void);                      // result of the last transfer
+  flexResult_t setError(flexResult_t result);        // for driver level errors (CRC, ...)
+  void      setTimeout(uint32_t us);
+  uint32_t  timeout(void);
+  uint32_t  deadline(uint32_t expectedUs);           // micros() by which a wait must be done
+  bool      expired(uint32_t deadline);              // FLEX_ERR_TIMEOUT once passed
+
+  // Shadow cache for control registers
+  uint8_t   readShadow8(uint8_t reg);                // bus read only on a miss
+  bool      writeShadow8(uint8_t reg, uint8_t value);
+  bool      shadow(uint8_t reg, uint16_t *value);    // true on a hit
+  void      setShadow(uint8_t reg, uint16_t value);
+  void      invalidate(uint8_t reg);
+  void      invalidateAll(void);
+
+  // Typed registers (see FlexRegister.h)
+  template<class REG> bool update(FlexBits<REG> bits);           // at most one write
+  template<class A, class... REST> bool readBlock(uint8_t *dest); // one burst per contiguous run
+  template<class A, class... REST> bool writeBlock(const uint8_t *src);
+
+  // Instrumentation
+  flexI2CStats_t stats(void);
+  void      resetStats(void);
+  void      waitMillis(uint32_t ms);                 // delay() counted as wait time
+#if FLEX_I2C_STATS
+  uint32_t  waitBegin(void)                { return micros(); }
+  void      waitEnd(uint32_t startedAt)    { _stats.waitMicros += micros() - startedAt; }
+  void      countTimeout(void)             { _stats.timeouts++; }
+#else
+  uint32_t  waitBegin(void)                { return 0; }
+  void      waitEnd(uint32_t startedAt)    { (void)startedAt; }
+  void      countTimeout(void)             { }
+#endif
+
+#if FLEX_I2C_TRACE
+  // Traffic capture, shared by all devices (NULL: off)
+  static void setTrace(FlexI2CTrace *trace);
+  static FlexI2CTrace *trace(void);
+#endif
+
+ private:
+  void      wireWrite(uint8_t x);
+  uint8_t   wireRead(void);
+  bool      endTransmission(bool stop);
+  template<class A> bool readRun(uint8_t *dest, uint8_t reg, uint8_t count);
+  template<class A, class B, class... REST> bool readRun(uint8_t *dest, uint8_t reg, uint8_t count);
+  template<class A> bool writeRun(const uint8_t *src, uint8_t reg, uint8_t count);
+  template<class A, class B, class... REST> bool writeRun(const uint8_t *src, uint8_t reg, uint8_t count);
+#if FLEX_I2C_TRACE
+  uint32_t  traceStart(void)               { return _trace ? micros() : 0; }
+  void      traceWrite(uint32_t at, int16_t reg, const uint8_t *src, uint8_t count, bool stop)
+  {
+    if (_trace) _trace->recordWrite(at, _address, reg, src, count, stop, _lastError);
+  }
+  void      traceRead(uint32_t at, uint8_t requested, const uint8_t *dest, uint8_t received, bool stop)
+  {
+    if (_trace) _trace->recordRead(at, _address, requested, dest, received, stop, _lastError);
+  }
+
+  static FlexI2CTrace *_trace;
+#else
+  uint32_t  traceStart(void)               { return 0; }
+  void      traceWrite(uint32_t, int16_t, const uint8_t *, uint8_t, bool) { }
+  void      traceRead(uint32_t, uint8_t, const uint8_t *, uint8_t, bool) { }
+#endif
+
+  TwoWire  *_wire;
+  uint8_t   _address;
+  uint8_t   _shadowReg[FLEX_I2C_SHADOW_SLOTS];
+  uint16_t  _shadowValue[FLEX_I2C_SHADOW_SLOTS];
+  uint8_t   _shadowValid;                            // bit per slot
+  flexResult_t _lastError;
+  uint32_t  _timeout;
+#if FLEX_I2C_STATS
+  flexI2CStats_t _stats;
+#endif
+};
+
+/**************************************************************************/
+/*!
+    @brief  Writes the fields in bits into register REG, the other bits
+            keep their value. They come from the shadow (one bus read on
+            a miss, none when bits covers the whole register), and the
+            write is skipped when the shadow already holds the result.
+*/
+/**************************************************************************/
+template<class REG>
+bool FlexI2CDevice::update(FlexBits<REG> bits)
+{
+  static_assert(REG::size() <= 2, "update: 8 and 16 bit registers only");
+
+  uint8_t  data[2];
+  uint16_t current = 0;
+  bool     cached = shadow(REG::address(), &current);
+
+  if (!cached && (bits.mask != REG::all()))
+  {
+    if (!readRegisters(REG::address(), data, REG::size()))
+    {
+      return false;
+    }
+    current = (REG::size() == 2) ? ((uint16_t)data[0] << 8) | data[1] : data[0];
+  }
+
+  uint16_t value = bits.apply(current);
+  if (cached && (value == current))
+  {
+    _lastError = FLEX_OK;
+    return true;
+  }
+
+  data[0] = (REG::size() == 2) ? (uint8_t)(value >> 8) : (uint8_t)value;
+  data[1] = (uint8_t)value;
+  if (writeRegisters(REG::address(), data, REG::size()))
+  {
+    setShadow(REG::address(), value);
+    return true;
+  }
+  invalidate(REG::address());
+  return false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads the registers A, REST... into dest, back to back in list
+            order. Registers that follow each other share one burst, so
+            the number of transactions is flexBlockBursts<A, REST...>().
+*/
+/**************************************************************************/
+template<class A, class... REST>
+bool FlexI2CDevice::readBlock(uint8_t *dest)
+{
+  return readRun<A, REST...>(dest, A::address(), 0);
+}
+
+template<class A, class... REST>
+bool FlexI2CDevice::writeBlock(const uint8_t *src)
+{
+  return writeRun<A, REST...>(src, A::address(), 0);
+}
+
+/* count bytes of the current run are pending at dest, starting at reg */
+template<class A>
+bool FlexI2CDevice::readRun(uint8_t *dest, uint8_t reg, uint8_t count)
+{
+  return readRegisters(reg, dest, count + A::size());
+}
+
+template<class A, class B, class... REST>
+bool FlexI2CDevice::readRun(uint8_t *dest, uint8_t reg, uint8_t count)
+{
+  count += A::size();
+  if (flexAdjacent<A, B>())
+  {
+    return readRun<B, REST...>(dest, reg, count);
+  }
+  return readRegisters(reg, dest, count) && readRun<B, REST...>(dest + count, B::address(), 0);
+}
+
+template<class A>
+bool FlexI2CDevice::writeRun(const uint8_t *src, uint8_t reg, uint8_t count)
+{
+  return writeRegisters(reg, src, count + A::size());
+}
+
+template<class A, class B, class... REST>
+bool FlexI2CDevice::writeRun(const uint8_t *src, uint8_t reg, uint8_t count)
+{
+  count += A::size();
+  if (flexAdjacent<A, B>())
+  {
+    return writeRun<B, REST...>(src, reg, count);
+  }
+  return writeRegisters(reg, src, count) && writeRun<B, REST...>(src + count, B::address(), 0);
+}
+
+#endif
@@ -0,0 +1,235 @@
+/**************************************************************************/
+/*!
+    @file     FlexI2CTrace.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Compact I2C traffic capture (see FlexI2CTrace.h for the record
+    layout).
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexI2CTrace.h"
+#include "FlexLog.h"
+
+/***************************************************************************
+ RECORDER
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a recorder that fills buffer (size bytes)
+*/
+/**************************************************************************/
+FlexI2CTrace::FlexI2CTrace(uint8_t *buffer, uint16_t size)
+{
+  _buffer = buffer;
+  _size = size;
+  reset();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes the head of a record when the whole record (payload
+            bytes included) fits, otherwise counts it as dropped
+*/
+/**************************************************************************/
+bool FlexI2CTrace::begin(uint8_t head, uint8_t address, uint32_t at, uint8_t count, int16_t received, uint16_t payload)
+{
+  uint8_t  header[1 + 1 + 5 + 2 + 2];
+  uint8_t  n = 0;
+  bool     key = !_keyed;
+
+  header[n++] = head | (key ? FLEX_TRACE_KEY : 0);
+  header[n++] = address;
+  n += flexPutVarint(&header[n], key ? at : at - _at);
+  n += flexPutVarint(&header[n], count);
+  if (received >= 0)
+  {
+    n += flexPutVarint(&header[n], (uint32_t)received);
+  }
+
+  if ((uint32_t)_length + n + payload > _size)
+  {
+    _dropped++;
+    return false;
+  }
+
+  put(header, n);
+  _at = at;
+  _keyed = true;
+  _records++;
+  return true;
+}
+
+void FlexI2CTrace::put(const uint8_t *data, uint8_t count)
+{
+  for (uint8_t i = 0; i < count; i++)
+  {
+    _buffer[_length++] = data[i];
+  }
+}
+
+void FlexI2CTrace::recordWrite(uint32_t at, uint8_t address, int16_t reg, const uint8_t *data, uint8_t count,
+                               bool stop, flexResult_t result)
+{
+  uint8_t total = count + ((reg >= 0) ? 1 : 0);
+  uint8_t head = (stop ? FLEX_TRACE_STOP : 0) | ((uint8_t)result & FLEX_TRACE_RESULT);
+
+  if (!begin(head, address, at, total, -1, total))
+  {
+    return;
+  }
+  if (reg >= 0)
+  {
+    _buffer[_length++] = (uint8_t)reg;
+  }
+  put(data, count);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Records a read; the bytes are only kept for a FLEX_OK read,
+            the driver drops the others anyway
+*/
+/**************************************************************************/
+void FlexI2CTrace::recordRead(uint32_t at, uint8_t address, uint8_t requested, const uint8_t *data, uint8_t received,
+                              bool stop, flexResult_t result)
+{
+  uint8_t head = FLEX_TRACE_READ | (stop ? FLEX_TRACE_STOP : 0) | ((uint8_t)result & FLEX_TRACE_RESULT);
+  uint8_t payload = (result == FLEX_OK) ? received : 0;
+
+  if (begin(head, address, at, requested, received, payload))
+  {
+    put(data, payload);
+  }
+}
+
+const uint8_t *FlexI2CTrace::data(void)
+{
+  return _buffer;
+}
+
+uint16_t FlexI2CTrace::length(void)
+{
+  return _length;
+}
+
+uint16_t FlexI2CTrace::size(void)
+{
+  return _size;
+}
+
+uint32_t FlexI2CTrace::records(void)
+{
+  return _records;
+}
+
+uint32_t FlexI2CTrace::dropped(void)
+{
+  return _dropped;
+}
+
+void FlexI2CTrace::clear(void)
+{
+  _length = 0;
+}
+
+void FlexI2CTrace::reset(void)
+{
+  _length = 0;
+  _at = 0;
+  _keyed = false;
+  _records = 0;
+  _dropped = 0;
+}
+
+/***************************************************************************
+ READER
+ ***************************************************************************/
+
+FlexI2CTraceReader::FlexI2CTraceReader(void)
+{
+  reset();
+}
+
+void FlexI2CTraceReader::reset(void)
+{
+  _at = 0;
+  _keyed = false;
+}
+
+int16_t FlexI2CTraceReader::decode(const uint8_t *data, uint16_t length, flexTraceRecord_t *record)
+{
+  uint16_t n = 2;
+  uint32_t raw;
+  int8_t   used;
+
+  if (length < 2)
+  {
+    return 0;
+  }
+
+  uint8_t head = data[0];
+  record->key      = (head & FLEX_TRACE_KEY) != 0;
+  record->read     = (head & FLEX_TRACE_READ) != 0;
+  record->stop     = (head & FLEX_TRACE_STOP) != 0;
+  record->result   = (flexResult_t)(head & FLEX_TRACE_RESULT);
+  record->address  = data[1];
+  if (!record->key && !_keyed)
+  {
+    return -1;
+  }
+
+  used = flexGetVarint(&data[n], length - n, &raw);
+  if (used <= 0)
+  {
+    return used;
+  }
+  n += used;
+  uint32_t at = record->key ? raw : _at + raw;
+
+  used = flexGetVarint(&data[n], length - n, &raw);
+  if (used <= 0)
+  {
+    return used;
+  }
+  if (raw > 0xFF)
+  {
+    return -1;
+  }
+  n += used;
+  record->count = (uint8_t)raw;
+  record->received = 0;
+  record->length = record->count;
+
+  if (record->read)
+  {
+    used = flexGetVarint(&data[n], length - n, &raw);
+    if (used <= 0)
+    {
+      return used;
+    }
+    if (raw > record->count)
+    {
+      return -1;
+    }
+    n += used;
+    record->received = (uint8_t)raw;
+    record->length = (record->result == FLEX_OK) ? record->received : 0;
+  }
+
+  if (n + record->length > length)
+  {
+    return 0;
+  }
+  record->data = &data[n];
+  record->at = at;
+  n += record->length;
+
+  _at = at;
+  _keyed = true;
+  return (int16_t)n;
+}
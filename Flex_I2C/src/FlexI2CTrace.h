@@ -0,0 +1,127 @@
+/**************************************************************************/
+/*!
+    @file     FlexI2CTrace.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Compact capture of the I2C traffic of every Flex driver.
+
+    All drivers do their bus I/O through FlexI2CDevice, so that is where
+    the traffic is tapped (the TwoWire calls of the Arduino cores are
+    not virtual, a wrapper bus would never see them):
+
+      uint8_t traceBuffer[2048];
+      FlexI2CTrace trace(traceBuffer, sizeof(traceBuffer));
+      FlexI2CDevice::setTrace(&trace);     // every device, every bus
+
+    Each transaction (one address phase) becomes one record with its
+    micros() start time, the address, direction, STOP or repeated START,
+    the flexResult_t and the bytes on the wire:
+
+      head     1 byte   bit 7     key record (absolute time)
+                        bit 6     read
+                        bit 5     STOP (0: repeated START follows)
+                        bits 2..0 flexResult_t
+      address  1 byte   7 bit address
+      time     varint   key: micros(), else micros() - previous record
+      count    varint   bytes written, or bytes requested
+      received varint   reads only: bytes the device supplied
+      data     count written bytes, or received bytes of a FLEX_OK read
+
+    A register read (pointer write, repeated START, 6 byte read) takes
+    some 16 bytes. The recorder only fills the buffer; the sketch moves
+    length() bytes to Serial or an SD card and calls clear(). Records
+    that do not fit are counted in dropped(), the ones after them still
+    decode. FlexI2CTraceReader is plain C++; host/flextrace_dump prints a
+    trace and host/sim/FlexSimReplay serves one back to the unmodified
+    drivers on Linux.
+
+    Define FLEX_I2C_TRACE as 0 to compile the tap out of FlexI2CDevice.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_I2C_TRACE_H
+#define _FLEX_I2C_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FlexResult.h"
+
+#ifndef FLEX_I2C_TRACE
+  #define FLEX_I2C_TRACE  1
+#endif
+
+#define FLEX_TRACE_KEY          0x80
+#define FLEX_TRACE_READ         0x40
+#define FLEX_TRACE_STOP         0x20
+#define FLEX_TRACE_RESULT       0x07
+
+/* Longest record: head, address, time, count, received and 255 bytes */
+#define FLEX_TRACE_RECORD_MAX   (1 + 1 + 5 + 2 + 2 + 255)
+
+typedef struct
+{
+  uint32_t      at;         // micros() when the transaction started
+  uint8_t       address;
+  bool          read;
+  bool          stop;
+  bool          key;
+  flexResult_t  result;
+  uint8_t       count;      // bytes written, or bytes requested
+  uint8_t       received;   // reads: bytes supplied by the device
+  const uint8_t *data;      // into the decoded buffer; count written or received read bytes
+  uint8_t       length;     // bytes at data
+} flexTraceRecord_t;
+
+class FlexI2CTrace
+{
+ public:
+  FlexI2CTrace(uint8_t *buffer, uint16_t size);
+
+  /* Called by FlexI2CDevice. reg >= 0 is sent in front of data */
+  void     recordWrite(uint32_t at, uint8_t address, int16_t reg, const uint8_t *data, uint8_t count,
+                       bool stop, flexResult_t result);
+  void     recordRead(uint32_t at, uint8_t address, uint8_t requested, const uint8_t *data, uint8_t received,
+                      bool stop, flexResult_t result);
+
+  const uint8_t *data(void);
+  uint16_t length(void);
+  uint16_t size(void);
+  uint32_t records(void);                    // stored since construction / reset()
+  uint32_t dropped(void);                    // did not fit
+  void     clear(void);                      // empties the buffer, time base continues
+  void     reset(void);                      // and the next record is a key record
+
+ private:
+  bool     begin(uint8_t head, uint8_t address, uint32_t at, uint8_t count, int16_t received, uint16_t payload);
+  void     put(const uint8_t *data, uint8_t count);
+
+  uint8_t  *_buffer;
+  uint16_t _size;
+  uint16_t _length;
+  uint32_t _at;                              // time of the last stored record
+  bool     _keyed;                           // a key record was stored since reset()
+  uint32_t _records;
+  uint32_t _dropped;
+};
+
+class FlexI2CTraceReader
+{
+ public:
+  FlexI2CTraceReader(void);
+
+  /* Decodes the record at the start of data. Returns the bytes used,
+     0 when length does not hold a whole record yet, -1 for a record
+     without a key record before it, or a malformed one */
+  int16_t  decode(const uint8_t *data, uint16_t length, flexTraceRecord_t *record);
+
+  void     reset(void);
+
+ private:
+  uint32_t _at;
+  bool     _keyed;
+};
+
+#endif
@@ -0,0 +1,119 @@
+/**************************************************************************/
+/*!
+    @file     FlexI2CTransport.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Asynchronous register transfers for the Flex drivers.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include "FlexI2CTransport.h"
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Burst read of count registers starting at reg into dest
+*/
+/**************************************************************************/
+bool FlexI2CTransport::read(flexI2CTransfer_t *transfer, uint8_t address, uint8_t reg,
+                            uint8_t *dest, uint8_t count,
+                            flexTransferCallback_t callback, void *context)
+{
+  transfer->address = address;
+  transfer->reg = reg;
+  transfer->op = FLEX_TRANSFER_READ;
+  transfer->count = count;
+  transfer->data = dest;
+  transfer->callback = callback;
+  transfer->context = context;
+  return submit(transfer);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Burst write of count registers starting at reg. src is not
+            copied and must stay valid until the transfer is done.
+*/
+/**************************************************************************/
+bool FlexI2CTransport::write(flexI2CTransfer_t *transfer, uint8_t address, uint8_t reg,
+                             const uint8_t *src, uint8_t count,
+                             flexTransferCallback_t callback, void *context)
+{
+  transfer->address = address;
+  transfer->reg = reg;
+  transfer->op = FLEX_TRANSFER_WRITE;
+  transfer->count = count;
+  transfer->data = (uint8_t *)src;
+  transfer->callback = callback;
+  transfer->context = context;
+  return submit(transfer);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read of count bytes without a register pointer write, from
+            wherever the device's pointer was left: one transaction
+            instead of two for devices read over and over at the same
+            register
+*/
+/**************************************************************************/
+bool FlexI2CTransport::receive(flexI2CTransfer_t *transfer, uint8_t address,
+                               uint8_t *dest, uint8_t count,
+                               flexTransferCallback_t callback, void *context)
+{
+  transfer->address = address;
+  transfer->reg = 0;
+  transfer->op = FLEX_TRANSFER_RECEIVE;
+  transfer->count = count;
+  transfer->data = dest;
+  transfer->callback = callback;
+  transfer->context = context;
+  return submit(transfer);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Waits for a submitted transfer. Returns its result, or
+            FLEX_ERR_TIMEOUT when it did not complete in time (it is then
+            still owned by the transport).
+*/
+/**************************************************************************/
+flexResult_t FlexI2CTransport::wait(flexI2CTransfer_t *transfer, uint32_t timeoutUs)
+{
+  uint32_t startedAt = micros();
+
+  while (!transfer->done)
+  {
+    if ((uint32_t)(micros() - startedAt) >= timeoutUs)
+    {
+      return FLEX_ERR_TIMEOUT;
+    }
+    service();
+  }
+  return transfer->result;
+}
+
+/***************************************************************************
+ PROTECTED FUNCTIONS
+ ***************************************************************************/
+
+void FlexI2CTransport::complete(flexI2CTransfer_t *transfer, flexResult_t result)
+{
+  transfer->result = result;
+  transfer->done = true;
+  if (transfer->callback != NULL)
+  {
+    transfer->callback(transfer);
+  }
+}
@@ -0,0 +1,110 @@
+/**************************************************************************/
+/*!
+    @file     FlexI2CTransport.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Asynchronous register transfers for the Flex drivers.
+
+    TwoWire::endTransmission() and requestFrom() keep the CPU busy for
+    the whole transfer: a 13 byte FXOS8700 burst is ~350 us at 400 kHz
+    in which nothing else runs. A FlexI2CTransport takes a transfer
+    descriptor, returns right away and completes the transfer in the
+    background: done and result are set and the optional callback is
+    called, possibly from interrupt context, so keep callbacks short.
+
+    Backends:
+    FlexWireTransport  - any TwoWire; completes every transfer inside
+                         submit(), so it works everywhere but gains no
+                         overlap (the reference / fallback backend);
+                         blocking(), so keep it out of interrupts
+    FlexSimTransport   - host simulator (host/sim), completes transfers
+                         on the simulated timeline after their bus time
+
+    A SERCOM interrupt or DMA backend implements the same interface.
+
+    Usage:
+    FlexWireTransport transport(&myWire);
+    flexI2CTransfer_t xfer;
+    uint8_t frame[13];
+
+    transport.read(&xfer, 0x1F, 0x00, frame, 13);
+    while (!xfer.done) { filter.update(); transport.service(); }
+    if (xfer.result == FLEX_OK) ...
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_I2C_TRANSPORT_H
+#define _FLEX_I2C_TRANSPORT_H
+
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include "FlexResult.h"
+
+typedef enum
+{
+  FLEX_TRANSFER_WRITE   = 0,  // register pointer + data, STOP
+  FLEX_TRANSFER_READ    = 1,  // register pointer, repeated START, data, STOP
+  FLEX_TRANSFER_RECEIVE = 2   // data from the current pointer, STOP (reg unused)
+} flexTransferOp_t;
+
+typedef struct flexI2CTransfer_s flexI2CTransfer_t;
+
+/* Called once the transfer has completed, possibly in interrupt context */
+typedef void (*flexTransferCallback_t)(flexI2CTransfer_t *transfer);
+
+struct flexI2CTransfer_s
+{
+  uint8_t                address;
+  uint8_t                reg;
+  uint8_t                op;        // flexTransferOp_t
+  uint8_t                count;
+  uint8_t               *data;      // source or destination, valid until done
+  flexTransferCallback_t callback;
+  void                  *context;   // for the callback
+  volatile bool          done;
+  volatile flexResult_t  result;
+  flexI2CTransfer_t     *next;      // queue link, owned by the transport
+};
+
+class FlexI2CTransport
+{
+ public:
+  /* Queues the transfer, false if it is still in flight or invalid */
+  virtual bool  submit(flexI2CTransfer_t *transfer) = 0;
+
+  /* Nothing queued or on the wire */
+  virtual bool  idle(void) = 0;
+
+  /* Progress for backends without interrupts, call from loop() */
+  virtual void  service(void) { }
+
+  /* Completes every transfer inside submit(): not for use from an ISR */
+  virtual bool  blocking(void) { return false; }
+
+  /* Fill in a transfer and submit it */
+  bool          read(flexI2CTransfer_t *transfer, uint8_t address, uint8_t reg,
+                     uint8_t *dest, uint8_t count,
+                     flexTransferCallback_t callback = NULL, void *context = NULL);
+  bool          write(flexI2CTransfer_t *transfer, uint8_t address, uint8_t reg,
+                      const uint8_t *src, uint8_t count,
+                      flexTransferCallback_t callback = NULL, void *context = NULL);
+  bool          receive(flexI2CTransfer_t *transfer, uint8_t address,
+                        uint8_t *dest, uint8_t count,
+                        flexTransferCallback_t callback = NULL, void *context = NULL);
+
+  /* Blocks (calling service()) until the transfer is done or timeoutUs passed */
+  flexResult_t  wait(flexI2CTransfer_t *transfer, uint32_t timeoutUs);
+
+ protected:
+  /* For the backends: marks the transfer done and runs its callback */
+  void          complete(flexI2CTransfer_t *transfer, flexResult_t result);
+};
+
+#endif
@@ -0,0 +1,209 @@
+/**************************************************************************/
+/*!
+    @file     FlexLog.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Compact binary sample log (see FlexLog.h for the record layout).
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexLog.h"
+
+uint8_t flexPutVarint(uint8_t *out, uint32_t value)
+{
+  uint8_t n = 0;
+  while (value >= 0x80)
+  {
+    out[n++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+int8_t flexGetVarint(const uint8_t *in, uint16_t length, uint32_t *value)
+{
+  uint32_t result = 0;
+  for (uint8_t n = 0; n < 5; n++)
+  {
+    if (n >= length)
+    {
+      return 0;
+    }
+    result |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+    if (!(in[n] & 0x80))
+    {
+      *value = result;
+      return n + 1;
+    }
+  }
+  return -1;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates an encoder; every stream starts with a key record
+    @param  keyInterval delta records between key records, 0 for none
+*/
+/**************************************************************************/
+FlexLogEncoder::FlexLogEncoder(uint8_t keyInterval)
+{
+  _keyInterval = keyInterval;
+  reset();
+}
+
+void FlexLogEncoder::setKeyInterval(uint8_t records)
+{
+  _keyInterval = records;
+}
+
+void FlexLogEncoder::reset(void)
+{
+  for (uint8_t i = 0; i < FLEX_LOG_STREAMS; i++)
+  {
+    _streams[i].count = 0;
+    _streams[i].sinceKey = 0;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Encodes one sample of sensor id
+    @param  id sensor id, below FLEX_LOG_STREAMS
+    @param  at micros() of the sample (e.g. sampleMicros())
+    @param  values raw values
+    @param  count number of values, 1 .. FLEX_LOG_VALUES
+    @param  record FLEX_LOG_RECORD_MAX bytes for the encoded record
+    @return record length in bytes, 0 if id or count is out of range
+*/
+/**************************************************************************/
+uint8_t FlexLogEncoder::encode(uint8_t id, uint32_t at, const int32_t *values, uint8_t count, uint8_t *record)
+{
+  if ((id >= FLEX_LOG_STREAMS) || (count == 0) || (count > FLEX_LOG_VALUES))
+  {
+    return 0;
+  }
+
+  flexLogStream_t *stream = &_streams[id];
+  bool key = (stream->count != count) ||
+             ((_keyInterval > 0) && (stream->sinceKey >= _keyInterval));
+
+  uint8_t n = 0;
+  record[n++] = (key ? FLEX_LOG_KEY : 0) | ((count - 1) << 4) | id;
+  n += flexPutVarint(&record[n], key ? at : at - stream->at);
+  for (uint8_t i = 0; i < count; i++)
+  {
+    int32_t value = key ? values[i] : (int32_t)((uint32_t)values[i] - (uint32_t)stream->values[i]);
+    n += flexPutVarint(&record[n], zigzag(value));
+    stream->values[i] = values[i];
+  }
+
+  stream->at = at;
+  stream->count = count;
+  stream->sinceKey = key ? 0 : stream->sinceKey + 1;
+  return n;
+}
+
+uint8_t FlexLogEncoder::encode(uint8_t id, uint32_t at, const int16_t *values, uint8_t count, uint8_t *record)
+{
+  int32_t wide[FLEX_LOG_VALUES];
+  if (count > FLEX_LOG_VALUES)
+  {
+    return 0;
+  }
+  for (uint8_t i = 0; i < count; i++)
+  {
+    wide[i] = values[i];
+  }
+  return encode(id, at, wide, count, record);
+}
+
+FlexLogDecoder::FlexLogDecoder(void)
+{
+  reset();
+}
+
+void FlexLogDecoder::reset(void)
+{
+  for (uint8_t i = 0; i < FLEX_LOG_MAX_IDS; i++)
+  {
+    _count[i] = 0;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes the record at the start of data
+    @param  data encoded bytes
+    @param  length bytes available at data
+    @param  record the decoded record (absolute time and values)
+    @return bytes used, 0 if the record is not complete yet, -1 if it
+            cannot be decoded
+*/
+/**************************************************************************/
+int16_t FlexLogDecoder::decode(const uint8_t *data, uint16_t length, flexLogRecord_t *record)
+{
+  if (length == 0)
+  {
+    return 0;
+  }
+
+  uint8_t head = data[0];
+  uint8_t id = head & 0x0F;
+  uint8_t count = ((head >> 4) & 0x07) + 1;
+  bool key = head & FLEX_LOG_KEY;
+
+  if (!key && (_count[id] != count))
+  {
+    return -1;
+  }
+
+  /* Decode into the record first, so an incomplete record leaves the
+     stream history untouched */
+  uint16_t n = 1;
+  uint32_t raw;
+  int8_t used = flexGetVarint(&data[n], length - n, &raw);
+  if (used <= 0)
+  {
+    return used;
+  }
+  n += used;
+  record->at = key ? raw : _at[id] + raw;
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    used = flexGetVarint(&data[n], length - n, &raw);
+    if (used <= 0)
+    {
+      return used;
+    }
+    n += used;
+    int32_t value = unzigzag(raw);
+    record->values[i] = key ? value : (int32_t)((uint32_t)_values[id][i] + (uint32_t)value);
+  }
+
+  record->id = id;
+  record->count = count;
+  record->key = key;
+
+  _at[id] = record->at;
+  _count[id] = count;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    _values[id][i] = record->values[i];
+  }
+  return n;
+}
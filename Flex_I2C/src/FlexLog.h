@@ -0,0 +1,130 @@
+/**************************************************************************/
+/*!
+    @file     FlexLog.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Compact binary sample log.
+
+    Building a text line per sample with String costs heap (and
+    fragments it) and sends some 60 bytes of ASCII for a battery
+    snapshot. A FlexLog record carries the same raw values in a few
+    bytes: the sensor id, the time since the previous sample of that
+    sensor and the change of every raw value, all as varints.
+
+    Record layout:
+
+      head     1 byte   bit 7     key record
+                        bits 6..4 number of values - 1 (1..8)
+                        bits 3..0 sensor id (0..15)
+      time     varint   key: micros(), delta: micros() - previous
+      values   varint   per value, zigzag coded;
+                        key: the value, delta: value - previous
+
+    Varints are 7 bits per byte, least significant group first, bit 7
+    set on every byte but the last. Zigzag maps 0, -1, 1, -2, ... to
+    0, 1, 2, 3, ... so small changes of either sign stay one byte.
+
+    Every stream starts with a key record, and the encoder writes one
+    again every keyInterval records (and when the number of values
+    changes), so a decoder that starts on a fresh file or after reset()
+    needs no history. The encoder only fills the caller's buffer; the
+    sketch writes it to Serial, an SD file or a radio. The decoder is
+    plain C++ and is used by host/flexlog_decode on Linux.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_LOG_H
+#define _FLEX_LOG_H
+
+#include <stdint.h>
+
+/* Sensor ids (0 .. FLEX_LOG_STREAMS - 1) the encoder keeps history for */
+#ifndef FLEX_LOG_STREAMS
+#define FLEX_LOG_STREAMS        6
+#endif
+
+/* Values per record the encoder accepts (at most 8) */
+#ifndef FLEX_LOG_VALUES
+#define FLEX_LOG_VALUES         8
+#endif
+
+/* Default records between key records, per stream */
+#ifndef FLEX_LOG_KEY_INTERVAL
+#define FLEX_LOG_KEY_INTERVAL   64
+#endif
+
+#define FLEX_LOG_KEY            0x80
+#define FLEX_LOG_MAX_IDS        16
+#define FLEX_LOG_MAX_VALUES     8
+
+#if (FLEX_LOG_STREAMS > FLEX_LOG_MAX_IDS) || (FLEX_LOG_VALUES > FLEX_LOG_MAX_VALUES)
+  #error "FLEX_LOG_STREAMS is limited to 16 and FLEX_LOG_VALUES to 8"
+#endif
+
+/* Worst case record size for the encoder's limits */
+#define FLEX_LOG_RECORD_MAX     (1 + 5 + 5 * FLEX_LOG_VALUES)
+
+typedef struct
+{
+  uint32_t at;                          // micros() of the last record
+  int32_t  values[FLEX_LOG_VALUES];     // raw values of the last record
+  uint8_t  count;                       // 0: next record is a key record
+  uint8_t  sinceKey;                    // delta records since the last key
+} flexLogStream_t;
+
+typedef struct
+{
+  uint8_t  id;
+  uint8_t  count;
+  bool     key;
+  uint32_t at;
+  int32_t  values[FLEX_LOG_MAX_VALUES];
+} flexLogRecord_t;
+
+/* Varints as used by the records (also by FlexI2CTrace): out needs room
+   for 5 bytes, returns the bytes written. flexGetVarint returns the bytes
+   used, 0 when the varint runs past length, -1 when it is longer than 5
+   bytes. */
+uint8_t flexPutVarint(uint8_t *out, uint32_t value);
+int8_t  flexGetVarint(const uint8_t *in, uint16_t length, uint32_t *value);
+
+class FlexLogEncoder
+{
+ public:
+  FlexLogEncoder(uint8_t keyInterval = FLEX_LOG_KEY_INTERVAL);
+
+  /* Encodes one sample into record (FLEX_LOG_RECORD_MAX bytes); returns
+     its length, 0 for an id or count out of range */
+  uint8_t encode(uint8_t id, uint32_t at, const int32_t *values, uint8_t count, uint8_t *record);
+  uint8_t encode(uint8_t id, uint32_t at, const int16_t *values, uint8_t count, uint8_t *record);
+
+  void    setKeyInterval(uint8_t records);   // 0: only the first record
+  void    reset(void);                       // next record of every id is a key
+
+ private:
+  flexLogStream_t _streams[FLEX_LOG_STREAMS];
+  uint8_t         _keyInterval;
+};
+
+class FlexLogDecoder
+{
+ public:
+  FlexLogDecoder(void);
+
+  /* Decodes the record at the start of data. Returns the bytes used,
+     0 when length does not hold a whole record yet, -1 for a delta
+     record without a key record for its id, or a malformed varint */
+  int16_t decode(const uint8_t *data, uint16_t length, flexLogRecord_t *record);
+
+  void    reset(void);
+
+ private:
+  uint32_t _at[FLEX_LOG_MAX_IDS];
+  int32_t  _values[FLEX_LOG_MAX_IDS][FLEX_LOG_MAX_VALUES];
+  uint8_t  _count[FLEX_LOG_MAX_IDS];    // 0: no key record seen yet
+};
+
+#endif
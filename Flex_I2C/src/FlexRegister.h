@@ -0,0 +1,153 @@
+/**************************************************************************/
+/*!
+    @file     FlexRegister.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Compile-time register map descriptors.
+
+    Drivers used to spell their register layout out by hand: a #define
+    per address and shifts and masks at every use (sampleRate <<= 3,
+    tempSetting &= B11000111). Here a register is a type and a bitfield
+    is a type on top of it, so the shifts and masks are computed by the
+    compiler and a field can only be written into its own register.
+
+      typedef FlexReg<0x26>                MPL_CTRL_REG1;
+      typedef FlexField<MPL_CTRL_REG1, 3, 3> MPL_CTRL1_OS;   // bits 5..3
+      typedef FlexField<MPL_CTRL_REG1, 7>    MPL_CTRL1_ALT;  // bit 7
+
+    set() gives a FlexBits value (mask + bits) for one register, and |
+    merges values of the same register into one (values of different
+    registers do not compile). FlexI2CDevice::update() then turns any
+    number of field changes into at most one write, using the shadow
+    cache for the other bits, and none at all when nothing changes:
+
+      dev.update(MPL_CTRL1_OS::set(7) | MPL_CTRL1_ALT::set(0));
+
+    Registers also carry their size in bytes, so a list of registers
+    tells at compile time which of them sit next to each other.
+    FlexI2CDevice::readBlock() / writeBlock() issue one auto-increment
+    burst per contiguous run:
+
+      typedef FlexReg<0x01, 3> MPL_OUT_P;  // OUT_P_MSB .. OUT_P_LSB
+      typedef FlexReg<0x04, 2> MPL_OUT_T;  // OUT_T_MSB .. OUT_T_LSB
+      dev.readBlock<MPL_OUT_P, MPL_OUT_T>(data);  // one 5 byte burst
+
+    16 bit registers (SIZE 2) are updated MSB first. Only use blocks
+    for register files that auto-increment byte by byte; pointer
+    addressed chips like the ADS1x15 take one register per transfer.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_REGISTER_H
+#define _FLEX_REGISTER_H
+
+#include <stdint.h>
+
+/* A register at ADDR that is SIZE bytes wide. Fields and update() take
+   1 or 2 byte registers, blocks also wider ones (e.g. a 24 bit output) */
+template<uint8_t ADDR, uint8_t SIZE = 1>
+struct FlexReg
+{
+  static_assert(SIZE >= 1, "FlexReg: SIZE is at least 1 byte");
+
+  static constexpr uint8_t  address(void) { return ADDR; }
+  static constexpr uint8_t  size(void)    { return SIZE; }
+  static constexpr uint16_t all(void)     { return (SIZE == 2) ? 0xFFFF : 0xFF; }
+};
+
+/* New content for some bits of register REG */
+template<class REG>
+struct FlexBits
+{
+  uint16_t mask;    // bits that are written
+  uint16_t bits;    // their new value, zero outside mask
+
+  constexpr FlexBits(uint16_t m, uint16_t b) : mask(m), bits(b & m) { }
+
+  constexpr FlexBits operator|(FlexBits other) const
+  {
+    return FlexBits(mask | other.mask, bits | other.bits);
+  }
+
+  /* Register value with these bits changed */
+  constexpr uint16_t apply(uint16_t current) const
+  {
+    return (current & ~mask & REG::all()) | bits;
+  }
+};
+
+/* WIDTH bits of register REG starting at bit SHIFT */
+template<class REG, uint8_t SHIFT, uint8_t WIDTH = 1>
+struct FlexField
+{
+  static_assert(REG::size() <= 2, "FlexField: fields are for 8 and 16 bit registers");
+  static_assert(SHIFT + WIDTH <= 8 * REG::size(), "FlexField: field does not fit its register");
+
+  typedef REG reg;
+
+  static constexpr uint16_t mask(void) { return (uint16_t)(((1UL << WIDTH) - 1) << SHIFT); }
+  static constexpr uint16_t limit(void) { return (uint16_t)((1UL << WIDTH) - 1); }
+
+  /* Field value positioned in its register, out of range values are cut */
+  static constexpr FlexBits<REG> set(uint16_t value)
+  {
+    return FlexBits<REG>(mask(), (uint16_t)(value << SHIFT));
+  }
+
+  /* Field value from a register value */
+  static constexpr uint16_t get(uint16_t current)
+  {
+    return (current & mask()) >> SHIFT;
+  }
+};
+
+/* True when B follows A in the register file */
+template<class A, class B>
+constexpr bool flexAdjacent(void)
+{
+  return B::address() == A::address() + A::size();
+}
+
+/* True when every register follows the one before it */
+template<class A>
+constexpr bool flexContiguous(void)
+{
+  return true;
+}
+
+template<class A, class B, class... REST>
+constexpr bool flexContiguous(void)
+{
+  return flexAdjacent<A, B>() && flexContiguous<B, REST...>();
+}
+
+/* Total bytes of a list of registers */
+template<class A>
+constexpr uint8_t flexBlockBytes(void)
+{
+  return A::size();
+}
+
+template<class A, class B, class... REST>
+constexpr uint8_t flexBlockBytes(void)
+{
+  return A::size() + flexBlockBytes<B, REST...>();
+}
+
+/* Bursts needed for a list of registers: one per contiguous run */
+template<class A>
+constexpr uint8_t flexBlockBursts(void)
+{
+  return 1;
+}
+
+template<class A, class B, class... REST>
+constexpr uint8_t flexBlockBursts(void)
+{
+  return (flexAdjacent<A, B>() ? 0 : 1) + flexBlockBursts<B, REST...>();
+}
+
+#endif
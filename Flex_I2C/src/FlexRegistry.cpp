@@ -0,0 +1,243 @@
+/**************************************************************************/
+/*!
+    @file     FlexRegistry.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Finds the Flex sensors on all buses and creates their drivers.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include "FlexRegistry.h"
+
+/* Every known address and the chip expected there, in scan order */
+static const struct
+{
+  uint8_t    address;
+  flexChip_t chip;
+} candidates[] =
+{
+  { 0x1F, FLEX_CHIP_FXOS8700 },
+  { 0x21, FLEX_CHIP_FXAS21002C },
+  { 0x40, FLEX_CHIP_HTU21DF },
+  { 0x48, FLEX_CHIP_ADS1X15 },
+  { 0x49, FLEX_CHIP_ADS1X15 },
+  { 0x4A, FLEX_CHIP_ADS1X15 },
+  { 0x4B, FLEX_CHIP_ADS1X15 },
+  { 0x55, FLEX_CHIP_BQ27441 },
+  { 0x60, FLEX_CHIP_MPL3115A2 }
+};
+
+#define CANDIDATES   (sizeof(candidates) / sizeof(candidates[0]))
+
+const char *flexChipName(flexChip_t chip)
+{
+  switch (chip)
+  {
+    case FLEX_CHIP_FXOS8700:   return "FXOS8700";
+    case FLEX_CHIP_FXAS21002C: return "FXAS21002C";
+    case FLEX_CHIP_HTU21DF:    return "HTU21DF";
+    case FLEX_CHIP_ADS1X15:    return "ADS1X15";
+    case FLEX_CHIP_BQ27441:    return "BQ27441";
+    case FLEX_CHIP_MPL3115A2:  return "MPL3115A2";
+    default:                   return "none";
+  }
+}
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+FlexRegistry::FlexRegistry(void)
+{
+  _busCount = 0;
+  _count = 0;
+  _scanMicros = 0;
+  memset(_factories, 0, sizeof(_factories));
+  memset(&_scanStats, 0, sizeof(_scanStats));
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Adds a bus to scan, false if the table is full
+*/
+/**************************************************************************/
+bool FlexRegistry::addBus(TwoWire *bus)
+{
+  if (_busCount >= FLEX_REGISTRY_BUSES)
+  {
+    return false;
+  }
+  _buses[_busCount++] = bus;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets the function that creates the driver for a chip, NULL
+            only identifies it
+*/
+/**************************************************************************/
+void FlexRegistry::setFactory(flexChip_t chip, flexDriverFactory_t factory)
+{
+  if ((chip > FLEX_CHIP_NONE) && (chip < FLEX_CHIP_COUNT))
+  {
+    _factories[chip] = factory;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Identifies the chips on every bus in one pass, then creates
+            and begins their drivers. Returns the number of chips found.
+            Call once at boot: the drivers of an earlier scan stay alive
+            but are no longer listed.
+*/
+/**************************************************************************/
+uint8_t FlexRegistry::scan(void)
+{
+  _count = 0;
+  memset(&_scanStats, 0, sizeof(_scanStats));
+  uint32_t startedAt = micros();
+
+  for (uint8_t i = 0; i < CANDIDATES; i++)
+  {
+    for (uint8_t b = 0; b < _busCount; b++)
+    {
+      FlexI2CDevice dev(_buses[b], candidates[i].address);
+      flexChip_t chip = identify(&dev, candidates[i].chip);
+
+#if FLEX_I2C_STATS
+      flexI2CStats_t s = dev.stats();
+      _scanStats.transactions += s.transactions;
+      _scanStats.bytesWritten += s.bytesWritten;
+      _scanStats.bytesRead += s.bytesRead;
+      _scanStats.nacks += s.nacks;
+#endif
+
+      if ((chip != FLEX_CHIP_NONE) && (_count < FLEX_REGISTRY_DEVICES))
+      {
+        flexFound_t *found = &_found[_count++];
+        found->bus = _buses[b];
+        found->address = candidates[i].address;
+        found->chip = chip;
+        found->sensor = NULL;
+      }
+    }
+  }
+  _scanMicros = micros() - startedAt;
+
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    flexDriverFactory_t factory = _factories[_found[i].chip];
+    if (factory != NULL)
+    {
+      _found[i].sensor = factory(_found[i].bus, _found[i].address);
+    }
+  }
+  return _count;
+}
+
+uint8_t FlexRegistry::count(void)
+{
+  return _count;
+}
+
+flexFound_t FlexRegistry::device(uint8_t index)
+{
+  flexFound_t none = { NULL, 0, FLEX_CHIP_NONE, NULL };
+  return (index < _count) ? _found[index] : none;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Driver of the first chip of a kind (on a given bus), NULL if
+            there is none
+*/
+/**************************************************************************/
+FlexAsyncSensor *FlexRegistry::find(flexChip_t chip, TwoWire *bus)
+{
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if ((_found[i].chip == chip) && ((bus == NULL) || (_found[i].bus == bus)))
+    {
+      return _found[i].sensor;
+    }
+  }
+  return NULL;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Bus counters and time of the identification pass of the last
+            scan() (driver begin() calls not included)
+*/
+/**************************************************************************/
+flexI2CStats_t FlexRegistry::scanStats(void)
+{
+  return _scanStats;
+}
+
+uint32_t FlexRegistry::scanMicros(void)
+{
+  return _scanMicros;
+}
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  One ID read, doubling as the presence probe: an empty bus
+            position fails on the address phase
+*/
+/**************************************************************************/
+flexChip_t FlexRegistry::identify(FlexI2CDevice *dev, flexChip_t candidate)
+{
+  uint8_t data[2] = { 0, 0 };
+  bool    match = false;
+
+  switch (candidate)
+  {
+    case FLEX_CHIP_FXOS8700:
+      match = dev->readRegisters(0x0D, data, 1) && (data[0] == 0xC7);
+      break;
+    case FLEX_CHIP_FXAS21002C:
+      match = dev->readRegisters(0x0C, data, 1) && (data[0] == 0xD7);
+      break;
+    case FLEX_CHIP_MPL3115A2:
+      match = dev->readRegisters(0x0C, data, 1) && (data[0] == 0xC4);
+      break;
+    case FLEX_CHIP_HTU21DF:
+      /* Read user register, its reserved bits may vary */
+      match = dev->readRegisters(0xE7, data, 1);
+      break;
+    case FLEX_CHIP_ADS1X15:
+      match = dev->readRegisters(0x01, data, 2);
+      break;
+    case FLEX_CHIP_BQ27441:
+    {
+      /* Control(DEVICE_TYPE), little endian subcommand and result */
+      const uint8_t subcommand[2] = { 0x01, 0x00 };
+      match = dev->writeRegisters(0x00, subcommand, 2) &&
+              dev->readRegisters(0x00, data, 2) &&
+              ((((uint16_t)data[1] << 8) | data[0]) == 0x0421);
+      break;
+    }
+    default:
+      break;
+  }
+  return match ? candidate : FLEX_CHIP_NONE;
+}
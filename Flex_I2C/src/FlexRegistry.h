@@ -0,0 +1,119 @@
+/**************************************************************************/
+/*!
+    @file     FlexRegistry.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Finds the Flex sensors on all buses and creates their drivers.
+
+    Replaces the hand written startup (probe one address per bus with an
+    empty write, then begin() every driver that answered). scan() visits
+    every known address on every registered bus in one pass, with the
+    buses interleaved, and identifies the chip with its ID read right
+    away, so an absent device costs a single NACKed address phase and a
+    present one a single register read (BQ27441: one Control() write
+    plus read):
+
+    0x1F FXOS8700     WHO_AM_I 0x0D == 0xC7
+    0x21 FXAS21002C   WHO_AM_I 0x0C == 0xD7
+    0x40 HTU21DF      user register answers
+    0x48-0x4B ADS1X15 config register answers (the chip has no ID)
+    0x55 BQ27441      Control(DEVICE_TYPE) == 0x0421
+    0x60 MPL3115A2    WHO_AM_I 0x0C == 0xC4
+
+    For every identified chip the factory registered for it (e.g.
+    Adafruit_HTU21DF_Flex::create) creates and begins the driver. The
+    factories allocate once at boot and the drivers live for the rest of
+    the run. Flex_I2C does not depend on the driver libraries, so the
+    sketch picks the factories (and ADS1015 or ADS1115).
+
+    Usage:
+    FlexRegistry registry;
+    registry.addBus(&myWire);
+    registry.addBus(&Wire);
+    registry.setFactory(FLEX_CHIP_HTU21DF, Adafruit_HTU21DF_Flex::create);
+    registry.setFactory(FLEX_CHIP_MPL3115A2, MPL3115A2_Flex::create);
+    registry.scan();
+
+    for (uint8_t i = 0; i < registry.count(); i++)
+      scheduler.add(registry.device(i).sensor, registry.device(i).bus, 1.0);
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_REGISTRY_H
+#define _FLEX_REGISTRY_H
+
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include <Wire.h>
+#include "FlexAsyncSensor.h"
+#include "FlexI2CDevice.h"
+
+#ifndef FLEX_REGISTRY_BUSES
+  #define FLEX_REGISTRY_BUSES     4
+#endif
+#ifndef FLEX_REGISTRY_DEVICES
+  #define FLEX_REGISTRY_DEVICES   16
+#endif
+
+typedef enum
+{
+  FLEX_CHIP_NONE       = 0,
+  FLEX_CHIP_FXOS8700   = 1,
+  FLEX_CHIP_FXAS21002C = 2,
+  FLEX_CHIP_HTU21DF    = 3,
+  FLEX_CHIP_ADS1X15    = 4,
+  FLEX_CHIP_BQ27441    = 5,
+  FLEX_CHIP_MPL3115A2  = 6,
+  FLEX_CHIP_COUNT      = 7
+} flexChip_t;
+
+/* Creates and begins a driver, NULL when begin() fails */
+typedef FlexAsyncSensor *(*flexDriverFactory_t)(TwoWire *bus, uint8_t address);
+
+typedef struct
+{
+  TwoWire         *bus;
+  uint8_t          address;
+  flexChip_t       chip;
+  FlexAsyncSensor *sensor;   // NULL without factory or when begin() failed
+} flexFound_t;
+
+const char *flexChipName(flexChip_t chip);
+
+class FlexRegistry
+{
+ public:
+  FlexRegistry(void);
+
+  bool        addBus(TwoWire *bus);
+  void        setFactory(flexChip_t chip, flexDriverFactory_t factory);
+
+  uint8_t     scan(void);                            // chips identified
+
+  uint8_t     count(void);
+  flexFound_t device(uint8_t index);
+  FlexAsyncSensor *find(flexChip_t chip, TwoWire *bus = NULL);
+
+  flexI2CStats_t scanStats(void);                    // identification pass only
+  uint32_t    scanMicros(void);
+
+ private:
+  flexChip_t  identify(FlexI2CDevice *dev, flexChip_t candidate);
+
+  TwoWire            *_buses[FLEX_REGISTRY_BUSES];
+  uint8_t             _busCount;
+  flexDriverFactory_t _factories[FLEX_CHIP_COUNT];
+  flexFound_t         _found[FLEX_REGISTRY_DEVICES];
+  uint8_t             _count;
+  flexI2CStats_t      _scanStats;
+  uint32_t            _scanMicros;
+};
+
+#endif
@@ -0,0 +1,40 @@
+/**************************************************************************/
+/*!
+    @file     FlexResult.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Typed results for Flex bus transactions and driver reads.
+
+    The original drivers reported failures as magic values (-999, 0, a
+    temperature computed from an all zero frame) or not at all. Every
+    FlexI2CDevice transfer now records a flexResult_t (see lastError())
+    and the drivers offer read functions that return one, with the
+    measurement passed back through a pointer:
+
+    float celsius;
+    if (htu.readTemperature(&celsius) == FLEX_OK) { ... }
+    else Serial.println(flexResultString(htu.lastError()));
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_RESULT_H
+#define _FLEX_RESULT_H
+
+typedef enum
+{
+  FLEX_OK             = 0,
+  FLEX_ERR_ADDR_NACK  = 1,  // nobody answered the address
+  FLEX_ERR_DATA_NACK  = 2,  // device NACKed a data byte (or is busy converting)
+  FLEX_ERR_SHORT_READ = 3,  // fewer bytes received than requested
+  FLEX_ERR_BUS        = 4,  // other bus error (arbitration lost, bus fault)
+  FLEX_ERR_TIMEOUT    = 5,  // deadline passed before the device was ready
+  FLEX_ERR_CRC        = 6,  // checksum of the received data does not match
+  FLEX_ERR_ARG        = 7   // invalid argument (channel, length, ...)
+} flexResult_t;
+
+const char *flexResultString(flexResult_t result);
+
+#endif
@@ -0,0 +1,124 @@
+/**************************************************************************/
+/*!
+    @file     FlexRing.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Fixed capacity single producer / single consumer ring buffer.
+
+    Hands samples from an interrupt handler (a data ready, ALERT/RDY or
+    GPOUT pin ISR, or a FlexI2CTransport completion callback) to loop()
+    without locks or allocation. One side may only push(), the other
+    only pop(); each index is written by one side only, so neither has
+    to disable interrupts. When the ring is full push() drops the new
+    item and counts an overrun instead of overwriting what the consumer
+    has not seen yet.
+
+    N must be a power of two (at most 128 on 8 bit AVR, 32768 elsewhere)
+    so the free running indices wrap cleanly.
+
+    Usage:
+    struct alert_t { uint32_t at; };
+    FlexRing<alert_t, 16> alerts;
+
+    void onAlert(void) { alert_t a = { micros() }; alerts.push(a); }
+
+    loop():
+    alert_t a;
+    while (alerts.pop(&a)) { ... }
+    if (alerts.overruns() != reported) { ... }
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_RING_H
+#define _FLEX_RING_H
+
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+/* Loads and stores of the index type must be single instructions */
+#if defined(__AVR__)
+  typedef uint8_t  flexRingIndex_t;
+#else
+  typedef uint16_t flexRingIndex_t;
+#endif
+
+/* Keeps the compiler from moving the item copy past the index update */
+#if defined(__GNUC__)
+  #define FLEX_RING_BARRIER()  __asm__ __volatile__ ("" ::: "memory")
+#else
+  #define FLEX_RING_BARRIER()
+#endif
+
+template <typename T, flexRingIndex_t N>
+class FlexRing
+{
+ public:
+  FlexRing(void) : _head(0), _tail(0), _overruns(0) { }
+
+  /* Producer side: false (and an overrun) when full */
+  bool push(const T &item)
+  {
+    flexRingIndex_t head = _head;
+    if ((flexRingIndex_t)(head - _tail) >= N)
+    {
+      _overruns++;
+      return false;
+    }
+    _items[head & (N - 1)] = item;
+    FLEX_RING_BARRIER();
+    _head = head + 1;
+    return true;
+  }
+
+  /* Consumer side: false when empty */
+  bool pop(T *item)
+  {
+    flexRingIndex_t tail = _tail;
+    if (tail == _head)
+    {
+      return false;
+    }
+    *item = _items[tail & (N - 1)];
+    FLEX_RING_BARRIER();
+    _tail = tail + 1;
+    return true;
+  }
+
+  /* Consumer side: drops everything queued so far */
+  void clear(void)                { _tail = _head; }
+
+  flexRingIndex_t count(void)     { return (flexRingIndex_t)(_head - _tail); }
+  bool            empty(void)     { return _head == _tail; }
+  flexRingIndex_t capacity(void)  { return N; }
+
+  /* Items dropped because the ring was full, never reset */
+  uint32_t overruns(void)
+  {
+#if defined(__AVR__)
+    uint8_t sreg = SREG;          // 32 bit load is not atomic on AVR
+    noInterrupts();
+    uint32_t overruns = _overruns;
+    SREG = sreg;
+    return overruns;
+#else
+    return _overruns;
+#endif
+  }
+
+ private:
+  static_assert((N > 0) && ((N & (N - 1)) == 0), "FlexRing size must be a power of two");
+  static_assert(N <= (flexRingIndex_t)(~(flexRingIndex_t)0) / 2 + 1, "FlexRing size too large for the index type");
+
+  T                         _items[N];
+  volatile flexRingIndex_t  _head;      // written by the producer only
+  volatile flexRingIndex_t  _tail;      // written by the consumer only
+  volatile uint32_t         _overruns;  // written by the producer only
+};
+
+#endif
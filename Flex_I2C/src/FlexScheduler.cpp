@@ -0,0 +1,419 @@
+/**************************************************************************/
+/*!
+    @file     FlexScheduler.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Cooperative scheduler for Flex sensors spread over several buses.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include "FlexScheduler.h"
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+FlexScheduler::FlexScheduler(void)
+{
+  _count = 0;
+  _callback = NULL;
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Registers a sensor on a bus with a target rate in Hz.
+            Returns the index of the sensor or -1 if the table is full.
+*/
+/**************************************************************************/
+int8_t FlexScheduler::add(FlexAsyncSensor *sensor, TwoWire *bus, float rateHz)
+{
+  if ((_count >= FLEX_SCHEDULER_MAX_SENSORS) || (rateHz <= 0))
+  {
+    return -1;
+  }
+
+  entry_t *entry = &_entries[_count];
+  memset(entry, 0, sizeof(entry_t));
+  entry->sensor = sensor;
+  entry->bus = bus;
+  entry->stats.period = (uint32_t)(1000000.0F / rateHz);
+
+  _order[_count] = _count;
+  return _count++;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets a function that is called after every collected sample
+*/
+/**************************************************************************/
+void FlexScheduler::setCallback(flexSampleCallback_t callback)
+{
+  _callback = callback;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Makes every sensor due now and builds the visiting order, with
+            the buses interleaved: first sensor of bus A, first of bus B,
+            second of bus A, ...
+*/
+/**************************************************************************/
+void FlexScheduler::begin(void)
+{
+  bool    placed[FLEX_SCHEDULER_MAX_SENSORS];
+  uint8_t n = 0;
+
+  memset(placed, 0, sizeof(placed));
+  while (n < _count)
+  {
+    /* One pass takes the next unplaced sensor of every bus */
+    TwoWire *seen[FLEX_SCHEDULER_MAX_SENSORS];
+    uint8_t  seenCount = 0;
+
+    for (uint8_t i = 0; i < _count; i++)
+    {
+      if (placed[i])
+      {
+        continue;
+      }
+      bool busTaken = false;
+      for (uint8_t b = 0; b < seenCount; b++)
+      {
+        if (seen[b] == _entries[i].bus)
+        {
+          busTaken = true;
+          break;
+        }
+      }
+      if (!busTaken)
+      {
+        seen[seenCount++] = _entries[i].bus;
+        placed[i] = true;
+        _order[n++] = i;
+      }
+    }
+  }
+
+  uint32_t now = micros();
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (_entries[i].asleep)
+    {
+      wakeEntry(&_entries[i], now);
+    }
+    _entries[i].nextDue = now;
+    _entries[i].inFlight = false;
+    _entries[i].since = now;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  One non-blocking pass over all sensors, call from loop()
+*/
+/**************************************************************************/
+void FlexScheduler::run(void)
+{
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    uint8_t index = _order[i];
+    service(&_entries[index], index, micros());
+  }
+}
+
+uint8_t FlexScheduler::count(void)
+{
+  return _count;
+}
+
+flexSchedulerStats_t FlexScheduler::stats(uint8_t index)
+{
+  return _entries[index].stats;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Achieved sample rate in Hz since begin() / resetStats()
+*/
+/**************************************************************************/
+float FlexScheduler::achievedRate(uint8_t index)
+{
+  flexSchedulerStats_t *s = &_entries[index].stats;
+
+  if ((s->samples < 2) || (s->lastSampleAt == s->firstSampleAt))
+  {
+    return 0;
+  }
+  return (float)(s->samples - 1) * 1000000.0F / (float)(s->lastSampleAt - s->firstSampleAt);
+}
+
+void FlexScheduler::resetStats(void)
+{
+  uint32_t now = micros();
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    uint32_t period = _entries[i].stats.period;
+    memset(&_entries[i].stats, 0, sizeof(flexSchedulerStats_t));
+    _entries[i].stats.period = period;
+    _entries[i].since = now;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Lets the scheduler put a sensor into its low power mode
+            between samples (off by default). A sensor without one
+            (sleep() returns false) simply stays awake.
+*/
+/**************************************************************************/
+bool FlexScheduler::setDutyCycle(uint8_t index, bool enable)
+{
+  if (index >= _count)
+  {
+    return false;
+  }
+  entry_t *entry = &_entries[index];
+  if (!enable && entry->asleep)
+  {
+    wakeEntry(entry, micros());
+  }
+  entry->dutyCycle = enable;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Estimated energy per collected sample in micro-joules, from the
+            time spent converting, idle and asleep and the sensor's typical
+            currents (powerProfile()) at the given supply voltage, e.g. the
+            BQ27441 voltage() / 1000.0. 0 without samples or a profile.
+*/
+/**************************************************************************/
+float FlexScheduler::energyPerSample(uint8_t index, float volts)
+{
+  uint32_t span;
+  entry_t *entry = &_entries[index];
+
+  if (entry->stats.samples == 0)
+  {
+    return 0;
+  }
+  /* uA * us = pC, pC * V = pJ */
+  return chargeOf(entry, &span) * volts / 1e6F / entry->stats.samples;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Estimated average supply current of a sensor in micro-amps
+*/
+/**************************************************************************/
+float FlexScheduler::averageMicroAmps(uint8_t index)
+{
+  uint32_t span;
+  float    charge = chargeOf(&_entries[index], &span);
+
+  return (span == 0) ? 0 : charge / span;
+}
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Collects a finished conversion, then starts the next one when
+            it is due. Polling only starts at the driver's nextPollTime()
+            (the nominal conversion time, or the end of the current stage
+            of a multi-stage driver) so idle sensors cost no bus traffic.
+*/
+/**************************************************************************/
+void FlexScheduler::service(entry_t *entry, uint8_t index, uint32_t now)
+{
+  flexSchedulerStats_t *s = &entry->stats;
+
+  if (entry->inFlight &&
+      ((uint32_t)(now - entry->startedAt) >= entry->sensor->nextPollTime()))
+  {
+    flexState_t state = entry->sensor->poll();
+
+    if (state == FLEX_READY)
+    {
+      bool collected = entry->sensor->collect();
+      if (!collected && (entry->sensor->state() == FLEX_BUSY))
+      {
+        /* The result was not there yet, the driver keeps polling */
+        return;
+      }
+      now = micros();
+      account(entry, now);
+      entry->inFlight = false;
+      if (collected)
+      {
+        if (s->samples == 0)
+        {
+          s->firstSampleAt = now;
+        }
+        s->lastSampleAt = now;
+        s->samples++;
+        if (_callback != NULL)
+        {
+          _callback(index, entry->sensor);
+        }
+      }
+      else
+      {
+        s->errors++;
+      }
+    }
+    else if (state == FLEX_ERROR)
+    {
+      account(entry, now);
+      entry->inFlight = false;
+      s->errors++;
+    }
+    else if (state == FLEX_IDLE)
+    {
+      /* Collected outside of the scheduler */
+      account(entry, now);
+      entry->inFlight = false;
+    }
+  }
+
+  /* Asleep: wake up early enough to be settled when the sample is due */
+  if (entry->asleep &&
+      ((int32_t)(now - (entry->nextDue - entry->sensor->powerProfile().wakeMicros)) >= 0))
+  {
+    wakeEntry(entry, now);
+  }
+
+  if ((int32_t)(now - entry->nextDue) < 0)
+  {
+    if (entry->dutyCycle && !entry->asleep && !entry->inFlight)
+    {
+      sleepEntry(entry, now);
+    }
+    return;
+  }
+
+  if (entry->inFlight)
+  {
+    /* Previous sample is still in flight at its next deadline */
+    s->missed++;
+    entry->nextDue += s->period;
+    return;
+  }
+
+  /* Started one or more full periods late: count and skip those slots */
+  uint32_t late = now - entry->nextDue;
+  if (late >= s->period)
+  {
+    s->missed += late / s->period;
+    entry->nextDue += (late / s->period) * s->period;
+  }
+
+  startEntry(entry, now);
+  entry->nextDue += s->period;
+}
+
+void FlexScheduler::startEntry(entry_t *entry, uint32_t now)
+{
+  account(entry, now);
+  if (entry->sensor->start())
+  {
+    entry->inFlight = true;
+    entry->startedAt = now;
+  }
+  else
+  {
+    entry->stats.errors++;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parks an idle sensor until its wake-up time, if the gap to the
+            next sample is long enough to be worth it
+*/
+/**************************************************************************/
+void FlexScheduler::sleepEntry(entry_t *entry, uint32_t now)
+{
+  uint32_t wakeMicros = entry->sensor->powerProfile().wakeMicros;
+
+  if ((uint32_t)(entry->nextDue - now) < wakeMicros + FLEX_SCHEDULER_MIN_SLEEP_US)
+  {
+    return;
+  }
+  account(entry, now);
+  if (entry->sensor->sleep())
+  {
+    entry->asleep = true;
+    entry->stats.sleeps++;
+  }
+  else
+  {
+    /* No low power mode (or it failed): leave the sensor awake */
+    entry->dutyCycle = false;
+  }
+}
+
+void FlexScheduler::wakeEntry(entry_t *entry, uint32_t now)
+{
+  account(entry, now);
+  entry->asleep = false;
+  if (!entry->sensor->wake())
+  {
+    entry->stats.errors++;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Adds the time since the last power state change to the state
+            the sensor was in: converting, asleep or idle
+*/
+/**************************************************************************/
+void FlexScheduler::account(entry_t *entry, uint32_t now)
+{
+  uint32_t spent = now - entry->since;
+
+  if (entry->inFlight)
+  {
+    entry->stats.convertMicros += spent;
+  }
+  else if (entry->asleep)
+  {
+    entry->stats.sleepMicros += spent;
+  }
+  else
+  {
+    entry->stats.idleMicros += spent;
+  }
+  entry->since = now;
+}
+
+/* Charge in pC (uA * us) up to now, and the time it covers */
+float FlexScheduler::chargeOf(entry_t *entry, uint32_t *span)
+{
+  account(entry, micros());
+
+  flexPowerProfile_t    p = entry->sensor->powerProfile();
+  flexSchedulerStats_t *s = &entry->stats;
+
+  *span = s->convertMicros + s->idleMicros + s->sleepMicros;
+  return p.convertMicroAmps * s->convertMicros +
+         p.idleMicroAmps * s->idleMicros +
+         p.sleepMicroAmps * s->sleepMicros;
+}
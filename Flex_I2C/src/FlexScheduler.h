@@ -0,0 +1,131 @@
+/**************************************************************************/
+/*!
+    @file     FlexScheduler.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Cooperative scheduler for Flex sensors spread over several buses.
+
+    Register driver instances (anything implementing FlexAsyncSensor)
+    together with their bus and target rate. Call run() from loop(): it
+    never blocks, it only issues the next due start(), poll() or
+    collect() calls. Entries are visited with their buses interleaved
+    (bus A, bus B, bus A, ...) so work on one SERCOM does not queue up
+    behind the other, and a long conversion (e.g. MPL3115A2 at OS=7)
+    never delays a fast sensor because nothing waits for it.
+
+    Per sensor the scheduler keeps the number of samples, missed
+    deadlines (sample still in flight or started a full period late)
+    and errors, and can report the achieved rate.
+
+    Duty cycling: setDutyCycle() lets the scheduler sleep() a sensor
+    (standby / power-down, see FlexAsyncSensor) once its sample is
+    collected, and wake() it again its powerProfile().wakeMicros before
+    the next one is due. Gaps shorter than the wake time plus
+    FLEX_SCHEDULER_MIN_SLEEP_US are not worth the bus traffic and are
+    spent awake. The time every sensor spends converting, idle and
+    asleep is counted, which with the sensor's typical currents gives
+    an estimate of its energy per sample and average current.
+
+    Usage:
+    TwoWire myWire(&sercom2, 4, 3);
+    Adafruit_HTU21DF_Flex htu = Adafruit_HTU21DF_Flex(&myWire);
+    MPL3115A2_Flex mpl = MPL3115A2_Flex(&Wire);
+    FlexScheduler scheduler;
+
+    scheduler.add(&htu, &myWire, 5.0);   // 5 Hz
+    scheduler.add(&mpl, &Wire, 1.0);     // 1 Hz
+    scheduler.setDutyCycle(1, true);     // standby between samples
+    scheduler.begin();
+
+    void loop() { scheduler.run(); ... }
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SCHEDULER_H
+#define _FLEX_SCHEDULER_H
+
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include <Wire.h>
+#include "FlexAsyncSensor.h"
+
+#ifndef FLEX_SCHEDULER_MAX_SENSORS
+  #define FLEX_SCHEDULER_MAX_SENSORS   12
+#endif
+
+#ifndef FLEX_SCHEDULER_MIN_SLEEP_US
+  #define FLEX_SCHEDULER_MIN_SLEEP_US  2000   // shortest sleep worth a sleep() / wake()
+#endif
+
+/* Called after every successful collect() */
+typedef void (*flexSampleCallback_t)(uint8_t index, FlexAsyncSensor *sensor);
+
+typedef struct
+{
+  uint32_t samples;         // successful collect() calls
+  uint32_t missed;          // deadlines missed
+  uint32_t errors;          // start/poll/collect reported FLEX_ERROR
+  uint32_t period;          // target period in us
+  uint32_t firstSampleAt;   // micros() of the first sample
+  uint32_t lastSampleAt;    // micros() of the last sample
+  uint32_t convertMicros;   // time from start() to collect (all three wrap after ~71 min)
+  uint32_t idleMicros;      // awake, no conversion in flight
+  uint32_t sleepMicros;     // between sleep() and wake()
+  uint32_t sleeps;          // sleep() calls
+} flexSchedulerStats_t;
+
+class FlexScheduler
+{
+ public:
+  FlexScheduler(void);
+
+  int8_t   add(FlexAsyncSensor *sensor, TwoWire *bus, float rateHz);
+  void     setCallback(flexSampleCallback_t callback);
+  void     begin(void);
+  void     run(void);
+
+  uint8_t  count(void);
+  flexSchedulerStats_t stats(uint8_t index);
+  float    achievedRate(uint8_t index);
+  void     resetStats(void);
+
+  // Power (see FlexAsyncSensor::powerProfile())
+  bool     setDutyCycle(uint8_t index, bool enable);
+  float    energyPerSample(uint8_t index, float volts);  // uJ, 0 when unknown
+  float    averageMicroAmps(uint8_t index);              // since begin() / resetStats()
+
+ private:
+  typedef struct
+  {
+    FlexAsyncSensor     *sensor;
+    TwoWire             *bus;
+    uint32_t             nextDue;
+    uint32_t             startedAt;
+    bool                 inFlight;
+    bool                 dutyCycle;
+    bool                 asleep;
+    uint32_t             since;      // micros() of the last power state change
+    flexSchedulerStats_t stats;
+  } entry_t;
+
+  void     service(entry_t *entry, uint8_t index, uint32_t now);
+  void     startEntry(entry_t *entry, uint32_t now);
+  void     sleepEntry(entry_t *entry, uint32_t now);
+  void     wakeEntry(entry_t *entry, uint32_t now);
+  void     account(entry_t *entry, uint32_t now);
+  float    chargeOf(entry_t *entry, uint32_t *span);
+
+  entry_t  _entries[FLEX_SCHEDULER_MAX_SENSORS];
+  uint8_t  _order[FLEX_SCHEDULER_MAX_SENSORS];
+  uint8_t  _count;
+  flexSampleCallback_t _callback;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/**************************************************************************/
+/*!
+    @file     FlexWireTransport.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Blocking FlexI2CTransport on top of any TwoWire bus.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include "FlexWireTransport.h"
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+FlexWireTransport::FlexWireTransport(TwoWire *wire)
+  : _i2c(wire, 0)
+{
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Runs the transfer right away and completes it before returning
+*/
+/**************************************************************************/
+bool FlexWireTransport::submit(flexI2CTransfer_t *transfer)
+{
+  if ((transfer == NULL) || (transfer->count == 0) || (transfer->data == NULL))
+  {
+    return false;
+  }
+
+  transfer->done = false;
+  transfer->next = NULL;
+  // only touch the address when it changes: setAddress() drops the shadow cache
+  if (_i2c.address() != transfer->address)
+  {
+    _i2c.setAddress(transfer->address);
+  }
+
+  if (transfer->op == FLEX_TRANSFER_READ)
+  {
+    _i2c.readRegisters(transfer->reg, transfer->data, transfer->count);
+  }
+  else if (transfer->op == FLEX_TRANSFER_RECEIVE)
+  {
+    _i2c.read(transfer->data, transfer->count);
+  }
+  else
+  {
+    _i2c.writeRegisters(transfer->reg, transfer->data, transfer->count);
+  }
+  complete(transfer, _i2c.lastError());
+  return true;
+}
+
+bool FlexWireTransport::idle(void)
+{
+  return true;
+}
+
+bool FlexWireTransport::blocking(void)
+{
+  return true;
+}
+
+FlexI2CDevice *FlexWireTransport::device(void)
+{
+  return &_i2c;
+}
@@ -0,0 +1,39 @@
+/**************************************************************************/
+/*!
+    @file     FlexWireTransport.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Blocking FlexI2CTransport on top of any TwoWire bus.
+
+    The transfer runs inside submit() through a FlexI2CDevice (burst with
+    repeated start, typed errors, counters), so by the time submit()
+    returns the transfer is done and its callback has run. Drivers written
+    against FlexI2CTransport therefore work on every core, they only gain
+    CPU time on a backend that really completes in the background.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_WIRE_TRANSPORT_H
+#define _FLEX_WIRE_TRANSPORT_H
+
+#include "FlexI2CTransport.h"
+#include "FlexI2CDevice.h"
+
+class FlexWireTransport : public FlexI2CTransport
+{
+ public:
+  FlexWireTransport(TwoWire *wire);
+
+  bool      submit(flexI2CTransfer_t *transfer);
+  bool      idle(void);
+  bool      blocking(void);          // true, the transfer runs inside submit()
+
+  FlexI2CDevice *device(void);       // counters of all transfers
+ private:
+  FlexI2CDevice _i2c;
+};
+
+#endif
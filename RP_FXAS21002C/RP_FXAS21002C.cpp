@@ -26,9 +26,6 @@
 #include <limits.h>
 
 #include "RP_FXAS21002C.h"
-#include "wiring_private.h" // pinPeripheral() function
-
-TwoWire myWire(&sercom2, 4, 3);
 
 /***************************************************************************
  PRIVATE FUNCTIONS
@@ -36,46 +33,22 @@ TwoWire myWire(&sercom2, 4, 3);
 
 /**************************************************************************/
 /*!
-    @brief  Abstract away platform differences in Arduino wire library
+    @brief  Writes a single register through the shared Flex transport
 */
 /**************************************************************************/
 void RP_FXAS21002C::write8(byte reg, byte value)
 {
-  myWire.beginTransmission(FXAS21002C_ADDRESS);
-  #if ARDUINO >= 100
-    myWire.write((uint8_t)reg);
-    myWire.write((uint8_t)value);
-  #else
-    myWire.send(reg);
-    myWire.send(value);
-  #endif
-  myWire.endTransmission();
+  _i2c.write8(reg, value);
 }
 
 /**************************************************************************/
 /*!
-    @brief  Abstract away platform differences in Arduino wire library
+    @brief  Reads a single register through the shared Flex transport
 */
 /**************************************************************************/
 byte RP_FXAS21002C::read8(byte reg)
 {
-  byte value;
-
-  myWire.beginTransmission((byte)FXAS21002C_ADDRESS);
-  #if ARDUINO >= 100
-    myWire.write((uint8_t)reg);
-  #else
-    myWire.send(reg);
-  #endif
-  if (myWire.endTransmission(false) != 0) return 0;
-  myWire.requestFrom((byte)FXAS21002C_ADDRESS, (byte)1);
-  #if ARDUINO >= 100
-    value = myWire.read();
-  #else
-    value = myWire.receive();
-  #endif
-
-  return value;
+  return _i2c.read8(reg);
 }
 
 /***************************************************************************
@@ -87,7 +60,10 @@ byte RP_FXAS21002C::read8(byte reg)
     @brief  Instantiates a new RP_FXAS21002C class
 */
 /**************************************************************************/
-RP_FXAS21002C::RP_FXAS21002C(int32_t sensorID) {
+RP_FXAS21002C::RP_FXAS21002C(TwoWire *wire, int32_t sensorID)
+  : _i2c(wire, FXAS21002C_ADDRESS)
+{
+  _wire = wire;
   _sensorID = sensorID;
 }
 
@@ -102,10 +78,7 @@ RP_FXAS21002C::RP_FXAS21002C(int32_t sensorID) {
 /**************************************************************************/
 bool RP_FXAS21002C::begin(gyroRange_t rng)
 {
-  /* Enable I2C */
-  myWire.begin();
-  pinPeripheral(4, PIO_SERCOM_ALT);
-  pinPeripheral(3, PIO_SERCOM_ALT);
+  /* I2C is not started here: begin your (SERCOM) Wire before calling this */
 
   /* Set the range the an appropriate value */
   _range = rng;
@@ -143,10 +116,12 @@ bool RP_FXAS21002C::begin(gyroRange_t rng)
      0  READY     Standby(0)/Ready(1)                                 0
 
   /* Reset then switch to active mode with 100Hz output */
+  FlexBits<GYRO_CTRL_REG1> active = GYRO_CTRL1_DR::set(3) | GYRO_CTRL1_ACTIVE::set(1);
   write8(GYRO_REGISTER_CTRL_REG1, 0x00);
-  write8(GYRO_REGISTER_CTRL_REG1, (1<<6));
-  write8(GYRO_REGISTER_CTRL_REG1, 0x0E);
-  delay(100); // 60 ms + 1/ODR
+  write8(GYRO_REGISTER_CTRL_REG1, GYRO_CTRL1_RST::set(1).bits);
+  write8(GYRO_REGISTER_CTRL_REG1, active.bits);
+  _i2c.setShadow(GYRO_CTRL_REG1::address(), active.bits); // for sleep() / wake()
+  _i2c.waitMillis(100); // 60 ms + 1/ODR
   /* ------------------------------------------------------------------ */
 
   return true;
@@ -154,97 +129,342 @@ bool RP_FXAS21002C::begin(gyroRange_t rng)
 
 /**************************************************************************/
 /*!
-    @brief  Gets the most recent sensor event
+    @brief  Factory for FlexRegistry: new driver with the default range,
+            NULL if begin() fails (fixed address)
 */
 /**************************************************************************/
-bool RP_FXAS21002C::getEvent(sensors_event_t* event)
+FlexAsyncSensor *RP_FXAS21002C::create(TwoWire *wire, uint8_t address)
 {
-  bool readingValid = false;
-
-  /* Clear the event */
-  memset(event, 0, sizeof(sensors_event_t));
+  (void)address;
+  RP_FXAS21002C *gyro = new RP_FXAS21002C(wire);
+  if (!gyro->begin())
+  {
+    delete gyro;
+    return NULL;
+  }
+  return gyro;
+}
 
+/**************************************************************************/
+/*!
+    @brief  Reads STATUS and the X/Y/Z output registers in one burst
+            into raw, the STATUS byte into *status when given
+*/
+/**************************************************************************/
+bool RP_FXAS21002C::readRaw(uint8_t *status)
+{
   /* Clear the raw data placeholder */
   raw.x = 0;
   raw.y = 0;
   raw.z = 0;
 
+  /* Read 7 bytes from the sensor in one burst */
+  uint8_t data[7];
+  if (!_i2c.readRegisters(GYRO_REGISTER_STATUS | 0x80, data, 7))
+  {
+    return false;
+  }
+
+  uint8_t xhi = data[1];
+  uint8_t xlo = data[2];
+  uint8_t yhi = data[3];
+  uint8_t ylo = data[4];
+  uint8_t zhi = data[5];
+  uint8_t zlo = data[6];
+
+  /* Shift values to create properly formed integer */
+  raw.x = (int16_t)((xhi << 8) | xlo);
+  raw.y = (int16_t)((yhi << 8) | ylo);
+  raw.z = (int16_t)((zhi << 8) | zlo);
+
+  if (status != NULL)
+  {
+    *status = data[0];
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the most recent sensor event
+*/
+/**************************************************************************/
+bool RP_FXAS21002C::getEvent(sensors_event_t* event)
+{
+  /* Clear the event */
+  memset(event, 0, sizeof(sensors_event_t));
+
+  if (!readSample())
+  {
+    return false;
+  }
+
+  getLastEvent(event);
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Burst read for getEvent(): a new sample is on average half
+            an output period old when it is read
+*/
+/**************************************************************************/
+bool RP_FXAS21002C::readSample(void)
+{
+  uint32_t readAt = micros();
+  uint8_t  status;
+  if (!readRaw(&status))
+  {
+    return false;
+  }
+  if (status & GYRO_STATUS_ZYXDR)
+  {
+    markSampled(readAt - conversionTime() / 2);
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clears the event and fills in the metadata, timestamp back
+            dated to when the sample was taken
+*/
+/**************************************************************************/
+void RP_FXAS21002C::initEvent(sensors_event_t* event)
+{
+  memset(event, 0, sizeof(sensors_event_t));
+
   event->version   = sizeof(sensors_event_t);
   event->sensor_id = _sensorID;
   event->type      = SENSOR_TYPE_GYROSCOPE;
-  event->timestamp = millis();
-
-  /* Read 7 bytes from the sensor */
-  myWire.beginTransmission((byte)FXAS21002C_ADDRESS);
-  #if ARDUINO >= 100
-    myWire.write(GYRO_REGISTER_STATUS | 0x80);
-  #else
-    myWire.send(GYRO_REGISTER_STATUS | 0x80);
-  #endif
-  myWire.endTransmission();
-  myWire.requestFrom((byte)FXAS21002C_ADDRESS, (byte)7);
-
-  #if ARDUINO >= 100
-    uint8_t status = myWire.read();
-    uint8_t xhi = myWire.read();
-    uint8_t xlo = myWire.read();
-    uint8_t yhi = myWire.read();
-    uint8_t ylo = myWire.read();
-    uint8_t zhi = myWire.read();
-    uint8_t zlo = myWire.read();
-  #else
-    uint8_t status = myWire.receive();
-    uint8_t xhi = myWire.receive();
-    uint8_t xlo = myWire.receive();
-    uint8_t yhi = myWire.receive();
-    uint8_t ylo = myWire.receive();
-    uint8_t zhi = myWire.receive();
-    uint8_t zlo = myWire.receive();
-  #endif
+  event->timestamp = millis() - (micros() - sampleMicros()) / 1000;
+}
 
-  /* Shift values to create properly formed integer */
-  event->gyro.x = (int16_t)((xhi << 8) | xlo);
-  event->gyro.y = (int16_t)((yhi << 8) | ylo);
-  event->gyro.z = (int16_t)((zhi << 8) | zlo);
+/**************************************************************************/
+/*!
+    @brief  Converts the last read raw values (getEvent() or collect())
+            into a sensor event without touching the bus
+*/
+/**************************************************************************/
+void RP_FXAS21002C::getLastEvent(sensors_event_t* event)
+{
+  initEvent(event);
 
-  /* Assign raw values in case someone needs them */
-  raw.x = event->gyro.x;
-  raw.y = event->gyro.y;
-  raw.z = event->gyro.z;
+  event->gyro.x = raw.x;
+  event->gyro.y = raw.y;
+  event->gyro.z = raw.z;
 
   /* Compensate values depending on the resolution */
-  switch(_range)
-  {
-    case GYRO_RANGE_250DPS:
-      event->gyro.x *= GYRO_SENSITIVITY_250DPS;
-      event->gyro.y *= GYRO_SENSITIVITY_250DPS;
-      event->gyro.z *= GYRO_SENSITIVITY_250DPS;
-      break;
-    case GYRO_RANGE_500DPS:
-      event->gyro.x *= GYRO_SENSITIVITY_500DPS;
-      event->gyro.y *= GYRO_SENSITIVITY_500DPS;
-      event->gyro.z *= GYRO_SENSITIVITY_500DPS;
-      break;
-    case GYRO_RANGE_1000DPS:
-      event->gyro.x *= GYRO_SENSITIVITY_1000DPS;
-      event->gyro.y *= GYRO_SENSITIVITY_1000DPS;
-      event->gyro.z *= GYRO_SENSITIVITY_1000DPS;
-      break;
-    case GYRO_RANGE_2000DPS:
-      event->gyro.x *= GYRO_SENSITIVITY_2000DPS;
-      event->gyro.y *= GYRO_SENSITIVITY_2000DPS;
-      event->gyro.z *= GYRO_SENSITIVITY_2000DPS;
-      break;
-  }
+  float sensitivity = fxasSensitivity(_range);
+  event->gyro.x *= sensitivity;
+  event->gyro.y *= sensitivity;
+  event->gyro.z *= sensitivity;
 
   /* Convert values to rad/s */
   event->gyro.x *= SENSORS_DPS_TO_RADS;
   event->gyro.y *= SENSORS_DPS_TO_RADS;
   event->gyro.z *= SENSORS_DPS_TO_RADS;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Integer version of getEvent(): rates in milli-degrees per
+            second instead of float rad/s
+*/
+/**************************************************************************/
+bool RP_FXAS21002C::getEventFixed(flexVector32_t* milliDps)
+{
+  if (!readSample())
+  {
+    return false;
+  }
+
+  getLastEventFixed(milliDps);
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Last read raw values in milli-dps: 7.8125 mdps/LSB at 250 dps
+            (125 >> 4), doubling with every range step
+*/
+/**************************************************************************/
+void RP_FXAS21002C::getLastEventFixed(flexVector32_t* milliDps)
+{
+  uint8_t shift = fxasFixedShift(_range);
+
+  milliDps->x = flexScale(raw.x, 125, shift);
+  milliDps->y = flexScale(raw.y, 125, shift);
+  milliDps->z = flexScale(raw.z, 125, shift);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts count raw samples to rad/s, one output array per
+            axis. Same scale as getEvent() at the current range.
+*/
+/**************************************************************************/
+void RP_FXAS21002C::convertBatch(const gyroRawData_t* raw, uint16_t count,
+                                 float* x, float* y, float* z)
+{
+  flexScaleXYZBatch((const int16_t*)raw, count, fxasSensitivity(_range) * SENSORS_DPS_TO_RADS, x, y, z);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Integer version of convertBatch(), milli-dps per axis
+*/
+/**************************************************************************/
+void RP_FXAS21002C::convertBatchFixed(const gyroRawData_t* raw, uint16_t count,
+                                      int32_t* x, int32_t* y, int32_t* z)
+{
+  flexScaleXYZBatchFixed((const int16_t*)raw, count, 125, fxasFixedShift(_range), x, y, z);
+}
+
+/***************************************************************************
+ NON-BLOCKING (FlexAsyncSensor)
+ ***************************************************************************/
 
+/**************************************************************************/
+/*!
+    @brief  The gyro is free running (100Hz after begin), so start() only
+            arms the data ready check
+*/
+/**************************************************************************/
+bool RP_FXAS21002C::start(void)
+{
+  markStarted();
   return true;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Single STATUS read, ready when a new X/Y/Z set is available.
+            Brackets the data ready edge for sampleMicros().
+*/
+/**************************************************************************/
+flexState_t RP_FXAS21002C::poll(void)
+{
+  if (_state != FLEX_BUSY)
+  {
+    return _state;
+  }
+  uint32_t readAt = micros();
+  byte status = read8(GYRO_REGISTER_STATUS);
+  readAt += (micros() - readAt) / 2;   // STATUS is clocked out halfway
+  if (_i2c.lastError() != FLEX_OK)
+  {
+    _state = FLEX_ERROR;
+  }
+  else if (status & GYRO_STATUS_ZYXDR)
+  {
+    markDataReady(readAt);
+    _state = FLEX_READY;
+  }
+  else if (overdue(_i2c.timeout()))
+  {
+    /* Free running at 100 Hz, no new sample means the sensor stopped */
+    _i2c.setError(FLEX_ERR_TIMEOUT);
+    _state = FLEX_ERROR;
+  }
+  else
+  {
+    markNotReady(readAt);
+  }
+  return _state;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Burst reads the new sample into raw, see getLastEvent()
+*/
+/**************************************************************************/
+bool RP_FXAS21002C::collect(void)
+{
+  if (_state != FLEX_READY)
+  {
+    return false;
+  }
+  if (!readRaw())
+  {
+    _state = FLEX_ERROR;
+    return false;
+  }
+  _state = FLEX_IDLE;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  One output data period (100Hz as configured by begin())
+*/
+/**************************************************************************/
+uint32_t RP_FXAS21002C::conversionTime(void)
+{
+  return 10000;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Standby (ACTIVE and READY clear), a single CTRL_REG1 write
+            from the shadow
+*/
+/**************************************************************************/
+bool RP_FXAS21002C::sleep(void)
+{
+  return _i2c.update(GYRO_CTRL1_ACTIVE::set(0) | GYRO_CTRL1_READY::set(0));
+}
+
+bool RP_FXAS21002C::wake(void)
+{
+  return _i2c.update(GYRO_CTRL1_ACTIVE::set(1));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Datasheet typical active and standby currents, and the
+            standby to active time (60 ms + 1/ODR). The long start-up
+            only pays off at low sample rates.
+*/
+/**************************************************************************/
+flexPowerProfile_t RP_FXAS21002C::powerProfile(void)
+{
+  flexPowerProfile_t profile;
+  profile.convertMicroAmps = 2700;
+  profile.idleMicroAmps = 2700;    // free running
+  profile.sleepMicroAmps = 2.8F;
+  profile.wakeMicros = 60000 + conversionTime();
+  return profile;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Result of the last bus transaction, e.g. why getEvent()
+            returned false
+*/
+/**************************************************************************/
+flexResult_t RP_FXAS21002C::lastError(void)
+{
+  return _i2c.lastError();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Bus and wait counters of this sensor, see flexI2CStats_t
+*/
+/**************************************************************************/
+flexI2CStats_t RP_FXAS21002C::getStats(void)
+{
+  return _i2c.stats();
+}
+
+void RP_FXAS21002C::resetStats(void)
+{
+  _i2c.resetStats();
+}
+
 /**************************************************************************/
 /*!
     @brief  Gets the sensor_t data
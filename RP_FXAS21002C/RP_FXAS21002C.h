@@ -35,6 +35,10 @@
 
 #include <Adafruit_Sensor.h> // might need to be changed as well...
 #include <Wire.h>
+#include <FlexI2CDevice.h>
+#include <FlexAsyncSensor.h>
+#include <FlexFixed.h>
+#include <FlexConvert.h>
 
 /*=========================================================================
     I2C ADDRESS/BITS AND SETTINGS
@@ -45,6 +49,7 @@
     #define GYRO_SENSITIVITY_500DPS  (0.015625F)  // ..
     #define GYRO_SENSITIVITY_1000DPS (0.03125F)   // ..
     #define GYRO_SENSITIVITY_2000DPS (0.0625F)    // ..
+    #define GYRO_STATUS_ZYXDR        (0x08)       // new X/Y/Z data ready
 /*=========================================================================*/
 
 /*=========================================================================
@@ -66,6 +71,17 @@
     } gyroRegisters_t;
 /*=========================================================================*/
 
+/*=========================================================================
+    REGISTER FIELDS (see FlexRegister.h)
+    -----------------------------------------------------------------------*/
+    typedef FlexReg<GYRO_REGISTER_CTRL_REG1>   GYRO_CTRL_REG1;
+
+    typedef FlexField<GYRO_CTRL_REG1, 0>       GYRO_CTRL1_READY;    // 1: ready (ACTIVE 0)
+    typedef FlexField<GYRO_CTRL_REG1, 1>       GYRO_CTRL1_ACTIVE;   // 0 with READY 0: standby
+    typedef FlexField<GYRO_CTRL_REG1, 2, 3>    GYRO_CTRL1_DR;       // 800Hz >> DR
+    typedef FlexField<GYRO_CTRL_REG1, 6>       GYRO_CTRL1_RST;
+/*=========================================================================*/
+
 /*=========================================================================
     OPTIONAL SPEED SETTINGS
     -----------------------------------------------------------------------*/
@@ -78,6 +94,29 @@
     } gyroRange_t;
 /*=========================================================================*/
 
+/*=========================================================================
+    SCALE PER RANGE
+    -----------------------------------------------------------------------
+    dps per LSB, and the flexScale() shift for milli-dps (125 >> 4 at
+    250 dps, one less for every range step). Constant expressions when
+    the range is, see FXAS21002C<RANGE>.
+    -----------------------------------------------------------------------*/
+    constexpr float fxasSensitivity(gyroRange_t range)
+    {
+      return (range == GYRO_RANGE_500DPS)  ? GYRO_SENSITIVITY_500DPS  :
+             (range == GYRO_RANGE_1000DPS) ? GYRO_SENSITIVITY_1000DPS :
+             (range == GYRO_RANGE_2000DPS) ? GYRO_SENSITIVITY_2000DPS :
+                                             GYRO_SENSITIVITY_250DPS;
+    }
+
+    constexpr uint8_t fxasFixedShift(gyroRange_t range)
+    {
+      return (range == GYRO_RANGE_500DPS)  ? 3 :
+             (range == GYRO_RANGE_1000DPS) ? 2 :
+             (range == GYRO_RANGE_2000DPS) ? 1 : 4;
+    }
+/*=========================================================================*/
+
 /*=========================================================================
     RAW GYROSCOPE DATA TYPE
     -----------------------------------------------------------------------*/
@@ -89,22 +128,124 @@
     } gyroRawData_t;
 /*=========================================================================*/
 
-class RP_FXAS21002C : public Adafruit_Sensor
+class RP_FXAS21002C : public Adafruit_Sensor, public FlexAsyncSensor
 {
   public:
-    RP_FXAS21002C(int32_t sensorID = -1);
+    RP_FXAS21002C(TwoWire *wire, int32_t sensorID = -1);
+    TwoWire *_wire;
 
     bool begin           ( gyroRange_t rng = GYRO_RANGE_250DPS );
+    static FlexAsyncSensor *create ( TwoWire *wire, uint8_t address );  /* FlexRegistry factory */
     bool getEvent        ( sensors_event_t* );
     void getSensor       ( sensor_t* );
+    void getLastEvent    ( sensors_event_t* );
+    bool getEventFixed     ( flexVector32_t* milliDps );   /* integer, no float math */
+    void getLastEventFixed ( flexVector32_t* milliDps );
+
+    /* Whole sample buffers (FIFO drains) at once, see FlexConvert.h */
+    void convertBatch      ( const gyroRawData_t* raw, uint16_t count,
+                             float* x, float* y, float* z );         /* rad/s */
+    void convertBatchFixed ( const gyroRawData_t* raw, uint16_t count,
+                             int32_t* x, int32_t* y, int32_t* z );   /* mdps */
+
+    /* Non-blocking data ready based reads (see FlexAsyncSensor) */
+    bool        start          ( void );
+    flexState_t poll           ( void );
+    bool        collect        ( void );
+    uint32_t    conversionTime ( void );
+
+    /* Standby between samples (see FlexScheduler::setDutyCycle()) */
+    bool        sleep          ( void );
+    bool        wake           ( void );
+    flexPowerProfile_t powerProfile ( void );
+
+    flexResult_t lastError    ( void );
+    flexI2CStats_t getStats   ( void );
+    void        resetStats     ( void );
 
     gyroRawData_t raw; /* Raw values from last sensor read */
 
+  protected:
+    bool        readRaw    ( uint8_t* status = NULL );
+    bool        readSample ( void );                 /* readRaw(), stamps new samples */
+    void        initEvent  ( sensors_event_t* event );
+
   private:
     void        write8  ( byte reg, byte value );
     byte        read8   ( byte reg );
+    FlexI2CDevice _i2c;
     gyroRange_t _range;
     int32_t     _sensorID;
 };
 
+/**************************************************************************/
+/*!
+    RP_FXAS21002C with the range fixed at compile time:
+
+      FXAS21002C<GYRO_RANGE_500DPS> gyro(&sensorTWI);
+      gyro.begin();
+
+    The conversions use constant scale factors instead of switching on
+    the range for every sample; everything else is RP_FXAS21002C.
+*/
+/**************************************************************************/
+template <gyroRange_t RANGE>
+class FXAS21002C : public RP_FXAS21002C
+{
+  public:
+    FXAS21002C(TwoWire *wire, int32_t sensorID = -1) : RP_FXAS21002C(wire, sensorID) { }
+
+    bool begin ( void ) { return RP_FXAS21002C::begin(RANGE); }
+
+    /* rad/s per LSB, and the flexScale() shift of 125 for milli-dps */
+    static constexpr float   scale         ( void ) { return fxasSensitivity(RANGE) * SENSORS_DPS_TO_RADS; }
+    static constexpr uint8_t milliDpsShift ( void ) { return fxasFixedShift(RANGE); }
+
+    bool getEvent ( sensors_event_t* event )
+    {
+      memset(event, 0, sizeof(sensors_event_t));
+      if (!readSample())
+      {
+        return false;
+      }
+      getLastEvent(event);
+      return true;
+    }
+
+    void getLastEvent ( sensors_event_t* event )
+    {
+      initEvent(event);
+      event->gyro.x = raw.x * scale();
+      event->gyro.y = raw.y * scale();
+      event->gyro.z = raw.z * scale();
+    }
+
+    bool getEventFixed ( flexVector32_t* milliDps )
+    {
+      if (!readSample())
+      {
+        return false;
+      }
+      getLastEventFixed(milliDps);
+      return true;
+    }
+
+    void getLastEventFixed ( flexVector32_t* milliDps )
+    {
+      milliDps->x = flexScale(raw.x, 125, milliDpsShift());
+      milliDps->y = flexScale(raw.y, 125, milliDpsShift());
+      milliDps->z = flexScale(raw.z, 125, milliDpsShift());
+    }
+
+    void convertBatch ( const gyroRawData_t* raw, uint16_t count, float* x, float* y, float* z )
+    {
+      flexScaleXYZBatch((const int16_t*)raw, count, scale(), x, y, z);
+    }
+
+    void convertBatchFixed ( const gyroRawData_t* raw, uint16_t count, int32_t* x, int32_t* y, int32_t* z )
+    {
+      flexScaleXYZBatchFixed((const int16_t*)raw, count, 125, milliDpsShift(), x, y, z);
+    }
+};
+
 #endif
@@ -1,13 +1,14 @@
 #include <Wire.h>
 #include <Adafruit_Sensor.h>
+#include "wiring_private.h" // pinPeripheral() function
 #include <RP_FXAS21002C.h>
 
-/* Assign a unique ID to this sensor at the same time */
-RP_FXAS21002C gyro = RP_FXAS21002C(0x0021002C);
-
 // this example uses TwoWire instead of Wire (for SERCOM)
 // J.A. Korten 2018
-// Note: ToDo RP_FXAS21002C gyro = RP_FXAS21002C(&myWire, 0x0021002C);
+TwoWire myWire(&sercom2, 4, 3);
+
+/* Assign a unique ID to this sensor at the same time */
+RP_FXAS21002C gyro = RP_FXAS21002C(&myWire, 0x0021002C);
 
 void displaySensorDetails(void)
 {
@@ -36,6 +37,11 @@ void setup(void)
 
   Serial.println("Gyroscope Test"); Serial.println("");
 
+  /* Start the bus first, the library does not do this for you */
+  myWire.begin();
+  pinPeripheral(4, PIO_SERCOM_ALT);
+  pinPeripheral(3, PIO_SERCOM_ALT);
+
   /* Initialise the sensor */
   if(!gyro.begin())
   {
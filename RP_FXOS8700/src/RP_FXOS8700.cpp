@@ -24,14 +24,6 @@
 #include <limits.h>
 
 #include "RP_FXOS8700.h"
-#include "wiring_private.h" // pinPeripheral() function
-
-TwoWire myWire(&sercom2, 4, 3);
-
-#define ACCEL_MG_LSB_2G (0.000244F)
-#define ACCEL_MG_LSB_4G (0.000488F)
-#define ACCEL_MG_LSB_8G (0.000976F)
-#define MAG_UT_LSB      (0.1F)
 
 /***************************************************************************
  PRIVATE FUNCTIONS
@@ -39,46 +31,22 @@ TwoWire myWire(&sercom2, 4, 3);
 
 /**************************************************************************/
 /*!
-    @brief  Abstract away platform differences in Arduino wire library
+    @brief  Writes a single register through the shared Flex transport
 */
 /**************************************************************************/
 void RP_FXOS8700::write8(byte reg, byte value)
 {
-  myWire.beginTransmission(FXOS8700_ADDRESS);
-  #if ARDUINO >= 100
-    myWire.write((uint8_t)reg);
-    myWire.write((uint8_t)value);
-  #else
-    myWire.send(reg);
-    myWire.send(value);
-  #endif
-  myWire.endTransmission();
+  _i2c.write8(reg, value);
 }
 
 /**************************************************************************/
 /*!
-    @brief  Abstract away platform differences in Arduino wire library
+    @brief  Reads a single register through the shared Flex transport
 */
 /**************************************************************************/
 byte RP_FXOS8700::read8(byte reg)
 {
-  byte value;
-
-  myWire.beginTransmission((byte)FXOS8700_ADDRESS);
-  #if ARDUINO >= 100
-    myWire.write((uint8_t)reg);
-  #else
-    myWire.send(reg);
-  #endif
-  if (myWire.endTransmission(false) != 0) return 0;
-  myWire.requestFrom((byte)FXOS8700_ADDRESS, (byte)1);
-  #if ARDUINO >= 100
-    value = myWire.read();
-  #else
-    value = myWire.receive();
-  #endif
-
-  return value;
+  return _i2c.read8(reg);
 }
 
 /***************************************************************************
@@ -90,10 +58,18 @@ byte RP_FXOS8700::read8(byte reg)
     @brief  Instantiates a new RP_FXOS8700 class
 */
 /**************************************************************************/
-RP_FXOS8700::RP_FXOS8700(int32_t accelSensorID, int32_t magSensorID)
+RP_FXOS8700::RP_FXOS8700(TwoWire *wire, int32_t accelSensorID, int32_t magSensorID)
+  : _i2c(wire, FXOS8700_ADDRESS)
 {
+  _wire = wire;
   _accelSensorID = accelSensorID;
   _magSensorID = magSensorID;
+  _transport = NULL;
+  _transfer.done = true;
+  _transfer.next = NULL;
+  _transferPending = false;
+  _frameRequested = false;
+  _submittedAt = 0;
 }
 
 /***************************************************************************
@@ -107,10 +83,7 @@ RP_FXOS8700::RP_FXOS8700(int32_t accelSensorID, int32_t magSensorID)
 /**************************************************************************/
 bool RP_FXOS8700::begin(fxos8700AccelRange_t rng)
 {
-  /* Enable I2C */
-  myWire.begin();
-  pinPeripheral(4, PIO_SERCOM_ALT);
-  pinPeripheral(3, PIO_SERCOM_ALT);
+  /* I2C is not started here: begin your (SERCOM) Wire before calling this */
 
   /* Set the range the an appropriate value */
   _range = rng;
@@ -131,46 +104,63 @@ bool RP_FXOS8700::begin(fxos8700AccelRange_t rng)
     return false;
   }
 
+  /* The whole configuration goes out as one batch */
+  FlexI2CBatch batch;
+
   /* Set to standby mode (required to make changes to this register) */
-  write8(FXOS8700_REGISTER_CTRL_REG1, 0);
+  batch.write(FXOS_CTRL1_ACTIVE::set(0));
 
   /* Configure the accelerometer */
-  switch (_range) {
-      case (ACCEL_RANGE_2G):
-        write8(FXOS8700_REGISTER_XYZ_DATA_CFG, 0x00);
-      break;
-      case (ACCEL_RANGE_4G):
-        write8(FXOS8700_REGISTER_XYZ_DATA_CFG, 0x01);
-      break;
-      case (ACCEL_RANGE_8G):
-        write8(FXOS8700_REGISTER_XYZ_DATA_CFG, 0x02);
-      break;
-  }
+  batch.write(FXOS_XYZ_FS::set(_range));
   /* High resolution */
-  write8(FXOS8700_REGISTER_CTRL_REG2, 0x02);
+  batch.write(FXOS_CTRL2_MODS::set(2));
   /* Active, Normal Mode, Low Noise, 100Hz in Hybrid Mode */
-  write8(FXOS8700_REGISTER_CTRL_REG1, 0x15);
+  FlexBits<FXOS_CTRL_REG1> ctrl1 = FXOS_CTRL1_DR::set(2) | FXOS_CTRL1_LNOISE::set(1) | FXOS_CTRL1_ACTIVE::set(1);
+  batch.write(ctrl1);
 
   /* Configure the magnetometer */
   /* Hybrid Mode, Over Sampling Rate = 16 */
-  write8(FXOS8700_REGISTER_MCTRL_REG1, 0x1F);
+  batch.write(FXOS_MCTRL1_HMS::set(3) | FXOS_MCTRL1_OS::set(7));
   /* Jump to reg 0x33 after reading 0x06 */
-  write8(FXOS8700_REGISTER_MCTRL_REG2, 0x20);
+  batch.write(FXOS_MCTRL2_AUTOINC::set(1));
 
+  if (_i2c.run(&batch) != FLEX_OK)
+  {
+    _i2c.invalidateAll();
+    return false;
+  }
+  /* The batch bypasses the shadow, sleep() / wake() start from here */
+  _i2c.setShadow(FXOS_CTRL_REG1::address(), ctrl1.bits);
   return true;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Gets the most recent sensor event
+    @brief  Factory for FlexRegistry: new driver with the default range,
+            NULL if begin() fails (fixed address)
 */
 /**************************************************************************/
-bool RP_FXOS8700::getEvent(sensors_event_t* accelEvent, sensors_event_t* magEvent)
+FlexAsyncSensor *RP_FXOS8700::create(TwoWire *wire, uint8_t address)
 {
-  /* Clear the event */
-  memset(accelEvent, 0, sizeof(sensors_event_t));
-  memset(magEvent, 0, sizeof(sensors_event_t));
+  (void)address;
+  RP_FXOS8700 *accelMag = new RP_FXOS8700(wire);
+  if (!accelMag->begin())
+  {
+    delete accelMag;
+    return NULL;
+  }
+  return accelMag;
+}
 
+/**************************************************************************/
+/*!
+    @brief  Reads STATUS, accel and (hybrid mode) mag output registers in
+            one 13 byte burst into accel_raw / mag_raw, the STATUS byte
+            into *status when given
+*/
+/**************************************************************************/
+bool RP_FXOS8700::readRaw(uint8_t *status)
+{
   /* Clear the raw data placeholder */
   accel_raw.x = 0;
   accel_raw.y = 0;
@@ -179,6 +169,104 @@ bool RP_FXOS8700::getEvent(sensors_event_t* accelEvent, sensors_event_t* magEven
   mag_raw.y = 0;
   mag_raw.z = 0;
 
+  /* Read 13 bytes from the sensor in one burst */
+  uint8_t data[13];
+  if (!_i2c.readRegisters(FXOS8700_REGISTER_STATUS | 0x80, data, 13))
+  {
+    return false;
+  }
+
+  decode(data);
+  if (status != NULL)
+  {
+    *status = data[0];
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Unpacks a STATUS .. MOUT_Z_LSB frame into accel_raw / mag_raw
+*/
+/**************************************************************************/
+void RP_FXOS8700::decode(const uint8_t *data)
+{
+  uint8_t axhi = data[1];
+  uint8_t axlo = data[2];
+  uint8_t ayhi = data[3];
+  uint8_t aylo = data[4];
+  uint8_t azhi = data[5];
+  uint8_t azlo = data[6];
+  uint8_t mxhi = data[7];
+  uint8_t mxlo = data[8];
+  uint8_t myhi = data[9];
+  uint8_t mylo = data[10];
+  uint8_t mzhi = data[11];
+  uint8_t mzlo = data[12];
+
+  /* Shift values to create properly formed integers */
+  /* Note, accel data is 14-bit and left-aligned, so we shift two bit right */
+  accel_raw.x = (int16_t)((axhi << 8) | axlo) >> 2;
+  accel_raw.y = (int16_t)((ayhi << 8) | aylo) >> 2;
+  accel_raw.z = (int16_t)((azhi << 8) | azlo) >> 2;
+  mag_raw.x = (int16_t)((mxhi << 8) | mxlo);
+  mag_raw.y = (int16_t)((myhi << 8) | mylo);
+  mag_raw.z = (int16_t)((mzhi << 8) | mzlo);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the most recent sensor event
+*/
+/**************************************************************************/
+bool RP_FXOS8700::getEvent(sensors_event_t* accelEvent, sensors_event_t* magEvent)
+{
+  /* Clear the event */
+  memset(accelEvent, 0, sizeof(sensors_event_t));
+  memset(magEvent, 0, sizeof(sensors_event_t));
+
+  if (!readSample())
+  {
+    return false;
+  }
+
+  getLastEvent(accelEvent, magEvent);
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Burst read for getEvent(): a new sample is on average half
+            an output period old when it is read
+*/
+/**************************************************************************/
+bool RP_FXOS8700::readSample(void)
+{
+  uint32_t readAt = micros();
+  uint8_t  status;
+  if (!readRaw(&status))
+  {
+    return false;
+  }
+  if (status & FXOS8700_STATUS_ZYXDR)
+  {
+    markSampled(readAt - conversionTime() / 2);
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clears both events and fills in the metadata
+*/
+/**************************************************************************/
+void RP_FXOS8700::initEvents(sensors_event_t* accelEvent, sensors_event_t* magEvent)
+{
+  /* Clear the event */
+  memset(accelEvent, 0, sizeof(sensors_event_t));
+  memset(magEvent, 0, sizeof(sensors_event_t));
+
   /* Set the static metadata */
   accelEvent->version   = sizeof(sensors_event_t);
   accelEvent->sensor_id = _accelSensorID;
@@ -188,96 +276,359 @@ bool RP_FXOS8700::getEvent(sensors_event_t* accelEvent, sensors_event_t* magEven
   magEvent->sensor_id = _magSensorID;
   magEvent->type      = SENSOR_TYPE_MAGNETIC_FIELD;
 
-  /* Read 13 bytes from the sensor */
-  myWire.beginTransmission((byte)FXOS8700_ADDRESS);
-  #if ARDUINO >= 100
-    myWire.write(FXOS8700_REGISTER_STATUS | 0x80);
-  #else
-    myWire.send(FXOS8700_REGISTER_STATUS | 0x80);
-  #endif
-  myWire.endTransmission();
-  myWire.requestFrom((byte)FXOS8700_ADDRESS, (byte)13);
-
-  /* ToDo: Check status first! */
-  #if ARDUINO >= 100
-    uint8_t status = myWire.read();
-    uint8_t axhi = myWire.read();
-    uint8_t axlo = myWire.read();
-    uint8_t ayhi = myWire.read();
-    uint8_t aylo = myWire.read();
-    uint8_t azhi = myWire.read();
-    uint8_t azlo = myWire.read();
-    uint8_t mxhi = myWire.read();
-    uint8_t mxlo = myWire.read();
-    uint8_t myhi = myWire.read();
-    uint8_t mylo = myWire.read();
-    uint8_t mzhi = myWire.read();
-    uint8_t mzlo = myWire.read();
-  #else
-    uint8_t status = myWire.receive();
-    uint8_t axhi = myWire.receive();
-    uint8_t axlo = myWire.receive();
-    uint8_t ayhi = myWire.receive();
-    uint8_t aylo = myWire.receive();
-    uint8_t azhi = myWire.receive();
-    uint8_t azlo = myWire.receive();
-    uint8_t mxhi = myWire.receive();
-    uint8_t mxlo = myWire.receive();
-    uint8_t myhi = myWire.receive();
-    uint8_t mylo = myWire.receive();
-    uint8_t mzhi = myWire.receive();
-    uint8_t mzlo = myWire.receive();
-  #endif
-
-  /* Set the timestamps */
-  accelEvent->timestamp = millis();
+  /* Set the timestamps, back dated to when the sample was taken */
+  accelEvent->timestamp = millis() - (micros() - sampleMicros()) / 1000;
   magEvent->timestamp = accelEvent->timestamp;
+}
 
-  /* Shift values to create properly formed integers */
-  /* Note, accel data is 14-bit and left-aligned, so we shift two bit right */
-  accelEvent->acceleration.x = (int16_t)((axhi << 8) | axlo) >> 2;
-  accelEvent->acceleration.y = (int16_t)((ayhi << 8) | aylo) >> 2;
-  accelEvent->acceleration.z = (int16_t)((azhi << 8) | azlo) >> 2;
-  magEvent->magnetic.x = (int16_t)((mxhi << 8) | mxlo);
-  magEvent->magnetic.y = (int16_t)((myhi << 8) | mylo);
-  magEvent->magnetic.z = (int16_t)((mzhi << 8) | mzlo);
-
-  /* Assign raw values in case someone needs them */
-  accel_raw.x = accelEvent->acceleration.x;
-  accel_raw.y = accelEvent->acceleration.y;
-  accel_raw.z = accelEvent->acceleration.z;
-  mag_raw.x = magEvent->magnetic.x;
-  mag_raw.y = magEvent->magnetic.y;
-  mag_raw.z = magEvent->magnetic.z;
+/**************************************************************************/
+/*!
+    @brief  Converts the last read raw values (getEvent() or collect())
+            into sensor events without touching the bus
+*/
+/**************************************************************************/
+void RP_FXOS8700::getLastEvent(sensors_event_t* accelEvent, sensors_event_t* magEvent)
+{
+  initEvents(accelEvent, magEvent);
 
-  /* Convert accel values to m/s^2 */
-  switch (_range) {
-      case (ACCEL_RANGE_2G):
-          accelEvent->acceleration.x *= ACCEL_MG_LSB_2G * SENSORS_GRAVITY_STANDARD;
-          accelEvent->acceleration.y *= ACCEL_MG_LSB_2G * SENSORS_GRAVITY_STANDARD;
-          accelEvent->acceleration.z *= ACCEL_MG_LSB_2G * SENSORS_GRAVITY_STANDARD;
-      break;
-      case (ACCEL_RANGE_4G):
-          accelEvent->acceleration.x *= ACCEL_MG_LSB_4G * SENSORS_GRAVITY_STANDARD;
-          accelEvent->acceleration.y *= ACCEL_MG_LSB_4G * SENSORS_GRAVITY_STANDARD;
-          accelEvent->acceleration.z *= ACCEL_MG_LSB_4G * SENSORS_GRAVITY_STANDARD;
-      break;
-      case (ACCEL_RANGE_8G):
-          accelEvent->acceleration.x *= ACCEL_MG_LSB_8G * SENSORS_GRAVITY_STANDARD;
-          accelEvent->acceleration.y *= ACCEL_MG_LSB_8G * SENSORS_GRAVITY_STANDARD;
-          accelEvent->acceleration.z *= ACCEL_MG_LSB_8G * SENSORS_GRAVITY_STANDARD;
-      break;
-  }
+  accelEvent->acceleration.x = accel_raw.x;
+  accelEvent->acceleration.y = accel_raw.y;
+  accelEvent->acceleration.z = accel_raw.z;
+  magEvent->magnetic.x = mag_raw.x;
+  magEvent->magnetic.y = mag_raw.y;
+  magEvent->magnetic.z = mag_raw.z;
 
+  /* Convert accel values to m/s^2 */
+  float scale = fxosAccelScale(_range) * SENSORS_GRAVITY_STANDARD;
+  accelEvent->acceleration.x *= scale;
+  accelEvent->acceleration.y *= scale;
+  accelEvent->acceleration.z *= scale;
 
   /* Convert mag values to uTesla */
   magEvent->magnetic.x *= MAG_UT_LSB;
   magEvent->magnetic.y *= MAG_UT_LSB;
   magEvent->magnetic.z *= MAG_UT_LSB;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Integer version of getEvent()
+*/
+/**************************************************************************/
+bool RP_FXOS8700::getEventFixed(flexVector32_t* milliG, flexVector32_t* nanoTesla)
+{
+  if (!readSample())
+  {
+    return false;
+  }
+
+  getLastEventFixed(milliG, nanoTesla);
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Last read raw values in milli-g (14 bit: 1000/4096 mg/LSB at
+            2G = 125 >> 9, doubling per range step) and nano-tesla
+            (0.1 uT/LSB = 100 nT)
+*/
+/**************************************************************************/
+void RP_FXOS8700::getLastEventFixed(flexVector32_t* milliG, flexVector32_t* nanoTesla)
+{
+  uint8_t shift = fxosAccelShift(_range);
+
+  milliG->x = flexScale(accel_raw.x, 125, shift);
+  milliG->y = flexScale(accel_raw.y, 125, shift);
+  milliG->z = flexScale(accel_raw.z, 125, shift);
+  nanoTesla->x = (int32_t)mag_raw.x * 100;
+  nanoTesla->y = (int32_t)mag_raw.y * 100;
+  nanoTesla->z = (int32_t)mag_raw.z * 100;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts count raw accel samples to m/s^2, one output array
+            per axis. Same scale as getEvent() at the current range.
+*/
+/**************************************************************************/
+void RP_FXOS8700::convertAccelBatch(const fxos8700RawData_t* raw, uint16_t count,
+                                    float* x, float* y, float* z)
+{
+  flexScaleXYZBatch((const int16_t*)raw, count, fxosAccelScale(_range) * SENSORS_GRAVITY_STANDARD, x, y, z);
+}
 
+/**************************************************************************/
+/*!
+    @brief  Integer version of convertAccelBatch(), milli-g per axis
+*/
+/**************************************************************************/
+void RP_FXOS8700::convertAccelBatchFixed(const fxos8700RawData_t* raw, uint16_t count,
+                                         int32_t* x, int32_t* y, int32_t* z)
+{
+  flexScaleXYZBatchFixed((const int16_t*)raw, count, 125, fxosAccelShift(_range), x, y, z);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts count raw mag samples to uT, one output array per axis
+*/
+/**************************************************************************/
+void RP_FXOS8700::convertMagBatch(const fxos8700RawData_t* raw, uint16_t count,
+                                  float* x, float* y, float* z)
+{
+  flexScaleXYZBatch((const int16_t*)raw, count, MAG_UT_LSB, x, y, z);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Integer version of convertMagBatch(), nano-tesla per axis
+*/
+/**************************************************************************/
+void RP_FXOS8700::convertMagBatchFixed(const fxos8700RawData_t* raw, uint16_t count,
+                                       int32_t* x, int32_t* y, int32_t* z)
+{
+  flexScaleXYZBatchFixed((const int16_t*)raw, count, 100, 0, x, y, z);
+}
+
+/***************************************************************************
+ NON-BLOCKING (FlexAsyncSensor)
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  The sensor is free running (100Hz hybrid after begin), so
+            start() only arms the data ready check
+*/
+/**************************************************************************/
+bool RP_FXOS8700::start(void)
+{
+  markStarted();
   return true;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Single STATUS read, ready when a new accel X/Y/Z set is there
+            (the mag is sampled in the same hybrid cycle)
+*/
+/**************************************************************************/
+flexState_t RP_FXOS8700::poll(void)
+{
+  if (_state != FLEX_BUSY)
+  {
+    return _state;
+  }
+  if (_transport != NULL)
+  {
+    return pollTransport();
+  }
+  uint32_t readAt = micros();
+  byte status = read8(FXOS8700_REGISTER_STATUS);
+  readAt += (micros() - readAt) / 2;   // STATUS is clocked out halfway
+  if (_i2c.lastError() != FLEX_OK)
+  {
+    _state = FLEX_ERROR;
+  }
+  else if (status & FXOS8700_STATUS_ZYXDR)
+  {
+    markDataReady(readAt);
+    _state = FLEX_READY;
+  }
+  else if (overdue(_i2c.timeout()))
+  {
+    /* Free running at 100 Hz, no new sample means the sensor stopped */
+    _i2c.setError(FLEX_ERR_TIMEOUT);
+    _state = FLEX_ERROR;
+  }
+  else
+  {
+    markNotReady(readAt);
+  }
+  return _state;
+}
+
+/**************************************************************************/
+/*!
+    @brief  poll() on a transport: every call without a transfer on the
+            wire submits a 1 byte STATUS read. Once ZYXDR is set the 13
+            byte STATUS .. MOUT burst follows, and its arrival is the new
+            sample.
+*/
+/**************************************************************************/
+flexState_t RP_FXOS8700::pollTransport(void)
+{
+  if (!_transfer.done)
+  {
+    return _state;
+  }
+
+  if (_transferPending)
+  {
+    _transferPending = false;
+    if (_transfer.result != FLEX_OK)
+    {
+      _frameRequested = false;
+      _i2c.setError(_transfer.result);
+      _state = FLEX_ERROR;
+      return _state;
+    }
+    if (_frameRequested)
+    {
+      _frameRequested = false;
+      _state = FLEX_READY;
+      return _state;
+    }
+    if (_frame[0] & FXOS8700_STATUS_ZYXDR)
+    {
+      markDataReady(_submittedAt);
+      if (_transport->read(&_transfer, _i2c.address(), FXOS8700_REGISTER_STATUS | 0x80, _frame, 13))
+      {
+        _transferPending = true;
+        _frameRequested = true;
+      }
+      else
+      {
+        _i2c.setError(FLEX_ERR_ARG);
+        _state = FLEX_ERROR;
+      }
+      return _state;
+    }
+    markNotReady(_submittedAt);
+  }
+
+  /* STATUS is the only byte on the wire, right after the submit */
+  _submittedAt = micros();
+  if (overdue(_i2c.timeout()))
+  {
+    _i2c.setError(FLEX_ERR_TIMEOUT);
+    _state = FLEX_ERROR;
+  }
+  else if (_transport->read(&_transfer, _i2c.address(), FXOS8700_REGISTER_STATUS, _frame, 1))
+  {
+    _transferPending = true;
+  }
+  else
+  {
+    _i2c.setError(FLEX_ERR_ARG);
+    _state = FLEX_ERROR;
+  }
+  return _state;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Burst reads the new sample, see getLastEvent()
+*/
+/**************************************************************************/
+bool RP_FXOS8700::collect(void)
+{
+  if (_state != FLEX_READY)
+  {
+    return false;
+  }
+  if (_transport != NULL)
+  {
+    /* The frame arrived with the transfer that made poll() ready */
+    decode(_frame);
+    _state = FLEX_IDLE;
+    return true;
+  }
+  if (!readRaw())
+  {
+    _state = FLEX_ERROR;
+    return false;
+  }
+  _state = FLEX_IDLE;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  One output data period (100Hz hybrid as configured by begin())
+*/
+/**************************************************************************/
+uint32_t RP_FXOS8700::conversionTime(void)
+{
+  return 10000;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Standby: accel and mag stop sampling, registers are kept.
+            A single CTRL_REG1 write from the shadow.
+*/
+/**************************************************************************/
+bool RP_FXOS8700::sleep(void)
+{
+  return _i2c.update(FXOS_CTRL1_ACTIVE::set(0));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Back to active; the first sample follows powerProfile().
+            wakeMicros later
+*/
+/**************************************************************************/
+bool RP_FXOS8700::wake(void)
+{
+  return _i2c.update(FXOS_CTRL1_ACTIVE::set(1));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Datasheet typical currents in hybrid mode at 100Hz, standby
+            current and the standby to active time (2/ODR + 1 ms)
+*/
+/**************************************************************************/
+flexPowerProfile_t RP_FXOS8700::powerProfile(void)
+{
+  flexPowerProfile_t profile;
+  profile.convertMicroAmps = 240;
+  profile.idleMicroAmps = 240;     // free running
+  profile.sleepMicroAmps = 2;
+  profile.wakeMicros = 2 * conversionTime() + 1000;
+  return profile;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Routes the poll() / collect() reads through an asynchronous
+            transport (NULL goes back to blocking reads on the Wire bus).
+            Transport transfers are not in getStats().
+*/
+/**************************************************************************/
+void RP_FXOS8700::setTransport(FlexI2CTransport *transport)
+{
+  _transport = transport;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Result of the last bus transaction, e.g. why getEvent()
+            returned false
+*/
+/**************************************************************************/
+flexResult_t RP_FXOS8700::lastError(void)
+{
+  return _i2c.lastError();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Bus and wait counters of this sensor, see flexI2CStats_t
+*/
+/**************************************************************************/
+flexI2CStats_t RP_FXOS8700::getStats(void)
+{
+  return _i2c.stats();
+}
+
+void RP_FXOS8700::resetStats(void)
+{
+  _i2c.resetStats();
+}
+
 /**************************************************************************/
 /*!
     @brief  Gets the sensor_t data
@@ -13,6 +13,19 @@
 
   Written by Kevin "KTOWN" Townsend for Adafruit Industries.
   BSD license, all text above must be included in any redistribution
+
+  This modified version (RP_FXOS8700) is used for SERCOM applications (ATSAMDxx)
+
+  Usage:
+  TwoWire sensorTWI(&sercom2, 4, 3);
+
+  RP_FXOS8700 accelmag = RP_FXOS8700(&sensorTWI, 0x8700A, 0x8700B);
+
+  With setTransport() the poll() / collect() path issues its reads
+  through an asynchronous FlexI2CTransport: a 1 byte STATUS read per
+  poll, and the 13 byte burst only once ZYXDR is set. poll() only
+  submits the reads and checks the results, the CPU is free while they
+  are on the wire.
  ****************************************************/
 #ifndef __RPFXOS8700_H__
 #define __RPFXOS8700_H__
@@ -25,12 +38,18 @@
 
 #include <Adafruit_Sensor.h>
 #include <Wire.h>
+#include <FlexI2CDevice.h>
+#include <FlexAsyncSensor.h>
+#include <FlexI2CTransport.h>
+#include <FlexFixed.h>
+#include <FlexConvert.h>
 
 /*=========================================================================
     I2C ADDRESS/BITS AND SETTINGS
     -----------------------------------------------------------------------*/
     #define FXOS8700_ADDRESS           (0x1F)     // 0011111
     #define FXOS8700_ID                (0xC7)     // 1100 0111
+    #define FXOS8700_STATUS_ZYXDR      (0x08)     // new accel X/Y/Z data ready
 /*=========================================================================*/
 
 /*=========================================================================
@@ -65,6 +84,25 @@
     } fxos8700Registers_t;
 /*=========================================================================*/
 
+/*=========================================================================
+    REGISTER FIELDS (see FlexRegister.h)
+    -----------------------------------------------------------------------*/
+    typedef FlexReg<FXOS8700_REGISTER_XYZ_DATA_CFG> FXOS_XYZ_DATA_CFG;
+    typedef FlexReg<FXOS8700_REGISTER_CTRL_REG1>    FXOS_CTRL_REG1;
+    typedef FlexReg<FXOS8700_REGISTER_CTRL_REG2>    FXOS_CTRL_REG2;
+    typedef FlexReg<FXOS8700_REGISTER_MCTRL_REG1>   FXOS_MCTRL_REG1;
+    typedef FlexReg<FXOS8700_REGISTER_MCTRL_REG2>   FXOS_MCTRL_REG2;
+
+    typedef FlexField<FXOS_XYZ_DATA_CFG, 0, 2>  FXOS_XYZ_FS;         // fxos8700AccelRange_t
+    typedef FlexField<FXOS_CTRL_REG1, 0>        FXOS_CTRL1_ACTIVE;   // 0: standby
+    typedef FlexField<FXOS_CTRL_REG1, 2>        FXOS_CTRL1_LNOISE;   // reduced noise, max. 4G
+    typedef FlexField<FXOS_CTRL_REG1, 3, 3>     FXOS_CTRL1_DR;       // 800Hz >> DR (hybrid: half)
+    typedef FlexField<FXOS_CTRL_REG2, 0, 2>     FXOS_CTRL2_MODS;     // 2: high resolution
+    typedef FlexField<FXOS_MCTRL_REG1, 0, 2>    FXOS_MCTRL1_HMS;     // 3: hybrid accel + mag
+    typedef FlexField<FXOS_MCTRL_REG1, 2, 3>    FXOS_MCTRL1_OS;      // mag oversampling
+    typedef FlexField<FXOS_MCTRL_REG2, 5>       FXOS_MCTRL2_AUTOINC; // burst jumps 0x06 -> 0x33
+/*=========================================================================*/
+
 /*=========================================================================
     OPTIONAL SPEED SETTINGS
     -----------------------------------------------------------------------*/
@@ -76,6 +114,31 @@
     } fxos8700AccelRange_t;
 /*=========================================================================*/
 
+/*=========================================================================
+    SCALE PER RANGE
+    -----------------------------------------------------------------------
+    g per LSB of the 14 bit accel data, and the flexScale() shift for
+    milli-g (125 >> 9 at 2G, one less for every range step). Constant
+    expressions when the range is, see FXOS8700<RANGE>.
+    -----------------------------------------------------------------------*/
+    #define ACCEL_MG_LSB_2G (0.000244F)
+    #define ACCEL_MG_LSB_4G (0.000488F)
+    #define ACCEL_MG_LSB_8G (0.000976F)
+    #define MAG_UT_LSB      (0.1F)
+
+    constexpr float fxosAccelScale(fxos8700AccelRange_t range)
+    {
+      return (range == ACCEL_RANGE_4G) ? ACCEL_MG_LSB_4G :
+             (range == ACCEL_RANGE_8G) ? ACCEL_MG_LSB_8G : ACCEL_MG_LSB_2G;
+    }
+
+    constexpr uint8_t fxosAccelShift(fxos8700AccelRange_t range)
+    {
+      return (range == ACCEL_RANGE_4G) ? 8 :
+             (range == ACCEL_RANGE_8G) ? 7 : 9;
+    }
+/*=========================================================================*/
+
 /*=========================================================================
     RAW GYROSCOPE DATA TYPE
     -----------------------------------------------------------------------*/
@@ -87,27 +150,157 @@
     } fxos8700RawData_t;
 /*=========================================================================*/
 
-class RP_FXOS8700 : public Adafruit_Sensor
+class RP_FXOS8700 : public Adafruit_Sensor, public FlexAsyncSensor
 {
   public:
-    RP_FXOS8700(int32_t accelSensorID = -1, int32_t magSensorID = -1);
+    RP_FXOS8700(TwoWire *wire, int32_t accelSensorID = -1, int32_t magSensorID = -1);
+    TwoWire *_wire;
 
     bool begin           ( fxos8700AccelRange_t rng = ACCEL_RANGE_2G );
+    static FlexAsyncSensor *create ( TwoWire *wire, uint8_t address );  /* FlexRegistry factory */
     bool getEvent        ( sensors_event_t* accel );
     void getSensor       ( sensor_t* accel );
     bool getEvent        ( sensors_event_t* accel, sensors_event_t* mag );
     void getSensor       ( sensor_t* accel, sensor_t* mag );
+    void getLastEvent    ( sensors_event_t* accel, sensors_event_t* mag );
+    /* Integer versions, no float math: milli-g and nano-tesla */
+    bool getEventFixed     ( flexVector32_t* milliG, flexVector32_t* nanoTesla );
+    void getLastEventFixed ( flexVector32_t* milliG, flexVector32_t* nanoTesla );
+
+    /* Whole sample buffers (FIFO drains) at once, see FlexConvert.h */
+    void convertAccelBatch      ( const fxos8700RawData_t* raw, uint16_t count,
+                                  float* x, float* y, float* z );         /* m/s^2 */
+    void convertAccelBatchFixed ( const fxos8700RawData_t* raw, uint16_t count,
+                                  int32_t* x, int32_t* y, int32_t* z );   /* milli-g */
+    void convertMagBatch        ( const fxos8700RawData_t* raw, uint16_t count,
+                                  float* x, float* y, float* z );         /* uT */
+    void convertMagBatchFixed   ( const fxos8700RawData_t* raw, uint16_t count,
+                                  int32_t* x, int32_t* y, int32_t* z );   /* nT */
+
+    /* Non-blocking data ready based reads (see FlexAsyncSensor) */
+    bool        start          ( void );
+    flexState_t poll           ( void );
+    bool        collect        ( void );
+    uint32_t    conversionTime ( void );
+    void        setTransport   ( FlexI2CTransport *transport );  // NULL: blocking
+
+    /* Standby between samples (see FlexScheduler::setDutyCycle()) */
+    bool        sleep          ( void );
+    bool        wake           ( void );
+    flexPowerProfile_t powerProfile ( void );
+
+    flexResult_t lastError    ( void );
+    flexI2CStats_t getStats   ( void );
+    void        resetStats     ( void );
 
     fxos8700RawData_t accel_raw; /* Raw values from last sensor read */
     fxos8700RawData_t mag_raw;   /* Raw values from last sensor read */
 
+  protected:
+    bool        readRaw    ( uint8_t *status = NULL );
+    bool        readSample ( void );                 /* readRaw(), stamps new samples */
+    void        initEvents ( sensors_event_t* accel, sensors_event_t* mag );
+
   private:
     void        write8  ( byte reg, byte value );
     byte        read8   ( byte reg );
+    void        decode  ( const uint8_t *data );
+    flexState_t pollTransport ( void );
 
+    FlexI2CDevice        _i2c;
+    FlexI2CTransport    *_transport;
+    flexI2CTransfer_t    _transfer;
+    bool                 _transferPending;
+    bool                 _frameRequested;  /* the pending transfer is the whole frame */
+    uint32_t             _submittedAt;
+    uint8_t              _frame[13];   /* STATUS .. MOUT_Z_LSB, async reads */
     fxos8700AccelRange_t _range;
     int32_t              _accelSensorID;
     int32_t              _magSensorID;
 };
 
+/**************************************************************************/
+/*!
+    RP_FXOS8700 with the accel range fixed at compile time:
+
+      FXOS8700<ACCEL_RANGE_4G> accelmag(&sensorTWI);
+      accelmag.begin();
+
+    The conversions use constant scale factors instead of switching on
+    the range for every sample; everything else is RP_FXOS8700.
+*/
+/**************************************************************************/
+template <fxos8700AccelRange_t RANGE>
+class FXOS8700 : public RP_FXOS8700
+{
+  public:
+    FXOS8700(TwoWire *wire, int32_t accelSensorID = -1, int32_t magSensorID = -1)
+      : RP_FXOS8700(wire, accelSensorID, magSensorID) { }
+
+    bool begin ( void ) { return RP_FXOS8700::begin(RANGE); }
+
+    /* m/s^2 per LSB, and the flexScale() shift of 125 for milli-g */
+    static constexpr float   accelScale ( void ) { return fxosAccelScale(RANGE) * SENSORS_GRAVITY_STANDARD; }
+    static constexpr uint8_t milliGShift ( void ) { return fxosAccelShift(RANGE); }
+
+    bool getEvent ( sensors_event_t* accel )
+    {
+      sensors_event_t mag;
+      return getEvent(accel, &mag);
+    }
+
+    bool getEvent ( sensors_event_t* accel, sensors_event_t* mag )
+    {
+      memset(accel, 0, sizeof(sensors_event_t));
+      memset(mag, 0, sizeof(sensors_event_t));
+      if (!readSample())
+      {
+        return false;
+      }
+      getLastEvent(accel, mag);
+      return true;
+    }
+
+    void getLastEvent ( sensors_event_t* accel, sensors_event_t* mag )
+    {
+      initEvents(accel, mag);
+      accel->acceleration.x = accel_raw.x * accelScale();
+      accel->acceleration.y = accel_raw.y * accelScale();
+      accel->acceleration.z = accel_raw.z * accelScale();
+      mag->magnetic.x = mag_raw.x * MAG_UT_LSB;
+      mag->magnetic.y = mag_raw.y * MAG_UT_LSB;
+      mag->magnetic.z = mag_raw.z * MAG_UT_LSB;
+    }
+
+    bool getEventFixed ( flexVector32_t* milliG, flexVector32_t* nanoTesla )
+    {
+      if (!readSample())
+      {
+        return false;
+      }
+      getLastEventFixed(milliG, nanoTesla);
+      return true;
+    }
+
+    void getLastEventFixed ( flexVector32_t* milliG, flexVector32_t* nanoTesla )
+    {
+      milliG->x = flexScale(accel_raw.x, 125, milliGShift());
+      milliG->y = flexScale(accel_raw.y, 125, milliGShift());
+      milliG->z = flexScale(accel_raw.z, 125, milliGShift());
+      nanoTesla->x = (int32_t)mag_raw.x * 100;
+      nanoTesla->y = (int32_t)mag_raw.y * 100;
+      nanoTesla->z = (int32_t)mag_raw.z * 100;
+    }
+
+    void convertAccelBatch ( const fxos8700RawData_t* raw, uint16_t count, float* x, float* y, float* z )
+    {
+      flexScaleXYZBatch((const int16_t*)raw, count, accelScale(), x, y, z);
+    }
+
+    void convertAccelBatchFixed ( const fxos8700RawData_t* raw, uint16_t count, int32_t* x, int32_t* y, int32_t* z )
+    {
+      flexScaleXYZBatchFixed((const int16_t*)raw, count, 125, milliGShift(), x, y, z);
+    }
+};
+
 #endif
@@ -45,10 +45,16 @@
 #include "SparkFunMPL3115A2_Flex.h"
 
 
-MPL3115A2_Flex::MPL3115A2_Flex(TwoWire *wire)
+MPL3115A2_Flex::MPL3115A2_Flex(TwoWire *wire) : _i2c(wire, MPL3115A2_ADDRESS)
 {
    this->_wire = wire;
   //Set initial values for private vars
+  _altimeterMode = false;
+  _oversample = 0;
+  _oneShotAt = 0;
+  _oneShotRunning = false;
+  _wakeActive = false;
+  memset(_lastData, 0, sizeof(_lastData));
 }
 
 //Begin
@@ -60,12 +66,29 @@ void MPL3115A2_Flex::begin(void)
   init(); // for convenience...
 }
 
+//Factory for FlexRegistry, the MPL3115A2 has a fixed address
+FlexAsyncSensor *MPL3115A2_Flex::create(TwoWire *wire, uint8_t address)
+{
+  (void)address;
+  MPL3115A2_Flex *mpl = new MPL3115A2_Flex(wire);
+  if (!mpl->init())
+  {
+    delete mpl;
+    return NULL;
+  }
+  return mpl;
+}
+
 boolean MPL3115A2_Flex::init()
 {
+  _i2c.invalidateAll(); //Sensor may have been reset since the last init
   if (IIC_Read(WHO_AM_I) == 196) {
     //pressureSensor.begin();
-    setModeBarometer(); // Measure pressure in Pascals from 20 to 110 kPa
-    setOversampleRate(7); // Set Oversample to the recommended 128
+    //Barometer mode (Pascals from 20 to 110 kPa) and the recommended
+    //oversample of 128 go out as a single CTRL_REG1 write
+    _altimeterMode = false;
+    _oversample = 7;
+    updateCtrlReg1(MPL_CTRL1_ALT::set(0) | MPL_CTRL1_OS::set(_oversample));
     enableEventFlags(); // Enable all three pressure and temp event flags
 
     return true;
@@ -75,32 +98,37 @@ boolean MPL3115A2_Flex::init()
 
 
 //Returns the number of meters above sea level
-//Returns -1 if no new data is available
+//Returns -999 if no new data is available, see readAltitude(float *) for the reason
 float MPL3115A2_Flex::readAltitude()
 {
-	toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+	float altitude;
+	if (readAltitude(&altitude) != FLEX_OK) return(-999);
+	return(altitude);
+}
 
-	//Wait for PDR bit, indicates we have new pressure data
-	int counter = 0;
-	while( (IIC_Read(STATUS) & (1<<1)) == 0)
-	{
-		if(++counter > 600) return(-999); //Error out after max of 512ms for a read
-		delay(1);
-	}
+//Same as above, *meters is only written on FLEX_OK
+flexResult_t MPL3115A2_Flex::readAltitude(float *meters)
+{
+	byte data[3];
+	flexResult_t result = readAltitudeData(data);
 
-	// Read pressure registers
-	_wire->beginTransmission(MPL3115A2_ADDRESS);
-	_wire->write(OUT_P_MSB);  // Address of data to get
-	_wire->endTransmission(false); // Send data to I2C dev with option for a repeated start. THIS IS NECESSARY and not supported before Arduino V1.0.1!
-	if (_wire->requestFrom(MPL3115A2_ADDRESS, 3) != 3) { // Request three bytes
-		return -999;
-	}
+	if (result == FLEX_OK) *meters = convertAltitude(data[0], data[1], data[2]);
+	return(result);
+}
 
-	byte msb, csb, lsb;
-	msb = _wire->read();
-	csb = _wire->read();
-	lsb = _wire->read();
+//Same as above in centimeters, no float math
+flexResult_t MPL3115A2_Flex::readAltitudeCm(int32_t *centimeters)
+{
+	byte data[3];
+	flexResult_t result = readAltitudeData(data);
+
+	if (result == FLEX_OK) *centimeters = convertAltitudeCm(data[0], data[1], data[2]);
+	return(result);
+}
 
+//Converts the OUT_P registers in altimeter mode to meters
+float MPL3115A2_Flex::convertAltitude(byte msb, byte csb, byte lsb)
+{
 	// The least significant bytes l_altitude and l_temp are 4-bit,
 	// fractional values, so you must cast the calulation in (float),
 	// shift the value over 4 spots to the right and divide by 16 (since
@@ -120,35 +148,37 @@ float MPL3115A2_Flex::readAltitudeFt()
 
 //Reads the current pressure in Pa
 //Unit must be set in barometric pressure mode
-//Returns -1 if no new data is available
+//Returns -999 if no new data is available, see readPressure(float *) for the reason
 float MPL3115A2_Flex::readPressure()
 {
-	//Check PDR bit, if it's not set then toggle OST
-	if(IIC_Read(STATUS) & (1<<2) == 0) toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+	float pressure;
+	if (readPressure(&pressure) != FLEX_OK) return(-999);
+	return(pressure);
+}
 
-	//Wait for PDR bit, indicates we have new pressure data
-	int counter = 0;
-	while(IIC_Read(STATUS) & (1<<2) == 0)
-	{
-		if(++counter > 600) return(-999); //Error out after max of 512ms for a read
-		delay(1);
-	}
+//Same as above, *pascal is only written on FLEX_OK
+flexResult_t MPL3115A2_Flex::readPressure(float *pascal)
+{
+	byte data[3];
+	flexResult_t result = readPressureData(data);
 
-	// Read pressure registers
-	_wire->beginTransmission(MPL3115A2_ADDRESS);
-	_wire->write(OUT_P_MSB);  // Address of data to get
-	_wire->endTransmission(false); // Send data to I2C dev with option for a repeated start. THIS IS NECESSARY and not supported before Arduino V1.0.1!
-	if (_wire->requestFrom(MPL3115A2_ADDRESS, 3) != 3) { // Request three bytes
-		return -999;
-	}
+	if (result == FLEX_OK) *pascal = convertPressure(data[0], data[1], data[2]);
+	return(result);
+}
 
-	byte msb, csb, lsb;
-	msb = _wire->read();
-	csb = _wire->read();
-	lsb = _wire->read();
+//Same as above in Pa * 4 (0.25 Pa resolution), no float math
+flexResult_t MPL3115A2_Flex::readPressureX4(uint32_t *quarterPascal)
+{
+	byte data[3];
+	flexResult_t result = readPressureData(data);
 
-	toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+	if (result == FLEX_OK) *quarterPascal = convertPressureX4(data[0], data[1], data[2]);
+	return(result);
+}
 
+//Converts the OUT_P registers in barometer mode to Pa
+float MPL3115A2_Flex::convertPressure(byte msb, byte csb, byte lsb)
+{
 	// Pressure comes back as a left shifted 20 bit number
 	long pressure_whole = (long)msb<<16 | (long)csb<<8 | (long)lsb;
 	pressure_whole >>= 6; //Pressure is an 18 bit number with 2 bits of decimal. Get rid of decimal portion.
@@ -162,32 +192,68 @@ float MPL3115A2_Flex::readPressure()
 	return(pressure);
 }
 
+//Returns -999 if no new data is available, see readTemp(float *) for the reason
 float MPL3115A2_Flex::readTemp()
 {
-	if(IIC_Read(STATUS) & (1<<1) == 0) toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+	float temperature;
+	if (readTemp(&temperature) != FLEX_OK) return(-999);
+	return(temperature);
+}
 
-	//Wait for TDR bit, indicates we have new temp data
-	int counter = 0;
-	while( (IIC_Read(STATUS) & (1<<1)) == 0)
-	{
-		if(++counter > 600) return(-999); //Error out after max of 512ms for a read
-		delay(1);
-	}
+//Same as above, *celsius is only written on FLEX_OK
+flexResult_t MPL3115A2_Flex::readTemp(float *celsius)
+{
+	byte data[2];
+	flexResult_t result = readTempData(data);
 
-	// Read temperature registers
-	_wire->beginTransmission(MPL3115A2_ADDRESS);
-	_wire->write(OUT_T_MSB);  // Address of data to get
-	_wire->endTransmission(false); // Send data to I2C dev with option for a repeated start. THIS IS NECESSARY and not supported before Arduino V1.0.1!
-	if (_wire->requestFrom(MPL3115A2_ADDRESS, 2) != 2) { // Request two bytes
-		return -999;
-	}
+	if (result == FLEX_OK) *celsius = convertTemp(data[0], data[1]);
+	return(result);
+}
 
-	byte msb, lsb;
-	msb = _wire->read();
-	lsb = _wire->read();
+//Same as above in centi-degrees Celsius, no float math
+flexResult_t MPL3115A2_Flex::readTempCenti(int16_t *centiCelsius)
+{
+	byte data[2];
+	flexResult_t result = readTempData(data);
 
-	toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+	if (result == FLEX_OK) *centiCelsius = convertTempCenti(data[0], data[1]);
+	return(result);
+}
 
+//Sleeps until the conversion started by the last toggleOneShot() is due,
+//then polls STATUS every millisecond until one of the bits in mask is set.
+//Gives up with FLEX_ERR_TIMEOUT once the conversion for the current
+//oversample rate is overdue by more than the device timeout.
+flexResult_t MPL3115A2_Flex::waitForData(byte mask)
+{
+	uint32_t elapsed = micros() - _oneShotAt;
+	if (elapsed < conversionTime()) _i2c.waitMillis((conversionTime() - elapsed + 999) / 1000);
+
+	uint32_t deadline = _i2c.deadline(0);
+	uint32_t waitStart = _i2c.waitBegin();
+	flexResult_t result = FLEX_OK;
+
+	for (;;)
+	{
+		byte status = IIC_Read(STATUS);
+		if (_i2c.lastError() != FLEX_OK) {
+			result = _i2c.lastError();
+			break;
+		}
+		if (status & mask) break;
+		if (_i2c.expired(deadline)) {
+			result = FLEX_ERR_TIMEOUT;
+			break;
+		}
+		delay(1);
+	}
+	_i2c.waitEnd(waitStart);
+	return(result);
+}
+
+//Converts the OUT_T registers to degrees Celsius
+float MPL3115A2_Flex::convertTemp(byte msb, byte lsb)
+{
     //Negative temperature fix by D.D.G.
 	word foo = 0;
     bool negSign = false;
@@ -214,6 +280,112 @@ float MPL3115A2_Flex::readTemp()
 	return(temperature);
 }
 
+//Integer conversions. OUT_P is Q18.2 Pa (barometer) or signed Q16.4 m
+//(altimeter), OUT_T signed Q8.4 degrees, all left aligned in the registers.
+uint32_t MPL3115A2_Flex::convertPressureX4(byte msb, byte csb, byte lsb)
+{
+	return(pressureWord(msb, csb, lsb) >> 4);
+}
+
+//Packs the three OUT_P registers into one word for the batch conversions
+uint32_t MPL3115A2_Flex::pressureWord(byte msb, byte csb, byte lsb)
+{
+	return((uint32_t)msb<<16 | (uint32_t)csb<<8 | lsb);
+}
+
+//Converts count barometer words to Pa in one loop, same values as readPressure()
+void MPL3115A2_Flex::convertPressureBatch(const uint32_t *words, uint16_t count, float *pascal)
+{
+	flexPressureBatch(words, count, pascal);
+}
+
+//Same as above in Pa * 4
+void MPL3115A2_Flex::convertPressureBatchX4(const uint32_t *words, uint16_t count, uint32_t *quarterPascal)
+{
+	flexPressureBatchX4(words, count, quarterPascal);
+}
+
+int32_t MPL3115A2_Flex::convertAltitudeCm(byte msb, byte csb, byte lsb)
+{
+	int32_t sixteenths = ((int32_t)(int8_t)msb<<16 | (int32_t)csb<<8 | lsb) >> 4;
+	return(flexScale(sixteenths, 25, 2)); // * 100 / 16
+}
+
+int16_t MPL3115A2_Flex::convertTempCenti(byte msb, byte lsb)
+{
+	int16_t sixteenths = (int16_t)((uint16_t)msb<<8 | lsb) >> 4;
+	return((int16_t)flexScale(sixteenths, 25, 2)); // * 100 / 16
+}
+
+//Bus part of readAltitude: new conversion, then the output registers
+flexResult_t MPL3115A2_Flex::readAltitudeData(byte *data)
+{
+	toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+
+	//Wait for PDR bit, indicates we have new pressure data
+	flexResult_t result = waitForData(1<<1);
+	if (result != FLEX_OK) return(result);
+
+	// Read pressure registers (burst, repeated start)
+	if (!_i2c.readRegisters(OUT_P_MSB, data, 3)) { // Request three bytes
+		return(_i2c.lastError());
+	}
+	markOneShotSample();
+
+	return(FLEX_OK);
+}
+
+//Bus part of readPressure: new conversion, then the output registers
+flexResult_t MPL3115A2_Flex::readPressureData(byte *data)
+{
+	//Check PDR bit, if it's not set then toggle OST
+	byte status = IIC_Read(STATUS);
+	if (_i2c.lastError() != FLEX_OK) return(_i2c.lastError());
+	if ((status & (1<<2)) == 0)
+	{
+		toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+
+		//Wait for PDR bit, indicates we have new pressure data
+		flexResult_t result = waitForData(1<<2);
+		if (result != FLEX_OK) return(result);
+	}
+
+	// Read pressure registers (burst, repeated start)
+	if (!_i2c.readRegisters(OUT_P_MSB, data, 3)) { // Request three bytes
+		return(_i2c.lastError());
+	}
+	markOneShotSample(); //Before the toggle below starts the next one
+
+	toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+
+	return(FLEX_OK);
+}
+
+//Bus part of readTemp: new conversion, then the output registers
+flexResult_t MPL3115A2_Flex::readTempData(byte *data)
+{
+	byte status = IIC_Read(STATUS);
+	if (_i2c.lastError() != FLEX_OK) return(_i2c.lastError());
+	if ((status & (1<<1)) == 0)
+	{
+		toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+
+		//Wait for TDR bit, indicates we have new temp data
+		flexResult_t result = waitForData(1<<1);
+		if (result != FLEX_OK) return(result);
+	}
+
+	// Read temperature registers (burst, repeated start)
+	if (!_i2c.readRegisters(OUT_T_MSB, data, 2)) { // Request two bytes
+		return(_i2c.lastError());
+	}
+	markOneShotSample(); //Before the toggle below starts the next one
+
+	toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+
+	return(FLEX_OK);
+}
+
 //Give me temperature in fahrenheit!
 float MPL3115A2_Flex::readTempF()
 {
@@ -224,36 +396,30 @@ float MPL3115A2_Flex::readTempF()
 //CTRL_REG1, ALT bit
 void MPL3115A2_Flex::setModeBarometer()
 {
-  byte tempSetting = IIC_Read(CTRL_REG1); //Read current settings
-  tempSetting &= ~(1<<7); //Clear ALT bit
-  IIC_Write(CTRL_REG1, tempSetting);
+  updateCtrlReg1(MPL_CTRL1_ALT::set(0)); //Clear ALT bit
+  _altimeterMode = false;
 }
 
 //Sets the mode to Altimeter
 //CTRL_REG1, ALT bit
 void MPL3115A2_Flex::setModeAltimeter()
 {
-  byte tempSetting = IIC_Read(CTRL_REG1); //Read current settings
-  tempSetting |= (1<<7); //Set ALT bit
-  IIC_Write(CTRL_REG1, tempSetting);
+  updateCtrlReg1(MPL_CTRL1_ALT::set(1)); //Set ALT bit
+  _altimeterMode = true;
 }
 
 //Puts the sensor in standby mode
 //This is needed so that we can modify the major control registers
 void MPL3115A2_Flex::setModeStandby()
 {
-  byte tempSetting = IIC_Read(CTRL_REG1); //Read current settings
-  tempSetting &= ~(1<<0); //Clear SBYB bit for Standby mode
-  IIC_Write(CTRL_REG1, tempSetting);
+  updateCtrlReg1(MPL_CTRL1_SBYB::set(0)); //Clear SBYB bit for Standby mode
 }
 
 //Puts the sensor in active mode
 //This is needed so that we can modify the major control registers
 void MPL3115A2_Flex::setModeActive()
 {
-  byte tempSetting = IIC_Read(CTRL_REG1); //Read current settings
-  tempSetting |= (1<<0); //Set SBYB bit for Active mode
-  IIC_Write(CTRL_REG1, tempSetting);
+  updateCtrlReg1(MPL_CTRL1_SBYB::set(1)); //Set SBYB bit for Active mode
 }
 
 //Call with a rate from 0 to 7. See page 33 for table of ratios.
@@ -262,52 +428,208 @@ void MPL3115A2_Flex::setModeActive()
 //the time between data samples.
 void MPL3115A2_Flex::setOversampleRate(byte sampleRate)
 {
-  if(sampleRate > 7) sampleRate = 7; //OS cannot be larger than 0b.0111
-  sampleRate <<= 3; //Align it for the CTRL_REG1 register
-
-  byte tempSetting = IIC_Read(CTRL_REG1); //Read current settings
-  tempSetting &= B11000111; //Clear out old OS bits
-  tempSetting |= sampleRate; //Mask in new OS bits
-  IIC_Write(CTRL_REG1, tempSetting);
+  if(sampleRate > MPL_CTRL1_OS::limit()) sampleRate = MPL_CTRL1_OS::limit(); //OS cannot be larger than 0b.0111
+  _oversample = sampleRate;
+  updateCtrlReg1(MPL_CTRL1_OS::set(sampleRate)); //Shift and mask come from the field
 }
 
 //Enables the pressure and temp measurement event flags so that we can
 //test against them. This is recommended in datasheet during setup.
 void MPL3115A2_Flex::enableEventFlags()
 {
-  IIC_Write(PT_DATA_CFG, 0x07); // Enable all three pressure and temp event flags
+  FlexBits<MPL_PT_DATA_CFG> flags = MPL_PT_DREM::set(1) | MPL_PT_PDEFE::set(1) | MPL_PT_TDEFE::set(1);
+  IIC_Write(PT_DATA_CFG, flags.bits); // Enable all three pressure and temp event flags
 }
 
 //Clears then sets the OST bit which causes the sensor to immediately take another reading
 //Needed to sample faster than 1Hz
+//Both writes come straight from the CTRL_REG1 shadow, no reads on the bus
 void MPL3115A2_Flex::toggleOneShot(void)
 {
-  byte tempSetting = IIC_Read(CTRL_REG1); //Read current settings
-  tempSetting &= ~(1<<1); //Clear OST bit
-  IIC_Write(CTRL_REG1, tempSetting);
+  byte tempSetting = readCtrlReg1(); //Current settings, OST already clear
+  _i2c.writeShadow8(CTRL_REG1, tempSetting);
+
+  IIC_Write(CTRL_REG1, MPL_CTRL1_OST::set(1).apply(tempSetting)); //Not shadowed, OST clears itself
+
+  //The conversion starts with this write, unless one is still running:
+  //the sensor ignores OST until that one is done
+  if (!_oneShotRunning || micros() - _oneShotAt >= conversionTime()) _oneShotAt = micros();
+  _oneShotRunning = true;
+}
+
+//The oversampled conversion averages over conversionTime(), the sample
+//it produces is taken as the middle of it
+void MPL3115A2_Flex::markOneShotSample()
+{
+  markSampled(_oneShotAt + conversionTime() / 2);
+  _oneShotRunning = false;
+}
+
+//CTRL_REG1 as last written by us (read from the sensor only the first
+//time). The OST bit clears itself when a conversion completes, so it is
+//never taken from the shadow.
+byte MPL3115A2_Flex::readCtrlReg1()
+{
+  return MPL_CTRL1_OST::set(0).apply(_i2c.readShadow8(CTRL_REG1));
+}
+
+//Changes the fields in bits, the rest of CTRL_REG1 comes from the shadow.
+//Any number of fields cost one write, or none when nothing changes.
+//OST is cleared along with them, so a set OST read back from the sensor
+//on a shadow miss never starts a conversion by accident.
+void MPL3115A2_Flex::updateCtrlReg1(FlexBits<MPL_CTRL_REG1> bits)
+{
+  _i2c.update(bits | MPL_CTRL1_OST::set(0));
+}
+
+//Forget the shadowed control registers, call this when the sensor was
+//reset or reconfigured behind the library's back
+void MPL3115A2_Flex::invalidateCache()
+{
+  _i2c.invalidateAll();
+}
+
+
+//Non-blocking measurement (see FlexAsyncSensor)
+//start() sets OST and returns, poll() only reads STATUS once the
+//oversample dependent conversion time has passed, collect() reads
+//pressure (or altitude) and temperature in a single 5 byte burst.
+bool MPL3115A2_Flex::start()
+{
+  toggleOneShot(); //Toggle the OST bit causing the sensor to immediately take another reading
+  markStarted();
+  return true;
+}
+
+flexState_t MPL3115A2_Flex::poll()
+{
+  if (_state != FLEX_BUSY) return _state;
+  if (!elapsedSinceStart(conversionTime())) return FLEX_BUSY;
+
+  //Check PDR bit, indicates we have new pressure / altitude data
+  byte status = IIC_Read(STATUS);
+  if (_i2c.lastError() != FLEX_OK) _state = FLEX_ERROR;
+  else if (status & (1<<2)) _state = FLEX_READY;
+  else if (overdue(_i2c.timeout())) {
+    _i2c.setError(FLEX_ERR_TIMEOUT);
+    _state = FLEX_ERROR;
+  }
+  return _state;
+}
+
+bool MPL3115A2_Flex::collect()
+{
+  if (_state != FLEX_READY) return false;
+
+  // Read OUT_P_MSB .. OUT_T_LSB in one go (adjacent, a single burst)
+  byte data[flexBlockBytes<MPL_OUT_P, MPL_OUT_T>()];
+  if (!_i2c.readBlock<MPL_OUT_P, MPL_OUT_T>(data)) {
+    _state = FLEX_ERROR;
+    return false;
+  }
+
+  memcpy(_lastData, data, sizeof(_lastData)); // converted when asked for
+  markOneShotSample();
+
+  _state = FLEX_IDLE;
+  return true;
+}
+
+//Max. conversion time for the current oversample rate (datasheet:
+//6ms at OS=0 up to 512ms at OS=7, roughly 2ms + 4ms * 2^OS)
+uint32_t MPL3115A2_Flex::conversionTime()
+{
+  return ((uint32_t)4000 << _oversample) + 2000;
+}
+
+//Standby between samples. One shot conversions (start()) run from
+//standby too, so only a sensor put in active mode is actually parked;
+//with the CTRL_REG1 shadow an unchanged standby costs no bus traffic.
+bool MPL3115A2_Flex::sleep()
+{
+  _wakeActive = MPL_CTRL1_SBYB::get(readCtrlReg1());
+  setModeStandby();
+  return (_i2c.lastError() == FLEX_OK);
+}
+
+bool MPL3115A2_Flex::wake()
+{
+  if (!_wakeActive) return true; //Was in standby already
+  setModeActive();
+  return (_i2c.lastError() == FLEX_OK);
+}
+
+//Datasheet typical currents: some 265uA average at OS=7 and one sample
+//per second, i.e. about 500uA while converting, 2uA in standby. Active
+//mode samples by itself, standby only converts on OST.
+flexPowerProfile_t MPL3115A2_Flex::powerProfile()
+{
+  flexPowerProfile_t profile;
+  profile.convertMicroAmps = 500;
+  profile.idleMicroAmps = MPL_CTRL1_SBYB::get(readCtrlReg1()) ? 265 : 2;
+  profile.sleepMicroAmps = 2;
+  profile.wakeMicros = 0;
+  return profile;
+}
+
+//Values of the last collect(), pressure and altitude are 0 in the other mode
+float MPL3115A2_Flex::lastPressure()
+{
+  return _altimeterMode ? 0 : convertPressure(_lastData[0], _lastData[1], _lastData[2]);
+}
+
+float MPL3115A2_Flex::lastAltitude()
+{
+  return _altimeterMode ? convertAltitude(_lastData[0], _lastData[1], _lastData[2]) : 0;
+}
 
-  tempSetting = IIC_Read(CTRL_REG1); //Read current settings to be safe
-  tempSetting |= (1<<1); //Set OST bit
-  IIC_Write(CTRL_REG1, tempSetting);
+float MPL3115A2_Flex::lastTemp()
+{
+  return convertTemp(_lastData[3], _lastData[4]);
 }
 
+uint32_t MPL3115A2_Flex::lastPressureX4()
+{
+  return _altimeterMode ? 0 : convertPressureX4(_lastData[0], _lastData[1], _lastData[2]);
+}
+
+int32_t MPL3115A2_Flex::lastAltitudeCm()
+{
+  return _altimeterMode ? convertAltitudeCm(_lastData[0], _lastData[1], _lastData[2]) : 0;
+}
+
+int16_t MPL3115A2_Flex::lastTempCenti()
+{
+  return convertTempCenti(_lastData[3], _lastData[4]);
+}
 
 // These are the two I2C functions in this sketch.
+// Both go through the shared Flex transport (repeated start on reads).
 byte MPL3115A2_Flex::IIC_Read(byte regAddr)
 {
   // This function reads one byte over IIC
-  _wire->beginTransmission(MPL3115A2_ADDRESS);
-  _wire->write(regAddr);  // Address of CTRL_REG1
-  _wire->endTransmission(false); // Send data to I2C dev with option for a repeated start. THIS IS NECESSARY and not supported before Arduino V1.0.1!
-  _wire->requestFrom(MPL3115A2_ADDRESS, 1); // Request the data...
-  return _wire->read();
+  return _i2c.read8(regAddr);
 }
 
 void MPL3115A2_Flex::IIC_Write(byte regAddr, byte value)
 {
-  // This function writes one byto over IIC
-  _wire->beginTransmission(MPL3115A2_ADDRESS);
-  _wire->write(regAddr);
-  _wire->write(value);
-  _wire->endTransmission(true);
+  // This function writes one byte over IIC
+  _i2c.write8(regAddr, value);
+}
+
+//Result of the last bus transaction or wait, see flexResult_t
+flexResult_t MPL3115A2_Flex::lastError()
+{
+	return _i2c.lastError();
+}
+
+//Bus and wait counters of this sensor, see flexI2CStats_t
+flexI2CStats_t MPL3115A2_Flex::getStats()
+{
+	return _i2c.stats();
+}
+
+void MPL3115A2_Flex::resetStats()
+{
+	_i2c.resetStats();
 }
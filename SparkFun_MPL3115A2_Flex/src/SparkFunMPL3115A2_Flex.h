@@ -27,6 +27,10 @@
 #endif
 
 #include <Wire.h>
+#include <FlexI2CDevice.h>
+#include <FlexAsyncSensor.h>
+#include <FlexFixed.h>
+#include <FlexConvert.h>
 
 #define MPL3115A2_ADDRESS 0x60 // Unshifted 7-bit I2C address for sensor
 
@@ -77,7 +81,21 @@
 #define OFF_T      0x2C
 #define OFF_H      0x2D
 
-class MPL3115A2_Flex {
+// Typed registers and fields (see FlexRegister.h)
+typedef FlexReg<OUT_P_MSB, 3>  MPL_OUT_P;   // OUT_P_MSB .. OUT_P_LSB
+typedef FlexReg<OUT_T_MSB, 2>  MPL_OUT_T;   // OUT_T_MSB .. OUT_T_LSB
+typedef FlexReg<PT_DATA_CFG>   MPL_PT_DATA_CFG;
+typedef FlexReg<CTRL_REG1>     MPL_CTRL_REG1;
+
+typedef FlexField<MPL_PT_DATA_CFG, 0> MPL_PT_TDEFE; // temperature event flag
+typedef FlexField<MPL_PT_DATA_CFG, 1> MPL_PT_PDEFE; // pressure / altitude event flag
+typedef FlexField<MPL_PT_DATA_CFG, 2> MPL_PT_DREM;  // data ready event
+typedef FlexField<MPL_CTRL_REG1, 0>    MPL_CTRL1_SBYB; // 1: active
+typedef FlexField<MPL_CTRL_REG1, 1>    MPL_CTRL1_OST;  // one shot, clears itself
+typedef FlexField<MPL_CTRL_REG1, 3, 3> MPL_CTRL1_OS;   // 2^OS samples
+typedef FlexField<MPL_CTRL_REG1, 7>    MPL_CTRL1_ALT;  // 1: altimeter
+
+class MPL3115A2_Flex : public FlexAsyncSensor {
 
 public:
   MPL3115A2_Flex(TwoWire *wire);
@@ -86,11 +104,19 @@ public:
   //Public Functions
   void begin(); // Gets sensor on the I2C bus.
   boolean init();
+  static FlexAsyncSensor *create(TwoWire *wire, uint8_t address); // FlexRegistry factory: new + init(), NULL on failure
   float readAltitude(); // Returns float with meters above sealevel. Ex: 1638.94
   float readAltitudeFt(); // Returns float with feet above sealevel. Ex: 5376.68
   float readPressure(); // Returns float with barometric pressure in Pa. Ex: 83351.25
   float readTemp(); // Returns float with current temperature in Celsius. Ex: 23.37
   float readTempF(); // Returns float with current temperature in Fahrenheit. Ex: 73.96
+  flexResult_t readAltitude(float *meters); // Typed versions: FLEX_OK or why there is no value
+  flexResult_t readPressure(float *pascal);
+  flexResult_t readTemp(float *celsius);
+  flexResult_t readAltitudeCm(int32_t *centimeters); // Integer versions, no float math
+  flexResult_t readPressureX4(uint32_t *quarterPascal); // Pa * 4, the sensor's own Q18.2 format. Ex: 333405 = 83351.25 Pa
+  flexResult_t readTempCenti(int16_t *centiCelsius); // Ex: 2337 = 23.37 C
+  flexResult_t lastError(); // Result of the last bus transaction or wait
   void setModeBarometer(); // Puts the sensor into Pascal measurement mode.
   void setModeAltimeter(); // Puts the sensor into altimetery mode.
   void setModeStandby(); // Puts the sensor into Standby mode. Required when changing CTRL1 register.
@@ -98,16 +124,61 @@ public:
   void setOversampleRate(byte); // Sets the # of samples from 1 to 128. See datasheet.
   void enableEventFlags(); // Sets the fundamental event flags. Required during setup.
 
+  // Non-blocking measurement (see FlexAsyncSensor)
+  bool start(); // Starts a one shot conversion and returns immediately
+  flexState_t poll(); // FLEX_READY once new pressure/altitude data is there
+  bool collect(); // Reads pressure (or altitude) and temperature in one burst
+  uint32_t conversionTime(); // Max. conversion time for the oversample rate in us
+  bool sleep(); // Standby between samples (see FlexScheduler::setDutyCycle())
+  bool wake(); // Back to active mode if it was active before sleep()
+  flexPowerProfile_t powerProfile(); // Typical currents for the energy estimate
+  float lastPressure(); // Pa, from the last collect() in barometer mode
+  float lastAltitude(); // meters, from the last collect() in altimeter mode
+  float lastTemp(); // Celsius, from the last collect()
+  uint32_t lastPressureX4(); // Integer versions of the above, Pa * 4
+  int32_t lastAltitudeCm(); // centimeters
+  int16_t lastTempCenti(); // centi-degrees Celsius
+
+  // Whole buffers of barometer words (OUT_P_MSB<<16 | OUT_P_CSB<<8 | OUT_P_LSB), e.g. a FIFO drain
+  static uint32_t pressureWord(byte msb, byte csb, byte lsb);
+  static void convertPressureBatch(const uint32_t *words, uint16_t count, float *pascal);
+  static void convertPressureBatchX4(const uint32_t *words, uint16_t count, uint32_t *quarterPascal);
+
+  // Instrumentation (see FlexI2CDevice)
+  flexI2CStats_t getStats(); // Bus transactions, bytes, NACKs, timeouts and wait time
+  void resetStats();
+  void invalidateCache(); // Re-read CTRL_REG1 from the sensor on next use
+
   //Public Variables
 
 private:
   //Private Functions
 
   void toggleOneShot();
+  void markOneShotSample(); // sampleMicros() of the data now in the output registers
+  flexResult_t waitForData(byte mask); // Polls STATUS, bounded by conversionTime() + timeout
+  byte readCtrlReg1();
+  void updateCtrlReg1(FlexBits<MPL_CTRL_REG1> bits); // One write at most, OST always clear
+  float convertAltitude(byte msb, byte csb, byte lsb);
+  float convertPressure(byte msb, byte csb, byte lsb);
+  float convertTemp(byte msb, byte lsb);
+  uint32_t convertPressureX4(byte msb, byte csb, byte lsb);
+  int32_t convertAltitudeCm(byte msb, byte csb, byte lsb);
+  int16_t convertTempCenti(byte msb, byte lsb);
+  flexResult_t readAltitudeData(byte *data); // OUT_P_MSB..OUT_P_LSB
+  flexResult_t readPressureData(byte *data); // OUT_P_MSB..OUT_P_LSB
+  flexResult_t readTempData(byte *data); // OUT_T_MSB..OUT_T_LSB
   byte IIC_Read(byte regAddr);
   void IIC_Write(byte regAddr, byte value);
 
   //Private Variables
+  FlexI2CDevice _i2c;
+  bool _altimeterMode;
+  byte _oversample;
+  uint32_t _oneShotAt; // micros() when the last OST conversion started
+  bool _oneShotRunning; // _oneShotAt's conversion was not read out yet
+  bool _wakeActive; // SBYB was set when sleep() was called
+  byte _lastData[5]; // OUT_P_MSB..OUT_T_LSB of the last collect(), converted on demand
 
 };
 
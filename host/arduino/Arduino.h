@@ -0,0 +1,69 @@
+/**************************************************************************/
+/*!
+    @file     Arduino.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Host (Linux) stand-in for the Arduino core, just enough to compile the
+    Flex drivers unmodified. Time is simulated: millis()/micros() return
+    the simulator clock and delay() advances it instead of sleeping, see
+    FlexSim.h.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_HOST_ARDUINO_H
+#define _FLEX_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool     boolean;
+typedef uint8_t  byte;
+typedef uint16_t word;
+
+#define HIGH            0x1
+#define LOW             0x0
+
+#define INPUT           0x0
+#define OUTPUT          0x1
+#define INPUT_PULLUP    0x2
+
+#define CHANGE          1
+#define FALLING         2
+#define RISING          3
+
+#define B00110000       48
+#define B11000111       199
+
+#define PI              3.1415926535897932384626433832795
+
+#ifndef min
+#define min(a,b)        ((a)<(b)?(a):(b))
+#endif
+#ifndef max
+#define max(a,b)        ((a)>(b)?(a):(b))
+#endif
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+#define digitalPinToInterrupt(p) (p)
+
+unsigned long millis(void);
+unsigned long micros(void);
+void          delay(unsigned long ms);
+void          delayMicroseconds(unsigned int us);
+void          yield(void);
+
+void          pinMode(uint8_t pin, uint8_t mode);
+void          digitalWrite(uint8_t pin, uint8_t value);
+int           digitalRead(uint8_t pin);
+void          attachInterrupt(uint8_t interrupt, void (*callback)(void), int mode);
+void          detachInterrupt(uint8_t interrupt);
+void          noInterrupts(void);
+void          interrupts(void);
+
+#endif
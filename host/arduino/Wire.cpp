@@ -0,0 +1,279 @@
+/**************************************************************************/
+/*!
+    @file     Wire.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Host stand-in for the Arduino TwoWire class, transfers go to the
+    attached simulated devices.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "Wire.h"
+#include "FlexSimDevice.h"
+
+TwoWire Wire;
+
+TwoWire::TwoWire(void)
+{
+  _deviceCount = 0;
+  _clock = 100000;
+  _bitRemainder = 0;
+  _background = false;
+  _backgroundMicros = 0;
+  _txAddress = 0;
+  _txLength = 0;
+  _transmitting = false;
+  _rxLength = 0;
+  _rxIndex = 0;
+  resetStats();
+}
+
+void TwoWire::begin(void)
+{
+}
+
+void TwoWire::begin(uint8_t address)
+{
+  (void)address;
+}
+
+void TwoWire::end(void)
+{
+}
+
+void TwoWire::setClock(uint32_t frequency)
+{
+  if (frequency > 0)
+  {
+    _clock = frequency;
+  }
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+  _txAddress = address;
+  _txLength = 0;
+  _transmitting = true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Same return codes as the SAMD core: 0 success, 2 NACK on
+            address, 3 NACK on data
+*/
+/**************************************************************************/
+uint8_t TwoWire::endTransmission(bool stopBit)
+{
+  (void)stopBit;
+  _transmitting = false;
+
+  FlexSimDevice *device = find(_txAddress);
+  _stats.transactions++;
+
+  if ((device == NULL) || !device->ackAddress(false))
+  {
+    _stats.nacks++;
+    charge(0, 0);
+    return 2;
+  }
+
+  bool ack = device->write(_txBuffer, _txLength);
+  charge(_txLength, 0);
+  _stats.bytesWritten += _txLength;
+  if (!ack)
+  {
+    _stats.nacks++;
+    return 3;
+  }
+  return 0;
+}
+
+uint8_t TwoWire::endTransmission(void)
+{
+  return endTransmission(true);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Returns the number of bytes read, 0 when the device NACKs
+*/
+/**************************************************************************/
+uint8_t TwoWire::requestFrom(uint8_t address, size_t quantity, bool stopBit)
+{
+  (void)stopBit;
+  if (quantity > WIRE_BUFFER_LENGTH)
+  {
+    quantity = WIRE_BUFFER_LENGTH;
+  }
+
+  _rxLength = 0;
+  _rxIndex = 0;
+  _stats.transactions++;
+
+  FlexSimDevice *device = find(address);
+  if ((device == NULL) || !device->ackAddress(true))
+  {
+    _stats.nacks++;
+    charge(0, 0);
+    return 0;
+  }
+
+  uint32_t stretch = device->stretchMicros();
+  _rxLength = device->read(_rxBuffer, quantity);
+  if (_rxLength == 0)
+  {
+    _stats.nacks++;
+  }
+  charge(_rxLength, stretch);
+  _stats.bytesRead += _rxLength;
+  return (uint8_t)_rxLength;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t quantity)
+{
+  return requestFrom(address, quantity, true);
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+  if (!_transmitting || (_txLength >= WIRE_BUFFER_LENGTH))
+  {
+    return 0;
+  }
+  _txBuffer[_txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity)
+{
+  for (size_t i = 0; i < quantity; i++)
+  {
+    if (!write(data[i]))
+    {
+      return i;
+    }
+  }
+  return quantity;
+}
+
+int TwoWire::available(void)
+{
+  return (int)(_rxLength - _rxIndex);
+}
+
+int TwoWire::read(void)
+{
+  if (_rxIndex >= _rxLength)
+  {
+    return -1;
+  }
+  return _rxBuffer[_rxIndex++];
+}
+
+int TwoWire::peek(void)
+{
+  if (_rxIndex >= _rxLength)
+  {
+    return -1;
+  }
+  return _rxBuffer[_rxIndex];
+}
+
+void TwoWire::flush(void)
+{
+}
+
+/***************************************************************************
+ HOST SIMULATOR
+ ***************************************************************************/
+
+bool TwoWire::attach(FlexSimDevice *device)
+{
+  if (_deviceCount >= FLEX_SIM_MAX_DEVICES)
+  {
+    return false;
+  }
+  _devices[_deviceCount++] = device;
+  return true;
+}
+
+void TwoWire::detach(FlexSimDevice *device)
+{
+  for (uint8_t i = 0; i < _deviceCount; i++)
+  {
+    if (_devices[i] == device)
+    {
+      _devices[i] = _devices[--_deviceCount];
+      return;
+    }
+  }
+}
+
+uint32_t TwoWire::clock(void)
+{
+  return _clock;
+}
+
+flexSimBusStats_t TwoWire::stats(void)
+{
+  return _stats;
+}
+
+void TwoWire::resetStats(void)
+{
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+void TwoWire::setBackground(bool background)
+{
+  _background = background;
+}
+
+uint64_t TwoWire::takeBackgroundMicros(void)
+{
+  uint64_t us = _backgroundMicros;
+  _backgroundMicros = 0;
+  return us;
+}
+
+FlexSimDevice *TwoWire::find(uint8_t address)
+{
+  for (uint8_t i = 0; i < _deviceCount; i++)
+  {
+    if (_devices[i]->address() == address)
+    {
+      return _devices[i];
+    }
+  }
+  return NULL;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Charges one address phase: START, address + R/W, the data
+            bytes (9 clocks each with ACK) and the STOP / repeated START,
+            plus clock stretching. Advances the simulated clock.
+*/
+/**************************************************************************/
+void TwoWire::charge(size_t bytes, uint32_t stretchMicros)
+{
+  uint64_t bits = 1 + 9 * (1 + (uint64_t)bytes) + 1;
+  uint64_t total = bits * 1000000ULL + _bitRemainder;
+  uint64_t us = total / _clock;
+
+  _bitRemainder = (uint32_t)(total % _clock);
+  us += stretchMicros;
+
+  _stats.busMicros += us;
+  if (_background)
+  {
+    _backgroundMicros += us;
+  }
+  else
+  {
+    flexSimAdvance(us);
+  }
+}
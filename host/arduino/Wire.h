@@ -0,0 +1,109 @@
+/**************************************************************************/
+/*!
+    @file     Wire.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Host stand-in for the Arduino TwoWire class (SAMD core signatures).
+
+    Instead of driving pins it hands every transfer to the simulated
+    devices attached to the bus (see FlexSimDevice.h) and keeps count of
+    what went over the wire. Each address phase (START or repeated START)
+    is one transaction; bus time is charged at the configured clock
+    (setClock(), 100 kHz by default) for the START, address, data, ACK
+    and STOP bits plus any clock stretching by the device, and advances
+    the simulated clock.
+    In background mode (used by FlexSimTransport) the bus time is only
+    collected, the transport decides when the transfer completes.
+
+    Usage:
+    TwoWire bus;
+    FlexSimMPL3115A2 mpl;
+
+    bus.attach(&mpl);
+    bus.setClock(400000);
+    ...run the unmodified driver...
+    flexSimBusStats_t s = bus.stats();
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_HOST_WIRE_H
+#define _FLEX_HOST_WIRE_H
+
+#include "Arduino.h"
+
+#define WIRE_BUFFER_LENGTH      256
+#define FLEX_SIM_MAX_DEVICES    16
+
+class FlexSimDevice;
+
+typedef struct
+{
+  uint32_t transactions;    // address phases (START and repeated START)
+  uint32_t bytesWritten;    // data bytes, address bytes not included
+  uint32_t bytesRead;
+  uint32_t nacks;           // address or data NACKs
+  uint64_t busMicros;       // time the bus was busy
+} flexSimBusStats_t;
+
+class TwoWire
+{
+ public:
+  TwoWire(void);
+
+  void     begin(void);
+  void     begin(uint8_t address);
+  void     end(void);
+  void     setClock(uint32_t frequency);
+
+  void     beginTransmission(uint8_t address);
+  uint8_t  endTransmission(bool stopBit);
+  uint8_t  endTransmission(void);
+
+  uint8_t  requestFrom(uint8_t address, size_t quantity, bool stopBit);
+  uint8_t  requestFrom(uint8_t address, size_t quantity);
+
+  size_t   write(uint8_t data);
+  size_t   write(const uint8_t *data, size_t quantity);
+  int      available(void);
+  int      read(void);
+  int      peek(void);
+  void     flush(void);
+
+  // Host simulator only
+  bool     attach(FlexSimDevice *device);
+  void     detach(FlexSimDevice *device);
+  uint32_t clock(void);
+  flexSimBusStats_t stats(void);
+  void     resetStats(void);
+  void     setBackground(bool background);  // bus time no longer advances the clock
+  uint64_t takeBackgroundMicros(void);      // bus time charged since, then 0
+
+ private:
+  FlexSimDevice *find(uint8_t address);
+  void     charge(size_t bytes, uint32_t stretchMicros);
+
+  FlexSimDevice *_devices[FLEX_SIM_MAX_DEVICES];
+  uint8_t  _deviceCount;
+  uint32_t _clock;
+  uint32_t _bitRemainder;   // sub-microsecond bit time carried over
+  bool     _background;
+  uint64_t _backgroundMicros;
+
+  uint8_t  _txAddress;
+  uint8_t  _txBuffer[WIRE_BUFFER_LENGTH];
+  size_t   _txLength;
+  bool     _transmitting;
+
+  uint8_t  _rxBuffer[WIRE_BUFFER_LENGTH];
+  size_t   _rxLength;
+  size_t   _rxIndex;
+
+  flexSimBusStats_t _stats;
+};
+
+extern TwoWire Wire;
+
+#endif
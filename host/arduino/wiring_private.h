@@ -0,0 +1,12 @@
+/* Host stand-in: pinPeripheral() only matters on SAMD hardware */
+#ifndef _FLEX_HOST_WIRING_PRIVATE_H
+#define _FLEX_HOST_WIRING_PRIVATE_H
+
+#include "Arduino.h"
+
+#define PIO_SERCOM      2
+#define PIO_SERCOM_ALT  3
+
+inline int pinPeripheral(uint32_t pin, int function) { (void)pin; (void)function; return 0; }
+
+#endif
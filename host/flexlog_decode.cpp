@@ -0,0 +1,84 @@
+/**************************************************************************/
+/*!
+    @file     flexlog_decode.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Turns a binary FlexLog stream (captured from Serial or copied from
+    an SD card) back into CSV: one line per record with the sensor id,
+    the micros() time, whether it was a key record, and the raw values.
+
+    Usage: flexlog_decode [file]      (stdin without a file)
+
+    The log has to start at a record boundary, i.e. at the start of a
+    file or right after the sketch called FlexLogEncoder::reset().
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <vector>
+
+#include "FlexLog.h"
+
+int main(int argc, char **argv)
+{
+  FILE *in = stdin;
+  if (argc > 1)
+  {
+    in = fopen(argv[1], "rb");
+    if (!in)
+    {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t got;
+  while ((got = fread(chunk, 1, sizeof(chunk), in)) > 0)
+  {
+    data.insert(data.end(), chunk, chunk + got);
+  }
+  if (in != stdin)
+  {
+    fclose(in);
+  }
+
+  FlexLogDecoder  decoder;
+  flexLogRecord_t record;
+  size_t offset = 0;
+  unsigned long records = 0;
+
+  printf("id,micros,key,values\n");
+  while (offset < data.size())
+  {
+    size_t left = data.size() - offset;
+    int16_t used = decoder.decode(&data[offset], (left > 0xFFFF) ? 0xFFFF : (uint16_t)left, &record);
+    if (used < 0)
+    {
+      fprintf(stderr, "flexlog_decode: bad record at byte %lu\n", (unsigned long)offset);
+      return 1;
+    }
+    if (used == 0)
+    {
+      fprintf(stderr, "flexlog_decode: %lu trailing bytes of a partial record\n", (unsigned long)left);
+      break;
+    }
+
+    printf("%u,%lu,%d", record.id, (unsigned long)record.at, record.key ? 1 : 0);
+    for (uint8_t i = 0; i < record.count; i++)
+    {
+      printf(",%ld", (long)record.values[i]);
+    }
+    printf("\n");
+
+    offset += used;
+    records++;
+  }
+
+  fprintf(stderr, "flexlog_decode: %lu records, %lu bytes\n", records, (unsigned long)data.size());
+  return 0;
+}
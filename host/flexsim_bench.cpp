@@ -0,0 +1,356 @@
+/**************************************************************************/
+/*!
+    @file     flexsim_bench.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Benchmark of the drivers' hot read paths against the simulated
+    devices, checked against a baseline file in the tree.
+
+    Every path runs a fixed number of samples at 400 kHz, five times
+    over. Per sample the bench measures the I2C transactions, the
+    simulated bus time and the host CPU time of the fastest round
+    (drivers plus models; the simulated delay()s cost nothing).
+    Transactions and bus time are exact on the simulator, so any change
+    from the baseline fails the run: an extra register round trip on a
+    hot path shows up as one more txn. CPU time depends on the host and
+    compiler, so it only fails with --strict, beyond CPU_TOLERANCE
+    percent; otherwise it is printed as a warning.
+
+    Usage: flexsim_bench [--update] [--strict] [baseline]
+
+      baseline  defaults to flexsim_bench.baseline
+      --update  writes the measured values as the new baseline
+      --strict  CPU time regressions fail the run as well
+
+    Exit status 0 when every path matches the baseline, 1 on a
+    regression, a missing path or an unreadable baseline.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <functional>
+#include <vector>
+#include <string>
+#include <chrono>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "FlexSim.h"
+#include "FlexSimHTU21DF.h"
+#include "FlexSimADS1X15.h"
+#include "FlexSimFXAS21002C.h"
+#include "FlexSimFXOS8700.h"
+#include "FlexSimMPL3115A2.h"
+#include "FlexSimBQ27441.h"
+
+#include "Adafruit_HTU21DF_Flex.h"
+#include "Adafruit_ADS1015_Flex.h"
+#include "RP_FXAS21002C.h"
+#include "RP_FXOS8700.h"
+#include "SparkFunMPL3115A2_Flex.h"
+#include "BQ27441_Flex.h"
+
+#define BENCH_CLOCK       400000
+#define BENCH_SAMPLES     500
+#define BENCH_ROUNDS      5
+#define BENCH_WARMUP      20
+#define CPU_TOLERANCE     25       // percent over the baseline
+#define BUS_TOLERANCE_US  0.05     // rounding of the baseline file
+
+typedef struct
+{
+  std::string name;
+  double      transactions;   // per sample
+  double      busMicros;
+  double      cpuNanos;
+} benchResult_t;
+
+static std::vector<benchResult_t> results;
+static volatile float sink;    // keeps the compiler from dropping a path
+
+/**************************************************************************/
+/*!
+    @brief  Runs one path BENCH_ROUNDS times BENCH_SAMPLES samples (after
+            BENCH_WARMUP) and records the per sample cost. The fastest
+            round is taken as CPU time, the others carry scheduler noise.
+*/
+/**************************************************************************/
+static void bench(TwoWire *bus, const char *name, std::function<float(void)> path)
+{
+  for (int i = 0; i < BENCH_WARMUP; i++)
+  {
+    sink = path();
+  }
+
+  benchResult_t r;
+  r.name     = name;
+  r.cpuNanos = 0;
+
+  for (int round = 0; round < BENCH_ROUNDS; round++)
+  {
+    bus->resetStats();
+    std::chrono::steady_clock::time_point startedAt = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_SAMPLES; i++)
+    {
+      sink = path();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - startedAt;
+    flexSimBusStats_t s = bus->stats();
+
+    double cpu = elapsed.count() / BENCH_SAMPLES;
+    if (round == 0 || cpu < r.cpuNanos)
+    {
+      r.cpuNanos = cpu;
+    }
+    r.transactions = (double)s.transactions / BENCH_SAMPLES;
+    r.busMicros    = (double)s.busMicros / BENCH_SAMPLES;
+  }
+  results.push_back(r);
+}
+
+static void runPaths(void)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(BENCH_CLOCK);
+
+  FlexSimHTU21DF    htuSim;
+  FlexSimADS1X15    ads1015Sim(0x48, false);
+  FlexSimADS1X15    ads1115Sim(0x49, true);
+  FlexSimFXAS21002C fxasSim;
+  FlexSimFXOS8700   fxosSim;
+  FlexSimMPL3115A2  mplSim;
+  FlexSimBQ27441    bqSim;
+
+  ads1015Sim.setInput(0, 1.234);
+  ads1015Sim.setInput(1, 0.345);
+  ads1115Sim.setInput(0, 1.234);
+  fxasSim.setRate(1.5, -2.0, 30.0);
+
+  bus.attach(&htuSim);
+  bus.attach(&ads1015Sim);
+  bus.attach(&ads1115Sim);
+  bus.attach(&fxasSim);
+  bus.attach(&fxosSim);
+  bus.attach(&mplSim);
+  bus.attach(&bqSim);
+
+  Adafruit_HTU21DF_Flex htu(&bus);
+  Adafruit_ADS1015_Flex ads1015(&bus, 0x48);
+  Adafruit_ADS1115_Flex ads1115(&bus, 0x49);
+  RP_FXAS21002C         gyro(&bus);
+  RP_FXOS8700           accelMag(&bus);
+  MPL3115A2_Flex        mpl(&bus);
+  BQ27441_Flex          lipo(&bus);
+
+  bool ok = htu.begin();
+  ads1015.begin();
+  ads1115.begin();
+  ok &= gyro.begin();
+  ok &= accelMag.begin();
+  ok &= mpl.init();
+  ok &= lipo.begin();
+  if (!ok)
+  {
+    fprintf(stderr, "flexsim_bench: a driver failed to begin\n");
+  }
+
+  bench(&bus, "HTU21DF.readTemperature", [&]() { return htu.readTemperature(); });
+  bench(&bus, "HTU21DF.readHumidity", [&]() { return htu.readHumidity(); });
+  bench(&bus, "ADS1015.readADC_SingleEnded", [&]() { return (float)ads1015.readADC_SingleEnded(0); });
+  bench(&bus, "ADS1015.readADC_Differential_0_1", [&]() { return (float)ads1015.readADC_Differential_0_1(); });
+  bench(&bus, "ADS1115.readADC_SingleEnded", [&]() { return (float)ads1115.readADC_SingleEnded(0); });
+  bench(&bus, "FXAS21002C.getEvent", [&]() {
+    sensors_event_t event;
+    gyro.getEvent(&event);
+    return event.gyro.z;
+  });
+  bench(&bus, "FXOS8700.getEvent", [&]() {
+    sensors_event_t accel, mag;
+    accelMag.getEvent(&accel, &mag);
+    return accel.acceleration.z;
+  });
+  bench(&bus, "MPL3115A2.readPressure", [&]() { return mpl.readPressure(); });
+  bench(&bus, "MPL3115A2.readTemp", [&]() { return mpl.readTemp(); });
+  bench(&bus, "BQ27441.soc", [&]() { return (float)lipo.soc(); });
+  bench(&bus, "BQ27441.voltage", [&]() { return (float)lipo.voltage(); });
+  bench(&bus, "BQ27441.current", [&]() { return (float)lipo.current(AVG); });
+
+  // Four inputs in one pipelined frame
+  ADS1x15Scan scan(&ads1015);
+  for (uint8_t c = 0; c < 4; c++)
+  {
+    scan.addSingleEnded(c, GAIN_TWOTHIRDS, ADS1015_DR_1600SPS);
+  }
+  bench(&bus, "ADS1x15Scan.read_4", [&]() {
+    adsScanFrame_t frame;
+    scan.read(&frame);
+    return (float)frame.counts[3];
+  });
+
+  // Continuous mode: the hot path is only the conversion register read
+  ads1115.startContinuous_SingleEnded(0);
+  delay(10);
+  bench(&bus, "ADS1115.getLastConversionResults", [&]() { return (float)ads1115.getLastConversionResults(); });
+}
+
+static bool loadBaseline(const char *path, std::vector<benchResult_t> *baseline)
+{
+  FILE *in = fopen(path, "r");
+  if (!in)
+  {
+    return false;
+  }
+
+  char line[256];
+  while (fgets(line, sizeof(line), in))
+  {
+    char name[128];
+    benchResult_t r;
+    if (line[0] == '#' || sscanf(line, "%127s %lf %lf %lf", name, &r.transactions, &r.busMicros, &r.cpuNanos) != 4)
+    {
+      continue;
+    }
+    r.name = name;
+    baseline->push_back(r);
+  }
+  fclose(in);
+  return true;
+}
+
+static bool saveBaseline(const char *path)
+{
+  FILE *out = fopen(path, "w");
+  if (!out)
+  {
+    return false;
+  }
+
+  fprintf(out, "# flexsim_bench baseline: per sample at %d Hz, %d samples per path\n",
+          BENCH_CLOCK, BENCH_SAMPLES);
+  fprintf(out, "# txn and bus_us must match exactly, cpu_ns is host dependent\n");
+  fprintf(out, "# %-38s %8s %10s %10s\n", "path", "txn", "bus_us", "cpu_ns");
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    fprintf(out, "%-40s %8.2f %10.1f %10.0f\n", results[i].name.c_str(),
+            results[i].transactions, results[i].busMicros, results[i].cpuNanos);
+  }
+  fclose(out);
+  return true;
+}
+
+static const benchResult_t *findResult(const std::vector<benchResult_t> &list, const std::string &name)
+{
+  for (size_t i = 0; i < list.size(); i++)
+  {
+    if (list[i].name == name)
+    {
+      return &list[i];
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv)
+{
+  const char *path = "flexsim_bench.baseline";
+  bool update = false;
+  bool strict = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--update"))
+    {
+      update = true;
+    }
+    else if (!strcmp(argv[i], "--strict"))
+    {
+      strict = true;
+    }
+    else
+    {
+      path = argv[i];
+    }
+  }
+
+  runPaths();
+
+  if (update)
+  {
+    if (!saveBaseline(path))
+    {
+      perror(path);
+      return 1;
+    }
+    printf("flexsim_bench: wrote %lu paths to %s\n", (unsigned long)results.size(), path);
+    return 0;
+  }
+
+  std::vector<benchResult_t> baseline;
+  if (!loadBaseline(path, &baseline))
+  {
+    perror(path);
+    return 1;
+  }
+
+  int failures = 0;
+  int warnings = 0;
+
+  printf("Flex hot paths at %d Hz, per sample (baseline %s)\n", BENCH_CLOCK, path);
+  printf("  %-34s %6s %6s %8s %8s %8s %8s  %s\n", "path", "txn", "base",
+         "bus_us", "base", "cpu_ns", "base", "");
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const benchResult_t &r = results[i];
+    const benchResult_t *b = findResult(baseline, r.name);
+    const char *verdict = "ok";
+
+    if (!b)
+    {
+      verdict = "NEW (not in baseline)";
+      failures++;
+      printf("  %-34s %6.2f %6s %8.1f %8s %8.0f %8s  %s\n", r.name.c_str(),
+             r.transactions, "-", r.busMicros, "-", r.cpuNanos, "-", verdict);
+      continue;
+    }
+
+    bool busChanged = (fabs(r.transactions - b->transactions) > 0.005) ||
+                      (fabs(r.busMicros - b->busMicros) > BUS_TOLERANCE_US);
+    bool cpuSlower  = r.cpuNanos > b->cpuNanos * (100 + CPU_TOLERANCE) / 100.0;
+
+    if (busChanged)
+    {
+      verdict = (r.transactions > b->transactions + 0.005 || r.busMicros > b->busMicros) ?
+                "FAIL bus regression" : "FAIL bus changed (faster? --update)";
+      failures++;
+    }
+    else if (cpuSlower)
+    {
+      verdict = strict ? "FAIL cpu regression" : "warn cpu slower";
+      strict ? failures++ : warnings++;
+    }
+
+    printf("  %-34s %6.2f %6.2f %8.1f %8.1f %8.0f %8.0f  %s\n", r.name.c_str(),
+           r.transactions, b->transactions, r.busMicros, b->busMicros,
+           r.cpuNanos, b->cpuNanos, verdict);
+  }
+
+  for (size_t i = 0; i < baseline.size(); i++)
+  {
+    if (!findResult(results, baseline[i].name))
+    {
+      printf("  %-34s missing from the bench  FAIL\n", baseline[i].name.c_str());
+      failures++;
+    }
+  }
+
+  printf("flexsim_bench: %lu paths, %d failed, %d cpu warnings\n",
+         (unsigned long)results.size(), failures, warnings);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,2138 @@
+/**************************************************************************/
+/*!
+    @file     flexsim_report.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Runs the unmodified Flex drivers against the simulated devices and
+    reports, per sample of each blocking read path, the I2C transactions,
+    data bytes, bus time, time spent in delay() and total elapsed time,
+    at 100 kHz, 400 kHz and 1 MHz. The drivers' own getStats() counters
+    are printed after each run as a cross-check of the bus model.
+
+    The integer (fixed point) outputs are checked against the float
+    ones on the same raw sample, the batch conversion kernels against
+    the per-sample getLastEvent() style path on a 32 sample FIFO drain,
+    and the drivers with the range / gain fixed at compile time against
+    the runtime ones (host CPU time per sample). The typed register
+    operations of FlexRegister.h are counted on the MPL3115A2.
+
+    Then the FXOS8700 poll() / collect() loop runs next to a stand-in
+    filter (FILTER_STEP_US of CPU work per step), blocking and through
+    the asynchronous transports, to show how much CPU time the bus takes
+    away from the filter. Sample timestamps are compared with the
+    instants the models latched or converted each sample, and a busy
+    loop() loses samples when it polls but not when a data ready
+    interrupt fills a FlexRing. ADS1x15Stream streams both ADCs at
+    their fastest data rates, paced by the simulated ALERT/RDY pin, at
+    400 kHz and 100 kHz, and a four input ADS1x15Scan frame is set
+    against four readADC_SingleEnded() calls, and four ADS1115s are read
+    as an ADS1x15Array. Single-shot reads on ADCs with a slow or fast
+    oscillator show the OS checks the conversion time model saves, and
+    a fixed gain is set against auto range on small and large inputs.
+    FlexLog records are compared in size
+    with the text lines of the example sketches, and a FlexScheduler
+    node runs with every sensor always on and then duty cycled. The bus
+    traffic of a node with a stalling loop() is captured with
+    FlexI2CTrace and replayed to the same drivers without any models.
+
+    A two bus node is then booted twice, with a FlexScanner style
+    probe-then-begin startup and with FlexRegistry, up to the first
+    sample of every sensor. Finally every sensor is made to fail
+    (removed from the bus, or a conversion that never finishes) to show
+    what a failed read costs.
+
+    Results that must match (templates against the runtime drivers,
+    scan and array frames against single reads, the FlexLog decoder
+    round trip, the trace replay) are checked: a failed check prints
+    CHECK FAILED and the exit code is 1.
+
+    Usage: flexsim_report [samples]
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <functional>
+#include <vector>
+#include <chrono>
+#include <math.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "FlexSim.h"
+#include "FlexSimHTU21DF.h"
+#include "FlexSimADS1X15.h"
+#include "FlexSimFXAS21002C.h"
+#include "FlexSimFXOS8700.h"
+#include "FlexSimMPL3115A2.h"
+#include "FlexSimBQ27441.h"
+#include "FlexSimTransport.h"
+#include "FlexSimReplay.h"
+
+#include "Adafruit_HTU21DF_Flex.h"
+#include "Adafruit_ADS1015_Flex.h"
+#include "RP_FXAS21002C.h"
+#include "RP_FXOS8700.h"
+#include "SparkFunMPL3115A2_Flex.h"
+#include "BQ27441_Flex.h"
+#include "FlexWireTransport.h"
+#include "FlexRegistry.h"
+#include "FlexRing.h"
+#include "FlexLog.h"
+#include "FlexScheduler.h"
+#include "FlexI2CTrace.h"
+
+#define FILTER_STEP_US   50
+#define BATCH_SAMPLES    32      // one FIFO drain
+#define BATCH_REPEAT     20000
+#define DUTY_SECONDS     10
+#define PRINT_US         25000   // loop() busy printing
+#define FXOS_INT1_PIN    7
+#define ADS_ALERT_PIN    8
+#define STREAM_MS        200     // per stream run
+#define STREAM_LOOP_US   50      // loop() work between read() calls
+#define LOG_SAMPLES      256
+#define REPLAY_PASSES    200
+#define TRACE_BUFFER     1024    // drained after every loop() pass
+
+/* Correctness checks, unlike the timings; any failure fails the run */
+static uint32_t checkFailures = 0;
+
+static void check(bool ok, const char *what)
+{
+  if (!ok)
+  {
+    printf("  CHECK FAILED: %s\n", what);
+    checkFailures++;
+  }
+}
+
+static void measure(TwoWire *bus, const char *name, int samples, std::function<float(void)> path)
+{
+  float value = 0;
+
+  bus->resetStats();
+  flexSimResetDelayMicros();
+  uint64_t startedAt = flexSimNow();
+
+  for (int i = 0; i < samples; i++)
+  {
+    value = path();
+  }
+
+  flexSimBusStats_t s = bus->stats();
+  double n = samples;
+  printf("  %-30s %6.1f %7.1f %9.1f %10.1f %10.1f %12.3f\n", name,
+         s.transactions / n, (s.bytesWritten + s.bytesRead) / n, s.busMicros / n,
+         flexSimDelayMicros() / n, (flexSimNow() - startedAt) / n, value);
+}
+
+static void driverStats(const char *name, flexI2CStats_t s)
+{
+  printf("  %-30s %6lu %7lu %6lu %9lu %10lu\n", name,
+         (unsigned long)s.transactions, (unsigned long)(s.bytesWritten + s.bytesRead),
+         (unsigned long)s.nacks, (unsigned long)s.timeouts, (unsigned long)s.waitMicros);
+}
+
+static void report(uint32_t clock, int samples)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimHTU21DF    htuSim;
+  FlexSimADS1X15    ads1015Sim(0x48, false);
+  FlexSimADS1X15    ads1115Sim(0x49, true);
+  FlexSimFXAS21002C fxasSim;
+  FlexSimFXOS8700   fxosSim;
+  FlexSimMPL3115A2  mplSim;
+  FlexSimBQ27441    bqSim;
+
+  ads1015Sim.setInput(0, 1.234);
+  ads1115Sim.setInput(0, 1.234);
+  fxasSim.setRate(1.5, -2.0, 30.0);
+
+  bus.attach(&htuSim);
+  bus.attach(&ads1015Sim);
+  bus.attach(&ads1115Sim);
+  bus.attach(&fxasSim);
+  bus.attach(&fxosSim);
+  bus.attach(&mplSim);
+  bus.attach(&bqSim);
+
+  Adafruit_HTU21DF_Flex htu(&bus);
+  Adafruit_ADS1015_Flex ads1015(&bus, 0x48);
+  Adafruit_ADS1115_Flex ads1115(&bus, 0x49);
+  RP_FXAS21002C         gyro(&bus);
+  RP_FXOS8700           accelMag(&bus);
+  MPL3115A2_Flex        mpl(&bus);
+  BQ27441_Flex          lipo(&bus);
+
+  bool ok = htu.begin();
+  ads1015.begin();
+  ads1115.begin();
+  ok &= gyro.begin();
+  ok &= accelMag.begin();
+  ok &= mpl.init();
+  ok &= lipo.begin();
+
+  printf("\n%lu Hz%s\n", (unsigned long)clock, ok ? "" : "  (a driver failed to begin)");
+  printf("  %-30s %6s %7s %9s %10s %10s %12s\n", "path (per sample)",
+         "txn", "bytes", "bus_us", "delay_us", "total_us", "last value");
+
+  measure(&bus, "HTU21DF readTemperature", samples, [&]() { return htu.readTemperature(); });
+  measure(&bus, "HTU21DF readHumidity", samples, [&]() { return htu.readHumidity(); });
+  measure(&bus, "ADS1015 readADC_SingleEnded", samples, [&]() { return (float)ads1015.readADC_SingleEnded(0); });
+  measure(&bus, "ADS1115 readADC_SingleEnded", samples, [&]() { return (float)ads1115.readADC_SingleEnded(0); });
+  measure(&bus, "FXAS21002C getEvent", samples, [&]() {
+    sensors_event_t event;
+    gyro.getEvent(&event);
+    return event.gyro.z;
+  });
+  measure(&bus, "FXOS8700 getEvent", samples, [&]() {
+    sensors_event_t accel, mag;
+    accelMag.getEvent(&accel, &mag);
+    return accel.acceleration.z;
+  });
+  measure(&bus, "MPL3115A2 readPressure", samples, [&]() { return mpl.readPressure(); });
+  measure(&bus, "MPL3115A2 readTemp", samples, [&]() { return mpl.readTemp(); });
+  measure(&bus, "BQ27441 soc", samples, [&]() { return (float)lipo.soc(); });
+  measure(&bus, "BQ27441 voltage", samples, [&]() { return (float)lipo.voltage(); });
+  measure(&bus, "BQ27441 GPOUTPolarity", samples, [&]() { return (float)lipo.GPOUTPolarity(); });
+
+  printf("  %-30s %6s %7s %6s %9s %10s\n", "driver getStats() since begin",
+         "txn", "bytes", "nacks", "timeouts", "wait_us");
+  driverStats("HTU21DF", htu.getStats());
+  driverStats("ADS1015", ads1015.getStats());
+  driverStats("ADS1115", ads1115.getStats());
+  driverStats("FXAS21002C", gyro.getStats());
+  driverStats("FXOS8700", accelMag.getStats());
+  driverStats("MPL3115A2", mpl.getStats());
+  driverStats("BQ27441", lipo.getStats());
+}
+
+static void compare(const char *name, double value, double fixed, const char *unit)
+{
+  printf("  %-30s %14.4f %14.4f %12.4f  %s\n", name, value, fixed, fixed - value, unit);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Float and integer outputs of one sample each, in the units of
+            the float API (differences are rounding / constant precision)
+*/
+/**************************************************************************/
+static void fixedPoint(uint32_t clock)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimHTU21DF    htuSim;
+  FlexSimADS1X15    adsSim(0x49, true);
+  FlexSimFXAS21002C fxasSim;
+  FlexSimFXOS8700   fxosSim;
+  FlexSimMPL3115A2  mplSim;
+
+  htuSim.setTemperature(-12.34);
+  htuSim.setHumidity(56.78);
+  adsSim.setInput(0, 1.234567);
+  fxasSim.setRate(1.5, -2.0, 30.0);
+  fxosSim.setAcceleration(0.1, -0.25, 0.98);
+  mplSim.setPressure(83351.25);
+  mplSim.setTemperature(-5.5);
+
+  bus.attach(&htuSim);
+  bus.attach(&adsSim);
+  bus.attach(&fxasSim);
+  bus.attach(&fxosSim);
+  bus.attach(&mplSim);
+
+  Adafruit_HTU21DF_Flex htu(&bus);
+  Adafruit_ADS1115_Flex ads(&bus, 0x49);
+  RP_FXAS21002C         gyro(&bus);
+  RP_FXOS8700           accelMag(&bus);
+  MPL3115A2_Flex        mpl(&bus);
+
+  htu.begin();
+  gyro.begin();
+  accelMag.begin();
+  mpl.init();
+
+  printf("\nFloat vs integer outputs\n");
+  printf("  %-30s %14s %14s %12s\n", "output", "float", "integer", "difference");
+
+  htu.start();
+  while (htu.poll() == FLEX_BUSY) { }
+  htu.collect();
+  compare("HTU21DF temperature", htu.lastTemperature(), htu.lastTemperatureCenti() / 100.0, "C");
+  compare("HTU21DF humidity", htu.lastHumidity(), htu.lastHumidityCenti() / 100.0, "%RH");
+
+  ads.startADC_SingleEnded(0);
+  while (ads.poll() == FLEX_BUSY) { }
+  ads.collect();
+  compare("ADS1115 AIN0", ads.lastResult() * ads.voltsPerBit(), ads.lastResult_uV() / 1e6, "V");
+
+  sensors_event_t event, mag;
+  flexVector32_t fixed, nanoTesla;
+  delay(20);
+  gyro.getEvent(&event);
+  gyro.getLastEventFixed(&fixed);
+  compare("FXAS21002C z", event.gyro.z, fixed.z / 1000.0 * SENSORS_DPS_TO_RADS, "rad/s");
+
+  delay(20);
+  accelMag.getEvent(&event, &mag);
+  accelMag.getLastEventFixed(&fixed, &nanoTesla);
+  compare("FXOS8700 accel z", event.acceleration.z, fixed.z / 1000.0 * SENSORS_GRAVITY_STANDARD, "m/s^2");
+  compare("FXOS8700 mag x", mag.magnetic.x, nanoTesla.x / 1000.0, "uT");
+
+  mpl.start();
+  while (mpl.poll() == FLEX_BUSY) { }
+  mpl.collect();
+  compare("MPL3115A2 pressure", mpl.lastPressure(), mpl.lastPressureX4() / 4.0, "Pa");
+  compare("MPL3115A2 temperature", mpl.lastTemp(), mpl.lastTempCenti() / 100.0, "C");
+}
+
+/**************************************************************************/
+/*!
+    @brief  Host CPU nanoseconds per sample of path, run BATCH_REPEAT
+            times over a BATCH_SAMPLES buffer
+*/
+/**************************************************************************/
+static double cpuNanos(std::function<void(void)> path)
+{
+  std::chrono::steady_clock::time_point startedAt = std::chrono::steady_clock::now();
+  for (int i = 0; i < BATCH_REPEAT; i++)
+  {
+    path();
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - startedAt;
+  return elapsed.count() / ((double)BATCH_REPEAT * BATCH_SAMPLES);
+}
+
+static void batchRow(const char *name, double maxDiff, double single, double batch)
+{
+  printf("  %-30s %12.6f %10.2f %10.2f %8.1fx\n", name, maxDiff, single, batch, single / batch);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Batch kernels vs one sample at a time on the same raw buffer:
+            largest difference and host CPU time per sample
+*/
+/**************************************************************************/
+static void batchConvert(uint32_t clock)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimADS1X15    adsSim(0x49, true);
+  FlexSimFXAS21002C fxasSim;
+  FlexSimFXOS8700   fxosSim;
+  FlexSimMPL3115A2  mplSim;
+
+  bus.attach(&adsSim);
+  bus.attach(&fxasSim);
+  bus.attach(&fxosSim);
+  bus.attach(&mplSim);
+
+  Adafruit_ADS1115_Flex ads(&bus, 0x49);
+  RP_FXAS21002C         gyro(&bus);
+  RP_FXOS8700           accelMag(&bus);
+  MPL3115A2_Flex        mpl(&bus);
+
+  ads.setGain(GAIN_FOUR);
+  gyro.begin(GYRO_RANGE_500DPS);
+  accelMag.begin(ACCEL_RANGE_4G);
+  mpl.init();
+
+  /* A FIFO drain worth of raw samples, spread over the full range */
+  gyroRawData_t     gyroRaw[BATCH_SAMPLES];
+  fxos8700RawData_t accelRaw[BATCH_SAMPLES];
+  int16_t           counts[BATCH_SAMPLES];
+  uint32_t          words[BATCH_SAMPLES];
+  float             pascalRef[BATCH_SAMPLES];
+  uint32_t          seed = 12345;
+
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    int16_t r[3];
+    for (int j = 0; j < 3; j++)
+    {
+      seed = seed * 1103515245 + 12345;
+      r[j] = (int16_t)(seed >> 16);
+    }
+    gyroRaw[i].x = r[0];
+    gyroRaw[i].y = r[1];
+    gyroRaw[i].z = r[2];
+    accelRaw[i].x = r[0] >> 2;   // 14 bit
+    accelRaw[i].y = r[1] >> 2;
+    accelRaw[i].z = r[2] >> 2;
+    counts[i] = r[0];
+
+    mplSim.setPressure(50000.0 + 1234.75 * i);
+    mpl.start();
+    while (mpl.poll() == FLEX_BUSY) { }
+    mpl.collect();
+    pascalRef[i] = mpl.lastPressure();
+    words[i] = mpl.lastPressureX4() << 4;
+  }
+
+  float    fx[BATCH_SAMPLES], fy[BATCH_SAMPLES], fz[BATCH_SAMPLES];
+  int32_t  ix[BATCH_SAMPLES], iy[BATCH_SAMPLES], iz[BATCH_SAMPLES];
+  uint32_t ux[BATCH_SAMPLES];
+  volatile float   sinkF = 0;
+  volatile int32_t sinkI = 0;
+  sensors_event_t  event, mag;
+  flexVector32_t   fixed, nanoTesla;
+  double           diff, single, batch;
+
+  printf("\nBatch conversion of a %d sample FIFO drain (host CPU ns per sample)\n", BATCH_SAMPLES);
+  printf("  %-30s %12s %10s %10s %9s\n", "kernel", "max_diff", "single_ns", "batch_ns", "speedup");
+
+  /* FXAS21002C rad/s */
+  gyro.convertBatch(gyroRaw, BATCH_SAMPLES, fx, fy, fz);
+  diff = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    gyro.raw = gyroRaw[i];
+    gyro.getLastEvent(&event);
+    diff = fmax(diff, fabs(event.gyro.x - fx[i]));
+    diff = fmax(diff, fabs(event.gyro.y - fy[i]));
+    diff = fmax(diff, fabs(event.gyro.z - fz[i]));
+  }
+  single = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { gyro.raw = gyroRaw[i]; gyro.getLastEvent(&event); sinkF = event.gyro.z; }
+  });
+  batch = cpuNanos([&]() { gyro.convertBatch(gyroRaw, BATCH_SAMPLES, fx, fy, fz); sinkF = fz[BATCH_SAMPLES - 1]; });
+  batchRow("FXAS21002C rad/s", diff, single, batch);
+
+  /* FXAS21002C milli-dps */
+  gyro.convertBatchFixed(gyroRaw, BATCH_SAMPLES, ix, iy, iz);
+  diff = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    gyro.raw = gyroRaw[i];
+    gyro.getLastEventFixed(&fixed);
+    diff = fmax(diff, fabs((double)fixed.x - ix[i]) + fabs((double)fixed.y - iy[i]) + fabs((double)fixed.z - iz[i]));
+  }
+  single = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { gyro.raw = gyroRaw[i]; gyro.getLastEventFixed(&fixed); sinkI = fixed.z; }
+  });
+  batch = cpuNanos([&]() { gyro.convertBatchFixed(gyroRaw, BATCH_SAMPLES, ix, iy, iz); sinkI = iz[BATCH_SAMPLES - 1]; });
+  batchRow("FXAS21002C mdps", diff, single, batch);
+
+  /* FXOS8700 accel m/s^2 and milli-g */
+  accelMag.convertAccelBatch(accelRaw, BATCH_SAMPLES, fx, fy, fz);
+  diff = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    accelMag.accel_raw = accelRaw[i];
+    accelMag.getLastEvent(&event, &mag);
+    diff = fmax(diff, fabs(event.acceleration.x - fx[i]));
+    diff = fmax(diff, fabs(event.acceleration.y - fy[i]));
+    diff = fmax(diff, fabs(event.acceleration.z - fz[i]));
+  }
+  single = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { accelMag.accel_raw = accelRaw[i]; accelMag.getLastEvent(&event, &mag); sinkF = event.acceleration.z; }
+  });
+  batch = cpuNanos([&]() { accelMag.convertAccelBatch(accelRaw, BATCH_SAMPLES, fx, fy, fz); sinkF = fz[BATCH_SAMPLES - 1]; });
+  batchRow("FXOS8700 accel m/s^2", diff, single, batch);
+
+  accelMag.convertAccelBatchFixed(accelRaw, BATCH_SAMPLES, ix, iy, iz);
+  diff = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    accelMag.accel_raw = accelRaw[i];
+    accelMag.getLastEventFixed(&fixed, &nanoTesla);
+    diff = fmax(diff, fabs((double)fixed.x - ix[i]) + fabs((double)fixed.y - iy[i]) + fabs((double)fixed.z - iz[i]));
+  }
+  single = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { accelMag.accel_raw = accelRaw[i]; accelMag.getLastEventFixed(&fixed, &nanoTesla); sinkI = fixed.z; }
+  });
+  batch = cpuNanos([&]() { accelMag.convertAccelBatchFixed(accelRaw, BATCH_SAMPLES, ix, iy, iz); sinkI = iz[BATCH_SAMPLES - 1]; });
+  batchRow("FXOS8700 accel milli-g", diff, single, batch);
+
+  /* ADS1115 V and uV */
+  ads.convertBatch(counts, BATCH_SAMPLES, fx);
+  ads.convertBatch_uV(counts, BATCH_SAMPLES, ix);
+  diff = 0;
+  double diffUv = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    diff = fmax(diff, fabs(counts[i] * ads.voltsPerBit() - fx[i]));
+    diffUv = fmax(diffUv, fabs((double)ads.microvolts(counts[i]) - ix[i]));
+  }
+  single = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { sinkF = counts[i] * ads.voltsPerBit(); }
+  });
+  batch = cpuNanos([&]() { ads.convertBatch(counts, BATCH_SAMPLES, fx); sinkF = fx[BATCH_SAMPLES - 1]; });
+  batchRow("ADS1115 V", diff, single, batch);
+  single = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { sinkI = ads.microvolts(counts[i]); }
+  });
+  batch = cpuNanos([&]() { ads.convertBatch_uV(counts, BATCH_SAMPLES, ix); sinkI = ix[BATCH_SAMPLES - 1]; });
+  batchRow("ADS1115 uV", diffUv, single, batch);
+
+  /* MPL3115A2 Pa, against the values collect() produced */
+  MPL3115A2_Flex::convertPressureBatch(words, BATCH_SAMPLES, fx);
+  MPL3115A2_Flex::convertPressureBatchX4(words, BATCH_SAMPLES, ux);
+  diff = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    diff = fmax(diff, fabs(pascalRef[i] - fx[i]));
+    diff = fmax(diff, fabs(pascalRef[i] - ux[i] / 4.0));
+  }
+  batch = cpuNanos([&]() { MPL3115A2_Flex::convertPressureBatch(words, BATCH_SAMPLES, fx); sinkF = fx[BATCH_SAMPLES - 1]; });
+  printf("  %-30s %12.6f %10s %10.2f\n", "MPL3115A2 Pa", diff, "-", batch);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Drivers with the range / gain fixed at compile time against
+            the runtime ones on the same raw samples: largest difference
+            and host CPU time per sample
+*/
+/**************************************************************************/
+static void templates(uint32_t clock)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimADS1X15    ads1015Sim(0x48, false);
+  FlexSimADS1X15    ads1115Sim(0x49, true);
+  FlexSimFXAS21002C fxasSim;
+  FlexSimFXOS8700   fxosSim;
+  bus.attach(&ads1015Sim);
+  bus.attach(&ads1115Sim);
+  bus.attach(&fxasSim);
+  bus.attach(&fxosSim);
+
+  RP_FXAS21002C                      gyro(&bus);
+  FXAS21002C<GYRO_RANGE_500DPS>      fixedGyro(&bus);
+  RP_FXOS8700                        accelMag(&bus);
+  FXOS8700<ACCEL_RANGE_4G>           fixedAccelMag(&bus);
+  Adafruit_ADS1015_Flex              ads1015(&bus, 0x48);
+  ADS1x15<CHIP_ADS1015, GAIN_ONE>    fixedAds1015(&bus, 0x48);
+  Adafruit_ADS1115_Flex              ads1115(&bus, 0x49);
+  ADS1x15<CHIP_ADS1115, GAIN_FOUR>   fixedAds1115(&bus, 0x49);
+
+  gyro.begin(GYRO_RANGE_500DPS);
+  fixedGyro.begin();
+  accelMag.begin(ACCEL_RANGE_4G);
+  fixedAccelMag.begin();
+  ads1015.setGain(GAIN_ONE);
+  ads1115.setGain(GAIN_FOUR);
+
+  gyroRawData_t     gyroRaw[BATCH_SAMPLES];
+  fxos8700RawData_t accelRaw[BATCH_SAMPLES];
+  int16_t           counts[BATCH_SAMPLES];
+  uint32_t          seed = 777;
+
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    int16_t r[3];
+    for (int j = 0; j < 3; j++)
+    {
+      seed = seed * 1103515245 + 12345;
+      r[j] = (int16_t)(seed >> 16);
+    }
+    gyroRaw[i].x = r[0];
+    gyroRaw[i].y = r[1];
+    gyroRaw[i].z = r[2];
+    accelRaw[i].x = r[0] >> 2;
+    accelRaw[i].y = r[1] >> 2;
+    accelRaw[i].z = r[2] >> 2;
+    counts[i] = r[0];
+  }
+
+  volatile float   sinkF = 0;
+  volatile int32_t sinkI = 0;
+  sensors_event_t  a, b, m;
+  flexVector32_t   fa, fb, n;
+  double           diff, runtime, fixed;
+
+  printf("\nCompile-time range / gain vs runtime drivers, %d samples (host CPU ns per sample)\n", BATCH_SAMPLES);
+  printf("  %-30s %12s %10s %11s %9s\n", "conversion", "max_diff", "runtime_ns", "template_ns", "speedup");
+
+  /* FXAS21002C at 500 dps */
+  diff = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    gyro.raw = fixedGyro.raw = gyroRaw[i];
+    gyro.getLastEvent(&a);
+    fixedGyro.getLastEvent(&b);
+    diff = fmax(diff, fabs(a.gyro.x - b.gyro.x) + fabs(a.gyro.y - b.gyro.y) + fabs(a.gyro.z - b.gyro.z));
+  }
+  runtime = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { gyro.raw = gyroRaw[i]; gyro.getLastEvent(&a); sinkF = a.gyro.z; }
+  });
+  fixed = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { fixedGyro.raw = gyroRaw[i]; fixedGyro.getLastEvent(&b); sinkF = b.gyro.z; }
+  });
+  batchRow("FXAS21002C getLastEvent", diff, runtime, fixed);
+  check(diff == 0, "FXAS21002C getLastEvent: template differs from the runtime driver");
+
+  diff = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    gyro.raw = fixedGyro.raw = gyroRaw[i];
+    gyro.getLastEventFixed(&fa);
+    fixedGyro.getLastEventFixed(&fb);
+    diff = fmax(diff, fabs((double)fa.x - fb.x) + fabs((double)fa.y - fb.y) + fabs((double)fa.z - fb.z));
+  }
+  runtime = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { gyro.raw = gyroRaw[i]; gyro.getLastEventFixed(&fa); sinkI = fa.z; }
+  });
+  fixed = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { fixedGyro.raw = gyroRaw[i]; fixedGyro.getLastEventFixed(&fb); sinkI = fb.z; }
+  });
+  batchRow("FXAS21002C getLastEventFixed", diff, runtime, fixed);
+  check(diff == 0, "FXAS21002C getLastEventFixed: template differs from the runtime driver");
+
+  /* FXOS8700 at 4G */
+  diff = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    accelMag.accel_raw = fixedAccelMag.accel_raw = accelRaw[i];
+    accelMag.mag_raw = fixedAccelMag.mag_raw = accelRaw[i];
+    accelMag.getLastEvent(&a, &m);
+    fixedAccelMag.getLastEvent(&b, &m);
+    diff = fmax(diff, fabs(a.acceleration.x - b.acceleration.x) + fabs(a.acceleration.y - b.acceleration.y) +
+                      fabs(a.acceleration.z - b.acceleration.z));
+  }
+  runtime = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { accelMag.accel_raw = accelRaw[i]; accelMag.getLastEvent(&a, &m); sinkF = a.acceleration.z; }
+  });
+  fixed = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { fixedAccelMag.accel_raw = accelRaw[i]; fixedAccelMag.getLastEvent(&b, &m); sinkF = b.acceleration.z; }
+  });
+  batchRow("FXOS8700 getLastEvent", diff, runtime, fixed);
+  check(diff == 0, "FXOS8700 getLastEvent: template differs from the runtime driver");
+
+  diff = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    accelMag.accel_raw = fixedAccelMag.accel_raw = accelRaw[i];
+    accelMag.getLastEventFixed(&fa, &n);
+    fixedAccelMag.getLastEventFixed(&fb, &n);
+    diff = fmax(diff, fabs((double)fa.x - fb.x) + fabs((double)fa.y - fb.y) + fabs((double)fa.z - fb.z));
+  }
+  runtime = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { accelMag.accel_raw = accelRaw[i]; accelMag.getLastEventFixed(&fa, &n); sinkI = fa.z; }
+  });
+  fixed = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { fixedAccelMag.accel_raw = accelRaw[i]; fixedAccelMag.getLastEventFixed(&fb, &n); sinkI = fb.z; }
+  });
+  batchRow("FXOS8700 getLastEventFixed", diff, runtime, fixed);
+  check(diff == 0, "FXOS8700 getLastEventFixed: template differs from the runtime driver");
+
+  /* ADS1115 at GAIN_FOUR: counts to V and uV */
+  diff = 0;
+  for (int i = 0; i < BATCH_SAMPLES; i++)
+  {
+    diff = fmax(diff, fabs(counts[i] * ads1115.voltsPerBit() - counts[i] * fixedAds1115.voltsPerBit()));
+    diff = fmax(diff, fabs((double)ads1115.microvolts(counts[i]) - fixedAds1115.microvolts(counts[i])));
+  }
+  runtime = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { sinkF = counts[i] * ads1115.voltsPerBit(); sinkI = ads1115.microvolts(counts[i]); }
+  });
+  fixed = cpuNanos([&]() {
+    for (int i = 0; i < BATCH_SAMPLES; i++) { sinkF = counts[i] * fixedAds1115.voltsPerBit(); sinkI = fixedAds1115.microvolts(counts[i]); }
+  });
+  batchRow("ADS1115 volts + microvolts", diff, runtime, fixed);
+  check(diff == 0, "ADS1115 volts + microvolts: template differs from the runtime driver");
+
+  /* ADS1015 negative differential reading: the sign extension path */
+  ads1015Sim.setInput(0, 0.25);
+  ads1015Sim.setInput(1, 1.75);
+  int16_t runtimeCounts = 0, fixedCounts = 0;
+  ads1015.readADC_Differential(DIFF_MUX_0_1, &runtimeCounts);
+  fixedAds1015.readADC_Differential(DIFF_MUX_0_1, &fixedCounts);
+  printf("  %-30s %12d %10d %11d   (-1.5 V: -750 counts)\n", "ADS1015 differential counts",
+         abs(runtimeCounts - fixedCounts), runtimeCounts, fixedCounts);
+  check((runtimeCounts == -750) && (fixedCounts == -750), "ADS1015 differential counts");
+}
+
+static void registerRow(const char *name, int bursts, flexI2CStats_t before, flexI2CStats_t after)
+{
+  char planned[8] = "-";
+  if (bursts >= 0)
+  {
+    snprintf(planned, sizeof(planned), "%d", bursts);
+  }
+  printf("  %-34s %7s %6lu %6lu\n", name, planned,
+         (unsigned long)(after.transactions - before.transactions),
+         (unsigned long)(after.bytesWritten - before.bytesWritten + after.bytesRead - before.bytesRead));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Bus cost of the typed register operations on the MPL3115A2:
+            field updates from the shadow and bursts planned at compile
+            time (bursts column) against what went over the bus. txn
+            counts address phases, a burst read takes two.
+*/
+/**************************************************************************/
+static void registers(uint32_t clock)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimMPL3115A2 mplSim;
+  bus.attach(&mplSim);
+
+  MPL3115A2_Flex mpl(&bus);
+  FlexI2CDevice  dev(&bus, MPL3115A2_ADDRESS);
+  flexI2CStats_t before;
+  uint8_t        data[8];
+
+  printf("\nMPL3115A2 typed register operations\n");
+  printf("  %-34s %7s %6s %6s\n", "operation", "bursts", "txn", "bytes");
+
+  before = mpl.getStats();
+  mpl.begin();
+  registerRow("begin(), ALT + OS in one write", -1, before, mpl.getStats());
+
+  before = mpl.getStats();
+  mpl.setModeStandby();
+  mpl.setOversampleRate(3);
+  mpl.setModeAltimeter();
+  mpl.setModeActive();
+  registerRow("4 setters, fields changed", -1, before, mpl.getStats());
+
+  before = mpl.getStats();
+  mpl.setModeStandby();
+  mpl.setOversampleRate(3);
+  mpl.setModeAltimeter();
+  mpl.setModeStandby();
+  registerRow("4 setters, shadow unchanged", -1, before, mpl.getStats());
+
+  before = dev.stats();
+  dev.update(MPL_CTRL1_SBYB::set(1) | MPL_CTRL1_OS::set(7) | MPL_CTRL1_ALT::set(0));
+  registerRow("update() of 3 fields, cold shadow", -1, before, dev.stats());
+
+  before = dev.stats();
+  dev.update(MPL_CTRL1_SBYB::set(0) | MPL_CTRL1_OS::set(5) | MPL_CTRL1_ALT::set(1));
+  registerRow("update() of 3 fields, shadowed", -1, before, dev.stats());
+
+  typedef FlexReg<P_MIN_MSB, 3> MPL_P_MIN;
+  typedef FlexReg<T_MIN_MSB, 2> MPL_T_MIN;
+  typedef FlexReg<P_MAX_MSB, 3> MPL_P_MAX;
+
+  before = dev.stats();
+  dev.readBlock<MPL_OUT_P, MPL_OUT_T>(data);
+  registerRow("readBlock OUT_P, OUT_T", flexBlockBursts<MPL_OUT_P, MPL_OUT_T>(), before, dev.stats());
+
+  before = dev.stats();
+  dev.readBlock<MPL_P_MIN, MPL_T_MIN, MPL_P_MAX>(data);
+  registerRow("readBlock P_MIN, T_MIN, P_MAX", flexBlockBursts<MPL_P_MIN, MPL_T_MIN, MPL_P_MAX>(), before, dev.stats());
+
+  before = dev.stats();
+  dev.readBlock<MPL_OUT_P, MPL_P_MIN>(data);
+  registerRow("readBlock OUT_P, P_MIN", flexBlockBursts<MPL_OUT_P, MPL_P_MIN>(), before, dev.stats());
+}
+
+static void overlapRun(const char *name, RP_FXOS8700 *accelMag, int samples, std::function<uint64_t(void)> busMicros)
+{
+  uint64_t bus = busMicros();
+  uint64_t startedAt = flexSimNow();
+  uint32_t steps = 0;
+  int collected = 0;
+
+  for (int i = 0; i < samples; i++)
+  {
+    accelMag->start();
+    while (accelMag->poll() == FLEX_BUSY)
+    {
+      flexSimAdvance(FILTER_STEP_US);   // one filter step
+      steps++;
+    }
+    collected += accelMag->collect();
+  }
+
+  double n = samples;
+  double total = (double)(flexSimNow() - startedAt);
+  double work = (double)steps * FILTER_STEP_US;
+  printf("  %-30s %9d %9.1f %10.1f %10.1f %8.1f%%\n", name, collected,
+         (busMicros() - bus) / n, (total - work) / n, steps / n, 100.0 * work / total);
+}
+
+static void overlap(uint32_t clock, int samples)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  TwoWire dmaBus;                      // the asynchronous controller
+  bus.setClock(clock);
+  dmaBus.setClock(clock);
+
+  FlexSimFXOS8700 fxosSim;
+  bus.attach(&fxosSim);
+  dmaBus.attach(&fxosSim);
+
+  RP_FXOS8700       accelMag(&bus);
+  FlexWireTransport wireTransport(&bus);
+  FlexSimTransport  simTransport(&dmaBus);
+  bool ok = accelMag.begin();
+
+  printf("\nFXOS8700 poll()/collect() next to a %d us filter step at %lu Hz%s\n", FILTER_STEP_US,
+         (unsigned long)clock, ok ? "" : "  (begin failed)");
+  printf("  %-30s %9s %9s %10s %10s %9s\n", "transport (per sample)",
+         "samples", "bus_us", "driver_us", "steps", "cpu_free");
+
+  overlapRun("blocking Wire", &accelMag, samples, [&]() { return bus.stats().busMicros; });
+  accelMag.setTransport(&wireTransport);
+  overlapRun("FlexWireTransport", &accelMag, samples, [&]() { return bus.stats().busMicros; });
+  accelMag.setTransport(&simTransport);
+  overlapRun("FlexSimTransport", &accelMag, samples, [&]() { return simTransport.busMicros(); });
+  accelMag.setTransport(NULL);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Runs sample() samples times; it returns the stamp minus the
+            simulated instant the sample was really taken
+*/
+/**************************************************************************/
+static void stampRow(const char *name, int samples, std::function<int32_t(void)> sample)
+{
+  double  sum = 0;
+  int32_t worst = 0;
+
+  for (int i = 0; i < samples; i++)
+  {
+    int32_t error = sample();
+    sum += abs(error);
+    worst = (abs(error) > abs(worst)) ? error : worst;
+  }
+  printf("  %-36s %12.1f %12ld\n", name, sum / samples, (long)worst);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sample timestamps against the models' latch instants: the old
+            millis() after the read, the back dated event timestamp and
+            sampleMicros(), blocking and with poll() / collect()
+*/
+/**************************************************************************/
+static void timestamps(uint32_t clock, int samples)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  TwoWire dmaBus;
+  bus.setClock(clock);
+  dmaBus.setClock(clock);
+
+  FlexSimFXAS21002C fxasSim;
+  FlexSimFXOS8700   fxosSim;
+  FlexSimADS1X15    adsSim(0x49, true);
+  bus.attach(&fxasSim);
+  bus.attach(&fxosSim);
+  bus.attach(&adsSim);
+  dmaBus.attach(&fxosSim);
+
+  RP_FXAS21002C         gyro(&bus);
+  RP_FXOS8700           accelMag(&bus);
+  Adafruit_ADS1115_Flex ads(&bus, 0x49);
+  FlexSimTransport      transport(&dmaBus);
+  sensors_event_t       event, mag;
+
+  gyro.begin();
+  accelMag.begin();
+
+  /* micros() is the simulated clock truncated to 32 bits */
+  #define STAMP_ERROR(stamp, truth)  ((int32_t)((uint32_t)(stamp) - (uint32_t)(truth)))
+
+  printf("\nSample timestamps vs data ready / conversion at %lu Hz (error in us)\n", (unsigned long)clock);
+  printf("  %-36s %12s %12s\n", "stamp", "mean_abs", "worst");
+
+  stampRow("FXAS21002C millis() after getEvent", samples, [&]() {
+    delayMicroseconds(3700);             // free running, called at any phase
+    gyro.getEvent(&event);
+    return STAMP_ERROR(millis() * 1000, fxasSim.sampledAt());
+  });
+  stampRow("FXAS21002C getEvent timestamp", samples, [&]() {
+    delayMicroseconds(3700);
+    gyro.getEvent(&event);
+    return STAMP_ERROR(event.timestamp * 1000, fxasSim.sampledAt());
+  });
+  stampRow("FXAS21002C getEvent sampleMicros", samples, [&]() {
+    delayMicroseconds(3700);
+    gyro.getEvent(&event);
+    return STAMP_ERROR(gyro.sampleMicros(), fxasSim.sampledAt());
+  });
+  stampRow("FXAS21002C poll/collect sampleMicros", samples, [&]() {
+    gyro.start();
+    while (gyro.poll() == FLEX_BUSY)
+    {
+      flexSimAdvance(FILTER_STEP_US);
+    }
+    gyro.collect();
+    return STAMP_ERROR(gyro.sampleMicros(), fxasSim.sampledAt());
+  });
+  stampRow("FXOS8700 poll/collect sampleMicros", samples, [&]() {
+    accelMag.start();
+    while (accelMag.poll() == FLEX_BUSY)
+    {
+      flexSimAdvance(FILTER_STEP_US);
+    }
+    accelMag.collect();
+    return STAMP_ERROR(accelMag.sampleMicros(), fxosSim.sampledAt());
+  });
+  accelMag.setTransport(&transport);
+  stampRow("FXOS8700 FlexSimTransport sampleMicros", samples, [&]() {
+    accelMag.start();
+    while (accelMag.poll() == FLEX_BUSY)
+    {
+      flexSimAdvance(FILTER_STEP_US);
+    }
+    accelMag.collect();
+    accelMag.getLastEvent(&event, &mag);
+    return STAMP_ERROR(accelMag.sampleMicros(), fxosSim.sampledAt());
+  });
+  accelMag.setTransport(NULL);
+  stampRow("ADS1115 millis() after collect", samples, [&]() {
+    ads.startADC_SingleEnded(0);
+    while (ads.poll() == FLEX_BUSY)
+    {
+      flexSimAdvance(FILTER_STEP_US);
+    }
+    ads.collect();
+    return STAMP_ERROR(millis() * 1000, adsSim.sampledAt());
+  });
+  stampRow("ADS1115 poll/collect sampleMicros", samples, [&]() {
+    ads.startADC_SingleEnded(0);
+    while (ads.poll() == FLEX_BUSY)
+    {
+      flexSimAdvance(FILTER_STEP_US);
+    }
+    ads.collect();
+    return STAMP_ERROR(ads.sampleMicros(), adsSim.sampledAt());
+  });
+
+  #undef STAMP_ERROR
+}
+
+/* FXOS8700 INT1 data ready -> ISR -> transport read -> callback -> ring */
+typedef struct
+{
+  uint32_t at;
+  uint8_t  frame[13];
+} ringSample_t;
+
+static FlexRing<ringSample_t, 16> ringSamples;
+static FlexSimTransport          *ringTransport;
+static flexI2CTransfer_t          ringTransfer;
+static uint8_t                    ringFrame[13];
+static uint32_t                   ringPeriod;
+static bool                       ringPinRunning;
+
+static void ringOnFrame(flexI2CTransfer_t *transfer)
+{
+  ringSample_t sample;
+  sample.at = (uint32_t)flexSimNow();
+  memcpy(sample.frame, transfer->data, sizeof(sample.frame));
+  ringSamples.push(sample);
+}
+
+static void ringOnDataReady(void)
+{
+  if (ringTransfer.done)
+  {
+    ringTransport->read(&ringTransfer, FXOS8700_ADDRESS, FXOS8700_REGISTER_STATUS | 0x80,
+                        ringFrame, 13, ringOnFrame);
+  }
+}
+
+/* Stand-in for the INT1 pin: a short low pulse at every latch */
+static void ringPinPulse(void *context)
+{
+  (void)context;
+  if (!ringPinRunning)
+  {
+    return;
+  }
+  flexSimSetPin(FXOS_INT1_PIN, LOW);
+  flexSimSetPin(FXOS_INT1_PIN, HIGH);
+  flexSimSchedule(flexSimNow() + ringPeriod, ringPinPulse, NULL);
+}
+
+/**************************************************************************/
+/*!
+    @brief  loop() that spends PRINT_US printing after every sample: once
+            polling the sensor itself, once draining a FlexRing filled
+            from the data ready interrupt
+*/
+/**************************************************************************/
+static void ring(uint32_t clock, int samples)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  TwoWire dmaBus;
+  bus.setClock(clock);
+  dmaBus.setClock(clock);
+
+  FlexSimFXOS8700 fxosSim;
+  bus.attach(&fxosSim);
+  dmaBus.attach(&fxosSim);
+
+  RP_FXOS8700      accelMag(&bus);
+  FlexSimTransport transport(&dmaBus);
+  accelMag.begin();
+
+  printf("\nFXOS8700 at %lu us per sample, loop() busy %d us per iteration\n",
+         (unsigned long)fxosSim.samplePeriod(), PRINT_US);
+  printf("  %-30s %9s %10s %9s %9s\n", "path", "latched", "delivered", "dropped", "overruns");
+
+  /* Polled from loop() */
+  uint32_t latched = fxosSim.samples();
+  int delivered = 0;
+  for (int i = 0; i < samples; i++)
+  {
+    accelMag.start();
+    while (accelMag.poll() == FLEX_BUSY) { }
+    delivered += accelMag.collect();
+    flexSimAdvance(PRINT_US);
+  }
+  latched = fxosSim.samples() - latched;
+  printf("  %-30s %9lu %10d %9ld %9s\n", "poll()/collect() in loop()", (unsigned long)latched,
+         delivered, (long)latched - delivered, "-");
+
+  /* Interrupt driven into the ring */
+  ringTransport = &transport;
+  ringTransfer.done = true;
+  ringTransfer.next = NULL;
+  ringPeriod = fxosSim.samplePeriod();
+  ringPinRunning = true;
+  flexSimSetPin(FXOS_INT1_PIN, HIGH);
+  attachInterrupt(FXOS_INT1_PIN, ringOnDataReady, FALLING);
+  flexSimSchedule(fxosSim.sampledAt() + ringPeriod, ringPinPulse, NULL);
+
+  latched = fxosSim.samples();
+  delivered = 0;
+  ringSample_t sample;
+  for (int i = 0; i < samples; i++)
+  {
+    while (ringSamples.pop(&sample))
+    {
+      delivered += (sample.frame[0] & FXOS8700_STATUS_ZYXDR) ? 1 : 0;
+    }
+    flexSimAdvance(PRINT_US);
+  }
+  ringPinRunning = false;
+  while (!transport.idle())
+  {
+    flexSimAdvance(10);
+  }
+  while (ringSamples.pop(&sample))
+  {
+    delivered += (sample.frame[0] & FXOS8700_STATUS_ZYXDR) ? 1 : 0;
+  }
+  latched = fxosSim.samples() - latched;
+  printf("  %-30s %9lu %10d %9ld %9lu\n", "INT1 ISR -> FlexRing", (unsigned long)latched,
+         delivered, (long)latched - delivered, (unsigned long)ringSamples.overruns());
+  detachInterrupt(FXOS_INT1_PIN);
+  flexSimAdvance(ringPeriod);            // let the last pin event lapse
+}
+
+/* ADS1x15 ALERT/RDY -> ISR -> one conversion read -> ADS1x15Stream ring */
+static ADS1x15Stream<64> *streamActive;
+
+static void streamOnAlert(void)
+{
+  streamActive->onDataReady();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Streams one ADC at its fastest data rate for STREAM_MS, with
+            loop() busy STREAM_LOOP_US between read() calls, and checks
+            every sample: spacing against the model's conversion period
+            and value against the converted input
+*/
+/**************************************************************************/
+static void streamRow(uint32_t clock, const char *name, bool is1115, adsSPS_t sps, bool useTransport)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  TwoWire dmaBus;
+  bus.setClock(clock);
+  dmaBus.setClock(clock);
+
+  FlexSimADS1X15 adsSim(0x48, is1115);
+  adsSim.setInput(0, 1.234);
+  bus.attach(&adsSim);
+  dmaBus.attach(&adsSim);
+
+  Adafruit_ADS1015_Flex  ads1015(&bus, 0x48);
+  Adafruit_ADS1115_Flex  ads1115(&bus, 0x48);
+  Adafruit_ADS1015_Flex *ads = is1115 ? &ads1115 : &ads1015;
+  FlexSimTransport       transport(&dmaBus);
+  ADS1x15Stream<64>      stream(ads, useTransport ? &transport : NULL);
+
+  ads->begin();
+  ads->setSPS(sps);
+  int16_t expected = ads->readADC_SingleEnded(0);
+
+  streamActive = &stream;
+  adsSim.setAlertPin(ADS_ALERT_PIN);
+  attachInterrupt(ADS_ALERT_PIN, streamOnAlert, FALLING);
+
+  stream.start_SingleEnded(0);
+  bus.resetStats();
+  dmaBus.resetStats();
+  uint32_t conversions = adsSim.conversions();
+  uint32_t period = adsSim.conversionMicros();
+  uint64_t end = flexSimNow() + (uint64_t)STREAM_MS * 1000;
+
+  uint32_t samples = 0;
+  uint32_t wrong = 0;
+  uint32_t maxSpacingError = 0;
+  uint32_t lastAt = 0;
+  adsSample_t sample;
+  while (flexSimNow() < end)
+  {
+    while (stream.read(&sample))
+    {
+      if (samples > 0)
+      {
+        uint32_t gap = sample.at - lastAt;
+        uint32_t periods = (gap + period / 2) / period;
+        uint32_t error = (uint32_t)abs((int32_t)(gap - periods * period));
+        maxSpacingError = (error > maxSpacingError) ? error : maxSpacingError;
+      }
+      lastAt = sample.at;
+      wrong += (sample.counts != expected) ? 1 : 0;
+      samples++;
+    }
+    flexSimAdvance(STREAM_LOOP_US);
+  }
+  conversions = adsSim.conversions() - conversions;
+  flexSimBusStats_t s = bus.stats();
+  flexSimBusStats_t d = dmaBus.stats();
+
+  stream.stop();
+  detachInterrupt(ADS_ALERT_PIN);
+  while (stream.read(&sample))
+  {
+    samples++;
+  }
+
+  printf("  %-40s %7lu %7lu %5lu %5lu %6.2f %7lu\n", name, (unsigned long)conversions,
+         (unsigned long)samples, (unsigned long)stream.lost(), (unsigned long)wrong,
+         samples ? (double)(s.transactions + d.transactions) / samples : 0.0,
+         (unsigned long)maxSpacingError);
+}
+
+/**************************************************************************/
+/*!
+    @brief  ADS1x15Stream at the ADS1015's 3300 SPS and the ADS1115's 860
+            SPS, the read queued on a transport or done by read() in loop()
+*/
+/**************************************************************************/
+static void stream(uint32_t clock)
+{
+  printf("\nADS1x15Stream at %lu Hz, ALERT/RDY paced, %d ms, loop() busy %d us per pass\n",
+         (unsigned long)clock, STREAM_MS, STREAM_LOOP_US);
+  printf("  %-40s %7s %7s %5s %5s %6s %7s\n", "path", "conv", "samples", "lost", "wrong",
+         "txn", "jit_us");
+  streamRow(clock, "ADS1015 3300 SPS, transport (ISR read)", false, ADS1015_DR_3300SPS, true);
+  streamRow(clock, "ADS1015 3300 SPS, read() in loop()", false, ADS1015_DR_3300SPS, false);
+  streamRow(clock, "ADS1115 860 SPS, transport (ISR read)", true, ADS1115_DR_860SPS, true);
+  streamRow(clock, "ADS1115 860 SPS, read() in loop()", true, ADS1115_DR_860SPS, false);
+}
+
+/**************************************************************************/
+/*!
+    @brief  One frame path: per frame transactions, bus time, elapsed
+            time, and the stamp error of the frame's last conversion
+*/
+/**************************************************************************/
+static void scanRow(TwoWire *bus, const char *name, int frames, std::function<int32_t(void)> frame)
+{
+  int32_t worst = 0;
+
+  bus->resetStats();
+  uint64_t startedAt = flexSimNow();
+  for (int i = 0; i < frames; i++)
+  {
+    int32_t error = frame();
+    worst = (abs(error) > abs(worst)) ? error : worst;
+  }
+  uint64_t elapsed = flexSimNow() - startedAt;
+  flexSimBusStats_t s = bus->stats();
+
+  printf("  %-40s %6.1f %8.1f %9.1f %7ld\n", name, (double)s.transactions / frames,
+         (double)s.busMicros / frames, (double)elapsed / frames, (long)worst);
+}
+
+/**************************************************************************/
+/*!
+    @brief  All four inputs of each ADC read one by one with
+            readADC_SingleEnded() against one ADS1x15Scan frame, and a
+            mixed list with a per entry gain and data rate
+*/
+/**************************************************************************/
+static void scan(uint32_t clock, int frames)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimADS1X15 ads1015Sim(0x48, false);
+  FlexSimADS1X15 ads1115Sim(0x49, true);
+  const float inputs[4] = { 1.234F, 0.345F, 2.5F, 0.02F };
+  for (uint8_t c = 0; c < 4; c++)
+  {
+    ads1015Sim.setInput(c, inputs[c]);
+    ads1115Sim.setInput(c, inputs[c]);
+  }
+  bus.attach(&ads1015Sim);
+  bus.attach(&ads1115Sim);
+
+  Adafruit_ADS1015_Flex ads1015(&bus, 0x48);
+  Adafruit_ADS1115_Flex ads1115(&bus, 0x49);
+  ads1015.begin();
+  ads1115.begin();
+  ads1015.setSPS(ADS1015_DR_3300SPS);
+  ads1115.setSPS(ADS1115_DR_860SPS);
+
+  ADS1x15Scan scan1015(&ads1015);
+  ADS1x15Scan scan1115(&ads1115);
+  ADS1x15Scan mixed(&ads1115);
+  for (uint8_t c = 0; c < 4; c++)
+  {
+    scan1015.addSingleEnded(c, GAIN_TWOTHIRDS, ADS1015_DR_3300SPS);
+    scan1115.addSingleEnded(c, GAIN_TWOTHIRDS, ADS1115_DR_860SPS);
+  }
+  mixed.addSingleEnded(0, GAIN_TWO, ADS1115_DR_860SPS);
+  mixed.addSingleEnded(2, GAIN_ONE, ADS1115_DR_475SPS);
+  mixed.addDifferential(DIFF_MUX_0_1, GAIN_TWO, ADS1115_DR_250SPS);
+  mixed.addSingleEnded(3, GAIN_SIXTEEN, ADS1115_DR_860SPS);
+
+  /* micros() is the simulated clock truncated to 32 bits */
+  #define STAMP_ERROR(stamp, truth)  ((int32_t)((uint32_t)(stamp) - (uint32_t)(truth)))
+
+  printf("\nFour input frames at %lu Hz, %d frames (per frame; stamp error of the last input in us)\n",
+         (unsigned long)clock, frames);
+  printf("  %-40s %6s %8s %9s %7s\n", "path", "txn", "bus_us", "total_us", "stamp");
+
+  int16_t single[4];
+  adsScanFrame_t frame;
+  uint32_t wrong = 0;
+
+  scanRow(&bus, "ADS1015 3300 SPS, 4 x readADC_SingleEnded", frames, [&]() {
+    for (uint8_t c = 0; c < 4; c++)
+    {
+      single[c] = ads1015.readADC_SingleEnded(c);
+    }
+    return STAMP_ERROR(ads1015.sampleMicros(), ads1015Sim.sampledAt());
+  });
+  scanRow(&bus, "ADS1015 3300 SPS, ADS1x15Scan", frames, [&]() {
+    scan1015.read(&frame);
+    for (uint8_t c = 0; c < 4; c++)
+    {
+      wrong += (frame.counts[c] != single[c]) ? 1 : 0;
+    }
+    return STAMP_ERROR(frame.at[3], ads1015Sim.sampledAt());
+  });
+  scanRow(&bus, "ADS1115 860 SPS, 4 x readADC_SingleEnded", frames, [&]() {
+    for (uint8_t c = 0; c < 4; c++)
+    {
+      single[c] = ads1115.readADC_SingleEnded(c);
+    }
+    return STAMP_ERROR(ads1115.sampleMicros(), ads1115Sim.sampledAt());
+  });
+  scanRow(&bus, "ADS1115 860 SPS, ADS1x15Scan", frames, [&]() {
+    scan1115.read(&frame);
+    for (uint8_t c = 0; c < 4; c++)
+    {
+      wrong += (frame.counts[c] != single[c]) ? 1 : 0;
+    }
+    return STAMP_ERROR(frame.at[3], ads1115Sim.sampledAt());
+  });
+  scanRow(&bus, "ADS1115 mixed gain / rate, ADS1x15Scan", frames, [&]() {
+    mixed.read(&frame);
+    return STAMP_ERROR(frame.at[3], ads1115Sim.sampledAt());
+  });
+  printf("  scan results that differ from readADC_SingleEnded(): %lu; mixed list %ld %ld %ld %ld uV\n",
+         (unsigned long)wrong, (long)frame.microvolts[0], (long)frame.microvolts[1],
+         (long)frame.microvolts[2], (long)frame.microvolts[3]);
+  check(wrong == 0, "ADS1x15Scan results differ from readADC_SingleEnded()");
+
+  #undef STAMP_ERROR
+}
+
+/**************************************************************************/
+/*!
+    @brief  Four ADS1115s (0x48-0x4B) at 860 SPS: one channel and all 16,
+            per device one after another against ADS1x15Array. Skew is
+            the largest spread of the conversion midpoints of one channel
+            across the devices.
+*/
+/**************************************************************************/
+static void array(uint32_t clock, int frames)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimADS1X15 sim0(0x48, true), sim1(0x49, true), sim2(0x4A, true), sim3(0x4B, true);
+  Adafruit_ADS1115_Flex adc0(&bus, 0x48), adc1(&bus, 0x49), adc2(&bus, 0x4A), adc3(&bus, 0x4B);
+  FlexSimADS1X15 *sims[4] = { &sim0, &sim1, &sim2, &sim3 };
+  Adafruit_ADS1115_Flex *adcs[4] = { &adc0, &adc1, &adc2, &adc3 };
+  ADS1x15Array adcArray;
+  for (uint8_t d = 0; d < 4; d++)
+  {
+    for (uint8_t c = 0; c < 4; c++)
+    {
+      sims[d]->setInput(c, 0.1F * (d * 4 + c + 1));
+    }
+    bus.attach(sims[d]);
+    adcs[d]->begin();
+    adcs[d]->setSPS(ADS1115_DR_860SPS);
+    adcArray.add(adcs[d]);
+  }
+
+  printf("\nFour ADS1115 at 860 SPS, %lu Hz, %d frames (per frame; skew and throughput over the devices)\n",
+         (unsigned long)clock, frames);
+  printf("  %-40s %6s %8s %9s %7s %8s\n", "path", "txn", "bus_us", "total_us", "skew_us", "ch/s");
+
+  int16_t serial[4][4];
+  adsArrayFrame_t frame;
+  uint32_t wrong = 0;
+  uint32_t stamps[4][4];
+
+  auto row = [&](const char *name, int channels, std::function<void(void)> path) {
+    uint32_t skew = 0;
+    bus.resetStats();
+    uint64_t startedAt = flexSimNow();
+    for (int i = 0; i < frames; i++)
+    {
+      path();
+      for (int c = 0; c < channels; c++)
+      {
+        uint32_t lo = stamps[0][c], hi = stamps[0][c];
+        for (int d = 1; d < 4; d++)
+        {
+          lo = (stamps[d][c] < lo) ? stamps[d][c] : lo;
+          hi = (stamps[d][c] > hi) ? stamps[d][c] : hi;
+        }
+        skew = (hi - lo > skew) ? hi - lo : skew;
+      }
+    }
+    double elapsed = (double)(flexSimNow() - startedAt) / frames;
+    flexSimBusStats_t s = bus.stats();
+    printf("  %-40s %6.1f %8.1f %9.1f %7lu %8.0f\n", name, (double)s.transactions / frames,
+           (double)s.busMicros / frames, elapsed, (unsigned long)skew, 4 * channels * 1e6 / elapsed);
+  };
+
+  row("channel 0, readADC_SingleEnded per device", 1, [&]() {
+    for (uint8_t d = 0; d < 4; d++)
+    {
+      serial[d][0] = adcs[d]->readADC_SingleEnded(0);
+      stamps[d][0] = adcs[d]->sampleMicros();
+    }
+  });
+  row("channel 0, ADS1x15Array", 1, [&]() {
+    adcArray.readADC_SingleEnded(0, &frame);
+    for (uint8_t d = 0; d < 4; d++)
+    {
+      wrong += (frame.counts[d][0] != serial[d][0]) ? 1 : 0;
+      stamps[d][0] = frame.at[d][0];
+    }
+  });
+  row("16 channels, readADC_SingleEnded each", 4, [&]() {
+    for (uint8_t d = 0; d < 4; d++)
+    {
+      for (uint8_t c = 0; c < 4; c++)
+      {
+        serial[d][c] = adcs[d]->readADC_SingleEnded(c);
+        stamps[d][c] = adcs[d]->sampleMicros();
+      }
+    }
+  });
+  row("16 channels, ADS1x15Array", 4, [&]() {
+    adcArray.readAll_SingleEnded(&frame);
+    for (uint8_t d = 0; d < 4; d++)
+    {
+      for (uint8_t c = 0; c < 4; c++)
+      {
+        wrong += (frame.counts[d][c] != serial[d][c]) ? 1 : 0;
+        stamps[d][c] = frame.at[d][c];
+      }
+    }
+  });
+  printf("  array results that differ from readADC_SingleEnded(): %lu, valid mask 0x%04lx\n",
+         (unsigned long)wrong, (unsigned long)frame.valid);
+  check((wrong == 0) && (frame.valid == 0xffff), "ADS1x15Array results differ from readADC_SingleEnded()");
+
+  bus.detach(&sim2);
+  flexResult_t result = adcArray.readAll_SingleEnded(&frame);
+  printf("  0x4A removed: %s, valid mask 0x%04lx\n", flexResultString(result), (unsigned long)frame.valid);
+}
+
+/**************************************************************************/
+/*!
+    @brief  readADC_SingleEnded() on a chip whose oscillator runs off the
+            nominal data rate: waitForConversion() sleeps through the
+            modelled time and confirms it with one OS check, overruns
+            teach it the chip's trim. Stamp is the error of the last
+            sampleMicros() against the model's conversion midpoint.
+*/
+/**************************************************************************/
+static void conversionRow(uint32_t clock, const char *name, bool is1115, adsSPS_t sps, float rateError, int samples)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimADS1X15 sim(0x48, is1115);
+  sim.setInput(0, 1.234F);
+  sim.setRateError(rateError);
+  bus.attach(&sim);
+
+  Adafruit_ADS1115_Flex ads1115(&bus, 0x48);
+  Adafruit_ADS1015_Flex ads1015(&bus, 0x48);
+  Adafruit_ADS1015_Flex *ads = is1115 ? &ads1115 : &ads1015;
+  ads->begin();
+  ads->setSPS(sps);
+
+  bus.resetStats();
+  uint64_t startedAt = flexSimNow();
+  for (int i = 0; i < samples; i++)
+  {
+    ads->readADC_SingleEnded(0);
+  }
+  uint64_t elapsed = flexSimNow() - startedAt;
+  flexSimBusStats_t s = bus.stats();
+
+  printf("  %-30s %+6.1f%% %6.2f %10.1f %9lu %6u %7ld\n", name, rateError * 100.0,
+         (double)s.transactions / samples, (double)elapsed / samples,
+         (unsigned long)ads->conversionOverruns(), ads->rateTrim(),
+         (long)(int32_t)(ads->sampleMicros() - (uint32_t)sim.sampledAt()));
+}
+
+static void conversionModel(uint32_t clock, int samples)
+{
+  printf("\nConversion time model at %lu Hz, %d x readADC_SingleEnded (per sample; trim in 1/1024)\n",
+         (unsigned long)clock, samples);
+  printf("  %-30s %7s %6s %10s %9s %6s %7s\n", "chip", "osc", "txn", "total_us", "overruns", "trim", "stamp");
+  conversionRow(clock, "ADS1115 8 SPS", true, ADS1115_DR_8SPS, -0.10F, samples);
+  conversionRow(clock, "ADS1115 8 SPS", true, ADS1115_DR_8SPS, 0.0F, samples);
+  conversionRow(clock, "ADS1115 8 SPS", true, ADS1115_DR_8SPS, 0.05F, samples);
+  conversionRow(clock, "ADS1115 8 SPS", true, ADS1115_DR_8SPS, 0.10F, samples);
+  conversionRow(clock, "ADS1115 860 SPS", true, ADS1115_DR_860SPS, 0.10F, samples);
+  conversionRow(clock, "ADS1015 3300 SPS", false, ADS1015_DR_3300SPS, 0.0F, samples);
+  conversionRow(clock, "ADS1015 3300 SPS", false, ADS1015_DR_3300SPS, 0.10F, samples);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Four inputs from 12 mV to 3.3 V on one ADS1115: the error of
+            a fixed gain against auto range, then ADS1x15Scan frames with
+            auto range and an input that jumps past its predicted range
+*/
+/**************************************************************************/
+static void autoRange(uint32_t clock, int frames)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimADS1X15 sim(0x48, true);
+  const float inputs[4] = { 0.0123F, 0.3141F, 1.4142F, 3.3F };
+  for (uint8_t c = 0; c < 4; c++)
+  {
+    sim.setInput(c, inputs[c]);
+  }
+  bus.attach(&sim);
+
+  Adafruit_ADS1115_Flex ads(&bus, 0x48);
+  ads.begin();
+  ads.setSPS(ADS1115_DR_860SPS);
+
+  printf("\nAuto range, ADS1115 at %lu Hz (error of readADC_SingleEnded_uV() in uV)\n", (unsigned long)clock);
+  printf("  %-10s %10s %10s %10s %10s\n", "input_V", "+-6.144V", "+-0.256V", "auto", "auto_range");
+  for (uint8_t c = 0; c < 4; c++)
+  {
+    int32_t truth = (int32_t)lroundf(inputs[c] * 1000000.0F);
+    int32_t wide, narrow, autoUv;
+
+    ads.setAutoRange(false);
+    ads.setGain(GAIN_TWOTHIRDS);
+    ads.readADC_SingleEnded_uV(c, &wide);
+    ads.setGain(GAIN_SIXTEEN);
+    ads.readADC_SingleEnded_uV(c, &narrow);
+    ads.setAutoRange(true);
+    ads.readADC_SingleEnded_uV(c, &autoUv);      // learns the range
+    ads.readADC_SingleEnded_uV(c, &autoUv);
+
+    printf("  %-10.4f %10ld %10ld %10ld %9.3fV\n", inputs[c], (long)labs(wide - truth),
+           (long)labs(narrow - truth), (long)labs(autoUv - truth),
+           adsFullScaleMicrovolts(ads.lastGain()) / 1000000.0);
+  }
+
+  ADS1x15Scan fixed(&ads);
+  ADS1x15Scan ranged(&ads);
+  for (uint8_t c = 0; c < 4; c++)
+  {
+    fixed.addSingleEnded(c, GAIN_TWOTHIRDS, ADS1115_DR_860SPS);
+    ranged.addSingleEnded(c, GAIN_TWOTHIRDS, ADS1115_DR_860SPS);
+  }
+  ranged.setAutoRange(true);
+
+  adsScanFrame_t frame;
+  auto frameError = [&](void) {
+    int32_t worst = 0;
+    for (uint8_t c = 0; c < 4; c++)
+    {
+      worst = max(worst, (int32_t)labs(frame.microvolts[c] - (int32_t)lroundf(inputs[c] * 1000000.0F)));
+    }
+    return worst;
+  };
+
+  printf("  %-40s %6s %8s %9s %7s\n", "scan frames", "txn", "bus_us", "total_us", "err_uV");
+  scanRow(&bus, "ADS1x15Scan, +-6.144V", frames, [&]() {
+    fixed.read(&frame);
+    return frameError();
+  });
+  ranged.read(&frame);                          // the first frame predicts the ranges
+  scanRow(&bus, "ADS1x15Scan, auto range", frames, [&]() {
+    ranged.read(&frame);
+    return frameError();
+  });
+
+  uint32_t before = ads.rangeReconversions();
+  sim.setInput(0, 2.5F);
+  scanRow(&bus, "auto range, AIN0 12 mV -> 2.5 V", 1, [&]() {
+    ranged.read(&frame);
+    return (int32_t)labs(frame.microvolts[0] - 2500000);
+  });
+  uint32_t reconversions = ads.rangeReconversions() - before;
+  ranged.read(&frame);
+  printf("  reconversions %lu, the next frame converts AIN0 at +-%.3f V\n", (unsigned long)reconversions,
+         adsFullScaleMicrovolts(frame.gain[0]) / 1000000.0);
+}
+
+static uint32_t logNoise(uint32_t *seed, int range)
+{
+  *seed = *seed * 1103515245 + 12345;
+  return (int)((*seed >> 16) % (2 * range + 1)) - range;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Bytes per sample of the example sketches' text lines against
+            FlexLog records of the same samples, and a round trip of all
+            records through FlexLogDecoder
+*/
+/**************************************************************************/
+static void logSize(uint32_t clock)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimFXOS8700  fxosSim;
+  FlexSimMPL3115A2 mplSim;
+  FlexSimBQ27441   bqSim;
+  bus.attach(&fxosSim);
+  bus.attach(&mplSim);
+  bus.attach(&bqSim);
+
+  RP_FXOS8700    accelMag(&bus);
+  MPL3115A2_Flex mpl(&bus);
+  BQ27441_Flex   lipo(&bus);
+  accelMag.begin(ACCEL_RANGE_4G);
+  mpl.init();
+  lipo.begin();
+
+  FlexLogEncoder          encoder;
+  std::vector<uint8_t>    stream;
+  std::vector<flexLogRecord_t> sent;
+  uint8_t                 record[FLEX_LOG_RECORD_MAX];
+  char                    line[160];
+  uint32_t                seed = 4321;
+
+  /* Keeps what was encoded, to check the decoder against */
+  auto log = [&](uint8_t id, uint32_t at, const int32_t *values, uint8_t count) {
+    uint8_t n = encoder.encode(id, at, values, count, record);
+    stream.insert(stream.end(), record, record + n);
+    flexLogRecord_t r;
+    r.id = id;
+    r.count = count;
+    r.at = at;
+    memcpy(r.values, values, count * sizeof(int32_t));
+    sent.push_back(r);
+    return (int)n;
+  };
+
+  printf("\nSample log size, %d samples per sensor (bytes per sample)\n", LOG_SAMPLES);
+  printf("  %-36s %8s %8s %8s\n", "sensor (text line of the example)", "text", "FlexLog", "ratio");
+
+  /* FXOS8700 accelmagneto example, a hand moving the board slowly */
+  long text = 0, binary = 0;
+  for (int i = 0; i < LOG_SAMPLES; i++)
+  {
+    fxosSim.setAcceleration(0.05 * sin(i / 40.0) + logNoise(&seed, 2) * 0.000488,
+                            0.05 * cos(i / 40.0) + logNoise(&seed, 2) * 0.000488,
+                            1.0 + logNoise(&seed, 2) * 0.000488);
+    fxosSim.setMagnetic(22.0 + logNoise(&seed, 3) * 0.1, -4.0 + logNoise(&seed, 3) * 0.1,
+                        41.0 + logNoise(&seed, 3) * 0.1);
+    accelMag.start();
+    while (accelMag.poll() == FLEX_BUSY) { }
+    accelMag.collect();
+
+    sensors_event_t a, m;
+    accelMag.getLastEvent(&a, &m);
+    text += snprintf(line, sizeof(line), "A X: %.4f  Y: %.4f  Z: %.4f  m/s^2\r\nM X: %.1f  Y: %.1f  Z: %.1f  uT\r\n\r\n",
+                     a.acceleration.x, a.acceleration.y, a.acceleration.z,
+                     m.magnetic.x, m.magnetic.y, m.magnetic.z);
+    int32_t raw[6] = { accelMag.accel_raw.x, accelMag.accel_raw.y, accelMag.accel_raw.z,
+                       accelMag.mag_raw.x, accelMag.mag_raw.y, accelMag.mag_raw.z };
+    binary += log(0, accelMag.sampleMicros(), raw, 6);
+  }
+  printf("  %-36s %8.1f %8.1f %7.1fx\n", "FXOS8700 accel + mag", (double)text / LOG_SAMPLES,
+         (double)binary / LOG_SAMPLES, (double)text / binary);
+
+  /* MPL3115A2 SparkFunPressure example, once a second */
+  text = binary = 0;
+  for (int i = 0; i < LOG_SAMPLES; i++)
+  {
+    mplSim.setPressure(101325.0 + 20.0 * sin(i / 60.0) + logNoise(&seed, 4) * 0.25);
+    mplSim.setTemperature(21.5 + i / 200.0);
+    mpl.start();
+    while (mpl.poll() == FLEX_BUSY) { }
+    mpl.collect();
+
+    text += snprintf(line, sizeof(line), "Pressure(Pa):%.2f Temp(f):%.2f\r\n", mpl.lastPressure(),
+                     mpl.lastTemp() * 9.0 / 5.0 + 32.0);
+    int32_t raw[2] = { (int32_t)mpl.lastPressureX4(), mpl.lastTempCenti() };
+    binary += log(1, mpl.sampleMicros(), raw, 2);
+    flexSimAdvance(1000000);
+  }
+  printf("  %-36s %8.1f %8.1f %7.1fx\n", "MPL3115A2 pressure + temperature", (double)text / LOG_SAMPLES,
+         (double)binary / LOG_SAMPLES, (double)text / binary);
+
+  /* BQ27441 GPOUT_SOC_INT printBatteryStats(), a slow discharge */
+  text = binary = 0;
+  for (int i = 0; i < LOG_SAMPLES; i++)
+  {
+    bqSim.setVoltage(3950 - i / 4);
+    bqSim.setStateOfCharge(83 - i / 32);
+    bqSim.setAverageCurrent(-180 + logNoise(&seed, 6));
+    lipo.start();
+    while (lipo.poll() == FLEX_BUSY) { }
+    lipo.collect();
+
+    battery_snapshot b = lipo.snapshot();
+    text += snprintf(line, sizeof(line), "[%lu] %u%% | %u mV | %d mA | %u / %u mAh | %d mW | %u%%\r\n",
+                     millis() / 1000, b.soc, b.voltage, b.avgCurrent, b.remCapacity,
+                     b.fullCapacity, b.avgPower, b.sohPercent);
+    int32_t raw[7] = { b.soc, b.voltage, b.avgCurrent, b.remCapacity, b.fullCapacity, b.avgPower, b.sohPercent };
+    binary += log(2, lipo.sampleMicros(), raw, 7);
+    flexSimAdvance(1000000);
+  }
+  printf("  %-36s %8.1f %8.1f %7.1fx\n", "BQ27441 battery stats", (double)text / LOG_SAMPLES,
+         (double)binary / LOG_SAMPLES, (double)text / binary);
+
+  /* All three streams interleaved in one log, back through the decoder */
+  FlexLogDecoder  decoder;
+  flexLogRecord_t got;
+  size_t offset = 0, records = 0, mismatches = 0;
+  while (offset < stream.size())
+  {
+    int16_t used = decoder.decode(&stream[offset], stream.size() - offset, &got);
+    if (used <= 0)
+    {
+      break;
+    }
+    const flexLogRecord_t &want = sent[records++];
+    bool same = (got.id == want.id) && (got.count == want.count) && (got.at == want.at) &&
+                !memcmp(got.values, want.values, want.count * sizeof(int32_t));
+    mismatches += same ? 0 : 1;
+    offset += used;
+  }
+  printf("  decoded %lu of %lu records, %lu mismatches, %lu bytes left over\n", (unsigned long)records,
+         (unsigned long)sent.size(), (unsigned long)mismatches, (unsigned long)(stream.size() - offset));
+  check((records == sent.size()) && (mismatches == 0) && (offset == stream.size()),
+        "FlexLog records do not survive the decoder round trip");
+}
+
+/**************************************************************************/
+/*!
+    @brief  A FlexScheduler node run for DUTY_SECONDS of simulated time,
+            every sensor awake all the time and then duty cycled: rate,
+            time awake, estimated average current and energy per sample
+            at the BQ27441's voltage
+*/
+/**************************************************************************/
+static void dutyCycle(uint32_t clock, bool enable)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimHTU21DF    htuSim;
+  FlexSimADS1X15    adsSim(0x48, true);
+  FlexSimFXAS21002C fxasSim;
+  FlexSimFXOS8700   fxosSim;
+  FlexSimMPL3115A2  mplSim;
+  FlexSimBQ27441    bqSim;
+  bus.attach(&htuSim);
+  bus.attach(&adsSim);
+  bus.attach(&fxasSim);
+  bus.attach(&fxosSim);
+  bus.attach(&mplSim);
+  bus.attach(&bqSim);
+
+  Adafruit_HTU21DF_Flex htu(&bus);
+  Adafruit_ADS1115_Flex ads(&bus, 0x48);
+  RP_FXAS21002C         gyro(&bus);
+  RP_FXOS8700           accelMag(&bus);
+  MPL3115A2_Flex        mpl(&bus);
+  BQ27441_Flex          lipo(&bus);
+
+  htu.begin();
+  ads.begin();
+  ads.startADC_SingleEnded(0);
+  while (ads.poll() == FLEX_BUSY) { }
+  ads.collect();
+  gyro.begin();
+  accelMag.begin();
+  mpl.init();
+  mpl.setModeActive();                   // samples by itself until parked
+  lipo.begin();
+
+  static const struct
+  {
+    const char *name;
+    float       rateHz;
+  } rates[] = { { "HTU21DF", 1 }, { "ADS1115", 10 }, { "FXAS21002C", 2 },
+                { "FXOS8700", 5 }, { "MPL3115A2", 0.5F } };
+  FlexAsyncSensor *sensors[] = { &htu, &ads, &gyro, &accelMag, &mpl };
+
+  FlexScheduler scheduler;
+  for (uint8_t i = 0; i < 5; i++)
+  {
+    scheduler.add(sensors[i], &bus, rates[i].rateHz);
+    scheduler.setDutyCycle(i, enable);
+  }
+  scheduler.begin();
+
+  uint64_t end = flexSimNow() + (uint64_t)DUTY_SECONDS * 1000000;
+  while (flexSimNow() < end)
+  {
+    scheduler.run();
+    flexSimAdvance(100);
+  }
+
+  float volts = lipo.voltage() / 1000.0F;
+  for (uint8_t i = 0; i < 5; i++)
+  {
+    flexSchedulerStats_t s = scheduler.stats(i);
+    uint64_t total = (uint64_t)s.convertMicros + s.idleMicros + s.sleepMicros;
+    char name[40];
+    snprintf(name, sizeof(name), "%s %s", rates[i].name, enable ? "duty cycled" : "always on");
+    printf("  %-30s %6.2f %6lu %7lu %7.1f %9.1f %9.2f\n", name, scheduler.achievedRate(i),
+           (unsigned long)s.missed, (unsigned long)s.sleeps,
+           total ? 100.0 * (s.convertMicros + s.idleMicros) / total : 0.0,
+           scheduler.averageMicroAmps(i), scheduler.energyPerSample(i, volts));
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  One node: FXOS8700 every loop() pass, HTU21DF every 10th, a
+            FXAS21002C that is not fitted. stalls adds the field unit's
+            own work (a filter step, a slow print every 25 passes).
+*/
+/**************************************************************************/
+static void replayNode(TwoWire *bus, bool stalls, std::vector<float> *values, std::vector<uint32_t> *times,
+                       std::function<void(void)> endOfPass)
+{
+  RP_FXOS8700           accelMag(bus);
+  Adafruit_HTU21DF_Flex htu(bus);
+  RP_FXAS21002C         gyro(bus);
+
+  accelMag.begin(ACCEL_RANGE_4G);
+  htu.begin();
+  gyro.begin();
+
+  for (int i = 0; i < REPLAY_PASSES; i++)
+  {
+    sensors_event_t accel, mag;
+    accelMag.getEvent(&accel, &mag);
+    times->push_back(micros());
+    values->push_back(accel.acceleration.z);
+    values->push_back(mag.magnetic.x);
+    if (i % 10 == 0)
+    {
+      values->push_back(htu.readTemperature());
+    }
+    if (stalls)
+    {
+      flexSimAdvance(FILTER_STEP_US);
+      if (i % 25 == 24)
+      {
+        flexSimAdvance(PRINT_US);
+      }
+    }
+    endOfPass();
+  }
+}
+
+static void replayRow(const char *name, uint32_t transactions, flexSimReplayStats_t *s,
+                      const std::vector<float> &values, const std::vector<float> &field,
+                      const std::vector<uint32_t> &times, const std::vector<uint32_t> &fieldTimes)
+{
+  size_t same = 0;
+  int32_t timeError = 0;
+  for (size_t i = 0; i < values.size() && i < field.size(); i++)
+  {
+    same += (values[i] == field[i]) ? 1 : 0;
+  }
+  for (size_t i = 0; i < times.size() && i < fieldTimes.size(); i++)
+  {
+    int32_t error = (int32_t)(times[i] - fieldTimes[i]);
+    timeError = (abs(error) > abs(timeError)) ? error : timeError;
+  }
+
+  if (s == NULL)
+  {
+    printf("  %-30s %6lu %10s %9s %10s %7lu/%-4lu %8s\n", name, (unsigned long)transactions,
+           "-", "-", "-", (unsigned long)same, (unsigned long)field.size(), "-");
+    return;
+  }
+  printf("  %-30s %6lu %10lu %9.1f %10lu %7lu/%-4lu %8ld\n", name, (unsigned long)transactions,
+         (unsigned long)s->mismatches, s->pacedMicros / 1000.0, (unsigned long)s->maxGapMicros,
+         (unsigned long)same, (unsigned long)field.size(), (long)timeError);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Captures the node's bus traffic with the models attached,
+            then serves the trace to the same drivers without models:
+            paced (held to the recorded times) and as fast as it goes
+*/
+/**************************************************************************/
+static void replay(uint32_t clock)
+{
+  std::vector<uint8_t>  captured;
+  std::vector<float>    fieldValues;
+  std::vector<uint32_t> fieldTimes;
+  uint8_t               buffer[TRACE_BUFFER];
+  FlexI2CTrace          trace(buffer, sizeof(buffer));
+  uint32_t              fieldTxn;
+
+  {
+    flexSimReset();
+    TwoWire bus;
+    bus.setClock(clock);
+
+    FlexSimFXOS8700 fxosSim;
+    FlexSimHTU21DF  htuSim;
+    bus.attach(&fxosSim);
+    bus.attach(&htuSim);
+
+    /* where the sketch writes the buffer to Serial or an SD card */
+    auto drain = [&]() {
+      captured.insert(captured.end(), trace.data(), trace.data() + trace.length());
+      trace.clear();
+    };
+    FlexI2CDevice::setTrace(&trace);
+    replayNode(&bus, true, &fieldValues, &fieldTimes, drain);
+    FlexI2CDevice::setTrace(NULL);
+    drain();
+    fieldTxn = bus.stats().transactions;
+  }
+
+  printf("\nBus capture and replay at %lu Hz, %d loop() passes (FXOS8700, HTU21DF, no FXAS21002C)\n",
+         (unsigned long)clock, REPLAY_PASSES);
+  printf("  trace: %lu transactions in %lu bytes (%.1f bytes each), %lu dropped\n",
+         (unsigned long)trace.records(), (unsigned long)captured.size(),
+         (double)captured.size() / trace.records(), (unsigned long)trace.dropped());
+  printf("  %-30s %6s %10s %9s %10s %12s %8s\n", "run", "txn", "mismatches", "paced_ms",
+         "max_gap_us", "same_values", "dt_us");
+  replayRow("field unit (models)", fieldTxn, NULL, fieldValues, fieldValues, fieldTimes, fieldTimes);
+
+  for (int paced = 1; paced >= 0; paced--)
+  {
+    std::vector<float>    values;
+    std::vector<uint32_t> times;
+
+    flexSimReset();
+    TwoWire bus;
+    bus.setClock(clock);
+
+    FlexSimReplay trace(captured.data(), captured.size());
+    trace.setPacing(paced);
+    trace.attach(&bus);
+    replayNode(&bus, false, &values, &times, []() { });
+
+    flexSimReplayStats_t s = trace.stats();
+    replayRow(paced ? "replay, paced" : "replay, unpaced", bus.stats().transactions, &s,
+              values, fieldValues, times, fieldTimes);
+    check((s.mismatches == 0) && (values == fieldValues), "trace replay differs from the field unit");
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Board bus with every chip, hut bus with HTU21DF + MPL3115A2.
+            The hand written startup probes every address with an empty
+            write, begins the drivers that answered and then reads each
+            sensor once, blocking; the registry identifies, creates and
+            then runs the first conversions side by side.
+*/
+/**************************************************************************/
+static void boot(uint32_t clock, bool useRegistry)
+{
+  static const flexDriverFactory_t factories[FLEX_CHIP_COUNT] =
+  {
+    NULL, RP_FXOS8700::create, RP_FXAS21002C::create, Adafruit_HTU21DF_Flex::create,
+    Adafruit_ADS1115_Flex::create, BQ27441_Flex::create, MPL3115A2_Flex::create
+  };
+  static const struct { uint8_t address; flexChip_t chip; } known[] =
+  {
+    { 0x1F, FLEX_CHIP_FXOS8700 }, { 0x21, FLEX_CHIP_FXAS21002C }, { 0x40, FLEX_CHIP_HTU21DF },
+    { 0x48, FLEX_CHIP_ADS1X15 }, { 0x49, FLEX_CHIP_ADS1X15 }, { 0x4A, FLEX_CHIP_ADS1X15 },
+    { 0x4B, FLEX_CHIP_ADS1X15 }, { 0x55, FLEX_CHIP_BQ27441 }, { 0x60, FLEX_CHIP_MPL3115A2 }
+  };
+
+  flexSimReset();
+
+  TwoWire board;
+  TwoWire hut;
+  board.setClock(clock);
+  hut.setClock(clock);
+
+  FlexSimHTU21DF    htuSim, hutHtuSim;
+  FlexSimADS1X15    adsSim(0x48, true);
+  FlexSimFXAS21002C fxasSim;
+  FlexSimFXOS8700   fxosSim;
+  FlexSimMPL3115A2  mplSim, hutMplSim;
+  FlexSimBQ27441    bqSim;
+
+  board.attach(&htuSim);
+  board.attach(&adsSim);
+  board.attach(&fxasSim);
+  board.attach(&fxosSim);
+  board.attach(&mplSim);
+  board.attach(&bqSim);
+  hut.attach(&hutHtuSim);
+  hut.attach(&hutMplSim);
+
+  FlexAsyncSensor *sensors[FLEX_REGISTRY_DEVICES];
+  uint8_t  count = 0;
+  uint64_t scanUs = 0;
+  uint32_t scanTxn = 0;
+
+  if (useRegistry)
+  {
+    FlexRegistry registry;
+    registry.addBus(&board);
+    registry.addBus(&hut);
+    for (uint8_t chip = 1; chip < FLEX_CHIP_COUNT; chip++)
+    {
+      registry.setFactory((flexChip_t)chip, factories[chip]);
+    }
+    registry.scan();
+    scanUs = registry.scanMicros();
+    scanTxn = registry.scanStats().transactions;
+    for (uint8_t i = 0; i < registry.count(); i++)
+    {
+      if (registry.device(i).sensor != NULL)
+      {
+        sensors[count++] = registry.device(i).sensor;
+      }
+    }
+  }
+  else
+  {
+    TwoWire *buses[2] = { &board, &hut };
+    uint8_t  present[2][sizeof(known) / sizeof(known[0])];
+    uint64_t startedAt = flexSimNow();
+
+    for (uint8_t b = 0; b < 2; b++)
+    {
+      uint32_t txn = buses[b]->stats().transactions;
+      for (uint8_t i = 0; i < sizeof(known) / sizeof(known[0]); i++)
+      {
+        buses[b]->beginTransmission(known[i].address);
+        present[b][i] = (buses[b]->endTransmission() == 0);
+      }
+      scanTxn += buses[b]->stats().transactions - txn;
+    }
+    scanUs = flexSimNow() - startedAt;
+
+    for (uint8_t b = 0; b < 2; b++)
+    {
+      for (uint8_t i = 0; i < sizeof(known) / sizeof(known[0]); i++)
+      {
+        FlexAsyncSensor *sensor = present[b][i] ? factories[known[i].chip](buses[b], known[i].address) : NULL;
+        if (sensor != NULL)
+        {
+          sensors[count++] = sensor;
+        }
+      }
+    }
+  }
+  uint64_t begunAt = flexSimNow();
+
+  /* First sample of every sensor */
+  uint8_t sampled = 0;
+  if (useRegistry)
+  {
+    bool done[FLEX_REGISTRY_DEVICES];
+    for (uint8_t i = 0; i < count; i++)
+    {
+      done[i] = !sensors[i]->start();
+    }
+    while (sampled < count)
+    {
+      sampled = 0;
+      for (uint8_t i = 0; i < count; i++)
+      {
+        if (!done[i])
+        {
+          flexState_t state = sensors[i]->poll();
+          if (state == FLEX_READY)
+          {
+            sensors[i]->collect();
+          }
+          done[i] = (state == FLEX_READY) || (state == FLEX_ERROR);
+        }
+        sampled += done[i];
+      }
+    }
+  }
+  else
+  {
+    for (uint8_t i = 0; i < count; i++)
+    {
+      sensors[i]->start();
+      while (sensors[i]->poll() == FLEX_BUSY)
+      {
+      }
+      sensors[i]->collect();
+      sampled++;
+    }
+  }
+
+  printf("  %-30s %7u %9lu %10.1f %11.1f %13.1f\n", useRegistry ? "FlexRegistry" : "probe, begin, read in turn",
+         count, (unsigned long)scanTxn, (double)scanUs, begunAt / 1000.0, flexSimNow() / 1000.0);
+}
+
+static void fault(TwoWire *bus, const char *name, std::function<flexResult_t(void)> path)
+{
+  bus->resetStats();
+  uint64_t startedAt = flexSimNow();
+  flexResult_t result = path();
+
+  printf("  %-36s %-16s %6lu %10.1f\n", name, flexResultString(result),
+         (unsigned long)bus->stats().transactions, (double)(flexSimNow() - startedAt));
+}
+
+static void faults(uint32_t clock)
+{
+  flexSimReset();
+
+  TwoWire bus;
+  bus.setClock(clock);
+
+  FlexSimADS1X15 adsSim(0x48, true);
+  bus.attach(&adsSim);
+
+  Adafruit_HTU21DF_Flex htu(&bus);
+  Adafruit_ADS1115_Flex ads(&bus, 0x48);
+  RP_FXAS21002C         gyro(&bus);
+  MPL3115A2_Flex        mpl(&bus);
+  BQ27441_Flex          lipo(&bus);
+
+  printf("\nFailed reads at %lu Hz (timeout %lu us)\n", (unsigned long)clock, (unsigned long)FLEX_I2C_TIMEOUT_US);
+  printf("  %-36s %-16s %6s %10s\n", "path", "result", "txn", "total_us");
+
+  fault(&bus, "HTU21DF readTemperature, absent", [&]() { float v; return htu.readTemperature(&v); });
+  fault(&bus, "MPL3115A2 readPressure, absent", [&]() { float v; return mpl.readPressure(&v); });
+  fault(&bus, "FXAS21002C getEvent, absent", [&]() {
+    sensors_event_t event;
+    gyro.getEvent(&event);
+    return gyro.lastError();
+  });
+  fault(&bus, "BQ27441 soc, absent", [&]() { lipo.soc(); return lipo.lastError(); });
+  fault(&bus, "ADS1115 readADC_SingleEnded, ok", [&]() { int16_t v; return ads.readADC_SingleEnded(0, &v); });
+  adsSim.setRateError(1000);
+  fault(&bus, "ADS1115 readADC_SingleEnded, stalled", [&]() { int16_t v; return ads.readADC_SingleEnded(0, &v); });
+}
+
+int main(int argc, char **argv)
+{
+  int samples = (argc > 1) ? atoi(argv[1]) : 20;
+  if (samples < 1)
+  {
+    samples = 1;
+  }
+
+  printf("Flex driver bus cost on the host simulator, %d samples per path\n", samples);
+  report(100000, samples);
+  report(400000, samples);
+  report(1000000, samples);
+  fixedPoint(400000);
+  batchConvert(400000);
+  templates(400000);
+  registers(400000);
+  overlap(400000, samples);
+  timestamps(400000, samples);
+  ring(400000, samples);
+  stream(400000);
+  stream(100000);
+  scan(400000, samples);
+  scan(100000, samples);
+  array(400000, samples);
+  conversionModel(400000, 40);
+  autoRange(400000, samples);
+  logSize(400000);
+
+  printf("\nFlexScheduler node for %d s at 400000 Hz, typical datasheet currents\n", DUTY_SECONDS);
+  printf("  %-30s %6s %6s %7s %7s %9s %9s\n", "sensor", "Hz", "missed", "sleeps", "awake%",
+         "avg_uA", "uJ/sample");
+  dutyCycle(400000, false);
+  dutyCycle(400000, true);
+  replay(400000);
+
+  printf("\nBoot of a two bus node (board: 6 chips, hut: HTU21DF + MPL3115A2) at 400000 Hz\n");
+  printf("  %-30s %7s %9s %10s %11s %13s\n", "startup", "drivers", "scan_txn", "scan_us",
+         "begun_ms", "1st_sample_ms");
+  boot(400000, false);
+  boot(400000, true);
+  faults(400000);
+
+  if (checkFailures > 0)
+  {
+    printf("\n%lu checks FAILED\n", (unsigned long)checkFailures);
+    return 1;
+  }
+  return 0;
+}
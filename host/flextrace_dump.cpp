@@ -0,0 +1,142 @@
+/**************************************************************************/
+/*!
+    @file     flextrace_dump.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Prints a binary FlexI2CTrace capture as CSV: one line per
+    transaction with its micros() start time, the time since the
+    previous one, address, direction, STOP / repeated START, result and
+    the bytes on the wire. A summary per address (transactions, bytes,
+    failures) and the largest gaps between transactions go to stderr.
+
+    Usage: flextrace_dump [file]      (stdin without a file)
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "FlexI2CTrace.h"
+
+#define DUMP_GAPS   5
+
+typedef struct
+{
+  unsigned long transactions;
+  unsigned long bytes;
+  unsigned long failures;
+} addressSummary_t;
+
+int main(int argc, char **argv)
+{
+  FILE *in = stdin;
+  if (argc > 1)
+  {
+    in = fopen(argv[1], "rb");
+    if (!in)
+    {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t got;
+  while ((got = fread(chunk, 1, sizeof(chunk), in)) > 0)
+  {
+    data.insert(data.end(), chunk, chunk + got);
+  }
+  if (in != stdin)
+  {
+    fclose(in);
+  }
+
+  FlexI2CTraceReader reader;
+  flexTraceRecord_t  record;
+  addressSummary_t   summary[128];
+  unsigned long      gapAt[DUMP_GAPS];
+  unsigned long      gap[DUMP_GAPS];
+  size_t   offset = 0;
+  unsigned long records = 0;
+  uint32_t previous = 0;
+
+  memset(summary, 0, sizeof(summary));
+  memset(gap, 0, sizeof(gap));
+  memset(gapAt, 0, sizeof(gapAt));
+
+  printf("micros,delta,address,op,stop,result,count,received,bytes\n");
+  while (offset < data.size())
+  {
+    size_t left = data.size() - offset;
+    int16_t used = reader.decode(&data[offset], (left > 0xFFFF) ? 0xFFFF : (uint16_t)left, &record);
+    if (used < 0)
+    {
+      fprintf(stderr, "flextrace_dump: bad record at byte %lu\n", (unsigned long)offset);
+      return 1;
+    }
+    if (used == 0)
+    {
+      fprintf(stderr, "flextrace_dump: %lu trailing bytes of a partial record\n", (unsigned long)left);
+      break;
+    }
+
+    unsigned long delta = records ? (unsigned long)(uint32_t)(record.at - previous) : 0;
+    previous = record.at;
+
+    printf("%lu,%lu,0x%02X,%c,%d,%s,%u,%u,", (unsigned long)record.at, delta, record.address,
+           record.read ? 'R' : 'W', record.stop ? 1 : 0, flexResultString(record.result),
+           record.count, record.received);
+    for (uint8_t i = 0; i < record.length; i++)
+    {
+      printf("%02X", record.data[i]);
+    }
+    printf("\n");
+
+    addressSummary_t *s = &summary[record.address & 0x7F];
+    s->transactions++;
+    s->bytes += record.read ? record.received : record.count;
+    if (record.result != FLEX_OK)
+    {
+      s->failures++;
+    }
+
+    /* keep the DUMP_GAPS largest gaps, largest first */
+    for (uint8_t i = 0; i < DUMP_GAPS; i++)
+    {
+      if (delta > gap[i])
+      {
+        memmove(&gap[i + 1], &gap[i], (DUMP_GAPS - 1 - i) * sizeof(gap[0]));
+        memmove(&gapAt[i + 1], &gapAt[i], (DUMP_GAPS - 1 - i) * sizeof(gapAt[0]));
+        gap[i] = delta;
+        gapAt[i] = record.at;
+        break;
+      }
+    }
+
+    offset += used;
+    records++;
+  }
+
+  fprintf(stderr, "flextrace_dump: %lu transactions, %lu bytes\n", records, (unsigned long)data.size());
+  fprintf(stderr, "  address  transactions    bytes  failed\n");
+  for (uint8_t a = 0; a < 128; a++)
+  {
+    if (summary[a].transactions)
+    {
+      fprintf(stderr, "  0x%02X    %12lu %8lu %7lu\n", a, summary[a].transactions,
+              summary[a].bytes, summary[a].failures);
+    }
+  }
+  fprintf(stderr, "  largest gaps (us before the transaction at micros):");
+  for (uint8_t i = 0; i < DUMP_GAPS && gap[i]; i++)
+  {
+    fprintf(stderr, " %lu@%lu", gap[i], gapAt[i]);
+  }
+  fprintf(stderr, "\n");
+  return 0;
+}
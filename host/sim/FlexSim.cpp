@@ -0,0 +1,222 @@
+/**************************************************************************/
+/*!
+    @file     FlexSim.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated clock and pins for the host build.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexSim.h"
+
+static uint64_t simNow = 0;
+static uint64_t simDelayMicros = 0;
+static uint8_t  simPins[FLEX_SIM_PINS];
+static void   (*simHandlers[FLEX_SIM_PINS])(void);
+static int      simModes[FLEX_SIM_PINS];
+static bool     simInterruptsEnabled = true;
+static bool     simFiring = false;
+
+static struct
+{
+  uint64_t       at;
+  flexSimEvent_t event;
+  void          *context;
+} simEvents[FLEX_SIM_EVENTS];
+static uint8_t  simEventCount = 0;
+
+/**************************************************************************/
+/*!
+    @brief  Moves the clock forward, firing the timed events it passes in
+            order (each at its own time). Events fired from an event only
+            move the clock.
+*/
+/**************************************************************************/
+static void advance(uint64_t us)
+{
+  uint64_t target = simNow + us;
+
+  while (!simFiring && simInterruptsEnabled)
+  {
+    int8_t next = -1;
+    for (uint8_t i = 0; i < simEventCount; i++)
+    {
+      if ((simEvents[i].at <= target) && ((next < 0) || (simEvents[i].at < simEvents[next].at)))
+      {
+        next = i;
+      }
+    }
+    if (next < 0)
+    {
+      break;
+    }
+
+    flexSimEvent_t event = simEvents[next].event;
+    void *context = simEvents[next].context;
+    if (simEvents[next].at > simNow)
+    {
+      simNow = simEvents[next].at;
+    }
+    simEvents[next] = simEvents[--simEventCount];
+
+    simFiring = true;
+    event(context);
+    simFiring = false;
+    if (simNow > target)
+    {
+      target = simNow;
+    }
+  }
+  simNow = target;
+}
+
+uint64_t flexSimNow(void)
+{
+  return simNow;
+}
+
+void flexSimAdvance(uint64_t us)
+{
+  advance(us);
+}
+
+void flexSimReset(void)
+{
+  simNow = 0;
+  simDelayMicros = 0;
+  simEventCount = 0;
+  memset(simPins, 0, sizeof(simPins));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Drives an input pin, fires its interrupt handler on a
+            matching edge
+*/
+/**************************************************************************/
+void flexSimSetPin(uint8_t pin, uint8_t level)
+{
+  if (pin >= FLEX_SIM_PINS)
+  {
+    return;
+  }
+
+  uint8_t old = simPins[pin];
+  simPins[pin] = level ? HIGH : LOW;
+  if ((old == simPins[pin]) || (simHandlers[pin] == NULL) || !simInterruptsEnabled)
+  {
+    return;
+  }
+
+  if ((simModes[pin] == CHANGE) ||
+      ((simModes[pin] == RISING) && (simPins[pin] == HIGH)) ||
+      ((simModes[pin] == FALLING) && (simPins[pin] == LOW)))
+  {
+    simHandlers[pin]();
+  }
+}
+
+uint64_t flexSimDelayMicros(void)
+{
+  return simDelayMicros;
+}
+
+void flexSimResetDelayMicros(void)
+{
+  simDelayMicros = 0;
+}
+
+bool flexSimSchedule(uint64_t at, flexSimEvent_t event, void *context)
+{
+  if (simEventCount >= FLEX_SIM_EVENTS)
+  {
+    return false;
+  }
+  simEvents[simEventCount].at = at;
+  simEvents[simEventCount].event = event;
+  simEvents[simEventCount].context = context;
+  simEventCount++;
+  return true;
+}
+
+/***************************************************************************
+ ARDUINO CORE
+ ***************************************************************************/
+
+unsigned long millis(void)
+{
+  advance(FLEX_SIM_CALL_COST_US);
+  return (unsigned long)(simNow / 1000);
+}
+
+unsigned long micros(void)
+{
+  advance(FLEX_SIM_CALL_COST_US);
+  return (unsigned long)simNow;
+}
+
+void delay(unsigned long ms)
+{
+  simDelayMicros += (uint64_t)ms * 1000;
+  advance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  simDelayMicros += us;
+  advance(us);
+}
+
+void yield(void)
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  if (pin < FLEX_SIM_PINS)
+  {
+    simPins[pin] = value ? HIGH : LOW;
+  }
+}
+
+int digitalRead(uint8_t pin)
+{
+  return (pin < FLEX_SIM_PINS) ? simPins[pin] : LOW;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*callback)(void), int mode)
+{
+  if (interrupt < FLEX_SIM_PINS)
+  {
+    simHandlers[interrupt] = callback;
+    simModes[interrupt] = mode;
+  }
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+  if (interrupt < FLEX_SIM_PINS)
+  {
+    simHandlers[interrupt] = NULL;
+  }
+}
+
+void noInterrupts(void)
+{
+  simInterruptsEnabled = false;
+}
+
+void interrupts(void)
+{
+  simInterruptsEnabled = true;
+  advance(0);   // events that came due meanwhile fire now
+}
@@ -0,0 +1,51 @@
+/**************************************************************************/
+/*!
+    @file     FlexSim.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated clock and pins for the host build.
+
+    There is no real time on the host: millis()/micros() read a simulated
+    microsecond clock. delay() and delayMicroseconds() advance it, bus
+    transfers advance it by their bus time (see Wire.h), and every
+    millis()/micros() call costs FLEX_SIM_CALL_COST_US so busy-wait loops
+    that only watch the clock still terminate.
+
+    Models can drive input pins with flexSimSetPin(); an edge fires the
+    handler registered with attachInterrupt() immediately, as an ISR would.
+
+    Timed events (flexSimSchedule()) fire as soon as the clock reaches
+    them, in the middle of whatever the CPU side is doing, like a
+    peripheral interrupt. They are held back while noInterrupts() is in
+    effect.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SIM_H
+#define _FLEX_SIM_H
+
+#include "Arduino.h"
+
+#ifndef FLEX_SIM_CALL_COST_US
+  #define FLEX_SIM_CALL_COST_US   1
+#endif
+
+#define FLEX_SIM_PINS             64
+#define FLEX_SIM_EVENTS           16
+
+typedef void (*flexSimEvent_t)(void *context);
+
+uint64_t flexSimNow(void);                  // simulated time in us
+void     flexSimAdvance(uint64_t us);
+void     flexSimReset(void);                // clock back to 0, pins low
+
+void     flexSimSetPin(uint8_t pin, uint8_t level);
+uint64_t flexSimDelayMicros(void);          // total time spent in delay()
+void     flexSimResetDelayMicros(void);
+
+bool     flexSimSchedule(uint64_t at, flexSimEvent_t event, void *context);  // false when full
+
+#endif
@@ -0,0 +1,290 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimADS1X15.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated ADS1015 / ADS1115 ADC.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexSimADS1X15.h"
+
+#define REG_CONVERT     0
+#define REG_CONFIG      1
+#define REG_LOTHRESH    2
+#define REG_HITHRESH    3
+
+#define CONFIG_OS       0x8000
+#define CONFIG_MODE     0x0100
+#define CONFIG_CPOL     0x0008
+#define CONFIG_CQUE     0x0003
+
+FlexSimADS1X15::FlexSimADS1X15(uint8_t address, bool ads1115)
+  : FlexSimDevice(address)
+{
+  _ads1115 = ads1115;
+  _pointer = REG_CONVERT;
+  _regs[REG_CONVERT] = 0x0000;
+  _regs[REG_CONFIG] = 0x8583;           // power-on default
+  _regs[REG_LOTHRESH] = 0x8000;
+  _regs[REG_HITHRESH] = 0x7FFF;
+  memset(_inputs, 0, sizeof(_inputs));
+  _rateError = 0;
+  _busy = false;
+  _continuous = false;
+  _startedAt = 0;
+  _readyAt = 0;
+  _latched = 0;
+  _conversions = 0;
+  _alertPin = -1;
+  _alertAt = 0;
+}
+
+void FlexSimADS1X15::setInput(uint8_t channel, float volts)
+{
+  if (channel < 4)
+  {
+    _inputs[channel] = volts;
+  }
+}
+
+void FlexSimADS1X15::setRateError(float fraction)
+{
+  _rateError = fraction;
+}
+
+uint16_t FlexSimADS1X15::reg(uint8_t pointer)
+{
+  update();
+  return _regs[pointer & 0x03];
+}
+
+uint32_t FlexSimADS1X15::conversions(void)
+{
+  update();
+  return _conversions;
+}
+
+/**************************************************************************/
+/*!
+    @brief  1 / data rate of the current config, including the
+            oscillator error
+*/
+/**************************************************************************/
+uint32_t FlexSimADS1X15::conversionMicros(void)
+{
+  static const uint16_t ads1015Rates[8] = { 128, 250, 490, 920, 1600, 2400, 3300, 3300 };
+  static const uint16_t ads1115Rates[8] = { 8, 16, 32, 64, 128, 250, 475, 860 };
+
+  uint8_t  index = (_regs[REG_CONFIG] >> 5) & 0x07;
+  uint16_t sps = _ads1115 ? ads1115Rates[index] : ads1015Rates[index];
+
+  return (uint32_t)((1000000.0F / sps) * (1.0F + _rateError));
+}
+
+bool FlexSimADS1X15::write(const uint8_t *data, size_t count)
+{
+  update();
+  if (count == 0)
+  {
+    return true;      // address probe
+  }
+
+  _pointer = data[0] & 0x03;
+  if (count < 3)
+  {
+    return (count == 1);
+  }
+
+  uint16_t value = ((uint16_t)data[1] << 8) | data[2];
+  if (_pointer == REG_CONVERT)
+  {
+    return true;      // read only
+  }
+  if (_pointer != REG_CONFIG)
+  {
+    _regs[_pointer] = value;
+    armAlert();
+    return true;
+  }
+
+  _regs[REG_CONFIG] = (value & ~CONFIG_OS) | (_regs[REG_CONFIG] & CONFIG_OS);
+  if (value & CONFIG_MODE)
+  {
+    _continuous = false;
+    if ((value & CONFIG_OS) && !_busy)
+    {
+      startConversion();
+    }
+  }
+  else
+  {
+    _continuous = true;
+    _busy = false;
+    _startedAt = flexSimNow();
+    _latched = 0;
+  }
+  armAlert();
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads the selected register MSB first, repeats it for reads
+            longer than 2 bytes like the real chip
+*/
+/**************************************************************************/
+size_t FlexSimADS1X15::read(uint8_t *dest, size_t count)
+{
+  update();
+
+  uint16_t value = _regs[_pointer];
+  if (_pointer == REG_CONFIG)
+  {
+    value = (value & ~CONFIG_OS) | ((_busy && !_continuous) ? 0 : CONFIG_OS);
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    dest[i] = (i & 1) ? (uint8_t)(value & 0xFF) : (uint8_t)(value >> 8);
+  }
+  return count;
+}
+
+void FlexSimADS1X15::update(void)
+{
+  uint64_t now = flexSimNow();
+
+  if (_busy && (now >= _readyAt))
+  {
+    _regs[REG_CONVERT] = convert();
+    _busy = false;
+    _conversions++;
+  }
+
+  if (_continuous)
+  {
+    uint32_t done = (uint32_t)((now - _startedAt) / conversionMicros());
+    if (done > _latched)
+    {
+      _regs[REG_CONVERT] = convert();
+      _conversions += done - _latched;
+      _latched = done;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  The instant the current result stands for: the middle of the
+            integration window that produced it
+*/
+/**************************************************************************/
+uint64_t FlexSimADS1X15::sampledAt(void)
+{
+  update();
+  uint32_t period = conversionMicros();
+  if (_continuous)
+  {
+    return _startedAt + (uint64_t)_latched * period - period / 2;
+  }
+  return _startedAt + period / 2;
+}
+
+void FlexSimADS1X15::startConversion(void)
+{
+  _busy = true;
+  _startedAt = flexSimNow();
+  _readyAt = _startedAt + conversionMicros();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Result code for the current MUX / PGA setting, clipped to full
+            scale
+*/
+/**************************************************************************/
+uint16_t FlexSimADS1X15::convert(void)
+{
+  static const float fullScale[8] = { 6.144F, 4.096F, 2.048F, 1.024F, 0.512F, 0.256F, 0.256F, 0.256F };
+  static const int8_t muxP[8] = { 0, 0, 1, 2, 0, 1, 2, 3 };
+  static const int8_t muxN[8] = { 1, 3, 3, 3, -1, -1, -1, -1 };
+
+  uint16_t config = _regs[REG_CONFIG];
+  uint8_t  mux = (config >> 12) & 0x07;
+  float    fsr = fullScale[(config >> 9) & 0x07];
+  float    volts = _inputs[muxP[mux]] - ((muxN[mux] >= 0) ? _inputs[muxN[mux]] : 0.0F);
+
+  float code = floorf(volts / fsr * 32768.0F + 0.5F);
+  code = constrain(code, -32768.0F, 32767.0F);
+
+  int16_t result = (int16_t)code;
+  if (!_ads1115)
+  {
+    result &= (int16_t)0xFFF0;            // 12 bit, left aligned
+  }
+  return (uint16_t)result;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Connects ALERT/RDY to pin (idle level per COMP_POL)
+*/
+/**************************************************************************/
+void FlexSimADS1X15::setAlertPin(uint8_t pin)
+{
+  _alertPin = pin;
+  flexSimSetPin(pin, (_regs[REG_CONFIG] & CONFIG_CPOL) ? LOW : HIGH);
+  armAlert();
+}
+
+/**************************************************************************/
+/*!
+    @brief  ALERT/RDY signals conversion ready: continuous mode, HI_THRESH
+            MSB set, LO_THRESH MSB clear and the comparator queue enabled
+*/
+/**************************************************************************/
+bool FlexSimADS1X15::readyMode(void)
+{
+  return _continuous &&
+         ((_regs[REG_CONFIG] & CONFIG_CQUE) != CONFIG_CQUE) &&
+         (_regs[REG_HITHRESH] & 0x8000) &&
+         !(_regs[REG_LOTHRESH] & 0x8000);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Schedules the pulse for the next conversion end. Events
+            scheduled before a config change come before _alertAt (or
+            after a pulse that already moved it) and are dropped.
+*/
+/**************************************************************************/
+void FlexSimADS1X15::armAlert(void)
+{
+  if ((_alertPin < 0) || !readyMode())
+  {
+    return;
+  }
+  uint32_t period = conversionMicros();
+  _alertAt = _startedAt + ((flexSimNow() - _startedAt) / period + 1) * period;
+  flexSimSchedule(_alertAt, onAlert, this);
+}
+
+void FlexSimADS1X15::onAlert(void *context)
+{
+  FlexSimADS1X15 *adc = (FlexSimADS1X15 *)context;
+
+  if ((adc->_alertPin < 0) || !adc->readyMode() || (flexSimNow() < adc->_alertAt))
+  {
+    return;
+  }
+
+  adc->update();                                  // latch the result first
+  bool activeHigh = (adc->_regs[REG_CONFIG] & CONFIG_CPOL) != 0;
+  flexSimSetPin(adc->_alertPin, activeHigh ? HIGH : LOW);
+  flexSimSetPin(adc->_alertPin, activeHigh ? LOW : HIGH);
+  adc->armAlert();
+}
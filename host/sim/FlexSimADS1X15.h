@@ -0,0 +1,79 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimADS1X15.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated ADS1015 (12 bit) / ADS1115 (16 bit) ADC (address 0x48-0x4B).
+
+    Four 16 bit registers behind a pointer byte: a write of pointer + 2
+    bytes sets a register (MSB first), a write of only the pointer selects
+    the register for following reads.
+
+    Writing CONFIG with OS=1 in single-shot mode starts one conversion,
+    OS reads 0 until it is done (1/SPS later). In continuous mode a new
+    result is latched every 1/SPS. Results follow the PGA full scale
+    range and the MUX setting from the voltages given to setInput(), the
+    ADS1015 returns its 12 bit result left aligned.
+
+    setRateError() skews the internal oscillator (datasheet: up to +-10%)
+    so drivers that assume the nominal data rate can be checked.
+
+    setAlertPin() wires ALERT/RDY to a simulated pin. In continuous mode
+    with the conversion-ready thresholds (HI_THRESH MSB 1, LO_THRESH MSB
+    0, comparator queue enabled) it pulses at the end of every
+    conversion, at the exact conversion time, so an attachInterrupt()
+    handler sees the edge as on the real chip. The comparator functions
+    are not modelled.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SIM_ADS1X15_H
+#define _FLEX_SIM_ADS1X15_H
+
+#include "FlexSimDevice.h"
+
+class FlexSimADS1X15 : public FlexSimDevice
+{
+ public:
+  FlexSimADS1X15(uint8_t address = 0x48, bool ads1115 = false);
+
+  bool     write(const uint8_t *data, size_t count);
+  size_t   read(uint8_t *dest, size_t count);
+
+  void     setInput(uint8_t channel, float volts);
+  void     setRateError(float fraction);      // e.g. 0.1 = 10% slower
+  uint16_t reg(uint8_t pointer);
+  uint32_t conversions(void);                 // number of finished conversions
+  uint32_t conversionMicros(void);            // for the current config
+  uint64_t sampledAt(void);                   // middle of the last conversion
+  void     setAlertPin(uint8_t pin);          // ALERT/RDY, conversion-ready pulses only
+
+ private:
+  void     update(void);
+  void     startConversion(void);
+  uint16_t convert(void);
+  bool     readyMode(void);
+  void     armAlert(void);
+  static void onAlert(void *context);
+
+  bool     _ads1115;
+  uint8_t  _pointer;
+  uint16_t _regs[4];
+  float    _inputs[4];
+  float    _rateError;
+
+  bool     _busy;             // single-shot conversion in progress
+  bool     _continuous;
+  uint64_t _startedAt;
+  uint64_t _readyAt;
+  uint32_t _latched;          // continuous conversions latched so far
+  uint32_t _conversions;
+
+  int16_t  _alertPin;         // -1: not connected
+  uint64_t _alertAt;          // next conversion end to pulse at
+};
+
+#endif
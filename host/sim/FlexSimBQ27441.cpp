@@ -0,0 +1,293 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimBQ27441.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated BQ27441-G1A fuel gauge.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexSimBQ27441.h"
+
+#define CMD_CONTROL         0x00
+#define CMD_TEMP            0x02
+#define CMD_VOLTAGE         0x04
+#define CMD_FLAGS           0x06
+#define CMD_NOM_CAPACITY    0x08
+#define CMD_AVAIL_CAPACITY  0x0A
+#define CMD_REM_CAPACITY    0x0C
+#define CMD_FULL_CAPACITY   0x0E
+#define CMD_AVG_CURRENT     0x10
+#define CMD_SOC             0x1C
+#define CMD_INT_TEMP        0x1E
+#define CMD_SOH             0x20
+#define CMD_OPCONFIG        0x3A
+#define CMD_DESIGN_CAPACITY 0x3C
+#define CMD_DATACLASS       0x3E
+#define CMD_DATABLOCK       0x3F
+#define CMD_BLOCKDATA       0x40
+#define CMD_CHECKSUM        0x60
+#define CMD_BLOCKCONTROL    0x61
+
+#define FLAG_CFGUPMODE      (1<<4)
+#define FLAG_BAT_DET        (1<<3)
+#define STATUS_SS           (1<<13)
+#define STATUS_INITCOMP     (1<<7)
+#define STATUS_VOK          (1<<1)
+
+#define ID_REGISTERS        64
+#define ID_STATE            82
+
+FlexSimBQ27441::FlexSimBQ27441(uint8_t address)
+  : FlexSimRegisterDevice(address)
+{
+  _classCount = 0;
+  _dataClass = 0;
+  _dataBlock = 0;
+  memset(_block, 0, sizeof(_block));
+  _controlResult = 0;
+  _lastSubcommand = 0;
+  _sealed = true;
+  _commits = 0;
+
+  // Data memory defaults: OpConfig 0x25F8, design capacity 1000 mAh
+  uint8_t *registers = block(ID_REGISTERS, 0);
+  registers[0] = 0x25;
+  registers[1] = 0xF8;
+  uint8_t *state = block(ID_STATE, 0);
+  state[10] = 1000 >> 8;
+  state[11] = 1000 & 0xFF;
+  syncExtended();
+
+  setWord(CMD_TEMP, 2982);                // 0.1 K
+  setVoltage(3850);
+  setWord(CMD_FLAGS, FLAG_BAT_DET);
+  setWord(CMD_NOM_CAPACITY, 780);
+  setWord(CMD_AVAIL_CAPACITY, 990);
+  setWord(CMD_REM_CAPACITY, 752);
+  setWord(CMD_FULL_CAPACITY, 990);
+  setAverageCurrent(-120);
+  setStateOfCharge(76);
+  setWord(CMD_INT_TEMP, 2990);
+  setWord(CMD_SOH, 0x0162);               // 98 %, status 1
+}
+
+void FlexSimBQ27441::setWord(uint8_t command, uint16_t value)
+{
+  _regs[command] = (uint8_t)(value & 0xFF);
+  _regs[command + 1] = (uint8_t)(value >> 8);
+}
+
+uint16_t FlexSimBQ27441::word(uint8_t command)
+{
+  return ((uint16_t)_regs[command + 1] << 8) | _regs[command];
+}
+
+void FlexSimBQ27441::setVoltage(uint16_t millivolts)
+{
+  setWord(CMD_VOLTAGE, millivolts);
+}
+
+void FlexSimBQ27441::setStateOfCharge(uint16_t percent)
+{
+  setWord(CMD_SOC, percent);
+}
+
+void FlexSimBQ27441::setAverageCurrent(int16_t milliamps)
+{
+  setWord(CMD_AVG_CURRENT, (uint16_t)milliamps);
+}
+
+bool FlexSimBQ27441::sealed(void)
+{
+  return _sealed;
+}
+
+bool FlexSimBQ27441::configUpdate(void)
+{
+  return (word(CMD_FLAGS) & FLAG_CFGUPMODE) != 0;
+}
+
+uint8_t FlexSimBQ27441::dataMemory(uint8_t classID, uint8_t offset)
+{
+  return block(classID, offset / 32)[offset % 32];
+}
+
+uint32_t FlexSimBQ27441::commits(void)
+{
+  return _commits;
+}
+
+void FlexSimBQ27441::onWrite(uint8_t reg, uint8_t value)
+{
+  if (reg == CMD_CONTROL)
+  {
+    _regs[reg] = value;
+  }
+  else if (reg == CMD_CONTROL + 1)
+  {
+    control(((uint16_t)value << 8) | _regs[CMD_CONTROL]);
+  }
+  else if (reg == CMD_DATACLASS)
+  {
+    _dataClass = value;
+    _dataBlock = 0;
+    loadBlock();
+  }
+  else if (reg == CMD_DATABLOCK)
+  {
+    _dataBlock = value;
+    loadBlock();
+  }
+  else if ((reg >= CMD_BLOCKDATA) && (reg < CMD_CHECKSUM))
+  {
+    _block[reg - CMD_BLOCKDATA] = value;
+  }
+  else if (reg == CMD_CHECKSUM)
+  {
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < 32; i++)
+    {
+      sum += _block[i];
+    }
+    if ((value == (uint8_t)(255 - sum)) && !_sealed && configUpdate())
+    {
+      commitBlock();
+    }
+  }
+  // other standard commands are read only
+}
+
+uint8_t FlexSimBQ27441::onRead(uint8_t reg)
+{
+  if (reg == CMD_CONTROL)
+  {
+    return (uint8_t)(_controlResult & 0xFF);
+  }
+  if (reg == CMD_CONTROL + 1)
+  {
+    return (uint8_t)(_controlResult >> 8);
+  }
+  if ((reg >= CMD_BLOCKDATA) && (reg < CMD_CHECKSUM))
+  {
+    return _block[reg - CMD_BLOCKDATA];
+  }
+  if (reg == CMD_CHECKSUM)
+  {
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < 32; i++)
+    {
+      sum += _block[i];
+    }
+    return 255 - sum;
+  }
+  return _regs[reg];
+}
+
+/**************************************************************************/
+/*!
+    @brief  Executes a Control() subcommand
+*/
+/**************************************************************************/
+void FlexSimBQ27441::control(uint16_t subcommand)
+{
+  uint16_t previous = _lastSubcommand;
+  _lastSubcommand = subcommand;
+
+  switch (subcommand)
+  {
+    case 0x0000:          // CONTROL_STATUS
+      _controlResult = STATUS_INITCOMP | STATUS_VOK | (_sealed ? STATUS_SS : 0);
+      break;
+    case 0x0001:          // DEVICE_TYPE
+      _controlResult = 0x0421;
+      break;
+    case 0x0002:          // FW_VERSION
+      _controlResult = 0x0109;
+      break;
+    case 0x0008:          // CHEM_ID
+      _controlResult = 0x0128;
+      break;
+    case 0x0013:          // SET_CFGUPDATE
+      if (!_sealed)
+      {
+        setWord(CMD_FLAGS, word(CMD_FLAGS) | FLAG_CFGUPMODE);
+      }
+      break;
+    case 0x0020:          // SEALED
+      _sealed = true;
+      break;
+    case 0x0042:          // SOFT_RESET
+    case 0x0043:          // EXIT_CFGUPDATE
+    case 0x0044:          // EXIT_RESIM
+      setWord(CMD_FLAGS, word(CMD_FLAGS) & ~FLAG_CFGUPMODE);
+      break;
+    case 0x8000:          // unseal key, twice in a row
+      if (previous == 0x8000)
+      {
+        _sealed = false;
+      }
+      break;
+    default:
+      _controlResult = 0;
+      break;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  32 byte block of a data memory class, created on first use
+*/
+/**************************************************************************/
+uint8_t *FlexSimBQ27441::block(uint8_t classID, uint8_t blockIndex)
+{
+  static uint8_t scratch[32];
+  blockIndex &= 0x01;
+
+  for (uint8_t i = 0; i < _classCount; i++)
+  {
+    if (_classes[i].id == classID)
+    {
+      return &_classes[i].data[32 * blockIndex];
+    }
+  }
+  if (_classCount >= FLEX_SIM_BQ27441_CLASSES)
+  {
+    memset(scratch, 0, sizeof(scratch));
+    return scratch;
+  }
+
+  dataClass_t *dc = &_classes[_classCount++];
+  dc->id = classID;
+  memset(dc->data, 0, sizeof(dc->data));
+  return &dc->data[32 * blockIndex];
+}
+
+void FlexSimBQ27441::loadBlock(void)
+{
+  memcpy(_block, block(_dataClass, _dataBlock), 32);
+}
+
+void FlexSimBQ27441::commitBlock(void)
+{
+  memcpy(block(_dataClass, _dataBlock), _block, 32);
+  _commits++;
+  syncExtended();
+}
+
+/**************************************************************************/
+/*!
+    @brief  OpConfig() / DesignCapacity() mirror data memory (big endian
+            there, little endian on the command interface)
+*/
+/**************************************************************************/
+void FlexSimBQ27441::syncExtended(void)
+{
+  uint8_t *registers = block(ID_REGISTERS, 0);
+  setWord(CMD_OPCONFIG, ((uint16_t)registers[0] << 8) | registers[1]);
+  uint8_t *state = block(ID_STATE, 0);
+  setWord(CMD_DESIGN_CAPACITY, ((uint16_t)state[10] << 8) | state[11]);
+}
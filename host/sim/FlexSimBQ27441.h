@@ -0,0 +1,80 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimBQ27441.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated BQ27441-G1A fuel gauge (address 0x55).
+
+    Standard commands 0x02..0x3F are little endian words in the register
+    file (set them with setWord() or the helpers). Control() at 0x00:
+    writing the subcommand LSB, MSB executes it, the result is read back
+    from 0x00. Supported: CONTROL_STATUS, DEVICE_TYPE (0x0421),
+    FW_VERSION, CHEM_ID, SET_CFGUPDATE, EXIT_CFGUPDATE, EXIT_RESIM,
+    SOFT_RESET, SEALED and the two step unseal with key 0x8000.
+
+    Data memory is reached through DataClass() 0x3E, DataBlock() 0x3F,
+    BlockData() 0x40..0x5F and BlockDataChecksum() 0x60. Writing a
+    matching checksum commits the block, only when unsealed and in
+    config update mode (Flags() CFGUPMODE) like the real gauge.
+    OpConfig() 0x3A and DesignCapacity() 0x3C follow data memory.
+
+    Starts sealed, with a 1000 mAh cell at 3.85 V / 76 %.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SIM_BQ27441_H
+#define _FLEX_SIM_BQ27441_H
+
+#include "FlexSimDevice.h"
+
+#define FLEX_SIM_BQ27441_CLASSES    8
+
+class FlexSimBQ27441 : public FlexSimRegisterDevice
+{
+ public:
+  FlexSimBQ27441(uint8_t address = 0x55);
+
+  void     setWord(uint8_t command, uint16_t value);
+  uint16_t word(uint8_t command);
+  void     setVoltage(uint16_t millivolts);
+  void     setStateOfCharge(uint16_t percent);
+  void     setAverageCurrent(int16_t milliamps);
+
+  bool     sealed(void);
+  bool     configUpdate(void);
+  uint8_t  dataMemory(uint8_t classID, uint8_t offset);
+  uint32_t commits(void);                     // data memory blocks written
+
+ protected:
+  void     onWrite(uint8_t reg, uint8_t value);
+  uint8_t  onRead(uint8_t reg);
+
+ private:
+  typedef struct
+  {
+    uint8_t id;
+    uint8_t data[64];
+  } dataClass_t;
+
+  void     control(uint16_t subcommand);
+  uint8_t *block(uint8_t classID, uint8_t blockIndex);
+  void     loadBlock(void);
+  void     commitBlock(void);
+  void     syncExtended(void);
+
+  dataClass_t _classes[FLEX_SIM_BQ27441_CLASSES];
+  uint8_t  _classCount;
+  uint8_t  _dataClass;
+  uint8_t  _dataBlock;
+  uint8_t  _block[32];
+
+  uint16_t _controlResult;
+  uint16_t _lastSubcommand;
+  bool     _sealed;
+  uint32_t _commits;
+};
+
+#endif
@@ -0,0 +1,84 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimDevice.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Base classes for the simulated I2C devices.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexSimDevice.h"
+
+FlexSimDevice::FlexSimDevice(uint8_t address)
+{
+  _address = address;
+}
+
+uint8_t FlexSimDevice::address(void)
+{
+  return _address;
+}
+
+void FlexSimDevice::setAddress(uint8_t address)
+{
+  _address = address;
+}
+
+/***************************************************************************
+ REGISTER FILE DEVICE
+ ***************************************************************************/
+
+FlexSimRegisterDevice::FlexSimRegisterDevice(uint8_t address)
+  : FlexSimDevice(address)
+{
+  memset(_regs, 0, sizeof(_regs));
+  _pointer = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  First byte sets the register pointer, the rest is written to
+            consecutive registers
+*/
+/**************************************************************************/
+bool FlexSimRegisterDevice::write(const uint8_t *data, size_t count)
+{
+  update();
+  if (count == 0)
+  {
+    return true;
+  }
+
+  _pointer = data[0] & pointerMask();
+  for (size_t i = 1; i < count; i++)
+  {
+    onWrite(_pointer, data[i]);
+    _pointer = nextPointer(_pointer);
+  }
+  return true;
+}
+
+size_t FlexSimRegisterDevice::read(uint8_t *dest, size_t count)
+{
+  update();
+  for (size_t i = 0; i < count; i++)
+  {
+    dest[i] = onRead(_pointer);
+    _pointer = nextPointer(_pointer);
+  }
+  return count;
+}
+
+uint8_t FlexSimRegisterDevice::reg(uint8_t reg)
+{
+  update();
+  return _regs[reg];
+}
+
+void FlexSimRegisterDevice::setReg(uint8_t reg, uint8_t value)
+{
+  _regs[reg] = value;
+}
@@ -0,0 +1,75 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimDevice.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Base classes for the simulated I2C devices that attach to the host
+    TwoWire.
+
+    FlexSimDevice sees whole transfers: the data bytes of one write
+    (everything after the address byte up to the STOP or repeated START)
+    and the length of one read. FlexSimRegisterDevice implements the
+    usual "first byte is the register pointer, then auto-increment"
+    behaviour on a 256 byte register file, models only override the
+    hooks for registers with side effects.
+
+    Models are lazy: instead of ticking, update() brings time dependent
+    state (conversions, output data rate) up to date from flexSimNow()
+    before every transfer.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SIM_DEVICE_H
+#define _FLEX_SIM_DEVICE_H
+
+#include "Arduino.h"
+#include "FlexSim.h"
+
+class FlexSimDevice
+{
+ public:
+  FlexSimDevice(uint8_t address);
+  virtual ~FlexSimDevice() {}
+
+  uint8_t          address(void);
+  void             setAddress(uint8_t address);
+
+  // One write transfer, return false to NACK it
+  virtual bool     write(const uint8_t *data, size_t count) = 0;
+  // One read transfer, returns the number of bytes supplied (0 = NACK)
+  virtual size_t   read(uint8_t *dest, size_t count) = 0;
+  // Time SCL is held low before a read can start (clock stretching)
+  virtual uint32_t stretchMicros(void) { return 0; }
+  // Address phase of a write or read transfer, return false to NACK it
+  virtual bool     ackAddress(bool read) { (void)read; return true; }
+
+ protected:
+  uint8_t _address;
+};
+
+class FlexSimRegisterDevice : public FlexSimDevice
+{
+ public:
+  FlexSimRegisterDevice(uint8_t address);
+
+  bool             write(const uint8_t *data, size_t count);
+  size_t           read(uint8_t *dest, size_t count);
+
+  uint8_t          reg(uint8_t reg);
+  void             setReg(uint8_t reg, uint8_t value);
+
+ protected:
+  virtual void     update(void) {}
+  virtual uint8_t  pointerMask(void) { return 0xFF; }
+  virtual uint8_t  nextPointer(uint8_t reg) { return reg + 1; }
+  virtual void     onWrite(uint8_t reg, uint8_t value) { _regs[reg] = value; }
+  virtual uint8_t  onRead(uint8_t reg) { return _regs[reg]; }
+
+  uint8_t _regs[256];
+  uint8_t _pointer;
+};
+
+#endif
@@ -0,0 +1,148 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimFXAS21002C.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated FXAS21002C 3-axis gyroscope.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexSimFXAS21002C.h"
+
+#define REG_STATUS      0x00
+#define REG_OUT_X_MSB   0x01
+#define REG_DR_STATUS   0x07
+#define REG_WHO_AM_I    0x0C
+#define REG_CTRL_REG0   0x0D
+#define REG_CTRL_REG1   0x13
+
+#define STATUS_ZYXDR    0x0F    // ZYXDR + X/Y/Z DR
+#define STATUS_ZYXOW    0xF0    // ZYXOW + X/Y/Z OW
+
+#define ACTIVATE_US     60000   // standby -> active, plus 1/ODR
+
+FlexSimFXAS21002C::FlexSimFXAS21002C(uint8_t address)
+  : FlexSimRegisterDevice(address)
+{
+  _rate[0] = _rate[1] = _rate[2] = 0;
+  reset();
+}
+
+void FlexSimFXAS21002C::setRate(float x, float y, float z)
+{
+  _rate[0] = x;
+  _rate[1] = y;
+  _rate[2] = z;
+}
+
+uint32_t FlexSimFXAS21002C::samplePeriod(void)
+{
+  static const uint32_t periods[8] = { 1250, 2500, 5000, 10000, 20000, 40000, 80000, 80000 };
+  return periods[(_regs[REG_CTRL_REG1] >> 2) & 0x07];
+}
+
+uint32_t FlexSimFXAS21002C::samples(void)
+{
+  update();
+  return _samples;
+}
+
+uint64_t FlexSimFXAS21002C::sampledAt(void)
+{
+  update();
+  return _activeSince + (uint64_t)_samples * samplePeriod();
+}
+
+void FlexSimFXAS21002C::reset(void)
+{
+  memset(_regs, 0, sizeof(_regs));
+  _regs[REG_WHO_AM_I] = 0xD7;
+  _active = false;
+  _activeSince = 0;
+  _samples = 0;
+}
+
+void FlexSimFXAS21002C::update(void)
+{
+  if (!_active || (flexSimNow() < _activeSince))
+  {
+    return;
+  }
+
+  uint32_t due = (uint32_t)((flexSimNow() - _activeSince) / samplePeriod());
+  if (due > _samples)
+  {
+    latch();
+    _samples = due;
+  }
+}
+
+void FlexSimFXAS21002C::onWrite(uint8_t reg, uint8_t value)
+{
+  if (reg == REG_CTRL_REG1)
+  {
+    if (value & 0x40)
+    {
+      reset();          // RST, self clearing
+      return;
+    }
+    bool active = (value & 0x02);
+    _regs[reg] = value;
+    if (active && !_active)
+    {
+      _activeSince = flexSimNow() + ACTIVATE_US;
+      _samples = 0;
+    }
+    _active = active;
+    return;
+  }
+  if ((reg == REG_WHO_AM_I) || (reg <= REG_DR_STATUS))
+  {
+    return;             // read only
+  }
+  _regs[reg] = value;
+}
+
+uint8_t FlexSimFXAS21002C::onRead(uint8_t reg)
+{
+  uint8_t value = _regs[reg];
+
+  if (reg == REG_STATUS)
+  {
+    value = _regs[REG_DR_STATUS];     // FIFO off: STATUS mirrors DR_STATUS
+  }
+  else if (reg == REG_OUT_X_MSB)
+  {
+    _regs[REG_DR_STATUS] = 0;
+  }
+  return value;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Latches a new sample into OUT_X/Y/Z, flags overwrites
+*/
+/**************************************************************************/
+void FlexSimFXAS21002C::latch(void)
+{
+  static const float lsbPerDps[4] = { 16.0F, 32.0F, 64.0F, 128.0F };   // 2000 .. 250 dps
+  float scale = lsbPerDps[_regs[REG_CTRL_REG0] & 0x03];
+
+  for (uint8_t axis = 0; axis < 3; axis++)
+  {
+    float code = constrain(_rate[axis] * scale, -32768.0F, 32767.0F);
+    int16_t raw = (int16_t)code;
+    _regs[REG_OUT_X_MSB + 2 * axis] = (uint8_t)((uint16_t)raw >> 8);
+    _regs[REG_OUT_X_MSB + 2 * axis + 1] = (uint8_t)(raw & 0xFF);
+  }
+
+  uint8_t status = _regs[REG_DR_STATUS];
+  if (status & 0x08)
+  {
+    status |= STATUS_ZYXOW;
+  }
+  _regs[REG_DR_STATUS] = status | STATUS_ZYXDR;
+}
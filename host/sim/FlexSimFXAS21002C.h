@@ -0,0 +1,51 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimFXAS21002C.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated FXAS21002C 3-axis gyroscope (address 0x21).
+
+    Register file with auto-increment (bit 7 of the register pointer is
+    ignored, the Flex driver sets it on burst reads). In active mode
+    (CTRL_REG1 ACTIVE) a new X/Y/Z sample is latched every 1/ODR after
+    the standby -> active transition time; STATUS ZYXDR is set and
+    ZYXOW when the previous sample was never read. Reading OUT_X_MSB
+    clears both. Output scaling follows the CTRL_REG0 full scale range.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SIM_FXAS21002C_H
+#define _FLEX_SIM_FXAS21002C_H
+
+#include "FlexSimDevice.h"
+
+class FlexSimFXAS21002C : public FlexSimRegisterDevice
+{
+ public:
+  FlexSimFXAS21002C(uint8_t address = 0x21);
+
+  void     setRate(float x, float y, float z);    // degrees per second
+  uint32_t samplePeriod(void);                    // 1/ODR in us
+  uint32_t samples(void);                         // samples latched so far
+  uint64_t sampledAt(void);                       // flexSimNow() of the latest latch
+
+ protected:
+  void     update(void);
+  uint8_t  pointerMask(void) { return 0x7F; }
+  void     onWrite(uint8_t reg, uint8_t value);
+  uint8_t  onRead(uint8_t reg);
+
+ private:
+  void     reset(void);
+  void     latch(void);
+
+  float    _rate[3];
+  bool     _active;
+  uint64_t _activeSince;
+  uint32_t _samples;
+};
+
+#endif
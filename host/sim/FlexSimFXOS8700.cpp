@@ -0,0 +1,196 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimFXOS8700.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated FXOS8700 accelerometer / magnetometer.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexSimFXOS8700.h"
+
+#define REG_STATUS        0x00
+#define REG_OUT_X_MSB     0x01
+#define REG_OUT_Z_LSB     0x06
+#define REG_WHO_AM_I      0x0D
+#define REG_XYZ_DATA_CFG  0x0E
+#define REG_CTRL_REG1     0x2A
+#define REG_CTRL_REG2     0x2B
+#define REG_M_DR_STATUS   0x32
+#define REG_MOUT_X_MSB    0x33
+#define REG_MOUT_Z_LSB    0x38
+#define REG_M_CTRL_REG1   0x5B
+#define REG_M_CTRL_REG2   0x5C
+
+#define STATUS_ZYXDR      0x0F
+#define STATUS_ZYXOW      0xF0
+
+#define ACTIVATE_US       2000    // boot to active, plus 1/ODR
+
+FlexSimFXOS8700::FlexSimFXOS8700(uint8_t address)
+  : FlexSimRegisterDevice(address)
+{
+  _accel[0] = 0;
+  _accel[1] = 0;
+  _accel[2] = 1.0;
+  _mag[0] = 20.0;
+  _mag[1] = 0;
+  _mag[2] = -40.0;
+  reset();
+}
+
+void FlexSimFXOS8700::setAcceleration(float x, float y, float z)
+{
+  _accel[0] = x;
+  _accel[1] = y;
+  _accel[2] = z;
+}
+
+void FlexSimFXOS8700::setMagnetic(float x, float y, float z)
+{
+  _mag[0] = x;
+  _mag[1] = y;
+  _mag[2] = z;
+}
+
+uint32_t FlexSimFXOS8700::samplePeriod(void)
+{
+  static const uint32_t periods[8] = { 1250, 2500, 5000, 10000, 20000, 80000, 160000, 640000 };
+  uint32_t period = periods[(_regs[REG_CTRL_REG1] >> 3) & 0x07];
+  return hybrid() ? 2 * period : period;
+}
+
+uint32_t FlexSimFXOS8700::samples(void)
+{
+  update();
+  return _samples;
+}
+
+uint64_t FlexSimFXOS8700::sampledAt(void)
+{
+  update();
+  return _activeSince + (uint64_t)_samples * samplePeriod();
+}
+
+void FlexSimFXOS8700::reset(void)
+{
+  memset(_regs, 0, sizeof(_regs));
+  _regs[REG_WHO_AM_I] = 0xC7;
+  _active = false;
+  _activeSince = 0;
+  _samples = 0;
+}
+
+bool FlexSimFXOS8700::hybrid(void)
+{
+  return (_regs[REG_M_CTRL_REG1] & 0x03) == 0x03;
+}
+
+void FlexSimFXOS8700::update(void)
+{
+  if (!_active || (flexSimNow() < _activeSince))
+  {
+    return;
+  }
+
+  uint32_t due = (uint32_t)((flexSimNow() - _activeSince) / samplePeriod());
+  if (due > _samples)
+  {
+    latch();
+    _samples = due;
+  }
+}
+
+uint8_t FlexSimFXOS8700::nextPointer(uint8_t reg)
+{
+  if (_regs[REG_M_CTRL_REG2] & 0x20)
+  {
+    if (reg == REG_OUT_Z_LSB)
+    {
+      return REG_MOUT_X_MSB;
+    }
+    if (reg == REG_MOUT_Z_LSB)
+    {
+      return REG_STATUS;
+    }
+  }
+  return (reg + 1) & 0x7F;
+}
+
+void FlexSimFXOS8700::onWrite(uint8_t reg, uint8_t value)
+{
+  if (reg == REG_CTRL_REG2 && (value & 0x40))
+  {
+    reset();            // RST, self clearing
+    return;
+  }
+  if (reg == REG_CTRL_REG1)
+  {
+    bool active = (value & 0x01);
+    _regs[reg] = value;
+    if (active && !_active)
+    {
+      _activeSince = flexSimNow() + ACTIVATE_US;
+      _samples = 0;
+    }
+    _active = active;
+    return;
+  }
+  if ((reg == REG_WHO_AM_I) || (reg <= REG_OUT_Z_LSB) ||
+      ((reg >= REG_M_DR_STATUS) && (reg <= REG_MOUT_Z_LSB)))
+  {
+    return;             // read only
+  }
+  _regs[reg] = value;
+}
+
+uint8_t FlexSimFXOS8700::onRead(uint8_t reg)
+{
+  uint8_t value = _regs[reg];
+
+  if (reg == REG_OUT_X_MSB)
+  {
+    _regs[REG_STATUS] = 0;
+  }
+  else if (reg == REG_MOUT_X_MSB)
+  {
+    _regs[REG_M_DR_STATUS] = 0;
+  }
+  return value;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Latches new accel (and in hybrid mode mag) samples
+*/
+/**************************************************************************/
+void FlexSimFXOS8700::latch(void)
+{
+  static const float lsbPerG[4] = { 4096.0F, 2048.0F, 1024.0F, 1024.0F };   // 14 bit, 2/4/8 g
+  float scale = lsbPerG[_regs[REG_XYZ_DATA_CFG] & 0x03];
+
+  for (uint8_t axis = 0; axis < 3; axis++)
+  {
+    float code = constrain(_accel[axis] * scale, -8192.0F, 8191.0F);
+    uint16_t raw = (uint16_t)((int16_t)code * 4);         // left aligned
+    _regs[REG_OUT_X_MSB + 2 * axis] = (uint8_t)(raw >> 8);
+    _regs[REG_OUT_X_MSB + 2 * axis + 1] = (uint8_t)(raw & 0xFF);
+
+    code = constrain(_mag[axis] * 10.0F, -32768.0F, 32767.0F);
+    raw = (uint16_t)(int16_t)code;
+    _regs[REG_MOUT_X_MSB + 2 * axis] = (uint8_t)(raw >> 8);
+    _regs[REG_MOUT_X_MSB + 2 * axis + 1] = (uint8_t)(raw & 0xFF);
+  }
+
+  uint8_t status = _regs[REG_STATUS];
+  _regs[REG_STATUS] = status | STATUS_ZYXDR | ((status & 0x08) ? STATUS_ZYXOW : 0);
+
+  if (hybrid() || (_regs[REG_M_CTRL_REG1] & 0x03) == 0x01)
+  {
+    status = _regs[REG_M_DR_STATUS];
+    _regs[REG_M_DR_STATUS] = status | STATUS_ZYXDR | ((status & 0x08) ? STATUS_ZYXOW : 0);
+  }
+}
@@ -0,0 +1,56 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimFXOS8700.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated FXOS8700 accelerometer / magnetometer (address 0x1F).
+
+    Register file with auto-increment (bit 7 of the pointer ignored, like
+    the gyro). With M_CTRL_REG2 hyb_autoinc_mode set, reading past
+    OUT_Z_LSB (0x06) continues at MOUT_X_MSB (0x33), so one 13 byte burst
+    from STATUS returns accel and mag. In active mode samples are latched
+    every 1/ODR (halved in hybrid mode); STATUS / M_DR_STATUS ZYXDR are
+    set and cleared by reading OUT_X_MSB / MOUT_X_MSB. Accel output is
+    14 bit left aligned scaled by XYZ_DATA_CFG, mag is 0.1 uT/LSB.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SIM_FXOS8700_H
+#define _FLEX_SIM_FXOS8700_H
+
+#include "FlexSimDevice.h"
+
+class FlexSimFXOS8700 : public FlexSimRegisterDevice
+{
+ public:
+  FlexSimFXOS8700(uint8_t address = 0x1F);
+
+  void     setAcceleration(float x, float y, float z);    // g
+  void     setMagnetic(float x, float y, float z);        // uT
+  uint32_t samplePeriod(void);                            // 1/ODR in us
+  uint32_t samples(void);
+  uint64_t sampledAt(void);                               // flexSimNow() of the latest latch
+
+ protected:
+  void     update(void);
+  uint8_t  pointerMask(void) { return 0x7F; }
+  uint8_t  nextPointer(uint8_t reg);
+  void     onWrite(uint8_t reg, uint8_t value);
+  uint8_t  onRead(uint8_t reg);
+
+ private:
+  void     reset(void);
+  void     latch(void);
+  bool     hybrid(void);
+
+  float    _accel[3];
+  float    _mag[3];
+  bool     _active;
+  uint64_t _activeSince;
+  uint32_t _samples;
+};
+
+#endif
@@ -0,0 +1,173 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimHTU21DF.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated HTU21D(F) humidity / temperature sensor.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexSimHTU21DF.h"
+
+FlexSimHTU21DF::FlexSimHTU21DF(uint8_t address)
+  : FlexSimDevice(address)
+{
+  _result = NONE;
+  _hold = false;
+  _readyAt = 0;
+  _resetUntil = 0;
+  _userRegister = 0x02;
+  _temperature = 21.5;
+  _humidity = 45.0;
+}
+
+void FlexSimHTU21DF::setTemperature(float celsius)
+{
+  _temperature = celsius;
+}
+
+void FlexSimHTU21DF::setHumidity(float percent)
+{
+  _humidity = percent;
+}
+
+bool FlexSimHTU21DF::write(const uint8_t *data, size_t count)
+{
+  if (flexSimNow() < _resetUntil)
+  {
+    return false;
+  }
+  if (count == 0)
+  {
+    return true;      // address probe
+  }
+
+  switch (data[0])
+  {
+    case 0xE3:
+      startConversion(TEMPERATURE, true, FLEX_SIM_HTU21DF_TEMP_US);
+      break;
+    case 0xF3:
+      startConversion(TEMPERATURE, false, FLEX_SIM_HTU21DF_TEMP_US);
+      break;
+    case 0xE5:
+      startConversion(HUMIDITY, true, FLEX_SIM_HTU21DF_HUM_US);
+      break;
+    case 0xF5:
+      startConversion(HUMIDITY, false, FLEX_SIM_HTU21DF_HUM_US);
+      break;
+    case 0xE6:
+      if (count > 1)
+      {
+        _userRegister = data[1];
+      }
+      break;
+    case 0xE7:
+      _result = USER_REGISTER;
+      break;
+    case 0xFE:
+      _result = NONE;
+      _userRegister = 0x02;
+      _resetUntil = flexSimNow() + FLEX_SIM_HTU21DF_RESET_US;
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+size_t FlexSimHTU21DF::read(uint8_t *dest, size_t count)
+{
+  if ((flexSimNow() < _resetUntil) || (_result == NONE))
+  {
+    return 0;
+  }
+
+  if (_result == USER_REGISTER)
+  {
+    memset(dest, _userRegister, count);
+    return count;
+  }
+
+  // Hold master reads were stretched up to _readyAt (see stretchMicros)
+  if (!_hold && (flexSimNow() < _readyAt))
+  {
+    return 0;
+  }
+
+  uint16_t raw = rawResult();
+  uint8_t frame[3] = { (uint8_t)(raw >> 8), (uint8_t)(raw & 0xFF), 0 };
+  frame[2] = crc8(frame, 2);
+  _result = NONE;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    dest[i] = (i < 3) ? frame[i] : 0xFF;
+  }
+  return count;
+}
+
+uint32_t FlexSimHTU21DF::stretchMicros(void)
+{
+  if (_hold && ((_result == TEMPERATURE) || (_result == HUMIDITY)) && (flexSimNow() < _readyAt))
+  {
+    return (uint32_t)(_readyAt - flexSimNow());
+  }
+  return 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  CRC-8 as sent by the sensor, polynomial 0x31, init 0x00
+*/
+/**************************************************************************/
+uint8_t FlexSimHTU21DF::crc8(const uint8_t *data, uint8_t count)
+{
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+void FlexSimHTU21DF::startConversion(result_t kind, bool hold, uint32_t duration)
+{
+  _result = kind;
+  _hold = hold;
+  _readyAt = flexSimNow() + duration;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Inverse of the datasheet conversion formulas, status bits set
+*/
+/**************************************************************************/
+uint16_t FlexSimHTU21DF::rawResult(void)
+{
+  float code;
+
+  if (_result == TEMPERATURE)
+  {
+    code = (_temperature + 46.85F) * 65536.0F / 175.72F;
+  }
+  else
+  {
+    code = (_humidity + 6.0F) * 65536.0F / 125.0F;
+  }
+  code = constrain(code, 0.0F, 65535.0F);
+
+  uint16_t raw = (uint16_t)code & 0xFFFC;
+  if (_result == HUMIDITY)
+  {
+    raw |= 0x02;
+  }
+  return raw;
+}
@@ -0,0 +1,62 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimHTU21DF.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated HTU21D(F) humidity / temperature sensor (address 0x40).
+
+    Command based, no register file:
+    0xE3 / 0xE5  measure, hold master: a read before the conversion is
+                 done stretches the clock until it is
+    0xF3 / 0xF5  measure, no hold master: reads are NACKed until done
+    0xE6 / 0xE7  write / read the user register
+    0xFE         soft reset, NACKs everything for 15 ms
+
+    Results are 16 bit (2 LSB status, bit 1 set for humidity) followed by
+    the CRC-8 (x^8 + x^5 + x^4 + 1) the sensor sends. Conversion times
+    are the datasheet maxima for 14 bit temperature / 12 bit humidity.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SIM_HTU21DF_H
+#define _FLEX_SIM_HTU21DF_H
+
+#include "FlexSimDevice.h"
+
+#define FLEX_SIM_HTU21DF_TEMP_US    50000
+#define FLEX_SIM_HTU21DF_HUM_US     16000
+#define FLEX_SIM_HTU21DF_RESET_US   15000
+
+class FlexSimHTU21DF : public FlexSimDevice
+{
+ public:
+  FlexSimHTU21DF(uint8_t address = 0x40);
+
+  bool     write(const uint8_t *data, size_t count);
+  size_t   read(uint8_t *dest, size_t count);
+  uint32_t stretchMicros(void);
+
+  void     setTemperature(float celsius);
+  void     setHumidity(float percent);
+
+  static uint8_t crc8(const uint8_t *data, uint8_t count);
+
+ private:
+  typedef enum { NONE, TEMPERATURE, HUMIDITY, USER_REGISTER } result_t;
+
+  void     startConversion(result_t kind, bool hold, uint32_t duration);
+  uint16_t rawResult(void);
+
+  result_t _result;
+  bool     _hold;
+  uint64_t _readyAt;
+  uint64_t _resetUntil;
+  uint8_t  _userRegister;
+  float    _temperature;
+  float    _humidity;
+};
+
+#endif
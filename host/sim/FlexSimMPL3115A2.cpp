@@ -0,0 +1,200 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimMPL3115A2.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated MPL3115A2 barometer / altimeter.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexSimMPL3115A2.h"
+
+#define REG_STATUS      0x00
+#define REG_OUT_P_MSB   0x01
+#define REG_OUT_T_MSB   0x04
+#define REG_DR_STATUS   0x06
+#define REG_WHO_AM_I    0x0C
+#define REG_PT_DATA_CFG 0x13
+#define REG_CTRL_REG1   0x26
+#define REG_CTRL_REG2   0x27
+
+#define CTRL1_SBYB      0x01
+#define CTRL1_OST       0x02
+#define CTRL1_RST       0x04
+#define CTRL1_ALT       0x80
+
+#define STATUS_TDR      0x02
+#define STATUS_PDR      0x04
+#define STATUS_PTDR     0x08
+#define STATUS_TOW      0x20
+#define STATUS_POW      0x40
+#define STATUS_PTOW     0x80
+
+FlexSimMPL3115A2::FlexSimMPL3115A2(uint8_t address)
+  : FlexSimRegisterDevice(address)
+{
+  _pressure = 101325.0;
+  _altitude = 12.5;
+  _temperature = 21.0;
+  reset();
+}
+
+void FlexSimMPL3115A2::setPressure(float pascal)
+{
+  _pressure = pascal;
+}
+
+void FlexSimMPL3115A2::setAltitude(float meters)
+{
+  _altitude = meters;
+}
+
+void FlexSimMPL3115A2::setTemperature(float celsius)
+{
+  _temperature = celsius;
+}
+
+uint32_t FlexSimMPL3115A2::conversionMicros(void)
+{
+  static const uint32_t times[8] = { 6000, 10000, 18000, 34000, 66000, 130000, 258000, 512000 };
+  return times[(_regs[REG_CTRL_REG1] >> 3) & 0x07];
+}
+
+uint32_t FlexSimMPL3115A2::conversions(void)
+{
+  update();
+  return _conversions;
+}
+
+void FlexSimMPL3115A2::reset(void)
+{
+  memset(_regs, 0, sizeof(_regs));
+  _regs[REG_WHO_AM_I] = 0xC4;
+  _converting = false;
+  _readyAt = 0;
+  _active = false;
+  _activeSince = 0;
+  _activeSamples = 0;
+  _conversions = 0;
+}
+
+void FlexSimMPL3115A2::update(void)
+{
+  uint64_t now = flexSimNow();
+
+  if (_converting && (now >= _readyAt))
+  {
+    _converting = false;
+    _regs[REG_CTRL_REG1] &= ~CTRL1_OST;
+    latch();
+  }
+
+  if (_active)
+  {
+    uint64_t period = 1000000ULL << (_regs[REG_CTRL_REG2] & 0x0F);
+    uint64_t first = _activeSince + conversionMicros();
+    if (now >= first)
+    {
+      uint32_t due = (uint32_t)((now - first) / period) + 1;
+      if (due > _activeSamples)
+      {
+        latch();
+        _activeSamples = due;
+      }
+    }
+  }
+}
+
+void FlexSimMPL3115A2::onWrite(uint8_t reg, uint8_t value)
+{
+  if (reg == REG_CTRL_REG1)
+  {
+    if (value & CTRL1_RST)
+    {
+      reset();
+      return;
+    }
+
+    bool active = (value & CTRL1_SBYB);
+    if (active && !_active)
+    {
+      _activeSince = flexSimNow();
+      _activeSamples = 0;
+    }
+    _active = active;
+
+    bool start = (value & CTRL1_OST) && !(_regs[reg] & CTRL1_OST) && !_converting;
+    _regs[reg] = value;
+    if (start)
+    {
+      _converting = true;
+      _readyAt = flexSimNow() + conversionMicros();
+    }
+    return;
+  }
+  if ((reg <= REG_DR_STATUS) || (reg == REG_WHO_AM_I))
+  {
+    return;             // read only
+  }
+  _regs[reg] = value;
+}
+
+uint8_t FlexSimMPL3115A2::onRead(uint8_t reg)
+{
+  uint8_t value = _regs[reg];
+
+  if (reg == REG_STATUS)
+  {
+    value = _regs[REG_DR_STATUS];     // FIFO off: STATUS mirrors DR_STATUS
+  }
+  else if (reg == REG_OUT_P_MSB)
+  {
+    _regs[REG_DR_STATUS] &= ~(STATUS_PDR | STATUS_POW);
+  }
+  else if (reg == REG_OUT_T_MSB)
+  {
+    _regs[REG_DR_STATUS] &= ~(STATUS_TDR | STATUS_TOW);
+  }
+
+  if ((_regs[REG_DR_STATUS] & (STATUS_PDR | STATUS_TDR)) == 0)
+  {
+    _regs[REG_DR_STATUS] &= ~(STATUS_PTDR | STATUS_PTOW);
+  }
+  return value;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Stores a finished conversion in OUT_P / OUT_T
+*/
+/**************************************************************************/
+void FlexSimMPL3115A2::latch(void)
+{
+  uint32_t p;
+
+  if (_regs[REG_CTRL_REG1] & CTRL1_ALT)
+  {
+    p = ((uint32_t)(int32_t)floorf(_altitude * 16.0F) << 4) & 0xFFFFF0;   // Q16.4, left aligned
+  }
+  else
+  {
+    p = ((uint32_t)(_pressure * 4.0F) << 4) & 0xFFFFF0;                   // Q18.2, left aligned
+  }
+  uint16_t t = (uint16_t)((int16_t)floorf(_temperature * 16.0F) << 4);   // Q8.4
+
+  _regs[REG_OUT_P_MSB] = (uint8_t)(p >> 16);
+  _regs[REG_OUT_P_MSB + 1] = (uint8_t)(p >> 8);
+  _regs[REG_OUT_P_MSB + 2] = (uint8_t)p;
+  _regs[REG_OUT_T_MSB] = (uint8_t)(t >> 8);
+  _regs[REG_OUT_T_MSB + 1] = (uint8_t)t;
+
+  uint8_t status = _regs[REG_DR_STATUS];
+  if (status & STATUS_PDR)  status |= STATUS_POW;
+  if (status & STATUS_TDR)  status |= STATUS_TOW;
+  if (status & STATUS_PTDR) status |= STATUS_PTOW;
+  _regs[REG_DR_STATUS] = status | STATUS_PDR | STATUS_TDR | STATUS_PTDR;
+  _conversions++;
+}
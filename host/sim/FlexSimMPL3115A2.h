@@ -0,0 +1,58 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimMPL3115A2.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Simulated MPL3115A2 barometer / altimeter (address 0x60).
+
+    Register file with auto-increment. Setting OST in CTRL_REG1 starts a
+    one shot conversion that takes the datasheet time for the oversample
+    ratio (6 ms at OS=0 .. 512 ms at OS=7); when done OST clears and
+    STATUS PDR/TDR/PTDR are set (with overwrite flags if the previous
+    result was never read). Reading OUT_P_MSB clears PDR, OUT_T_MSB
+    clears TDR. In active mode (SBYB) conversions repeat every 2^ST
+    seconds (CTRL_REG2). OUT_P holds pressure (Q18.2 Pa) or, with ALT
+    set, altitude (Q16.4 m); OUT_T is Q8.4 degC.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SIM_MPL3115A2_H
+#define _FLEX_SIM_MPL3115A2_H
+
+#include "FlexSimDevice.h"
+
+class FlexSimMPL3115A2 : public FlexSimRegisterDevice
+{
+ public:
+  FlexSimMPL3115A2(uint8_t address = 0x60);
+
+  void     setPressure(float pascal);
+  void     setAltitude(float meters);
+  void     setTemperature(float celsius);
+  uint32_t conversionMicros(void);      // for the current oversample ratio
+  uint32_t conversions(void);
+
+ protected:
+  void     update(void);
+  void     onWrite(uint8_t reg, uint8_t value);
+  uint8_t  onRead(uint8_t reg);
+
+ private:
+  void     reset(void);
+  void     latch(void);
+
+  float    _pressure;
+  float    _altitude;
+  float    _temperature;
+  bool     _converting;
+  uint64_t _readyAt;
+  bool     _active;
+  uint64_t _activeSince;
+  uint32_t _activeSamples;
+  uint32_t _conversions;
+};
+
+#endif
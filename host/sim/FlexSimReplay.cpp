@@ -0,0 +1,285 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimReplay.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    Serves a FlexI2CTrace capture back to the drivers (see
+    FlexSimReplay.h).
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include <string.h>
+
+#include "FlexSimReplay.h"
+
+/***************************************************************************
+ PORT
+ ***************************************************************************/
+
+FlexSimReplayPort::FlexSimReplayPort(FlexSimReplay *replay, uint8_t address)
+  : FlexSimDevice(address), _replay(replay)
+{
+}
+
+bool FlexSimReplayPort::ackAddress(bool read)
+{
+  return _replay->addressPhase(_address, read);
+}
+
+bool FlexSimReplayPort::write(const uint8_t *data, size_t count)
+{
+  return _replay->serveWrite(_address, data, count);
+}
+
+size_t FlexSimReplayPort::read(uint8_t *dest, size_t count)
+{
+  return _replay->serveRead(_address, dest, count);
+}
+
+/***************************************************************************
+ REPLAY
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Decodes the whole trace up front; valid() is false when it
+            holds a malformed or partial record (the records before it
+            are still served)
+*/
+/**************************************************************************/
+FlexSimReplay::FlexSimReplay(const uint8_t *trace, size_t length)
+{
+  FlexI2CTraceReader reader;
+  flexTraceRecord_t  record;
+  size_t   offset = 0;
+  uint32_t previous = 0;
+  uint64_t at = 0;
+
+  _valid = true;
+  _pace = true;
+  while (offset < length)
+  {
+    size_t left = length - offset;
+    int16_t used = reader.decode(&trace[offset], (left > 0xFFFF) ? 0xFFFF : (uint16_t)left, &record);
+    if (used <= 0)
+    {
+      _valid = false;
+      break;
+    }
+
+    if (!_entries.empty())
+    {
+      at += (uint32_t)(record.at - previous);
+    }
+    previous = record.at;
+
+    entry_t entry;
+    entry.at = at;
+    entry.bytes.assign(record.data, record.data + record.length);
+    entry.record = record;
+    entry.record.data = NULL;   // see bytes
+    _entries.push_back(entry);
+
+    offset += used;
+  }
+  rewind();
+}
+
+FlexSimReplay::~FlexSimReplay()
+{
+  for (size_t i = 0; i < _ports.size(); i++)
+  {
+    delete _ports[i];
+  }
+}
+
+bool FlexSimReplay::valid(void)
+{
+  return _valid;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Attaches a port for every address in the trace to bus.
+            Attach it to a bus without models for those addresses.
+*/
+/**************************************************************************/
+uint8_t FlexSimReplay::attach(TwoWire *bus)
+{
+  bool    seen[128];
+  uint8_t attached = 0;
+
+  memset(seen, 0, sizeof(seen));
+  for (size_t i = 0; i < _entries.size(); i++)
+  {
+    uint8_t address = _entries[i].record.address & 0x7F;
+    if (seen[address])
+    {
+      continue;
+    }
+    seen[address] = true;
+
+    FlexSimReplayPort *port = new FlexSimReplayPort(this, address);
+    if (!bus->attach(port))
+    {
+      delete port;
+      break;
+    }
+    _ports.push_back(port);
+    attached++;
+  }
+  return attached;
+}
+
+void FlexSimReplay::setPacing(bool pace)
+{
+  _pace = pace;
+}
+
+bool FlexSimReplay::done(void)
+{
+  return _next >= _entries.size();
+}
+
+void FlexSimReplay::rewind(void)
+{
+  _next = 0;
+  _pending = false;
+  _started = false;
+  _origin = 0;
+  _mismatched = -1;
+
+  memset(&_stats, 0, sizeof(_stats));
+  _stats.records = _entries.size();
+  _stats.firstMismatch = -1;
+  _stats.maxGapRecord = -1;
+}
+
+flexSimReplayStats_t FlexSimReplay::stats(void)
+{
+  return _stats;
+}
+
+void FlexSimReplay::mismatch(size_t index)
+{
+  if (_mismatched == (int32_t)index)
+  {
+    return;
+  }
+  _mismatched = (int32_t)index;
+  _stats.mismatches++;
+  if (_stats.firstMismatch < 0)
+  {
+    _stats.firstMismatch = (int32_t)index;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Takes the next record for an address phase: holds the
+            transfer to its recorded time and ACKs or NACKs it as
+            recorded
+*/
+/**************************************************************************/
+bool FlexSimReplay::addressPhase(uint8_t address, bool read)
+{
+  _pending = false;
+  if (_next >= _entries.size())
+  {
+    _stats.overruns++;
+    return false;
+  }
+
+  size_t   index = _next++;
+  entry_t *entry = &_entries[index];
+  uint64_t now = flexSimNow();
+
+  if (!_started)
+  {
+    _origin = now - entry->at;
+    _started = true;
+  }
+
+  uint64_t target = _origin + entry->at;
+  if (_pace && (now < target))
+  {
+    uint64_t gap = target - now;
+    flexSimAdvance(gap);
+    _stats.pacedMicros += gap;
+    if (gap > _stats.maxGapMicros)
+    {
+      _stats.maxGapMicros = (uint32_t)gap;
+      _stats.maxGapRecord = (int32_t)index;
+    }
+  }
+  else if ((now > target) && (now - target > _stats.maxLateMicros))
+  {
+    _stats.maxLateMicros = (uint32_t)(now - target);
+  }
+
+  _stats.served++;
+  if ((entry->record.address != address) || (entry->record.read != read))
+  {
+    mismatch(index);
+  }
+  if (entry->record.result == FLEX_ERR_ADDR_NACK)
+  {
+    return false;
+  }
+  _pending = true;
+  return true;
+}
+
+bool FlexSimReplay::serveWrite(uint8_t address, const uint8_t *data, size_t count)
+{
+  (void)address;
+  if (!_pending)
+  {
+    return false;
+  }
+  _pending = false;
+
+  size_t   index = _next - 1;
+  entry_t *entry = &_entries[index];
+  if (entry->record.read || (entry->record.count != count) ||
+      (count && memcmp(entry->bytes.data(), data, count)))
+  {
+    mismatch(index);
+  }
+  return (entry->record.result == FLEX_OK);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Supplies the recorded bytes of a read. Short reads supply as
+            many (zero) bytes as the device did in the field.
+*/
+/**************************************************************************/
+size_t FlexSimReplay::serveRead(uint8_t address, uint8_t *dest, size_t count)
+{
+  (void)address;
+  if (!_pending)
+  {
+    return 0;
+  }
+  _pending = false;
+
+  size_t   index = _next - 1;
+  entry_t *entry = &_entries[index];
+  if (!entry->record.read || (entry->record.count != count))
+  {
+    mismatch(index);
+  }
+
+  size_t supplied = entry->record.received;
+  if (supplied > count)
+  {
+    supplied = count;
+  }
+  memset(dest, 0, supplied);
+  memcpy(dest, entry->bytes.data(), (entry->bytes.size() < supplied) ? entry->bytes.size() : supplied);
+  return supplied;
+}
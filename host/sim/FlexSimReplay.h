@@ -0,0 +1,120 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimReplay.h
+    @author   J.A. Korten
+    @license  BSD
+
+    Serves a FlexI2CTrace capture back to the unmodified drivers.
+
+    Instead of register models the bus gets one replay port per address
+    in the trace. Every address phase takes the next record: it is ACKed
+    or NACKed as recorded, a read returns the recorded bytes and a write
+    is compared with the recorded one. Transfers that differ from the
+    trace (address, direction, length or written bytes) are counted as
+    mismatches, so a replay with none reproduces the field unit's bus
+    traffic exactly.
+
+    With pacing on (the default) a transfer does not start before its
+    recorded time, relative to the first one: the simulated clock is
+    advanced over the time the field unit spent outside the drivers
+    (its other work, serial output, a stalled loop), so micros() based
+    timestamps, timeouts and polling loops run as in the field. The time
+    added that way is the field unit's own loop profile: stats() gives
+    the total, the largest single gap and the record it came before.
+
+    Usage:
+    FlexSimReplay replay(traceBytes, traceLength);
+    TwoWire bus;
+    replay.attach(&bus);                // instead of the models
+    RP_FXOS8700 accelMag(&bus);
+    accelMag.begin();                   // the sketch's code, unchanged
+    ...
+    flexSimReplayStats_t s = replay.stats();
+
+    Recorded Wire timeouts and bus errors of writes come back as data
+    NACKs, the host bus has no other way to fail a transfer.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SIM_REPLAY_H
+#define _FLEX_SIM_REPLAY_H
+
+#include <vector>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "FlexSim.h"
+#include "FlexSimDevice.h"
+#include "FlexI2CTrace.h"
+
+typedef struct
+{
+  uint32_t records;         // in the trace
+  uint32_t served;          // address phases answered from the trace
+  uint32_t mismatches;      // transfers that differ from their record
+  int32_t  firstMismatch;   // record index, -1 for none
+  uint32_t overruns;        // transfers after the end of the trace
+  uint64_t pacedMicros;     // clock advanced to hold transfers to their recorded time
+  uint32_t maxGapMicros;    // largest single advance ...
+  int32_t  maxGapRecord;    // ... and the record it held back
+  uint32_t maxLateMicros;   // largest start after the recorded time
+} flexSimReplayStats_t;
+
+class FlexSimReplay;
+
+class FlexSimReplayPort : public FlexSimDevice
+{
+ public:
+  FlexSimReplayPort(FlexSimReplay *replay, uint8_t address);
+
+  bool     ackAddress(bool read);
+  bool     write(const uint8_t *data, size_t count);
+  size_t   read(uint8_t *dest, size_t count);
+
+ private:
+  FlexSimReplay *_replay;
+};
+
+class FlexSimReplay
+{
+ public:
+  FlexSimReplay(const uint8_t *trace, size_t length);
+  ~FlexSimReplay();
+
+  bool      valid(void);                 // the whole trace decoded
+  uint8_t   attach(TwoWire *bus);        // one port per address, returns the ports attached
+  void      setPacing(bool pace);
+  bool      done(void);                  // every record served
+  void      rewind(void);                // serve from the first record again, clears stats()
+  flexSimReplayStats_t stats(void);
+
+ private:
+  friend class FlexSimReplayPort;
+
+  typedef struct
+  {
+    uint64_t             at;             // us since the first record
+    flexTraceRecord_t    record;         // data is NULL, see bytes
+    std::vector<uint8_t> bytes;
+  } entry_t;
+
+  bool      addressPhase(uint8_t address, bool read);
+  bool      serveWrite(uint8_t address, const uint8_t *data, size_t count);
+  size_t    serveRead(uint8_t address, uint8_t *dest, size_t count);
+  void      mismatch(size_t index);
+
+  std::vector<entry_t>            _entries;
+  std::vector<FlexSimReplayPort*> _ports;
+  bool      _valid;
+  bool      _pace;
+  size_t    _next;                       // record for the next address phase
+  bool      _pending;                    // _next - 1 was ACKed, its data phase follows
+  bool      _started;
+  uint64_t  _origin;                     // simulated time of the first record
+  int32_t   _mismatched;                 // last record counted as a mismatch
+  flexSimReplayStats_t _stats;
+};
+
+#endif
@@ -0,0 +1,163 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimTransport.cpp
+    @author   J.A. Korten
+    @license  BSD
+
+    FlexI2CTransport backend for the host simulator.
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#include "FlexSimTransport.h"
+
+FlexSimTransport::FlexSimTransport(TwoWire *wire)
+{
+  _wire = wire;
+  _wire->setBackground(true);
+  _head = NULL;
+  _tail = NULL;
+  _result = FLEX_OK;
+  _completed = 0;
+  _busMicros = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Queues the transfer, it starts as soon as the bus is free
+*/
+/**************************************************************************/
+bool FlexSimTransport::submit(flexI2CTransfer_t *transfer)
+{
+  if ((transfer == NULL) || (transfer->count == 0) || (transfer->data == NULL))
+  {
+    return false;
+  }
+
+  noInterrupts();
+  for (flexI2CTransfer_t *queued = _head; queued != NULL; queued = queued->next)
+  {
+    if (queued == transfer)
+    {
+      interrupts();
+      return false;   // still in flight
+    }
+  }
+
+  transfer->done = false;
+  transfer->next = NULL;
+  if (_head == NULL)
+  {
+    _head = transfer;
+    _tail = transfer;
+    begin();
+  }
+  else
+  {
+    _tail->next = transfer;
+    _tail = transfer;
+  }
+  interrupts();
+  return true;
+}
+
+bool FlexSimTransport::idle(void)
+{
+  return _head == NULL;
+}
+
+uint32_t FlexSimTransport::completed(void)
+{
+  return _completed;
+}
+
+uint64_t FlexSimTransport::busMicros(void)
+{
+  return _busMicros;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Runs the head transfer against the models right away (bus
+            time collected, not spent) and schedules its completion
+*/
+/**************************************************************************/
+void FlexSimTransport::begin(void)
+{
+  flexI2CTransfer_t *transfer = _head;
+  uint8_t status = 0;
+
+  _wire->takeBackgroundMicros();
+  if (transfer->op != FLEX_TRANSFER_RECEIVE)
+  {
+    _wire->beginTransmission(transfer->address);
+    _wire->write(transfer->reg);
+    if (transfer->op == FLEX_TRANSFER_READ)
+    {
+      status = _wire->endTransmission(false);
+    }
+    else
+    {
+      _wire->write(transfer->data, transfer->count);
+      status = _wire->endTransmission();
+    }
+  }
+
+  _result = (status == 0) ? FLEX_OK : (status == 2) ? FLEX_ERR_ADDR_NACK :
+            (status == 3) ? FLEX_ERR_DATA_NACK : FLEX_ERR_BUS;
+
+  if ((_result == FLEX_OK) && (transfer->op != FLEX_TRANSFER_WRITE))
+  {
+    uint8_t received = _wire->requestFrom(transfer->address, (size_t)transfer->count);
+    for (uint8_t i = 0; i < received; i++)
+    {
+      _rx[i] = _wire->read();
+    }
+    if (received < transfer->count)
+    {
+      _result = (received == 0) ? FLEX_ERR_ADDR_NACK : FLEX_ERR_SHORT_READ;
+    }
+  }
+
+  uint64_t us = _wire->takeBackgroundMicros();
+  _busMicros += us;
+  flexSimSchedule(flexSimNow() + us, onComplete, this);
+}
+
+void FlexSimTransport::onComplete(void *context)
+{
+  ((FlexSimTransport *)context)->finish();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Completion "interrupt": hands the transfer back and starts the
+            next one, which may have been queued by the callback
+*/
+/**************************************************************************/
+void FlexSimTransport::finish(void)
+{
+  flexI2CTransfer_t *transfer = _head;
+
+  if ((_result == FLEX_OK) && (transfer->op != FLEX_TRANSFER_WRITE))
+  {
+    memcpy(transfer->data, _rx, transfer->count);
+  }
+
+  _head = transfer->next;
+  if (_head == NULL)
+  {
+    _tail = NULL;
+  }
+  transfer->next = NULL;
+  _completed++;
+
+  // a transfer submitted by the callback onto an idle queue starts itself
+  flexI2CTransfer_t *next = _head;
+  complete(transfer, _result);
+  if (next != NULL)
+  {
+    begin();
+  }
+}
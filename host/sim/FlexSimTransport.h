@@ -0,0 +1,64 @@
+/**************************************************************************/
+/*!
+    @file     FlexSimTransport.h
+    @author   J.A. Korten
+    @license  BSD
+
+    FlexI2CTransport backend for the host simulator.
+
+    Behaves like an interrupt / DMA driven I2C controller: submit()
+    queues the transfer and returns, the transfer occupies the bus for its
+    real bus time on the simulated timeline and completes in a timed
+    event (see flexSimSchedule()), in the middle of whatever the CPU side
+    is doing. Transfers run one after the other in submission order.
+
+    The transport puts its TwoWire in background mode, so give it a bus of
+    its own with the models it talks to attached (a model may be attached
+    to several buses) and keep blocking drivers off that bus. The device
+    sees the transfer when it starts, data and callback arrive when it
+    ends.
+
+    Usage:
+    TwoWire dmaBus;
+    dmaBus.attach(&fxosSim);
+    FlexSimTransport transport(&dmaBus);
+    accelMag.setTransport(&transport);
+
+    Flexible extensions J.A. Korten 2019
+*/
+/**************************************************************************/
+
+#ifndef _FLEX_SIM_TRANSPORT_H
+#define _FLEX_SIM_TRANSPORT_H
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "FlexSim.h"
+#include "FlexI2CTransport.h"
+
+class FlexSimTransport : public FlexI2CTransport
+{
+ public:
+  FlexSimTransport(TwoWire *wire);
+
+  bool      submit(flexI2CTransfer_t *transfer);
+  bool      idle(void);
+
+  uint32_t  completed(void);        // transfers completed so far
+  uint64_t  busMicros(void);        // bus time of those transfers
+
+ private:
+  static void onComplete(void *context);
+  void      begin(void);            // puts the head of the queue on the wire
+  void      finish(void);
+
+  TwoWire            *_wire;
+  flexI2CTransfer_t  *_head;         // on the wire
+  flexI2CTransfer_t  *_tail;
+  flexResult_t        _result;       // of the transfer on the wire
+  uint8_t             _rx[WIRE_BUFFER_LENGTH];
+  uint32_t            _completed;
+  uint64_t            _busMicros;
+};
+
+#endif